@@ -393,21 +393,7 @@ ref<Texture> Texture::createFromFile(
         Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
         if (pBitmap)
         {
-            ResourceFormat texFormat = pBitmap->getFormat();
-            if (loadAsSrgb)
-            {
-                texFormat = linearToSrgbFormat(texFormat);
-            }
-
-            pTex = pDevice->createTexture2D(
-                pBitmap->getWidth(),
-                pBitmap->getHeight(),
-                texFormat,
-                1,
-                generateMipLevels ? Texture::kMaxPossible : 1,
-                pBitmap->getData(),
-                bindFlags
-            );
+            pTex = createFromBitmap(pDevice, *pBitmap, generateMipLevels, loadAsSrgb, bindFlags);
         }
     }
 
@@ -431,6 +417,25 @@ ref<Texture> Texture::createFromFile(
     return pTex;
 }
 
+ref<Texture> Texture::createFromBitmap(
+    ref<Device> pDevice,
+    const Bitmap& bitmap,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    ResourceBindFlags bindFlags
+)
+{
+    ResourceFormat texFormat = bitmap.getFormat();
+    if (loadAsSrgb)
+    {
+        texFormat = linearToSrgbFormat(texFormat);
+    }
+
+    return pDevice->createTexture2D(
+        bitmap.getWidth(), bitmap.getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, bitmap.getData(), bindFlags
+    );
+}
+
 gfx::IResource* Texture::getGfxResource() const
 {
     return mGfxTextureResource;
@@ -583,30 +588,13 @@ void Texture::getSubresourceBlob(uint32_t subresource, void* pData, size_t size)
     std::memcpy(pData, data.data(), data.size());
 }
 
-void Texture::captureToFile(
-    uint32_t mipLevel,
-    uint32_t arraySlice,
-    const std::filesystem::path& path,
-    Bitmap::FileFormat format,
-    Bitmap::ExportFlags exportFlags,
-    bool async
-)
+std::vector<uint8_t> Texture::readImageData(uint32_t mipLevel, uint32_t arraySlice, ResourceFormat& format)
 {
-    if (format == Bitmap::FileFormat::DdsFile)
-    {
-        FALCOR_THROW("Texture::captureToFile does not yet support saving to DDS.");
-    }
-
-    if (mType != Type::Texture2D)
-        FALCOR_THROW("Texture::captureToFile only supported for 2D textures.");
-
     RenderContext* pContext = mpDevice->getRenderContext();
 
     // Handle the special case where we have an HDR texture with less then 3 channels.
     FormatType type = getFormatType(mFormat);
     uint32_t channels = getFormatChannelCount(mFormat);
-    std::vector<uint8_t> textureData;
-    ResourceFormat resourceFormat = mFormat;
 
     if (type == FormatType::Float && channels < 3)
     {
@@ -620,15 +608,34 @@ void Texture::captureToFile(
             ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
         );
         pContext->blit(getSRV(mipLevel, 1, arraySlice, 1), pOther->getRTV(0, 0, 1));
-        textureData = pContext->readTextureSubresource(pOther.get(), 0);
-        resourceFormat = ResourceFormat::RGBA32Float;
+        format = ResourceFormat::RGBA32Float;
+        return pContext->readTextureSubresource(pOther.get(), 0);
     }
-    else
+
+    format = mFormat;
+    return pContext->readTextureSubresource(this, getSubresourceIndex(arraySlice, mipLevel));
+}
+
+void Texture::captureToFile(
+    uint32_t mipLevel,
+    uint32_t arraySlice,
+    const std::filesystem::path& path,
+    Bitmap::FileFormat format,
+    Bitmap::ExportFlags exportFlags,
+    bool async
+)
+{
+    if (format == Bitmap::FileFormat::DdsFile)
     {
-        uint32_t subresource = getSubresourceIndex(arraySlice, mipLevel);
-        textureData = pContext->readTextureSubresource(this, subresource);
+        FALCOR_THROW("Texture::captureToFile does not yet support saving to DDS.");
     }
 
+    if (mType != Type::Texture2D)
+        FALCOR_THROW("Texture::captureToFile only supported for 2D textures.");
+
+    ResourceFormat resourceFormat;
+    std::vector<uint8_t> textureData = readImageData(mipLevel, arraySlice, resourceFormat);
+
     uint32_t width = getWidth(mipLevel);
     uint32_t height = getHeight(mipLevel);
 
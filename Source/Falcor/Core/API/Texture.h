@@ -195,6 +195,22 @@ public:
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
     );
 
+    /**
+     * Create a new texture object from a bitmap, e.g. one decoded ahead of time with Bitmap::createFromFile().
+     * @param[in] bitmap The bitmap holding the image data.
+     * @param[in] generateMipLevels Whether the mip-chain should be generated.
+     * @param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3 or 4 component textures.
+     * @param[in] bindFlags The bind flags to create the texture with.
+     * @return A new texture.
+     */
+    static ref<Texture> createFromBitmap(
+        ref<Device> pDevice,
+        const Bitmap& bitmap,
+        bool generateMipLevels,
+        bool loadAsSrgb,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource
+    );
+
     gfx::ITextureResource* getGfxTextureResource() const { return mGfxTextureResource; }
 
     virtual gfx::IResource* getGfxResource() const override;
@@ -274,6 +290,16 @@ public:
      */
     void getSubresourceBlob(uint32_t subresource, void* pData, size_t size) const;
 
+    /**
+     * Read back a subresource for saving to an image file.
+     * HDR textures with less than three channels are expanded to RGBA32Float, as not all image formats support them.
+     * @param[in] mipLevel Requested mip-level
+     * @param[in] arraySlice Requested array-slice
+     * @param[out] format Format of the returned data.
+     * @return The texel data.
+     */
+    std::vector<uint8_t> readImageData(uint32_t mipLevel, uint32_t arraySlice, ResourceFormat& format);
+
     /**
      * Capture the texture to an image file.
      * @param[in] mipLevel Requested mip-level
@@ -310,6 +336,11 @@ public:
      */
     const std::filesystem::path& getSourcePath() const { return mSourcePath; }
 
+    /**
+     * In case the texture was loaded from a file, use this to set the import flags used.
+     */
+    void setImportFlags(Bitmap::ImportFlags importFlags) { mImportFlags = importFlags; }
+
     /**
      * In case the texture was loaded from a file, get the import flags used.
      */
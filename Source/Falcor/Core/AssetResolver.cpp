@@ -44,7 +44,12 @@ std::filesystem::path AssetResolver::resolvePath(const std::filesystem::path& pa
     // If this is an existing absolute path, or a relative path to the working directory, return it.
     std::filesystem::path absolute = std::filesystem::absolute(path);
     if (std::filesystem::exists(absolute))
-        return std::filesystem::canonical(absolute);
+    {
+        std::filesystem::path canonical = std::filesystem::canonical(absolute);
+        if (mResolveCallback)
+            mResolveCallback(canonical);
+        return canonical;
+    }
 
     // Otherwise, try to resolve using search paths.
     // First try resolving for the specified asset category.
@@ -56,6 +61,8 @@ std::filesystem::path AssetResolver::resolvePath(const std::filesystem::path& pa
 
     if (resolved.empty())
         logWarning("Failed to resolve path '{}' for asset type '{}'.", path, category);
+    else if (mResolveCallback)
+        mResolveCallback(resolved);
 
     return resolved;
 }
@@ -75,7 +82,12 @@ std::vector<std::filesystem::path> AssetResolver::resolvePathPattern(
     std::filesystem::path absolute = std::filesystem::absolute(path);
     std::vector<std::filesystem::path> resolved = globFilesInDirectory(absolute, regex, firstMatchOnly);
     if (!resolved.empty())
+    {
+        if (mResolveCallback)
+            for (const auto& p : resolved)
+                mResolveCallback(p);
         return resolved;
+    }
 
     // Otherwise, try to resolve using search paths.
     // First try resolving for the specified asset category.
@@ -87,6 +99,9 @@ std::vector<std::filesystem::path> AssetResolver::resolvePathPattern(
 
     if (resolved.empty())
         logWarning("Failed to resolve path pattern '{}/{}' for asset type '{}'.", path, pattern, category);
+    else if (mResolveCallback)
+        for (const auto& p : resolved)
+            mResolveCallback(p);
 
     return resolved;
 }
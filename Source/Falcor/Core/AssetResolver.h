@@ -30,6 +30,7 @@
 #include "Macros.h"
 #include "Enum.h"
 #include <filesystem>
+#include <functional>
 #include <regex>
 #include <string>
 #include <vector>
@@ -88,6 +89,9 @@ FALCOR_ENUM_REGISTER(SearchPathPriority);
 class FALCOR_API AssetResolver
 {
 public:
+    /// Callback invoked for every successfully resolved path.
+    using ResolveCallback = std::function<void(const std::filesystem::path& resolvedPath)>;
+
     /// Default constructor.
     AssetResolver();
 
@@ -137,6 +141,13 @@ public:
         AssetCategory category = AssetCategory::Any
     );
 
+    /**
+     * Set a callback that is invoked with every path resolved by this resolver.
+     * This is used to track the files a scene is loaded from. The callback is copied along with the resolver.
+     * @param callback Callback function, or an empty function to disable.
+     */
+    void setResolveCallback(ResolveCallback callback) { mResolveCallback = std::move(callback); }
+
     /// Return the global default asset resolver.
     static AssetResolver& getDefaultResolver();
 
@@ -158,5 +169,6 @@ private:
     };
 
     std::vector<SearchContext> mSearchContexts;
+    ResolveCallback mResolveCallback;
 };
 } // namespace Falcor
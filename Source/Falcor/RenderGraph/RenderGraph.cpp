@@ -35,6 +35,7 @@
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
 #include "Utils/Scripting/Scripting.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Utils/StringUtils.h"
 
 namespace Falcor
 {
@@ -545,6 +546,14 @@ void RenderGraph::setInput(const std::string& name, const ref<Resource>& pResour
         mpExe->setInput(name, pResource);
 }
 
+void RenderGraph::setResourceAliasingEnabled(bool enabled)
+{
+    if (mCompilerDeps.aliasResources == enabled)
+        return;
+    mCompilerDeps.aliasResources = enabled;
+    mRecompile = true;
+}
+
 void RenderGraph::markOutput(const std::string& name, TextureChannelFlags mask)
 {
     FALCOR_CHECK(mask != TextureChannelFlags::None, "Mask must be non-empty");
@@ -676,6 +685,26 @@ bool canFieldsConnect(const RenderPassReflection::Field& src, const RenderPassRe
 
 void RenderGraph::renderUI(RenderContext* pRenderContext, Gui::Widgets& widget)
 {
+    if (auto group = widget.group("Resource aliasing"))
+    {
+        bool enabled = isResourceAliasingEnabled();
+        if (group.checkbox("Enabled", enabled))
+            setResourceAliasingEnabled(enabled);
+        group.tooltip("Share resources between transient fields with disjoint lifetimes.");
+
+        if (mpExe)
+        {
+            const auto& stats = mpExe->getAliasingStats();
+            group.text(fmt::format(
+                "Resources: {} in {} allocations\nMemory: {} (saved {})",
+                stats.resourceCount,
+                stats.allocationCount,
+                formatByteSize(stats.allocatedSize),
+                formatByteSize(stats.getSavedSize())
+            ));
+        }
+    }
+
     if (mpExe)
         mpExe->renderUI(pRenderContext, widget);
 }
@@ -759,6 +788,7 @@ FALCOR_SCRIPT_BINDING(RenderGraph)
     renderGraph.def("get_pass", &RenderGraph::getPass, "name"_a);
     renderGraph.def("__getitem__", [](RenderGraph& self, const std::string& name) { return self.getPass(name); });
     renderGraph.def("get_output", pybind11::overload_cast<const std::string&>(&RenderGraph::getOutput), "name"_a);
+    renderGraph.def_property("resource_aliasing", &RenderGraph::isResourceAliasingEnabled, &RenderGraph::setResourceAliasingEnabled);
 
     // PYTHONDEPRECATED BEGIN
     renderGraph.def(
@@ -162,6 +162,17 @@ public:
      */
     void setInput(const std::string& name, const ref<Resource>& pResource);
 
+    /**
+     * Enable/disable sharing of resources between transient fields with disjoint lifetimes.
+     * Changing this triggers a recompilation of the graph.
+     */
+    void setResourceAliasingEnabled(bool enabled);
+
+    /**
+     * Returns true if resources are shared between transient fields with disjoint lifetimes.
+     */
+    bool isResourceAliasingEnabled() const { return mCompilerDeps.aliasResources; }
+
     /**
      * Returns true if a render pass exists by this name in the graph.
      */
@@ -263,13 +263,6 @@ bool RenderGraphCompiler::insertAutoPasses()
 
 void RenderGraphCompiler::allocateResources(ref<Device> pDevice, ResourceCache* pResourceCache)
 {
-    // Build list to look up execution order index from the pass
-    std::unordered_map<RenderPass*, uint32_t> passToIndex;
-    for (size_t i = 0; i < mExecutionList.size(); i++)
-    {
-        passToIndex.emplace(mExecutionList[i].pPass.get(), uint32_t(i));
-    }
-
     for (size_t i = 0; i < mExecutionList.size(); i++)
     {
         uint32_t nodeIndex = mExecutionList[i].index;
@@ -336,13 +329,12 @@ void RenderGraphCompiler::allocateResources(ref<Device> pDevice, ResourceCache*
             std::string srcFieldName = mGraph.mNodeData[pEdge->getSourceNode()].name + '.' + edgeData.srcField;
             std::string dstFieldName = mGraph.mNodeData[nodeIndex].name + '.' + dstField.getName();
 
-            const auto& pSrcPass = mGraph.mNodeData[pEdge->getSourceNode()].pPass.get();
-            const auto& srcReflection = mExecutionList[passToIndex.at(pSrcPass)].reflector;
-            pResourceCache->registerField(dstFieldName, dstField, passToIndex[pSrcPass], srcFieldName);
+            // The resource is in use until the consuming pass has executed
+            pResourceCache->registerField(dstFieldName, dstField, uint32_t(i), srcFieldName);
         }
     }
 
-    pResourceCache->allocateResources(pDevice, mDependencies.defaultResourceProps);
+    pResourceCache->allocateResources(pDevice, mDependencies.defaultResourceProps, mDependencies.aliasResources);
 }
 
 void RenderGraphCompiler::restoreCompilationChanges()
@@ -46,6 +46,7 @@ public:
     {
         ResourceCache::DefaultProperties defaultResourceProps;
         ResourceCache::ResourcesMap externalResources;
+        bool aliasResources = false; ///< Share resources between transient fields with disjoint lifetimes.
     };
     static std::unique_ptr<RenderGraphExe> compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies);
 
@@ -99,6 +99,11 @@ public:
      */
     void setInput(const std::string& name, const ref<Resource>& pResource);
 
+    /**
+     * Get statistics about the resources shared between transient fields.
+     */
+    const ResourceCache::AliasingStats& getAliasingStats() const { return mpResourceCache->getAliasingStats(); }
+
 private:
     friend class RenderGraphCompiler;
 
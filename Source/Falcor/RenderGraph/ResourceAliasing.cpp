@@ -0,0 +1,106 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ResourceAliasing.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <set>
+#include <utility>
+
+namespace Falcor
+{
+ResourceAliasingPlanner::Plan ResourceAliasingPlanner::plan(const std::vector<Request>& requests)
+{
+    Plan plan;
+    plan.slots.resize(requests.size(), kNoSlot);
+
+    // Visit requests in order of first use. Ties are broken by request index to keep the plan deterministic.
+    std::vector<uint32_t> order(requests.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return requests[a].firstUse < requests[b].firstUse; }
+    );
+
+    struct KeyState
+    {
+        std::set<std::pair<uint32_t, uint32_t>> busy; ///< Occupied slots as (lastUse, slot), ordered by when they become free.
+        std::set<uint32_t> free;                      ///< Slots that are free at the current time.
+    };
+    std::map<uint64_t, KeyState> keyStates;
+
+    auto newSlot = [&plan]()
+    {
+        plan.slotSizes.push_back(0);
+        return plan.getSlotCount() - 1;
+    };
+
+    for (uint32_t i : order)
+    {
+        const Request& request = requests[i];
+        FALCOR_ASSERT(request.firstUse <= request.lastUse);
+        plan.requestedSize += request.size;
+
+        uint32_t slot = kNoSlot;
+        if (request.canAlias)
+        {
+            KeyState& state = keyStates[request.key];
+
+            // Release all slots whose last use ends before this request starts.
+            while (!state.busy.empty() && state.busy.begin()->first < request.firstUse)
+            {
+                state.free.insert(state.busy.begin()->second);
+                state.busy.erase(state.busy.begin());
+            }
+
+            if (!state.free.empty())
+            {
+                slot = *state.free.begin();
+                state.free.erase(state.free.begin());
+            }
+            else
+            {
+                slot = newSlot();
+            }
+            state.busy.emplace(request.lastUse, slot);
+        }
+        else
+        {
+            slot = newSlot();
+        }
+
+        plan.slots[i] = slot;
+        plan.slotSizes[slot] = std::max(plan.slotSizes[slot], request.size);
+    }
+
+    for (uint64_t size : plan.slotSizes)
+        plan.allocatedSize += size;
+
+    return plan;
+}
+} // namespace Falcor
@@ -0,0 +1,75 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Plans which transient render graph resources can share the same allocation.
+ *
+ * Each request describes a resource by the range of execution indices it is used in, its size in bytes
+ * and a compatibility key. Requests with the same key and disjoint lifetimes are packed into the same slot
+ * using greedy interval partitioning, which uses the minimum number of slots per key.
+ * The planner doesn't touch the GPU, so it can be tested without a device.
+ */
+class FALCOR_API ResourceAliasingPlanner
+{
+public:
+    static constexpr uint32_t kNoSlot = uint32_t(-1);
+
+    struct Request
+    {
+        uint32_t firstUse = 0; ///< First execution index using the resource.
+        uint32_t lastUse = 0;  ///< Last execution index using the resource (inclusive).
+        uint64_t size = 0;     ///< Size of the resource in bytes.
+        uint64_t key = 0;      ///< Compatibility key. Only requests with equal keys can share a slot.
+        bool canAlias = true;  ///< If false, the request always gets a slot of its own.
+    };
+
+    struct Plan
+    {
+        std::vector<uint32_t> slots;     ///< Slot index for each request.
+        std::vector<uint64_t> slotSizes; ///< Size of each slot in bytes (the largest request assigned to it).
+        uint64_t requestedSize = 0;      ///< Total size of all requests in bytes.
+        uint64_t allocatedSize = 0;      ///< Total size of all slots in bytes.
+
+        uint32_t getSlotCount() const { return (uint32_t)slotSizes.size(); }
+        uint64_t getSavedSize() const { return requestedSize - allocatedSize; }
+    };
+
+    /**
+     * Compute a plan for a list of requests. The result is deterministic for a given input.
+     * @param[in] requests List of requests.
+     * @return Plan with one slot index per request.
+     */
+    static Plan plan(const std::vector<Request>& requests);
+};
+} // namespace Falcor
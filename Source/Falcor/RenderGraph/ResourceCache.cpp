@@ -29,7 +29,12 @@
 #include "Core/API/Device.h"
 #include "Core/API/Texture.h"
 #include "Core/API/Buffer.h"
+#include "ResourceAliasing.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -37,6 +42,7 @@ void ResourceCache::reset()
 {
     mNameToIndex.clear();
     mResourceData.clear();
+    mAliasingStats = {};
 }
 
 const ref<Resource>& ResourceCache::getResource(const std::string& name) const
@@ -119,27 +125,52 @@ void ResourceCache::registerField(
     }
 }
 
-inline ref<Resource> createResourceForPass(
-    ref<Device> pDevice,
+namespace
+{
+/**
+ * Fully resolved creation parameters of a resource.
+ * Two fields with equal descs can be backed by the same resource.
+ */
+struct ResourceDesc
+{
+    RenderPassReflection::Field::Type type = RenderPassReflection::Field::Type::Texture2D;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t depth = 0;
+    uint32_t sampleCount = 0;
+    uint32_t arraySize = 0;
+    uint32_t mipLevels = 0;
+    ResourceFormat format = ResourceFormat::Unknown;
+    ResourceBindFlags bindFlags = ResourceBindFlags::None;
+
+    bool operator==(const ResourceDesc& other) const
+    {
+        return type == other.type && width == other.width && height == other.height && depth == other.depth &&
+               sampleCount == other.sampleCount && arraySize == other.arraySize && mipLevels == other.mipLevels &&
+               format == other.format && bindFlags == other.bindFlags;
+    }
+};
+
+ResourceDesc resolveResourceDesc(
+    Device* pDevice,
     const ResourceCache::DefaultProperties& params,
     const RenderPassReflection::Field& field,
-    bool resolveBindFlags,
-    const std::string& resourceName
+    bool resolveBindFlags
 )
 {
-    uint32_t width = field.getWidth() ? field.getWidth() : params.dims.x;
-    uint32_t height = field.getHeight() ? field.getHeight() : params.dims.y;
-    uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-    uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-    auto bindFlags = field.getBindFlags();
-    auto arraySize = field.getArraySize();
-    auto mipLevels = field.getMipCount();
-
-    ResourceFormat format = ResourceFormat::Unknown;
+    ResourceDesc desc;
+    desc.type = field.getType();
+    desc.width = field.getWidth() ? field.getWidth() : params.dims.x;
+    desc.height = field.getHeight() ? field.getHeight() : params.dims.y;
+    desc.depth = field.getDepth() ? field.getDepth() : 1;
+    desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+    desc.bindFlags = field.getBindFlags();
+    desc.arraySize = field.getArraySize();
+    desc.mipLevels = field.getMipCount();
 
     if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
     {
-        format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+        desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
         if (resolveBindFlags)
         {
             ResourceBindFlags mask = ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource;
@@ -147,41 +178,85 @@ inline ref<Resource> createResourceForPass(
             bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
             if (isOutput || isInternal)
                 mask |= ResourceBindFlags::DepthStencil | ResourceBindFlags::RenderTarget;
-            auto supported = pDevice->getFormatBindFlags(format);
+            auto supported = pDevice->getFormatBindFlags(desc.format);
             mask &= supported;
-            bindFlags |= mask;
+            desc.bindFlags |= mask;
         }
     }
     else // RawBuffer
     {
         if (resolveBindFlags)
-            bindFlags = ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource;
+            desc.bindFlags = ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource;
+    }
+
+    return desc;
+}
+
+/**
+ * Estimate the memory footprint of a resource. Only used for reporting, so driver specific padding is ignored.
+ */
+uint64_t estimateResourceSize(const ResourceDesc& desc)
+{
+    if (desc.type == RenderPassReflection::Field::Type::RawBuffer)
+        return desc.width;
+
+    uint32_t height = desc.type == RenderPassReflection::Field::Type::Texture1D ? 1 : desc.height;
+    uint32_t depth = desc.type == RenderPassReflection::Field::Type::Texture3D ? desc.depth : 1;
+    uint32_t arraySize = desc.type == RenderPassReflection::Field::Type::Texture3D ? 1 : desc.arraySize;
+    if (desc.type == RenderPassReflection::Field::Type::TextureCube)
+        arraySize *= 6;
+    uint32_t mipLevels = desc.sampleCount > 1 ? 1 : desc.mipLevels;
+    if (mipLevels == Resource::kMaxPossible)
+        mipLevels = bitScanReverse(desc.width | height | depth) + 1;
+
+    uint32_t blockWidth = getFormatWidthCompressionRatio(desc.format);
+    uint32_t blockHeight = getFormatHeightCompressionRatio(desc.format);
+    uint64_t bytesPerBlock = getFormatBytesPerBlock(desc.format);
+
+    uint64_t size = 0;
+    for (uint32_t mip = 0; mip < mipLevels; mip++)
+    {
+        uint64_t w = div_round_up(std::max(desc.width >> mip, 1u), blockWidth);
+        uint64_t h = div_round_up(std::max(height >> mip, 1u), blockHeight);
+        uint64_t d = std::max(depth >> mip, 1u);
+        size += w * h * d * bytesPerBlock;
     }
+    return size * arraySize * desc.sampleCount;
+}
+
+ref<Resource> createResource(Device* pDevice, const ResourceDesc& desc, const std::string& resourceName)
+{
     ref<Resource> pResource;
 
-    switch (field.getType())
+    switch (desc.type)
     {
     case RenderPassReflection::Field::Type::RawBuffer:
-        pResource = pDevice->createBuffer(width, bindFlags, MemoryType::DeviceLocal);
+        pResource = pDevice->createBuffer(desc.width, desc.bindFlags, MemoryType::DeviceLocal);
         break;
     case RenderPassReflection::Field::Type::Texture1D:
-        pResource = pDevice->createTexture1D(width, format, arraySize, mipLevels, nullptr, bindFlags);
+        pResource = pDevice->createTexture1D(desc.width, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
         break;
     case RenderPassReflection::Field::Type::Texture2D:
-        if (sampleCount > 1)
+        if (desc.sampleCount > 1)
         {
-            pResource = pDevice->createTexture2DMS(width, height, format, sampleCount, arraySize, bindFlags);
+            pResource =
+                pDevice->createTexture2DMS(desc.width, desc.height, desc.format, desc.sampleCount, desc.arraySize, desc.bindFlags);
         }
         else
         {
-            pResource = pDevice->createTexture2D(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+            pResource = pDevice->createTexture2D(
+                desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags
+            );
         }
         break;
     case RenderPassReflection::Field::Type::Texture3D:
-        pResource = pDevice->createTexture3D(width, height, depth, format, mipLevels, nullptr, bindFlags);
+        pResource =
+            pDevice->createTexture3D(desc.width, desc.height, desc.depth, desc.format, desc.mipLevels, nullptr, desc.bindFlags);
         break;
     case RenderPassReflection::Field::Type::TextureCube:
-        pResource = pDevice->createTextureCube(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+        pResource = pDevice->createTextureCube(
+            desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags
+        );
         break;
     default:
         FALCOR_UNREACHABLE();
@@ -190,15 +265,84 @@ inline ref<Resource> createResourceForPass(
     pResource->setName(resourceName);
     return pResource;
 }
+} // namespace
 
-void ResourceCache::allocateResources(ref<Device> pDevice, const DefaultProperties& params)
+void ResourceCache::allocateResources(ref<Device> pDevice, const DefaultProperties& params, bool aliasResources)
 {
-    for (auto& data : mResourceData)
+    // Collect the fields that need a resource and resolve their creation parameters.
+    // Fields with identical parameters get the same compatibility key.
+    std::vector<uint32_t> dataIndices;
+    std::vector<ResourceDesc> descs;
+    std::vector<ResourceDesc> uniqueDescs;
+    std::vector<ResourceAliasingPlanner::Request> requests;
+
+    for (uint32_t i = 0; i < (uint32_t)mResourceData.size(); i++)
     {
-        if ((data.pResource == nullptr) && (data.field.isValid()))
-        {
-            data.pResource = createResourceForPass(pDevice, params, data.field, data.resolveBindFlags, data.name);
-        }
+        const auto& data = mResourceData[i];
+        if ((data.pResource != nullptr) || !data.field.isValid())
+            continue;
+
+        ResourceDesc desc = resolveResourceDesc(pDevice.get(), params, data.field, data.resolveBindFlags);
+        auto it = std::find(uniqueDescs.begin(), uniqueDescs.end(), desc);
+        uint64_t key = it - uniqueDescs.begin();
+        if (it == uniqueDescs.end())
+            uniqueDescs.push_back(desc);
+
+        ResourceAliasingPlanner::Request request;
+        request.firstUse = data.lifetime.first;
+        request.lastUse = data.lifetime.second;
+        request.size = estimateResourceSize(desc);
+        request.key = key;
+        request.canAlias = aliasResources && isTransient(data);
+        requests.push_back(request);
+
+        dataIndices.push_back(i);
+        descs.push_back(desc);
     }
+
+    ResourceAliasingPlanner::Plan plan = ResourceAliasingPlanner::plan(requests);
+
+    // Create one resource per slot and share it between all fields assigned to the slot.
+    std::vector<ref<Resource>> slotResources(plan.getSlotCount());
+    for (size_t r = 0; r < requests.size(); r++)
+    {
+        auto& data = mResourceData[dataIndices[r]];
+        auto& pResource = slotResources[plan.slots[r]];
+        if (pResource == nullptr)
+            pResource = createResource(pDevice.get(), descs[r], data.name);
+        else
+            pResource->setName(pResource->getName() + ", " + data.name);
+        data.pResource = pResource;
+    }
+
+    mAliasingStats.resourceCount += (uint32_t)requests.size();
+    mAliasingStats.allocationCount += plan.getSlotCount();
+    mAliasingStats.requestedSize += plan.requestedSize;
+    mAliasingStats.allocatedSize += plan.allocatedSize;
+
+    if (requests.size() > plan.getSlotCount())
+    {
+        logInfo(
+            "Render graph resource aliasing: {} resources in {} allocations, saved {} of {}.",
+            mAliasingStats.resourceCount,
+            mAliasingStats.allocationCount,
+            formatByteSize(mAliasingStats.getSavedSize()),
+            formatByteSize(mAliasingStats.requestedSize)
+        );
+    }
+}
+
+bool ResourceCache::isTransient(const ResourceData& data)
+{
+    // Graph outputs have to stay valid after the graph has executed.
+    if (data.lifetime.second == uint32_t(-1))
+        return false;
+    // Persistent fields must keep their data between execute() calls.
+    if (is_set(data.field.getFlags(), RenderPassReflection::Field::Flags::Persistent))
+        return false;
+    // Internal fields are commonly used to carry history between frames.
+    if (is_set(data.field.getVisibility(), RenderPassReflection::Field::Visibility::Internal))
+        return false;
+    return true;
 }
 } // namespace Falcor
@@ -83,11 +83,34 @@ public:
      */
     const RenderPassReflection::Field& getResourceReflection(const std::string& name) const;
 
+    /**
+     * Statistics accumulated over all allocateResources() calls since the last reset().
+     * Sizes are estimates that ignore driver specific padding.
+     */
+    struct AliasingStats
+    {
+        uint32_t resourceCount = 0;   ///< Number of resources requested by the graph fields.
+        uint32_t allocationCount = 0; ///< Number of resources actually created.
+        uint64_t requestedSize = 0;   ///< Memory in bytes needed without aliasing.
+        uint64_t allocatedSize = 0;   ///< Memory in bytes needed with aliasing.
+
+        uint64_t getSavedSize() const { return requestedSize - allocatedSize; }
+    };
+
     /**
      * Allocate all resources that need to be created/updated.
      * This includes new resources, resources whose properties have been updated since last allocation call.
+     * @param[in] pDevice GPU device.
+     * @param[in] params Default properties for fields that don't fully specify their resource.
+     * @param[in] aliasResources If true, transient fields with disjoint lifetimes and identical properties share a resource.
+     * Graph outputs, internal fields and fields marked Persistent are never shared.
      */
-    void allocateResources(ref<Device> pDevice, const DefaultProperties& params);
+    void allocateResources(ref<Device> pDevice, const DefaultProperties& params, bool aliasResources = false);
+
+    /**
+     * Get the aliasing statistics of all resources allocated since the last reset().
+     */
+    const AliasingStats& getAliasingStats() const { return mAliasingStats; }
 
     /**
      * Clears all registered field/resource properties and allocated resources.
@@ -104,12 +127,16 @@ private:
         std::string name;                       // Full name of the resource, including the pass name
     };
 
+    static bool isTransient(const ResourceData& data);
+
     // Resources and properties for fields within (and therefore owned by) a render graph
     std::unordered_map<std::string, uint32_t> mNameToIndex;
     std::vector<ResourceData> mResourceData;
 
     // References to output resources not to be allocated by the render graph
     ResourcesMap mExternalResources;
+
+    AliasingStats mAliasingStats;
 };
 
 } // namespace Falcor
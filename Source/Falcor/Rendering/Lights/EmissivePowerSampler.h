@@ -29,7 +29,7 @@
 #include "EmissiveLightSampler.h"
 #include "Core/Macros.h"
 #include "Scene/Lights/LightCollection.h"
-#include <random>
+#include "Utils/Sampling/AliasTableBuilder.h"
 #include <vector>
 
 namespace Falcor
@@ -70,7 +70,8 @@ namespace Falcor
         virtual void bindShaderData(const ShaderVar& var) const override;
 
     protected:
-        /** Generate an alias table
+        /** Generate an alias table.
+            Only the parts of the table with modified weights are rebuilt, and the buffer is reused if the size is unchanged.
             \param[in] weights  The weights we'd like to sample each entry proportional to
             \returns The alias table
         */
@@ -79,7 +80,7 @@ namespace Falcor
         // Internal state
         bool                            mNeedsRebuild = true;   ///< Trigger rebuild on the next call to update(). We should always build on the first call, so the initial value is true.
 
-        std::mt19937                    mAliasTableRng;
+        AliasTableBuilder               mTriangleTableBuilder;
         AliasTable                      mTriangleTable;
     };
 }
@@ -28,9 +28,15 @@
 #include "LightBVHBuilder.h"
 #include "Core/Error.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 #include "Utils/Timing/Profiler.h"
+#include "Utils/Math/Common.h"
 #include "Utils/Math/MathConstants.slangh"
 #include <algorithm>
+#include <cmath>
+#include <execution>
+#include <future>
+#include <thread>
 
 namespace
 {
@@ -44,6 +50,60 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Triangle ranges larger than this are processed in chunks when computing node bounds and binning.
+    // The per-chunk results are merged in chunk order, so floating-point sums don't depend on whether the chunks run in parallel.
+    const uint32_t kChunkSize = 1 << 14;
+
+    // Minimum triangle count of a node for its children to be built as separate tasks.
+    const uint32_t kMinParallelBuildTriangleCount = 1 << 16;
+
+    /** Returns the depth up to which nodes may build their children as separate tasks.
+        This creates a few tasks per thread, which is enough to balance the load.
+    */
+    uint32_t getMaxParallelBuildDepth()
+    {
+        static const uint32_t maxDepth = (uint32_t)std::ceil(std::log2(std::max(1u, std::thread::hardware_concurrency()))) + 2;
+        return maxDepth;
+    }
+
+    /** Accumulates per-triangle data into a list of values (e.g. bins).
+        Large triangle ranges are split into chunks that are accumulated separately, in parallel if requested,
+        starting from the initial values. The per-chunk values are then merged into the result in chunk order.
+        \param[in,out] values Initial values, replaced by the accumulated values.
+        \param[in] begin First triangle to process.
+        \param[in] end One past the last triangle to process.
+        \param[in] parallel Process chunks in parallel.
+        \param[in] accumulate Function accumulate(values, triangleIndex) adding a triangle to the values.
+        \param[in] merge Function merge(value, chunkValue) merging the accumulated value of a chunk into the result.
+    */
+    template<typename T, typename AccumulateFunc, typename MergeFunc>
+    void accumulateChunked(std::vector<T>& values, uint32_t begin, uint32_t end, bool parallel, const AccumulateFunc& accumulate, const MergeFunc& merge)
+    {
+        if (end - begin <= kChunkSize)
+        {
+            for (uint32_t i = begin; i < end; ++i) accumulate(values, i);
+            return;
+        }
+
+        const uint32_t chunkCount = div_round_up(end - begin, kChunkSize);
+        std::vector<std::vector<T>> chunkValues(chunkCount, values);
+        auto processChunk = [&](uint32_t chunk)
+        {
+            const uint32_t chunkBegin = begin + chunk * kChunkSize;
+            const uint32_t chunkEnd = std::min(end, chunkBegin + kChunkSize);
+            for (uint32_t i = chunkBegin; i < chunkEnd; ++i) accumulate(chunkValues[chunk], i);
+        };
+
+        NumericRange<uint32_t> chunks(0, chunkCount);
+        if (parallel) std::for_each(std::execution::par, chunks.begin(), chunks.end(), processChunk);
+        else std::for_each(chunks.begin(), chunks.end(), processChunk);
+
+        for (const auto& chunk : chunkValues)
+        {
+            for (size_t i = 0; i < values.size(); ++i) merge(values[i], chunk[i]);
+        }
+    }
+
     inline float safeACos(float v)
     {
         return std::acos(std::clamp(v, -1.0f, 1.0f));
@@ -235,11 +295,29 @@ namespace Falcor
         // Get global list of emissive triangles.
         FALCOR_ASSERT(bvh.mpLightCollection);
         const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
-        if (triangles.empty()) return;
+
+        // Build the tree. If there are no non-culled triangles, we're done.
+        BuildResult result = buildHierarchy(triangles);
+        if (result.nodes.empty()) return;
+
+        // The BVH is ready, mark it as valid and upload the data.
+        bvh.mNodes = std::move(result.nodes);
+        bvh.mIsValid = true;
+        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
+        bvh.uploadCPUBuffers(result.triangleIndices, result.triangleBitmasks);
+
+        // Computate metadata.
+        bvh.finalize();
+    }
+
+    LightBVHBuilder::BuildResult LightBVHBuilder::buildHierarchy(const std::vector<LightCollection::MeshLightTriangle>& triangles) const
+    {
+        BuildResult result;
+        if (triangles.empty()) return result;
 
         // Create list of triangles that should be included in BVH.
         // For each triangle, precompute data we need for the build.
-        BuildingData data(bvh.mNodes);
+        BuildingData data(result);
         data.trianglesData.reserve(triangles.size());
 
         for (size_t i = 0; i < triangles.size(); i++)
@@ -262,7 +340,7 @@ namespace Falcor
         }
 
         // If there are no non-culled triangles, we're done.
-        if (data.trianglesData.empty()) return;
+        if (data.trianglesData.empty()) return result;
 
         // Validate options.
         if (mOptions.maxTriangleCountPerLeaf > kMaxLeafTriangleCount)
@@ -278,16 +356,17 @@ namespace Falcor
         // To be grossly conservative, assume each triangle requires two nodes.
         // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
         // TODO: Better estimate of how many nodes we will need.
-        data.nodes.clear();
         data.nodes.reserve(2 * data.trianglesData.size());
         data.triangleIndices.reserve(data.trianglesData.size());
 
         const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
         data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
-        // Build the tree.
+        // Build the tree into subtrees and concatenate them in depth-first order.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+        Subtree root;
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data, root);
+        appendSubtree(root, data);
         FALCOR_ASSERT(!data.nodes.empty());
 
         size_t numValid = 0;
@@ -299,13 +378,7 @@ namespace Falcor
         float cosConeAngle;
         computeLightingConesInternal(0, data, cosConeAngle);
 
-        // The BVH is ready, mark it as valid and upload the data.
-        bvh.mIsValid = true;
-        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
-
-        // Computate metadata.
-        bvh.finalize();
+        return result;
     }
 
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
@@ -346,27 +419,34 @@ namespace Falcor
             }
         }
 
+        optionsChanged |= widget.checkbox("Parallel build", options.useParallelBuild);
+
         return optionsChanged;
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, Subtree& subtree) const
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
 
         // Compute the AABB and total flux of the node.
-        float nodeFlux = 0.f;
-        AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
-        {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
-        }
+        std::vector<std::pair<AABB, float>> nodeSums(1, { AABB(), 0.f });
+        accumulateChunked(nodeSums, triangleRange.begin, triangleRange.end, options.useParallelBuild,
+            [&data](auto& sums, uint32_t dataIndex)
+            {
+                sums[0].first |= data.trianglesData[dataIndex].bounds;
+                sums[0].second += data.trianglesData[dataIndex].flux;
+            },
+            [](auto& sum, const auto& chunkSum)
+            {
+                sum.first |= chunkSum.first;
+                sum.second += chunkSum.second;
+            });
+        const AABB nodeBounds = nodeSums[0].first;
+        const float nodeFlux = nodeSums[0].second;
         FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
-
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
-        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
+        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options) : SplitResult();
 
         // If we should split, then create an internal node and split.
         if (splitResult.isValid())
@@ -378,9 +458,9 @@ namespace Falcor
             std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(subtree.nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)subtree.nodes.size();
+            subtree.nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -394,13 +474,37 @@ namespace Falcor
                 FALCOR_THROW("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+
+            if (options.useParallelBuild && triangleRange.length() >= kMinParallelBuildTriangleCount && depth < getMaxParallelBuildDepth())
+            {
+                // Build the children as separate subtrees, the left one on another thread.
+                // The children operate on disjoint triangle ranges. They are linked to this node in appendSubtree().
+                // Note that the parent of a large node is large as well, so this node is always the root of its subtree.
+                FALCOR_ASSERT(nodeIndex == 0);
+                subtree.pLeft = std::make_unique<Subtree>();
+                subtree.pRight = std::make_unique<Subtree>();
+
+                auto leftTask = std::async(std::launch::async, [&]()
+                {
+                    buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, *subtree.pLeft);
+                });
+                buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, *subtree.pRight);
+                leftTask.get();
+
+                node.rightChildIdx = 0; // Resolved in appendSubtree().
+            }
+            else
+            {
+                uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, subtree);
+                uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, subtree);
 
-            FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
-            node.rightChildIdx = rightIndex;
+                FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
+                node.rightChildIdx = rightIndex;
+            }
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            subtree.nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -408,9 +512,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(subtree.nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)subtree.nodes.size();
+            subtree.nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -420,24 +524,59 @@ namespace Falcor
             node.attribs.cosConeAngle = cosTheta;
 
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = (uint32_t)subtree.triangleIndices.size();
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
             for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
             {
                 uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
+                subtree.triangleIndices.push_back(globalTriangleIndex);
                 data.triangleBitmasks[globalTriangleIndex] = bitmask;
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
+            FALCOR_ASSERT(subtree.triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            subtree.nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
 
-    float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle)
+    void LightBVHBuilder::appendSubtree(const Subtree& subtree, BuildingData& data) const
+    {
+        FALCOR_ASSERT(data.nodes.size() + subtree.nodes.size() <= std::numeric_limits<uint32_t>::max());
+        const uint32_t nodeOffset = (uint32_t)data.nodes.size();
+        const uint32_t triangleOffset = (uint32_t)data.triangleIndices.size();
+
+        // Note: The node indices are patched directly in the packed data, as unpacking and repacking the node attributes is lossy.
+        // The right child index of internal nodes and the triangle offset of leaf nodes are stored in the low bits of data[0].x.
+        if (subtree.pLeft)
+        {
+            // The children of the root node were built as separate subtrees. Place them after the root node.
+            FALCOR_ASSERT(subtree.pRight && subtree.nodes.size() == 1 && subtree.triangleIndices.empty());
+            data.nodes.push_back(subtree.nodes[0]);
+            appendSubtree(*subtree.pLeft, data);
+            data.nodes[nodeOffset].data[0].x = (uint32_t)data.nodes.size();
+            appendSubtree(*subtree.pRight, data);
+            return;
+        }
+
+        for (PackedNode node : subtree.nodes)
+        {
+            if (node.isLeaf())
+            {
+                FALCOR_ASSERT(node.getLeafNode().triangleOffset + triangleOffset < kMaxLeafTriangleOffset);
+                node.data[0].x += triangleOffset;
+            }
+            else
+            {
+                node.data[0].x += nodeOffset;
+            }
+            data.nodes.push_back(node);
+        }
+        data.triangleIndices.insert(data.triangleIndices.end(), subtree.triangleIndices.begin(), subtree.triangleIndices.end());
+    }
+
+    float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle) const
     {
         if (!data.nodes[nodeIndex].isLeaf())
         {
@@ -497,7 +636,7 @@ namespace Falcor
         return coneDirection;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/)
     {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
@@ -524,7 +663,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -569,11 +708,13 @@ namespace Falcor
             for (Bin& bin : bins) bin = Bin();
 
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            accumulateChunked(bins, triangleRange.begin, triangleRange.end, parameters.useParallelBuild,
+                [&](std::vector<Bin>& chunkBins, uint32_t i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    chunkBins[getBinId(td)] |= td;
+                },
+                [](Bin& bin, const Bin& chunkBin) { bin |= chunkBin; });
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -637,7 +778,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -679,7 +820,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -739,11 +880,13 @@ namespace Falcor
             for (Bin& bin : bins) bin = Bin();
 
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            accumulateChunked(bins, triangleRange.begin, triangleRange.end, parameters.useParallelBuild,
+                [&](std::vector<Bin>& chunkBins, uint32_t i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    chunkBins[getBinId(td)] |= td;
+                },
+                [](Bin& bin, const Bin& chunkBin) { bin |= chunkBin; });
 
             // Compute the lighting cones for each bin.
             // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
@@ -754,12 +897,20 @@ namespace Falcor
                 bin.cosConeAngle = length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
                 bin.coneDirection = normalize(bin.coneDirection);
             }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
-            }
+            // Growing the cone per triangle is order-independent (it takes the minimum cosine, or the invalid angle
+            // if any triangle invalidates the cone), so chunks are merged in the same way.
+            accumulateChunked(bins, triangleRange.begin, triangleRange.end, parameters.useParallelBuild,
+                [&](std::vector<Bin>& chunkBins, uint32_t i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    Bin& bin = chunkBins[getBinId(td)];
+                    bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
+                },
+                [](Bin& bin, const Bin& chunkBin)
+                {
+                    bool isValid = bin.cosConeAngle != kInvalidCosConeAngle && chunkBin.cosConeAngle != kInvalidCosConeAngle;
+                    bin.cosConeAngle = isValid ? std::min(bin.cosConeAngle, chunkBin.cosConeAngle) : kInvalidCosConeAngle;
+                });
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -848,7 +999,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAOH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -858,7 +1009,7 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
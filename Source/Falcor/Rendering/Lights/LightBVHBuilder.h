@@ -78,6 +78,7 @@ namespace Falcor
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            bool           useParallelBuild = true;                              ///< Build the BVH on multiple threads. The resulting BVH is identical to the one built on a single thread.
 
             template<typename Archive>
             void serialize(Archive& ar)
@@ -93,9 +94,19 @@ namespace Falcor
                 ar("allowRefitting", allowRefitting);
                 ar("usePreintegration", usePreintegration);
                 ar("useLightingCones", useLightingCones);
+                ar("useParallelBuild", useParallelBuild);
             }
         };
 
+        /** Result of the CPU part of the BVH build.
+        */
+        struct BuildResult
+        {
+            std::vector<PackedNode> nodes;                  ///< BVH nodes in depth-first order. Empty if no triangles were included.
+            std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node.
+            std::vector<uint64_t> triangleBitmasks;         ///< Per-triangle bit pattern retracing the tree traversal to reach the triangle. Indexed by global triangle index.
+        };
+
         /** Constructor.
             \param[in] options The options to use for building the BVH.
         */
@@ -106,6 +117,12 @@ namespace Falcor
         */
         void build(RenderContext* pRenderContext, LightBVH& bvh);
 
+        /** Build the BVH hierarchy on the CPU. This is the part of build() that doesn't access the GPU.
+            \param[in] triangles Global list of emissive triangles.
+            \return The BVH nodes and per-triangle data.
+        */
+        BuildResult buildHierarchy(const std::vector<LightCollection::MeshLightTriangle>& triangles) const;
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -147,34 +164,56 @@ namespace Falcor
         {
             std::vector<PackedNode>& nodes;                 ///< BVH nodes generated by the builder.
             std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
-            std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
-            std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
-            float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
+            std::vector<uint32_t>& triangleIndices;         ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
+            std::vector<uint64_t>& triangleBitmasks;        ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
 
-            BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
+            BuildingData(BuildResult& result) : nodes(result.nodes), triangleIndices(result.triangleIndices), triangleBitmasks(result.triangleBitmasks) {}
+        };
+
+        /** Part of the BVH built by a single task.
+            Node indices and triangle offsets are local to the subtree and get resolved by appendSubtree().
+            If the children of the subtree's root node were built as separate tasks, the subtree holds only the root node
+            and the children are stored in pLeft/pRight.
+        */
+        struct Subtree
+        {
+            std::vector<PackedNode> nodes;                  ///< Nodes in depth-first order.
+            std::vector<uint32_t> triangleIndices;          ///< Triangle indices of the leaf nodes.
+            std::unique_ptr<Subtree> pLeft;                 ///< Left child subtree, or nullptr if stored in the node list.
+            std::unique_ptr<Subtree> pRight;                ///< Right child subtree, or nullptr if stored in the node list.
         };
 
         /** Compute the split according to a specified heuristic.
             \param[in] data Prepared light data.
             \param[in] triangleRange Range of triangles to process.
             \param[in] nodeBounds Bounds for the node to be splitted.
+            \param[in] nodeFlux Total flux of the node to be splitted.
             \param[in] parameters Various parameters defining how the building should occur.
         */
-        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)>;
+        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)>;
 
         /** Renders the UI with builder options.
         */
         bool renderOptions(Gui::Widgets& widget, Options& options) const;
 
         /** Recursive BVH build.
+            Large nodes build their two children as separate tasks if parallel building is enabled.
+            Different tasks only access disjoint triangle ranges, so the result doesn't depend on the scheduling.
             \param[in] splitHeuristic The splitting heuristic to be used.
             \param[in] bitmask Bit pattern retracing the tree traversal to reach the node to be built: 0=left child, 1=right child.
             \param[in] depth Depth of the node to be built
             \param[in] triangleRange Range of triangles to process.
             \param[in,out] data Prepared light data.
-            \return Index of the allocated node.
+            \param[in,out] subtree Subtree to add the node to.
+            \return Index of the allocated node in the subtree.
+        */
+        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, Subtree& subtree) const;
+
+        /** Append the nodes of a subtree to the final node list in depth-first order, resolving local node indices and triangle offsets.
+            \param[in] subtree The subtree.
+            \param[in,out] data Prepared light data.
         */
-        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+        void appendSubtree(const Subtree& subtree, BuildingData& data) const;
 
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
@@ -182,7 +221,7 @@ namespace Falcor
             \param[out] cosConeAngle Cosine of the cone angle of the lighting cone for the current node, or kInvalidCosConeAngle if the cone is invalid.
             \return direction of the lighting cone for the current node.
         */
-        float3 computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle);
+        float3 computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle) const;
 
         /** Compute lighting cone for a range of triangles.
             \param[in] triangleRange Range of triangles to process.
@@ -193,9 +232,9 @@ namespace Falcor
         static float3 computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta);
 
         // See the documentation of SplitHeuristicFunction.
-        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/);
-        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
-        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
+        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/);
+        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters);
+        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters);
 
         static SplitHeuristicFunction getSplitFunction(SplitHeuristic heuristic);
 
@@ -0,0 +1,451 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ProbePlacement.h"
+#include "Core/Error.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+constexpr float kInf = std::numeric_limits<float>::infinity();
+constexpr uint32_t kNoRegion = std::numeric_limits<uint32_t>::max();
+
+struct Voxels
+{
+    uint3 dims;
+    size_t count;
+
+    explicit Voxels(uint3 dims) : dims(dims), count((size_t)dims.x * dims.y * dims.z) {}
+
+    size_t index(uint32_t x, uint32_t y, uint32_t z) const { return x + (size_t)dims.x * (y + (size_t)dims.y * z); }
+};
+
+/**
+ * Separating axis test of a triangle against a unit voxel (Akenine-Möller, "Fast 3D Triangle-Box Overlap Testing").
+ * The triangle vertices are given relative to the voxel center.
+ */
+bool triangleOverlapsVoxel(const float3& v0, const float3& v1, const float3& v2)
+{
+    const float h = 0.5f;
+
+    // Voxel face normals.
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (std::min({v0[axis], v1[axis], v2[axis]}) > h || std::max({v0[axis], v1[axis], v2[axis]}) < -h)
+            return false;
+    }
+
+    // Cross products of the voxel axes and the triangle edges.
+    const float3 edges[3] = {v1 - v0, v2 - v1, v0 - v2};
+    for (const float3& e : edges)
+    {
+        const float3 axes[3] = {float3(0.f, -e.z, e.y), float3(e.z, 0.f, -e.x), float3(-e.y, e.x, 0.f)};
+        for (const float3& a : axes)
+        {
+            const float p0 = dot(a, v0), p1 = dot(a, v1), p2 = dot(a, v2);
+            const float r = h * (std::abs(a.x) + std::abs(a.y) + std::abs(a.z));
+            if (std::min({p0, p1, p2}) > r || std::max({p0, p1, p2}) < -r)
+                return false;
+        }
+    }
+
+    // Triangle plane.
+    const float3 n = cross(edges[0], edges[1]);
+    const float r = h * (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+    return std::abs(dot(n, v0)) <= r;
+}
+
+/**
+ * 1D squared Euclidean distance transform (Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled Functions").
+ * Reads n samples from f with the given stride and writes the result back in place. Samples equal to kInf are ignored.
+ */
+void distanceTransform1D(float* f, size_t stride, uint32_t n, std::vector<float>& values, std::vector<uint32_t>& v, std::vector<float>& z)
+{
+    values.resize(n);
+    v.resize(n);
+    z.resize(n + 1);
+    for (uint32_t q = 0; q < n; ++q)
+        values[q] = f[q * stride];
+
+    int k = -1;
+    for (uint32_t q = 0; q < n; ++q)
+    {
+        if (values[q] == kInf)
+            continue;
+        if (k < 0)
+        {
+            k = 0;
+            v[0] = q;
+            z[0] = -kInf;
+            z[1] = kInf;
+            continue;
+        }
+        float s;
+        while (true)
+        {
+            const uint32_t p = v[k];
+            s = ((values[q] + float(q) * float(q)) - (values[p] + float(p) * float(p))) / (2.f * float(q) - 2.f * float(p));
+            if (s > z[k])
+                break;
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kInf;
+    }
+
+    if (k < 0)
+        return; // No finite samples, the line stays at infinity.
+
+    k = 0;
+    for (uint32_t q = 0; q < n; ++q)
+    {
+        while (z[k + 1] < float(q))
+            ++k;
+        const float d = float(q) - float(v[k]);
+        f[q * stride] = d * d + values[v[k]];
+    }
+}
+} // namespace
+
+ProbePlacement::Result ProbePlacement::compute(
+    const Grid& grid,
+    fstd::span<const float3> positions,
+    fstd::span<const uint32_t> indices,
+    const Options& options
+)
+{
+    FALCOR_CHECK(all(grid.probeCounts > uint3(0)), "Probe counts must be non-zero.");
+    FALCOR_CHECK(all(grid.spacing > float3(0.f)), "Probe spacing must be positive.");
+    FALCOR_CHECK(indices.size() % 3 == 0, "Index count must be a multiple of 3.");
+
+    const uint3 counts = grid.probeCounts;
+    const uint32_t probeCount = counts.x * counts.y * counts.z;
+
+    // Choose the voxelization resolution.
+    uint32_t vpp = std::max(options.voxelsPerProbe, 1u);
+    while (vpp > 1 && (double)probeCount * vpp * vpp * vpp > (double)options.maxVoxelCount)
+        --vpp;
+
+    const Voxels voxels(counts * vpp);
+    const float3 voxelSize = grid.spacing / float(vpp);
+
+    // Voxelize the triangles. Voxel coordinates are used from here on: voxel (x, y, z) covers [x, x + 1) x [y, y + 1) x [z, z + 1).
+    // Each voxel accumulates the (unnormalized) normals of the triangles overlapping it, which are later used to tell
+    // apart open regions from regions enclosed by geometry.
+    std::vector<uint8_t> surface(voxels.count, 0);
+    std::vector<float3> normals(voxels.count, float3(0.f));
+    {
+        const uint32_t triangleCount = (uint32_t)(indices.size() / 3);
+        auto toVoxel = [&](uint32_t i) { return (positions[indices[i]] - grid.origin) / voxelSize; };
+
+        // Bin triangles by slabs of voxel layers along z. Each slab is processed by one task and visits its triangles in order.
+        const uint32_t slabCount = counts.z;
+        std::vector<std::vector<uint32_t>> slabs(slabCount);
+        for (uint32_t t = 0; t < triangleCount; ++t)
+        {
+            FALCOR_CHECK(
+                indices[3 * t] < positions.size() && indices[3 * t + 1] < positions.size() && indices[3 * t + 2] < positions.size(),
+                "Triangle {} has out of bounds indices.",
+                t
+            );
+            const float3 p0 = toVoxel(3 * t), p1 = toVoxel(3 * t + 1), p2 = toVoxel(3 * t + 2);
+            const float zMin = std::min({p0.z, p1.z, p2.z});
+            const float zMax = std::max({p0.z, p1.z, p2.z});
+            if (!(zMax >= 0.f && zMin <= float(voxels.dims.z)))
+                continue;
+            const uint32_t first = (uint32_t)std::clamp(std::ceil(zMin - 1.f), 0.f, float(voxels.dims.z - 1)) / vpp;
+            const uint32_t last = (uint32_t)std::clamp(std::floor(zMax), 0.f, float(voxels.dims.z - 1)) / vpp;
+            for (uint32_t s = first; s <= last; ++s)
+                slabs[s].push_back(t);
+        }
+
+        auto voxelizeSlab = [&](uint32_t s)
+        {
+            const int zBegin = int(s * vpp), zEnd = int((s + 1) * vpp);
+            for (uint32_t t : slabs[s])
+            {
+                const float3 p0 = toVoxel(3 * t), p1 = toVoxel(3 * t + 1), p2 = toVoxel(3 * t + 2);
+                const float3 n = cross(p1 - p0, p2 - p0);
+                const float3 pMin = min(min(p0, p1), p2), pMax = max(max(p0, p1), p2);
+
+                // Voxels touching the bounding box, including those that share a face with it.
+                int3 vMin, vMax;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    vMin[axis] = std::max(int(std::ceil(pMin[axis] - 1.f)), 0);
+                    vMax[axis] = std::min(int(std::floor(pMax[axis])), int(voxels.dims[axis]) - 1);
+                }
+                vMin.z = std::max(vMin.z, zBegin);
+                vMax.z = std::min(vMax.z, zEnd - 1);
+
+                for (int z = vMin.z; z <= vMax.z; ++z)
+                {
+                    for (int y = vMin.y; y <= vMax.y; ++y)
+                    {
+                        for (int x = vMin.x; x <= vMax.x; ++x)
+                        {
+                            const float3 center = float3(float(x), float(y), float(z)) + 0.5f;
+                            if (!triangleOverlapsVoxel(p0 - center, p1 - center, p2 - center))
+                                continue;
+                            const size_t i = voxels.index(x, y, z);
+                            surface[i] = 1;
+                            normals[i] += n;
+                        }
+                    }
+                }
+            }
+        };
+        NumericRange<uint32_t> range(0, slabCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), voxelizeSlab);
+    }
+
+    // Compute the squared distance (in voxels) from each voxel center to the closest surface voxel center.
+    std::vector<float> distance(voxels.count);
+    std::transform(surface.begin(), surface.end(), distance.begin(), [](uint8_t s) { return s ? 0.f : kInf; });
+    {
+        const uint3 dims = voxels.dims;
+        auto transformAxis = [&](int axis)
+        {
+            // Each task processes all lines along the axis in one plane of the remaining axes.
+            const int planeAxis = axis == 2 ? 1 : 2;
+            const int lineAxis = 3 - axis - planeAxis;
+            const size_t strides[3] = {1, (size_t)dims.x, (size_t)dims.x * dims.y};
+            auto transformPlane = [&](uint32_t plane)
+            {
+                std::vector<float> values, z;
+                std::vector<uint32_t> v;
+                for (uint32_t line = 0; line < dims[lineAxis]; ++line)
+                {
+                    float* f = distance.data() + plane * strides[planeAxis] + line * strides[lineAxis];
+                    distanceTransform1D(f, strides[axis], dims[axis], values, v, z);
+                }
+            };
+            NumericRange<uint32_t> range(0, dims[planeAxis]);
+            std::for_each(std::execution::par, range.begin(), range.end(), transformPlane);
+        };
+        transformAxis(0);
+        transformAxis(1);
+        transformAxis(2);
+    }
+
+    // Label the 6-connected regions of empty voxels, and classify them by counting front and back facing boundary voxels.
+    std::vector<uint32_t> regions(voxels.count, kNoRegion);
+    std::vector<uint8_t> regionEnclosed;
+    {
+        const int3 dims = int3(voxels.dims);
+        const int3 offsets[6] = {int3(-1, 0, 0), int3(1, 0, 0), int3(0, -1, 0), int3(0, 1, 0), int3(0, 0, -1), int3(0, 0, 1)};
+        std::vector<int3> stack;
+        for (int z = 0; z < dims.z; ++z)
+        {
+            for (int y = 0; y < dims.y; ++y)
+            {
+                for (int x = 0; x < dims.x; ++x)
+                {
+                    const size_t seed = voxels.index(x, y, z);
+                    if (surface[seed] || regions[seed] != kNoRegion)
+                        continue;
+
+                    const uint32_t region = (uint32_t)regionEnclosed.size();
+                    uint64_t frontCount = 0, backCount = 0;
+                    regions[seed] = region;
+                    stack.push_back(int3(x, y, z));
+                    while (!stack.empty())
+                    {
+                        const int3 p = stack.back();
+                        stack.pop_back();
+                        for (const int3& o : offsets)
+                        {
+                            const int3 q = p + o;
+                            if (any(q < int3(0)) || any(q >= dims))
+                                continue;
+                            const size_t j = voxels.index(q.x, q.y, q.z);
+                            if (surface[j])
+                            {
+                                // The surface faces this region if its normal points back towards p.
+                                const float facing = -dot(normals[j], float3(o));
+                                frontCount += facing > 0.f;
+                                backCount += facing < 0.f;
+                            }
+                            else if (regions[j] == kNoRegion)
+                            {
+                                regions[j] = region;
+                                stack.push_back(q);
+                            }
+                        }
+                    }
+                    const uint64_t total = frontCount + backCount;
+                    regionEnclosed.push_back(total > 0 && double(backCount) > options.backfaceThreshold * double(total));
+                }
+            }
+        }
+    }
+
+    // Summed volume table of surface voxels for footprint queries. Entry (x, y, z) holds the count in [0, x) x [0, y) x [0, z).
+    const uint3 tableDims = voxels.dims + 1u;
+    std::vector<uint32_t> table((size_t)tableDims.x * tableDims.y * tableDims.z, 0);
+    auto tableIndex = [&](uint32_t x, uint32_t y, uint32_t z) { return x + (size_t)tableDims.x * (y + (size_t)tableDims.y * z); };
+    for (uint32_t z = 1; z < tableDims.z; ++z)
+    {
+        for (uint32_t y = 1; y < tableDims.y; ++y)
+        {
+            for (uint32_t x = 1; x < tableDims.x; ++x)
+            {
+                table[tableIndex(x, y, z)] = surface[voxels.index(x - 1, y - 1, z - 1)] + table[tableIndex(x - 1, y, z)] +
+                                             table[tableIndex(x, y - 1, z)] + table[tableIndex(x, y, z - 1)] -
+                                             table[tableIndex(x - 1, y - 1, z)] - table[tableIndex(x - 1, y, z - 1)] -
+                                             table[tableIndex(x, y - 1, z - 1)] + table[tableIndex(x - 1, y - 1, z - 1)];
+            }
+        }
+    }
+    auto countSurface = [&](uint3 lo, uint3 hi)
+    {
+        return table[tableIndex(hi.x, hi.y, hi.z)] - table[tableIndex(lo.x, hi.y, hi.z)] - table[tableIndex(hi.x, lo.y, hi.z)] -
+               table[tableIndex(hi.x, hi.y, lo.z)] + table[tableIndex(lo.x, lo.y, hi.z)] + table[tableIndex(lo.x, hi.y, lo.z)] +
+               table[tableIndex(hi.x, lo.y, lo.z)] - table[tableIndex(lo.x, lo.y, lo.z)];
+    };
+
+    // Place the probes.
+    Result result;
+    result.voxelsPerProbe = vpp;
+    result.offsets.resize(probeCount, float3(0.f));
+    result.states.resize(probeCount, ProbeState::Active);
+
+    const float minDistance2 = (options.minClearance * vpp) * (options.minClearance * vpp);
+    const float maxOffset = options.maxOffset * vpp;
+    auto isOpen = [&](size_t i) { return !surface[i] && !regionEnclosed[regions[i]]; };
+
+    auto placeProbe = [&](uint32_t probeIndex)
+    {
+        const uint3 probe(probeIndex % counts.x, (probeIndex / counts.x) % counts.y, probeIndex / (counts.x * counts.y));
+
+        // The probe is interpolated from within one cell of its position along each axis. Footprints are
+        // rounded outwards to whole voxels and clipped to the grid.
+        if (options.cullFar)
+        {
+            const float3 center = (float3(probe) + 0.5f) * float(vpp);
+            const uint3 lo = uint3(max(center - float(vpp), float3(0.f)));
+            const uint3 hi = min(uint3(ceil(center + float(vpp))), voxels.dims);
+            if (countSurface(lo, hi) == 0)
+            {
+                result.states[probeIndex] = ProbeState::Far;
+                return;
+            }
+        }
+
+        // Keep the probe where it is if it already has enough clearance.
+        // The probe lies on a voxel corner for even resolutions, in which case the voxel above it is used.
+        const float3 center = (float3(probe) + 0.5f) * float(vpp);
+        const uint3 home = uint3(center);
+        const size_t homeIndex = voxels.index(home.x, home.y, home.z);
+        if (isOpen(homeIndex) && distance[homeIndex] >= minDistance2)
+            return;
+
+        // Otherwise search the voxels whose centers are within reach for the closest one with enough clearance,
+        // or the one with the most clearance. Ties are broken by visiting order, which keeps the result deterministic.
+        int3 lo, hi;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            lo[axis] = std::max(int(std::ceil(center[axis] - maxOffset - 0.5f)), 0);
+            hi[axis] = std::min(int(std::floor(center[axis] + maxOffset - 0.5f)), int(voxels.dims[axis]) - 1);
+        }
+
+        bool found = false;
+        bool foundClear = false;
+        float bestOffset2 = kInf;
+        float bestDistance = 0.f;
+        float3 bestOffset(0.f);
+        for (int z = lo.z; z <= hi.z; ++z)
+        {
+            for (int y = lo.y; y <= hi.y; ++y)
+            {
+                for (int x = lo.x; x <= hi.x; ++x)
+                {
+                    const size_t i = voxels.index(x, y, z);
+                    if (!isOpen(i))
+                        continue;
+                    const float3 offset = float3(float(x), float(y), float(z)) + 0.5f - center;
+                    const float offset2 = dot(offset, offset);
+                    const bool clear = distance[i] >= minDistance2;
+                    bool better;
+                    if (clear != foundClear)
+                        better = clear;
+                    else if (clear)
+                        better = offset2 < bestOffset2;
+                    else
+                        better = distance[i] > bestDistance || (distance[i] == bestDistance && offset2 < bestOffset2);
+                    if (!found || better)
+                    {
+                        found = true;
+                        foundClear = clear;
+                        bestOffset2 = offset2;
+                        bestDistance = distance[i];
+                        bestOffset = offset;
+                    }
+                }
+            }
+        }
+
+        if (!found)
+        {
+            if (options.cullInside)
+                result.states[probeIndex] = ProbeState::Inside;
+            return;
+        }
+        result.offsets[probeIndex] = bestOffset * voxelSize;
+    };
+    NumericRange<uint32_t> range(0, probeCount);
+    std::for_each(std::execution::par, range.begin(), range.end(), placeProbe);
+
+    for (uint32_t i = 0; i < probeCount; ++i)
+    {
+        switch (result.states[i])
+        {
+        case ProbeState::Active:
+            result.activeProbes.push_back(i);
+            if (any(result.offsets[i] != float3(0.f)))
+                ++result.movedCount;
+            break;
+        case ProbeState::Inside:
+            ++result.insideCount;
+            break;
+        case ProbeState::Far:
+            ++result.farCount;
+            break;
+        }
+    }
+
+    return result;
+}
+} // namespace Falcor
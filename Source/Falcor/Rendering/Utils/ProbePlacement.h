@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h> // TODO C++20: Replace with <span>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU probe placement for uniform probe grids (e.g. DDGI).
+ *
+ * Probes start out at the cell centers of a uniform grid. The scene triangles are voxelized
+ * at a resolution of `voxelsPerProbe` voxels per grid cell and axis, and the exact distance
+ * from each voxel to the voxelized surfaces is computed. Then each probe is:
+ * - marked Far if no geometry lies within its trilinear footprint (one cell along each axis),
+ *   i.e. no shading point ever interpolates from it,
+ * - moved to the closest voxel within `maxOffset` cells that is at least `minClearance` cells
+ *   away from geometry, or the voxel with the most clearance if there is none,
+ * - marked Inside if no empty voxel is in reach, or if the empty region it lies in is
+ *   enclosed by surfaces that face away from it (the interior of a closed mesh).
+ *
+ * Distances and offsets are measured in grid cells, so the voxels are isotropic even
+ * if the grid spacing is not. The result does not depend on thread scheduling.
+ */
+class FALCOR_API ProbePlacement
+{
+public:
+    enum class ProbeState : uint8_t
+    {
+        Active = 0, ///< Probe is used.
+        Inside = 1, ///< Probe is inside geometry or in an enclosed region.
+        Far = 2,    ///< Probe has no geometry within its footprint.
+    };
+
+    struct Grid
+    {
+        float3 origin = float3(0.f);   ///< Minimum corner of the grid.
+        float3 spacing = float3(1.f);  ///< Cell size.
+        uint3 probeCounts = uint3(1u); ///< Number of probes (cells) along each axis.
+    };
+
+    struct Options
+    {
+        uint32_t voxelsPerProbe = 8;        ///< Voxelization resolution per grid cell and axis.
+        uint32_t maxVoxelCount = 1u << 21;  ///< Maximum number of voxels. voxelsPerProbe is reduced to stay below it.
+        float maxOffset = 0.45f;            ///< Maximum probe offset along each axis in cells.
+        float minClearance = 0.2f;          ///< Desired distance from probes to geometry in cells.
+        float backfaceThreshold = 0.5f;     ///< Empty regions with more than this fraction of back-facing boundary are enclosed.
+        bool cullInside = true;             ///< Deactivate probes that are inside geometry.
+        bool cullFar = true;                ///< Deactivate probes without geometry in their footprint.
+    };
+
+    struct Result
+    {
+        std::vector<float3> offsets;        ///< World-space offset per probe relative to its grid position.
+        std::vector<ProbeState> states;     ///< State per probe.
+        std::vector<uint32_t> activeProbes; ///< Indices of the active probes in increasing order.
+        uint32_t insideCount = 0;           ///< Number of probes marked Inside.
+        uint32_t farCount = 0;              ///< Number of probes marked Far.
+        uint32_t movedCount = 0;            ///< Number of active probes with a non-zero offset.
+        uint32_t voxelsPerProbe = 0;        ///< Voxelization resolution that was used.
+
+        uint32_t getProbeCount() const { return (uint32_t)states.size(); }
+        uint32_t getActiveCount() const { return (uint32_t)activeProbes.size(); }
+
+        /// Returns the fraction of probes that are not active.
+        float getCulledFraction() const
+        {
+            return states.empty() ? 0.f : float(states.size() - activeProbes.size()) / float(states.size());
+        }
+    };
+
+    /**
+     * Get the linear index of a probe. Probes are stored in x-major order.
+     */
+    static uint32_t getProbeIndex(const Grid& grid, uint3 probe)
+    {
+        return probe.x + grid.probeCounts.x * (probe.y + grid.probeCounts.y * probe.z);
+    }
+
+    /**
+     * Get the position of a probe before any offset is applied.
+     */
+    static float3 getGridPosition(const Grid& grid, uint3 probe) { return grid.origin + (float3(probe) + 0.5f) * grid.spacing; }
+
+    /**
+     * Compute the probe placement for a triangle soup.
+     * Triangles are expected to be wound counter-clockwise when seen from their front side.
+     * @param[in] grid Probe grid.
+     * @param[in] positions World-space vertex positions.
+     * @param[in] indices Triangle list indices into positions.
+     * @param[in] options Placement options.
+     * @return Returns the placement.
+     */
+    static Result compute(const Grid& grid, fstd::span<const float3> positions, fstd::span<const uint32_t> indices, const Options& options);
+};
+} // namespace Falcor
@@ -30,7 +30,10 @@
 #include "Utils/ObjectIDPython.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Utils/NumericRange.h"
 #include "Scene/Transform.h"
+#include <algorithm>
+#include <execution>
 
 namespace Falcor
 {
@@ -38,6 +41,9 @@ namespace Falcor
     {
         const double kEpsilonTime = 1e-5f;
 
+        // Below this number of animations, animateMany() samples on the calling thread.
+        const size_t kMinParallelAnimationCount = 256;
+
         const Gui::DropdownList kChannelLoopModeDropdown =
         {
             { (uint32_t)Animation::Behavior::Constant, "Constant" },
@@ -112,6 +118,30 @@ namespace Falcor
     {}
 
     float4x4 Animation::animate(double currentTime)
+    {
+        Keyframe interpolated = sample(currentTime);
+        return math::matrixFromTRS(interpolated.translation, interpolated.rotation, interpolated.scaling);
+    }
+
+    void Animation::animateMany(fstd::span<const ref<Animation>> animations, double currentTime, fstd::span<float4x4> transforms)
+    {
+        FALCOR_CHECK(animations.size() == transforms.size(), "'transforms' must have one element per animation.");
+
+        // Sample and compose all transforms. Each animation and output element is only touched by one thread,
+        // including the animation's keyframe cursor, so no scratch storage is shared between workers.
+        NumericRange<size_t> range(0, animations.size());
+        auto animateOne = [&](size_t i)
+        {
+            Keyframe k = animations[i]->sample(currentTime);
+            transforms[i] = math::matrixFromTRS(k.translation, k.rotation, k.scaling);
+        };
+        if (animations.size() >= kMinParallelAnimationCount)
+            std::for_each(std::execution::par, range.begin(), range.end(), animateOne);
+        else
+            std::for_each(range.begin(), range.end(), animateOne);
+    }
+
+    Animation::Keyframe Animation::sample(double currentTime)
     {
         // Calculate the sample time.
         double time = currentTime;
@@ -147,31 +177,14 @@ namespace Falcor
             interpolated = interpolate(mInterpolationMode, time);
         }
 
-        float4x4 T = math::matrixFromTranslation(interpolated.translation);
-        float4x4 R = math::matrixFromQuat(interpolated.rotation);
-        float4x4 S = math::matrixFromScaling(interpolated.scaling);
-        float4x4 transform = mul(mul(T, R), S);
-
-        return transform;
+        return interpolated;
     }
 
     Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
     {
         FALCOR_ASSERT(!mKeyframes.empty());
 
-        // Validate cached frame index.
-        size_t frameIndex = std::clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
-
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
-        {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
-        }
-
-        // Cache frame index;
-        mCachedFrameIndex = frameIndex;
+        size_t frameIndex = findKeyframe(time);
 
         // Compute index of adjacent frame including optional warping.
         auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
@@ -218,6 +231,60 @@ namespace Falcor
         }
     }
 
+    // Returns the index of the last keyframe at or before the given time, or 0 if the time is before the first keyframe.
+    // Playback is usually coherent, so the search starts at the keyframe found by the previous call. The current and next
+    // segments are checked first, then the search gallops outwards in either direction and finishes with a binary search.
+    // This keeps sequential playback O(1) and arbitrary jumps (e.g. looping) O(log n).
+    size_t Animation::findKeyframe(double time) const
+    {
+        FALCOR_ASSERT(!mKeyframes.empty());
+
+        const size_t count = mKeyframes.size();
+        size_t index = std::min(mCachedFrameIndex, count - 1);
+        size_t lo = 0;
+        size_t hi = count;
+
+        if (mKeyframes[index].time <= time)
+        {
+            if (index + 1 == count || time < mKeyframes[index + 1].time)
+                return mCachedFrameIndex = index;
+            if (index + 2 == count || time < mKeyframes[index + 2].time)
+                return mCachedFrameIndex = index + 1;
+
+            // Gallop forward until a keyframe after the time is found.
+            lo = index + 2;
+            for (size_t step = 1; lo + step < count; step *= 2)
+            {
+                if (time < mKeyframes[lo + step].time)
+                {
+                    hi = lo + step;
+                    break;
+                }
+                lo += step;
+            }
+        }
+        else
+        {
+            // Gallop backward until a keyframe at or before the time is found.
+            hi = index;
+            lo = 0;
+            for (size_t step = 1; step <= hi; step *= 2)
+            {
+                if (mKeyframes[hi - step].time <= time)
+                {
+                    lo = hi - step;
+                    break;
+                }
+                hi -= step;
+            }
+        }
+
+        // Binary search for the first keyframe after the time in [lo, hi).
+        auto it = std::upper_bound(mKeyframes.begin() + lo, mKeyframes.begin() + hi, time, [](double t, const Keyframe& k) { return t < k.time; });
+        index = (size_t)(it - mKeyframes.begin());
+        return mCachedFrameIndex = (index > 0 ? index - 1 : 0);
+    }
+
     // Calculates the sample time within the keyframe range if the current time lies outside and
     // the animation does not behave linearly. If the animation behaves linearly, then the
     // current time is returned. This function should not be used if the current time lies
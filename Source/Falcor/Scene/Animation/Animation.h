@@ -155,12 +155,22 @@ namespace Falcor
         */
         float4x4 animate(double currentTime);
 
+        /** Compute multiple animations at once.
+            Large batches are sampled in parallel, with each animation handled by a single thread.
+            \param[in] animations Animations to compute.
+            \param[in] currentTime The current time in seconds.
+            \param[out] transforms Transform matrix for each animation. Must have the same size as 'animations'.
+        */
+        static void animateMany(fstd::span<const ref<Animation>> animations, double currentTime, fstd::span<float4x4> transforms);
+
         /* Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
 
     private:
+        Keyframe sample(double currentTime);
         Keyframe interpolate(InterpolationMode mode, double time) const;
+        size_t findKeyframe(double time) const;
         double calcSampleTime(double currentTime);
 
         std::string mName;
@@ -174,7 +184,7 @@ namespace Falcor
         bool mEnableWarping = false;
 
         std::vector<Keyframe> mKeyframes;
-        mutable size_t mCachedFrameIndex = 0;
+        mutable size_t mCachedFrameIndex = 0; // Keyframe found by the last lookup. Used as the starting point for the next one.
 
         friend class SceneCache;
     };
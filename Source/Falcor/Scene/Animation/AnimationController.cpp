@@ -29,7 +29,11 @@
 #include "Core/API/RenderContext.h"
 #include "Utils/Timing/Profiler.h"
 #include "Scene/Scene.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
+#include <execution>
 #include <fstream>
+#include <iterator>
 
 namespace Falcor
 {
@@ -39,6 +43,15 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        // Levels with fewer nodes than this are updated on the calling thread.
+        const size_t kMinParallelLevelSize = 1024;
+
+        float4x4 inverseTranspose(const float4x4& m)
+        {
+            bool isAffine = m[3][0] == 0.f && m[3][1] == 0.f && m[3][2] == 0.f && m[3][3] == 1.f;
+            return transpose(isAffine ? inverseAffine(m) : inverse(m));
+        }
     }
 
     AnimationController::AnimationController(ref<Device> pDevice, Scene* pScene, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<ref<Animation>>& animations)
@@ -85,6 +98,7 @@ namespace Falcor
         }
 
         createSkinningPass(skinningVertexData);
+        initNodeLevels();
 
         // Determine length of global animation loop.
         for (const auto& pAnimation : mAnimations)
@@ -192,6 +206,44 @@ namespace Falcor
         }
     }
 
+    void AnimationController::initNodeLevels()
+    {
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        const uint32_t nodeCount = (uint32_t)sceneGraph.size();
+        const uint32_t kUnknown = std::numeric_limits<uint32_t>::max();
+
+        // Compute the depth of each node. Parents are not guaranteed to precede their children.
+        std::vector<uint32_t> depths(nodeCount, kUnknown);
+        std::vector<uint32_t> stack;
+        uint32_t levelCount = 0;
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            uint32_t nodeID = i;
+            while (depths[nodeID] == kUnknown && sceneGraph[nodeID].parent != NodeID::Invalid())
+            {
+                stack.push_back(nodeID);
+                nodeID = sceneGraph[nodeID].parent.get();
+                FALCOR_CHECK(stack.size() <= nodeCount, "Scene graph contains a cycle.");
+            }
+            if (depths[nodeID] == kUnknown) depths[nodeID] = 0;
+            for (; !stack.empty(); stack.pop_back())
+            {
+                depths[stack.back()] = depths[nodeID] + 1;
+                nodeID = stack.back();
+            }
+            levelCount = std::max(levelCount, depths[i] + 1);
+        }
+
+        // Bucket nodes by depth. Nodes within a level stay in index order to keep memory accesses coherent.
+        mLevelOffsets.assign(levelCount + 1, 0);
+        for (uint32_t depth : depths) mLevelOffsets[depth + 1]++;
+        for (uint32_t level = 0; level < levelCount; level++) mLevelOffsets[level + 1] += mLevelOffsets[level];
+
+        mLevelNodes.resize(nodeCount);
+        std::vector<uint32_t> cursors(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+        for (uint32_t i = 0; i < nodeCount; i++) mLevelNodes[cursors[depths[i]]++] = i;
+    }
+
     bool AnimationController::animate(RenderContext* pRenderContext, double currentTime)
     {
         FALCOR_PROFILE(pRenderContext, "animate");
@@ -291,43 +343,75 @@ namespace Falcor
 
     void AnimationController::updateLocalMatrices(double time)
     {
-        for (auto& pAnimation : mAnimations)
+        mAnimationTransforms.resize(mAnimations.size());
+        Animation::animateMany(mAnimations, time, mAnimationTransforms);
+
+        for (size_t i = 0; i < mAnimations.size(); i++)
         {
-            NodeID nodeID = pAnimation->getNodeID();
+            NodeID nodeID = mAnimations[i]->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
-            mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
+            mLocalMatrices[nodeID.get()] = mAnimationTransforms[i];
             mMatricesChanged[nodeID.get()] = true;
         }
     }
 
     void AnimationController::updateWorldMatrices(bool updateAll)
     {
-        const auto& sceneGraph = mpScene->mSceneGraph;
+        // Update the hierarchy one level at a time. All parents of a level have been updated by the previous
+        // levels, so the nodes within a level are independent and can be updated in parallel.
+        for (size_t level = 0; level + 1 < mLevelOffsets.size(); level++)
+        {
+            NumericRange<uint32_t> range(mLevelOffsets[level], mLevelOffsets[level + 1]);
+            auto updateNode = [&](uint32_t i) { updateWorldMatrix(mLevelNodes[i], updateAll); };
+
+            if (mLevelOffsets[level + 1] - mLevelOffsets[level] >= kMinParallelLevelSize)
+                std::for_each(std::execution::par, range.begin(), range.end(), updateNode);
+            else
+                std::for_each(range.begin(), range.end(), updateNode);
+        }
+
+        updateDirtyRanges();
+    }
 
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+    void AnimationController::updateWorldMatrix(uint32_t nodeID, bool updateAll)
+    {
+        const auto& node = mpScene->mSceneGraph[nodeID];
+
+        // Propagate matrix change flag to children.
+        if (node.parent != NodeID::Invalid())
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
-            {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
-            }
+            mMatricesChanged[nodeID] = mMatricesChanged[nodeID] || mMatricesChanged[node.parent.get()];
+        }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
+        if (!mMatricesChanged[nodeID] && !updateAll) return;
 
-            mGlobalMatrices[i] = mLocalMatrices[i];
+        mGlobalMatrices[nodeID] = mLocalMatrices[nodeID];
 
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
-            {
-                mGlobalMatrices[i] = mul(mGlobalMatrices[sceneGraph[i].parent.get()], mGlobalMatrices[i]);
-            }
+        if (node.parent != NodeID::Invalid())
+        {
+            mGlobalMatrices[nodeID] = mul(mGlobalMatrices[node.parent.get()], mGlobalMatrices[nodeID]);
+        }
 
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
+        mInvTransposeGlobalMatrices[nodeID] = inverseTranspose(mGlobalMatrices[nodeID]);
 
-            if (mpSkinningPass)
-            {
-                mSkinningMatrices[i] = mul(mGlobalMatrices[i], sceneGraph[i].localToBindSpace);
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
-            }
+        if (mpSkinningPass)
+        {
+            mSkinningMatrices[nodeID] = mul(mGlobalMatrices[nodeID], node.localToBindSpace);
+            mInvTransposeSkinningMatrices[nodeID] = inverseTranspose(mSkinningMatrices[nodeID]);
+        }
+    }
+
+    void AnimationController::updateDirtyRanges()
+    {
+        mDirtyRanges.clear();
+
+        const uint32_t count = (uint32_t)mMatricesChanged.size();
+        for (uint32_t i = 0; i < count;)
+        {
+            while (i < count && !mMatricesChanged[i]) ++i;
+            uint32_t begin = i;
+            while (i < count && mMatricesChanged[i]) ++i;
+            if (i > begin) mDirtyRanges.emplace_back(begin, i);
         }
     }
 
@@ -343,25 +427,29 @@ namespace Falcor
             // Upload all matrices.
             mpWorldMatricesBuffer->setBlob(mGlobalMatrices.data(), 0, mpWorldMatricesBuffer->getSize());
             mpInvTransposeWorldMatricesBuffer->setBlob(mInvTransposeGlobalMatrices.data(), 0, mpInvTransposeWorldMatricesBuffer->getSize());
+            mPrevDirtyRanges.clear();
         }
         else
         {
-            // Upload changed matrices only.
-            for (size_t i = 0; i < mGlobalMatrices.size();)
-            {
-                // Detect ranges of consecutive matrices that have all changed or not.
-                size_t offset = i;
-                bool changed = mMatricesChanged[i];
-                while (i < mGlobalMatrices.size() && mMatricesChanged[i] == changed) ++i;
+            // The current and previous buffers are swapped every update, so the buffer being written was last
+            // written two updates ago. Upload the matrices changed in this or the previous update.
+            std::vector<Range> ranges;
+            ranges.reserve(mDirtyRanges.size() + mPrevDirtyRanges.size());
+            std::merge(mDirtyRanges.begin(), mDirtyRanges.end(), mPrevDirtyRanges.begin(), mPrevDirtyRanges.end(), std::back_inserter(ranges));
 
-                // Upload range of changed matrices.
-                if (changed)
-                {
-                    size_t count = i - offset;
-                    mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                    mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                }
+            for (size_t i = 0; i < ranges.size();)
+            {
+                // Coalesce overlapping and adjacent ranges.
+                uint32_t begin = ranges[i].first;
+                uint32_t end = ranges[i].second;
+                for (++i; i < ranges.size() && ranges[i].first <= end; ++i) end = std::max(end, ranges[i].second);
+
+                size_t count = end - begin;
+                mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[begin], begin * sizeof(float4x4), count * sizeof(float4x4));
+                mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[begin], begin * sizeof(float4x4), count * sizeof(float4x4));
             }
+
+            mPrevDirtyRanges = mDirtyRanges;
         }
     }
 
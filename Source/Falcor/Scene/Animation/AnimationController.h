@@ -110,7 +110,11 @@ namespace Falcor
 
         /** Check if a matrix changed since last frame.
         */
-        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
+        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()] != 0; }
+
+        /** Get the flags per matrix, non-zero if the matrix changed in the last call to animate().
+        */
+        const std::vector<uint8_t>& getMatricesChanged() const { return mMatricesChanged; }
 
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
@@ -149,8 +153,11 @@ namespace Falcor
         friend class Scene;
 
         void initLocalMatrices();
+        void initNodeLevels();
         void updateLocalMatrices(double time);
         void updateWorldMatrices(bool updateAll = false);
+        void updateWorldMatrix(uint32_t nodeID, bool updateAll);
+        void updateDirtyRanges();
         void uploadWorldMatrices(bool uploadAll = false);
 
         void bindBuffers();
@@ -163,10 +170,17 @@ namespace Falcor
         // Animation
         std::vector<ref<Animation>> mAnimations;
         std::vector<bool> mNodesEdited;
+        std::vector<float4x4> mAnimationTransforms; ///< Scratch buffer with the transform of each animation.
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
-        std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<uint8_t> mMatricesChanged;      ///< Flag per matrix, true if matrix changed since last frame. Stored as bytes so levels can be updated in parallel.
+
+        using Range = std::pair<uint32_t, uint32_t>;
+        std::vector<uint32_t> mLevelNodes;          ///< Scene graph nodes sorted by depth in the hierarchy. Parents are always in an earlier level than their children.
+        std::vector<uint32_t> mLevelOffsets;        ///< Offset of the first node of each level in mLevelNodes, followed by the total node count.
+        std::vector<Range> mDirtyRanges;            ///< Ranges [begin, end) of matrices changed in the current update.
+        std::vector<Range> mPrevDirtyRanges;        ///< Ranges [begin, end) of matrices changed in the previous update.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
@@ -517,6 +517,10 @@ namespace Falcor
         updateFlags |= mMaterialUpdates;
         mMaterialUpdates = Material::UpdateFlags::None;
 
+        // Update mip residency of streamed textures. Textures whose residency changed are replaced, so rebind them.
+        if (mpTextureManager->updateStreaming())
+            updateFlags |= Material::UpdateFlags::ResourcesChanged;
+
         // Create parameter block if needed.
         if (!mpMaterialsBlock)
         {
@@ -30,6 +30,29 @@
 
 namespace Falcor
 {
+    namespace
+    {
+        /** Get the block compression used when cooking textures for a material texture slot.
+        */
+        ImageIO::CompressionMode getCookCompression(Material::TextureSlot slot)
+        {
+            switch (slot)
+            {
+            case Material::TextureSlot::BaseColor:
+            case Material::TextureSlot::Specular:
+            case Material::TextureSlot::Emissive:
+            case Material::TextureSlot::Transmission:
+                return ImageIO::CompressionMode::BC7;
+            case Material::TextureSlot::Normal:
+                // Two channel normal maps are reconstructed in the shader (see NormalMapType::RG).
+                return ImageIO::CompressionMode::BC5;
+            default:
+                // Displacement and index textures need exact values.
+                return ImageIO::CompressionMode::None;
+            }
+        }
+    }
+
     MaterialTextureLoader::MaterialTextureLoader(TextureManager& textureManager, bool useSrgb)
         : mUseSrgb(useSrgb)
         , mTextureManager(textureManager)
@@ -41,7 +64,7 @@ namespace Falcor
         assignTextures();
     }
 
-    void MaterialTextureLoader::loadTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path)
+    void MaterialTextureLoader::loadTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool loadAsSrgb)
     {
         FALCOR_ASSERT(pMaterial);
         if (!pMaterial->hasTextureSlot(slot))
@@ -50,7 +73,7 @@ namespace Falcor
             return;
         }
 
-        bool srgb = mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb;
+        bool srgb = loadAsSrgb && mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb;
 
         // Request texture to be loaded.
         auto handle = mTextureManager.loadTexture(
@@ -62,13 +85,23 @@ namespace Falcor
             Bitmap::ImportFlags::None,
             nullptr /*search dirs*/,
             nullptr /*load count*/,
-            pMaterial.get()
+            pMaterial.get(),
+            getCookCompression(slot)
         );
 
         // Store assignment to material for later.
         mTextureAssignments.emplace_back(TextureAssignment{ pMaterial, slot, handle });
     }
 
+    void MaterialTextureLoader::setMaterialPriority(const std::set<const Material*>& materials, uint32_t priority)
+    {
+        for (const auto& assignment : mTextureAssignments)
+        {
+            if (materials.count(assignment.pMaterial.get()) > 0)
+                mTextureManager.setTexturePriority(assignment.handle, priority);
+        }
+    }
+
     void MaterialTextureLoader::assignTextures()
     {
         mTextureManager.waitForAllTexturesLoading();
@@ -30,6 +30,7 @@
 #include "Scene/Material/Material.h"
 #include "Utils/Image/TextureManager.h"
 #include <filesystem>
+#include <set>
 #include <vector>
 
 namespace Falcor
@@ -52,8 +53,16 @@ namespace Falcor
             \param[in] pMaterial Material to load texture into.
             \param[in] slot Slot to load texture into.
             \param[in] path Texture file path.
+            \param[in] loadAsSrgb Load the texture as sRGB if the slot is sRGB. Set to false for linear data in sRGB slots.
         */
-        void loadTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path);
+        void loadTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool loadAsSrgb = true);
+
+        /** Set the load priority of the textures requested for a set of materials.
+            Textures with higher priority are loaded first if their load request is still pending.
+            \param[in] materials Materials whose textures to prioritize.
+            \param[in] priority Priority.
+        */
+        void setMaterialPriority(const std::set<const Material*>& materials, uint32_t priority);
 
         void finishLoading()
         {
@@ -0,0 +1,645 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PlyReader.h"
+#include "Core/Error.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include <fast_float/fast_float.h>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Falcor
+{
+namespace
+{
+enum class Format
+{
+    Ascii,
+    BinaryLittleEndian,
+    BinaryBigEndian,
+};
+
+enum class Type
+{
+    Invalid,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Float32,
+    Float64,
+};
+
+/// Vertex attribute slots that are read from the vertex element.
+enum Slot : int
+{
+    kSlotNone = -1,
+    kSlotX,
+    kSlotY,
+    kSlotZ,
+    kSlotNX,
+    kSlotNY,
+    kSlotNZ,
+    kSlotU,
+    kSlotV,
+    kSlotCount,
+};
+
+struct Property
+{
+    std::string name;
+    Type type = Type::Invalid;
+    Type countType = Type::Invalid; ///< Type of the list count, or Invalid for scalar properties.
+
+    bool isList() const { return countType != Type::Invalid; }
+};
+
+struct Element
+{
+    std::string name;
+    size_t count = 0;
+    std::vector<Property> properties;
+
+    bool hasLists() const
+    {
+        for (const auto& property : properties)
+            if (property.isList())
+                return true;
+        return false;
+    }
+};
+
+Type parseType(std::string_view name)
+{
+    if (name == "char" || name == "int8")
+        return Type::Int8;
+    if (name == "uchar" || name == "uint8")
+        return Type::UInt8;
+    if (name == "short" || name == "int16")
+        return Type::Int16;
+    if (name == "ushort" || name == "uint16")
+        return Type::UInt16;
+    if (name == "int" || name == "int32")
+        return Type::Int32;
+    if (name == "uint" || name == "uint32")
+        return Type::UInt32;
+    if (name == "float" || name == "float32")
+        return Type::Float32;
+    if (name == "double" || name == "float64")
+        return Type::Float64;
+    FALCOR_THROW("Unknown property type '{}'.", name);
+}
+
+size_t getTypeSize(Type type)
+{
+    switch (type)
+    {
+    case Type::Int8:
+    case Type::UInt8:
+        return 1;
+    case Type::Int16:
+    case Type::UInt16:
+        return 2;
+    case Type::Int32:
+    case Type::UInt32:
+    case Type::Float32:
+        return 4;
+    case Type::Float64:
+        return 8;
+    default:
+        FALCOR_UNREACHABLE();
+    }
+}
+
+int getVertexSlot(std::string_view name)
+{
+    if (name == "x")
+        return kSlotX;
+    if (name == "y")
+        return kSlotY;
+    if (name == "z")
+        return kSlotZ;
+    if (name == "nx")
+        return kSlotNX;
+    if (name == "ny")
+        return kSlotNY;
+    if (name == "nz")
+        return kSlotNZ;
+    // Texture coordinate naming varies between exporters.
+    if (name == "u" || name == "s" || name == "texture_u" || name == "texture_s")
+        return kSlotU;
+    if (name == "v" || name == "t" || name == "texture_v" || name == "texture_t")
+        return kSlotV;
+    return kSlotNone;
+}
+
+bool isSpace(uint8_t c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+std::vector<std::string_view> splitTokens(std::string_view line)
+{
+    std::vector<std::string_view> tokens;
+    size_t pos = 0;
+    while (pos < line.size())
+    {
+        while (pos < line.size() && isSpace(line[pos]))
+            ++pos;
+        size_t start = pos;
+        while (pos < line.size() && !isSpace(line[pos]))
+            ++pos;
+        if (pos > start)
+            tokens.push_back(line.substr(start, pos - start));
+    }
+    return tokens;
+}
+
+template<typename T>
+T loadValue(const uint8_t* ptr, bool swap)
+{
+    T value;
+    if (swap)
+    {
+        uint8_t bytes[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); ++i)
+            bytes[i] = ptr[sizeof(T) - 1 - i];
+        std::memcpy(&value, bytes, sizeof(T));
+    }
+    else
+    {
+        std::memcpy(&value, ptr, sizeof(T));
+    }
+    return value;
+}
+
+double loadBinary(const uint8_t* ptr, Type type, bool swap)
+{
+    switch (type)
+    {
+    case Type::Int8:
+        return (double)loadValue<int8_t>(ptr, swap);
+    case Type::UInt8:
+        return (double)loadValue<uint8_t>(ptr, swap);
+    case Type::Int16:
+        return (double)loadValue<int16_t>(ptr, swap);
+    case Type::UInt16:
+        return (double)loadValue<uint16_t>(ptr, swap);
+    case Type::Int32:
+        return (double)loadValue<int32_t>(ptr, swap);
+    case Type::UInt32:
+        return (double)loadValue<uint32_t>(ptr, swap);
+    case Type::Float32:
+        return (double)loadValue<float>(ptr, swap);
+    case Type::Float64:
+        return loadValue<double>(ptr, swap);
+    default:
+        FALCOR_UNREACHABLE();
+    }
+}
+
+uint32_t toIndex(double value)
+{
+    if (!(value >= 0.0 && value <= (double)std::numeric_limits<uint32_t>::max()))
+        FALCOR_THROW("Invalid vertex index {}.", value);
+    return (uint32_t)value;
+}
+
+/// Sequential reader for the body of a PLY file.
+class BodyReader
+{
+public:
+    BodyReader(const uint8_t* begin, const uint8_t* end, Format format)
+        : mPtr(begin)
+        , mEnd(end)
+        , mAscii(format == Format::Ascii)
+        // Falcor only runs on little endian platforms.
+        , mSwap(format == Format::BinaryBigEndian)
+    {}
+
+    bool isAscii() const { return mAscii; }
+    bool isSwapped() const { return mSwap; }
+    const uint8_t* getPtr() const { return mPtr; }
+    size_t getRemaining() const { return mEnd - mPtr; }
+
+    void require(size_t size) const
+    {
+        if (getRemaining() < size)
+            FALCOR_THROW("Unexpected end of file.");
+    }
+
+    void advance(size_t size)
+    {
+        require(size);
+        mPtr += size;
+    }
+
+    double read(Type type)
+    {
+        if (mAscii)
+            return readAscii();
+        size_t size = getTypeSize(type);
+        require(size);
+        double value = loadBinary(mPtr, type, mSwap);
+        mPtr += size;
+        return value;
+    }
+
+    void skip(Type type, size_t count)
+    {
+        if (mAscii)
+        {
+            for (size_t i = 0; i < count; ++i)
+                readAscii();
+        }
+        else
+        {
+            size_t size = getTypeSize(type);
+            if (count > getRemaining() / size)
+                FALCOR_THROW("Unexpected end of file.");
+            mPtr += count * size;
+        }
+    }
+
+private:
+    double readAscii()
+    {
+        while (mPtr < mEnd && isSpace(*mPtr))
+            ++mPtr;
+        // Skip '+' character, fast_float::from_chars doesn't handle it.
+        if (mPtr < mEnd && *mPtr == '+')
+            ++mPtr;
+        double value = 0.0;
+        auto result = fast_float::from_chars(reinterpret_cast<const char*>(mPtr), reinterpret_cast<const char*>(mEnd), value);
+        if (result.ec != std::errc())
+        {
+            if (mPtr == mEnd)
+                FALCOR_THROW("Unexpected end of file.");
+            FALCOR_THROW("Failed to parse value.");
+        }
+        mPtr = reinterpret_cast<const uint8_t*>(result.ptr);
+        return value;
+    }
+
+    const uint8_t* mPtr;
+    const uint8_t* mEnd;
+    bool mAscii;
+    bool mSwap;
+};
+
+/// Check that an element count is plausible before allocating memory for it.
+void checkElementCount(const Element& element, const BodyReader& reader)
+{
+    // Each property takes at least one byte (or one character plus a separator in ASCII files).
+    size_t minSize = 0;
+    for (const auto& property : element.properties)
+        minSize += reader.isAscii() ? 2 : getTypeSize(property.isList() ? property.countType : property.type);
+    if (minSize > 0 && element.count > (reader.getRemaining() + 1) / minSize)
+        FALCOR_THROW("Element '{}' count {} exceeds the file size.", element.name, element.count);
+}
+
+void skipElement(const Element& element, BodyReader& reader)
+{
+    checkElementCount(element, reader);
+    for (size_t i = 0; i < element.count; ++i)
+    {
+        for (const auto& property : element.properties)
+        {
+            if (property.isList())
+                reader.skip(property.type, (size_t)reader.read(property.countType));
+            else
+                reader.skip(property.type, 1);
+        }
+    }
+}
+
+void readVertices(const Element& element, BodyReader& reader, PlyReader::Mesh& mesh)
+{
+    checkElementCount(element, reader);
+
+    std::vector<int> slots(element.properties.size(), kSlotNone);
+    bool hasSlot[kSlotCount] = {};
+    for (size_t i = 0; i < element.properties.size(); ++i)
+    {
+        const auto& property = element.properties[i];
+        int slot = property.isList() ? kSlotNone : getVertexSlot(property.name);
+        if (slot != kSlotNone)
+        {
+            slots[i] = slot;
+            hasSlot[slot] = true;
+        }
+    }
+
+    if (!hasSlot[kSlotX] || !hasSlot[kSlotY] || !hasSlot[kSlotZ])
+        FALCOR_THROW("Vertex element is missing positions.");
+    const bool hasNormals = hasSlot[kSlotNX] && hasSlot[kSlotNY] && hasSlot[kSlotNZ];
+    const bool hasTexCoords = hasSlot[kSlotU] && hasSlot[kSlotV];
+
+    mesh.positions.resize(element.count);
+    mesh.normals.resize(hasNormals ? element.count : 0);
+    mesh.texCoords.resize(hasTexCoords ? element.count : 0);
+
+    float values[kSlotCount] = {};
+    auto storeVertex = [&](size_t i)
+    {
+        mesh.positions[i] = float3(values[kSlotX], values[kSlotY], values[kSlotZ]);
+        if (hasNormals)
+            mesh.normals[i] = float3(values[kSlotNX], values[kSlotNY], values[kSlotNZ]);
+        if (hasTexCoords)
+            mesh.texCoords[i] = float2(values[kSlotU], values[kSlotV]);
+    };
+
+    if (!reader.isAscii() && !element.hasLists())
+    {
+        // Fast path for binary vertices with a fixed stride.
+        struct Field
+        {
+            size_t offset;
+            Type type;
+            int slot;
+        };
+        std::vector<Field> fields;
+        size_t stride = 0;
+        for (size_t i = 0; i < element.properties.size(); ++i)
+        {
+            if (slots[i] != kSlotNone)
+                fields.push_back({stride, element.properties[i].type, slots[i]});
+            stride += getTypeSize(element.properties[i].type);
+        }
+
+        reader.require(element.count * stride);
+        const uint8_t* base = reader.getPtr();
+        for (size_t i = 0; i < element.count; ++i, base += stride)
+        {
+            for (const auto& field : fields)
+                values[field.slot] = (float)loadBinary(base + field.offset, field.type, reader.isSwapped());
+            storeVertex(i);
+        }
+        reader.advance(element.count * stride);
+        return;
+    }
+
+    for (size_t i = 0; i < element.count; ++i)
+    {
+        for (size_t j = 0; j < element.properties.size(); ++j)
+        {
+            const auto& property = element.properties[j];
+            if (property.isList())
+            {
+                reader.skip(property.type, (size_t)reader.read(property.countType));
+            }
+            else
+            {
+                double value = reader.read(property.type);
+                if (slots[j] != kSlotNone)
+                    values[slots[j]] = (float)value;
+            }
+        }
+        storeVertex(i);
+    }
+}
+
+void readFaces(const Element& element, BodyReader& reader, PlyReader::Mesh& mesh)
+{
+    checkElementCount(element, reader);
+
+    const Property* pIndexProperty = nullptr;
+    for (const auto& property : element.properties)
+    {
+        if (property.isList() && (property.name == "vertex_indices" || property.name == "vertex_index"))
+            pIndexProperty = &property;
+    }
+    if (!pIndexProperty)
+        FALCOR_THROW("Face element is missing vertex indices.");
+
+    mesh.indices.reserve(mesh.indices.size() + element.count * 3);
+
+    // Triangulate polygons as triangle fans.
+    auto addPolygon = [&mesh](const uint32_t* polygon, size_t count)
+    {
+        for (size_t k = 2; k < count; ++k)
+        {
+            mesh.indices.push_back(polygon[0]);
+            mesh.indices.push_back(polygon[k - 1]);
+            mesh.indices.push_back(polygon[k]);
+        }
+    };
+
+    std::vector<uint32_t> polygon;
+
+    if (!reader.isAscii() && element.properties.size() == 1)
+    {
+        // Fast path for binary faces only storing the vertex indices.
+        const Type countType = pIndexProperty->countType;
+        const Type indexType = pIndexProperty->type;
+        const size_t countSize = getTypeSize(countType);
+        const size_t indexSize = getTypeSize(indexType);
+        const bool swap = reader.isSwapped();
+        for (size_t i = 0; i < element.count; ++i)
+        {
+            reader.require(countSize);
+            size_t count = (size_t)loadBinary(reader.getPtr(), countType, swap);
+            reader.advance(countSize);
+            if (count > reader.getRemaining() / indexSize)
+                FALCOR_THROW("Unexpected end of file.");
+            polygon.resize(count);
+            const uint8_t* ptr = reader.getPtr();
+            for (size_t k = 0; k < count; ++k, ptr += indexSize)
+                polygon[k] = toIndex(loadBinary(ptr, indexType, swap));
+            reader.advance(count * indexSize);
+            addPolygon(polygon.data(), count);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < element.count; ++i)
+    {
+        for (const auto& property : element.properties)
+        {
+            if (!property.isList())
+            {
+                reader.skip(property.type, 1);
+                continue;
+            }
+
+            size_t count = (size_t)reader.read(property.countType);
+            if (&property != pIndexProperty)
+            {
+                reader.skip(property.type, count);
+                continue;
+            }
+
+            if (!reader.isAscii() && count > reader.getRemaining() / getTypeSize(property.type))
+                FALCOR_THROW("Unexpected end of file.");
+            polygon.resize(count);
+            for (size_t k = 0; k < count; ++k)
+                polygon[k] = toIndex(reader.read(property.type));
+            addPolygon(polygon.data(), count);
+        }
+    }
+}
+} // namespace
+
+PlyReader::Mesh PlyReader::read(const std::filesystem::path& path)
+{
+    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    if (!file.isOpen())
+        FALCOR_THROW("Failed to open file.");
+    return read(file.getData(), file.getMappedSize());
+}
+
+PlyReader::Mesh PlyReader::read(const void* data, size_t size)
+{
+    const uint8_t* ptr = static_cast<const uint8_t*>(data);
+    const uint8_t* end = ptr + size;
+
+    // Returns the next header line without the line terminator.
+    auto nextLine = [&]()
+    {
+        const uint8_t* newline = static_cast<const uint8_t*>(std::memchr(ptr, '\n', end - ptr));
+        if (!newline)
+            FALCOR_THROW("Missing 'end_header'.");
+        std::string_view line(reinterpret_cast<const char*>(ptr), newline - ptr);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        ptr = newline + 1;
+        return line;
+    };
+
+    if (size < 4 || std::memcmp(ptr, "ply", 3) != 0 || nextLine() != "ply")
+        FALCOR_THROW("Not a PLY file.");
+
+    // Parse header.
+    std::optional<Format> format;
+    std::vector<Element> elements;
+    while (true)
+    {
+        auto tokens = splitTokens(nextLine());
+        if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info")
+            continue;
+
+        if (tokens[0] == "end_header")
+        {
+            break;
+        }
+        else if (tokens[0] == "format")
+        {
+            if (tokens.size() < 2)
+                FALCOR_THROW("Invalid 'format' line.");
+            if (tokens[1] == "ascii")
+                format = Format::Ascii;
+            else if (tokens[1] == "binary_little_endian")
+                format = Format::BinaryLittleEndian;
+            else if (tokens[1] == "binary_big_endian")
+                format = Format::BinaryBigEndian;
+            else
+                FALCOR_THROW("Unknown format '{}'.", tokens[1]);
+        }
+        else if (tokens[0] == "element")
+        {
+            if (tokens.size() != 3)
+                FALCOR_THROW("Invalid 'element' line.");
+            Element element;
+            element.name = tokens[1];
+            auto result = std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), element.count);
+            if (result.ec != std::errc())
+                FALCOR_THROW("Invalid count for element '{}'.", element.name);
+            elements.push_back(std::move(element));
+        }
+        else if (tokens[0] == "property")
+        {
+            if (elements.empty())
+                FALCOR_THROW("Property defined before any element.");
+            Property property;
+            if (tokens.size() == 5 && tokens[1] == "list")
+            {
+                property.countType = parseType(tokens[2]);
+                property.type = parseType(tokens[3]);
+                property.name = tokens[4];
+                if (property.countType == Type::Float32 || property.countType == Type::Float64)
+                    FALCOR_THROW("Invalid list count type for property '{}'.", property.name);
+            }
+            else if (tokens.size() == 3)
+            {
+                property.type = parseType(tokens[1]);
+                property.name = tokens[2];
+            }
+            else
+            {
+                FALCOR_THROW("Invalid 'property' line.");
+            }
+            elements.back().properties.push_back(std::move(property));
+        }
+        else
+        {
+            FALCOR_THROW("Unknown header keyword '{}'.", tokens[0]);
+        }
+    }
+
+    if (!format)
+        FALCOR_THROW("Missing 'format' line.");
+
+    // Parse body.
+    Mesh mesh;
+    BodyReader reader(ptr, end, *format);
+    bool hasVertices = false;
+    for (const auto& element : elements)
+    {
+        if (element.name == "vertex" && !hasVertices)
+        {
+            readVertices(element, reader, mesh);
+            hasVertices = true;
+        }
+        else if (element.name == "face")
+        {
+            readFaces(element, reader, mesh);
+        }
+        else
+        {
+            skipElement(element, reader);
+        }
+    }
+
+    if (!hasVertices)
+        FALCOR_THROW("Missing vertex element.");
+    if (mesh.indices.empty())
+        FALCOR_THROW("File contains no faces.");
+    for (uint32_t index : mesh.indices)
+    {
+        if (index >= mesh.positions.size())
+            FALCOR_THROW("Vertex index {} is out of bounds.", index);
+    }
+
+    return mesh;
+}
+} // namespace Falcor
@@ -0,0 +1,73 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Native reader for meshes stored in the PLY (polygon file format).
+ *
+ * Supports ASCII, binary little endian and binary big endian files.
+ * Files are memory mapped and parsed in place without intermediate copies.
+ * Vertex positions, normals and texture coordinates are read together with the face vertex lists.
+ * Polygons are triangulated as triangle fans. All other elements and properties are skipped.
+ *
+ * All functions throw a RuntimeError if the file is malformed.
+ */
+class FALCOR_API PlyReader
+{
+public:
+    struct Mesh
+    {
+        std::vector<float3> positions; ///< Vertex positions.
+        std::vector<float3> normals;   ///< Vertex normals (empty if the file has no normals).
+        std::vector<float2> texCoords; ///< Vertex texture coordinates (empty if the file has no texture coordinates).
+        std::vector<uint32_t> indices; ///< Triangle list indices.
+    };
+
+    /**
+     * Read a PLY mesh from a file.
+     * @param[in] path File path.
+     * @return Returns the mesh.
+     */
+    static Mesh read(const std::filesystem::path& path);
+
+    /**
+     * Read a PLY mesh from memory.
+     * @param[in] data Pointer to the file contents.
+     * @param[in] size Size of the file contents in bytes.
+     * @return Returns the mesh.
+     */
+    static Mesh read(const void* data, size_t size);
+};
+} // namespace Falcor
@@ -50,6 +50,8 @@
 #include "Utils/NumericRange.h"
 
 #include <fstream>
+#include <limits>
+#include <map>
 #include <numeric>
 #include <sstream>
 #include <algorithm>
@@ -226,6 +228,17 @@ namespace Falcor
         // Setup volume grid -> id map.
         for (size_t i = 0; i < mGrids.size(); ++i) mGridIDs.emplace(mGrids[i], (uint32_t)i);
 
+        // Streamed grid sequences reuse the grid ID of their current grid for all frames.
+        for (uint32_t volumeIndex = 0; volumeIndex < (uint32_t)mGridVolumes.size(); ++volumeIndex)
+        {
+            for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridVolume::GridSlot::Count; ++slotIndex)
+            {
+                auto slot = (GridVolume::GridSlot)slotIndex;
+                const auto& pGrid = mGridVolumes[volumeIndex]->getGrid(slot);
+                if (mGridVolumes[volumeIndex]->getGridStreamer(slot) && pGrid) mStreamedGrids.push_back({ volumeIndex, slot, mGridIDs.at(pGrid) });
+            }
+        }
+
         // Set default SDF grid config.
         setSDFGridConfig();
 
@@ -902,17 +915,73 @@ namespace Falcor
         }
     }
 
+    void Scene::updateTextureStreaming()
+    {
+        TextureManager& textureManager = mpMaterials->getTextureManager();
+        if (!textureManager.getStreamingOptions().enabled || mCameras.empty()) return;
+
+        // Estimate the screen size of each material as the largest projected bounding sphere of its visible instances.
+        // Instances without mesh bounds (curves, SDF grids) conservatively want their materials at full detail.
+        const auto& pCamera = getCamera();
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        const float3 cameraPos = pCamera->getPosition();
+        const float projScale = pCamera->getProjMatrix()[1][1];
+        const float nearZ = pCamera->getNearPlane();
+
+        std::vector<float> materialScreenSize(getMaterialCount(), 0.f);
+        for (const auto& inst : mGeometryInstanceData)
+        {
+            float& screenSize = materialScreenSize[inst.materialID];
+            if (inst.getType() != GeometryType::TriangleMesh && inst.getType() != GeometryType::DisplacedTriangleMesh)
+            {
+                screenSize = std::numeric_limits<float>::max();
+                continue;
+            }
+
+            AABB bounds = mMeshBBs[inst.geometryID].transform(globalMatrices[inst.globalMatrixID]);
+            if (pCamera->isObjectCulled(bounds)) continue;
+
+            float radius = bounds.radius();
+            float distance = std::max(length(bounds.center() - cameraPos) - radius, nearZ);
+            screenSize = std::max(screenSize, radius * projScale / distance);
+        }
+
+        // Textures shared by several materials are wanted at the largest screen size of any of them.
+        std::map<const Texture*, float> textureScreenSize;
+        for (uint32_t materialID = 0; materialID < getMaterialCount(); materialID++)
+        {
+            if (materialScreenSize[materialID] == 0.f) continue;
+            const auto& pMaterial = getMaterial(MaterialID(materialID));
+            for (uint32_t slot = 0; slot < (uint32_t)Material::TextureSlot::Count; slot++)
+            {
+                if (auto pTexture = pMaterial->getTexture((Material::TextureSlot)slot))
+                {
+                    float& screenSize = textureScreenSize[pTexture.get()];
+                    screenSize = std::max(screenSize, materialScreenSize[materialID]);
+                }
+            }
+        }
+
+        textureManager.markTexturesUsed(std::vector<std::pair<const Texture*, float>>(textureScreenSize.begin(), textureScreenSize.end()));
+    }
+
     void Scene::updateGeometryInstances(bool forceUpdate)
     {
         if (mGeometryInstanceData.empty()) return;
 
-        bool dataChanged = false;
+        // Track the range of changed instances, only that range is uploaded.
+        size_t firstChanged = std::numeric_limits<size_t>::max();
+        size_t lastChanged = 0;
         const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
-        for (auto& inst : mGeometryInstanceData)
+        for (size_t i = 0; i < mGeometryInstanceData.size(); i++)
         {
+            auto& inst = mGeometryInstanceData[i];
             if (inst.getType() == GeometryType::TriangleMesh || inst.getType() == GeometryType::DisplacedTriangleMesh)
             {
+                // Flags only depend on the transform, skip instances that didn't move.
+                if (!forceUpdate && !mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID })) continue;
+
                 uint32_t prevFlags = inst.flags;
 
                 FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
@@ -930,14 +999,25 @@ namespace Falcor
                 if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
                 else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
 
-                dataChanged |= (inst.flags != prevFlags);
+                if (inst.flags != prevFlags)
+                {
+                    firstChanged = std::min(firstChanged, i);
+                    lastChanged = std::max(lastChanged, i);
+                }
             }
         }
 
-        if (forceUpdate || dataChanged)
+        if (forceUpdate)
         {
-            uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
-            mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
+            firstChanged = 0;
+            lastChanged = mGeometryInstanceData.size() - 1;
+        }
+
+        if (firstChanged <= lastChanged)
+        {
+            size_t byteOffset = firstChanged * sizeof(GeometryInstanceData);
+            size_t byteSize = (lastChanged - firstChanged + 1) * sizeof(GeometryInstanceData);
+            mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data() + firstChanged, byteOffset, byteSize);
         }
     }
 
@@ -1683,6 +1763,8 @@ namespace Falcor
         {
             if (forceUpdate || pGridVolume->getUpdates() != GridVolume::UpdateFlags::None)
             {
+                if (is_set(pGridVolume->getUpdates(), GridVolume::UpdateFlags::GridsChanged)) bindStreamedGrids(volumeIndex);
+
                 // Fetch copy of volume data.
                 auto data = pGridVolume->getData();
                 data.densityGrid = (pGridVolume->getDensityGrid() ? mGridIDs.at(pGridVolume->getDensityGrid()) : SdfGridID::Invalid()).getSlang();
@@ -1722,6 +1804,31 @@ namespace Falcor
         }
     }
 
+    void Scene::bindStreamedGrids(uint32_t volumeIndex)
+    {
+        auto gridsVar = mpSceneBlock->getRootVar()["grids"];
+        for (const auto& streamedGrid : mStreamedGrids)
+        {
+            if (streamedGrid.volumeIndex != volumeIndex) continue;
+
+            // Swap the grid of the current frame into the grid ID reserved for the sequence.
+            // Frames that fail to load keep the last grid that loaded (see GridStreamer), so a missing grid means none has loaded.
+            const auto& pGrid = mGridVolumes[volumeIndex]->getGrid(streamedGrid.slot);
+            auto& pSceneGrid = mGrids[streamedGrid.gridID.get()];
+            if (!pGrid)
+            {
+                logWarning("Grid volume '{}' has no grid loaded for its streamed sequence, keeping the previously bound grid.", mGridVolumes[volumeIndex]->getName());
+                continue;
+            }
+            if (pGrid == pSceneGrid) continue;
+
+            mGridIDs.erase(pSceneGrid);
+            mGridIDs.emplace(pGrid, streamedGrid.gridID);
+            pSceneGrid = pGrid;
+            pSceneGrid->bindShaderData(gridsVar[streamedGrid.gridID.get()]);
+        }
+    }
+
     IScene::UpdateFlags Scene::updateEnvMap(bool forceUpdate)
     {
         IScene::UpdateFlags flags = IScene::UpdateFlags::None;
@@ -1843,6 +1950,7 @@ namespace Falcor
 
         // Perform updates that may affect the scene defines.
         updateGeometryTypes();
+        updateTextureStreaming();
         mUpdates |= updateMaterials(false);
 
         // Update scene defines.
@@ -1899,6 +2007,13 @@ namespace Falcor
         {
             invalidateTlasCache();
             updateGeometryInstances(false);
+
+            // Update the transforms of moved instances every frame, so that the instance descs stay in sync
+            // even if the TLAS isn't rebuilt every frame. The dirty ranges are uploaded on the next TLAS build.
+            if (mInstanceDescsValid)
+            {
+                mInstanceDescs.updateTransforms(mpAnimationController->getGlobalMatrices(), mpAnimationController->getMatricesChanged());
+            }
         }
 
         // Update existing BLASes if skinned animation and/or procedural primitives moved.
@@ -3240,7 +3355,9 @@ namespace Falcor
         if (mRebuildBlas)
         {
             // Invalidate any previous TLASes as they won't be valid anymore.
+            // The instance descs reference the BLASes by address and have to be regenerated as well.
             invalidateTlasCache();
+            mInstanceDescsValid = false;
 
             if (mBlasData.empty())
             {
@@ -3502,7 +3619,7 @@ namespace Falcor
         }
     }
 
-    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const
+    void Scene::fillInstanceDesc(TlasInstanceDescs& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const
     {
         instanceDescs.clear();
         uint32_t instanceContributionToHitGroupIndex = 0;
@@ -3568,11 +3685,12 @@ namespace Falcor
                 instanceID += (uint32_t)meshList.size();
 
                 float4x4 transform4x4 = float4x4::identity();
+                uint32_t matrixId = TlasInstanceDescs::kStaticTransform;
                 if (!isStatic)
                 {
                     // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
                     // Just pick the matrix from the first mesh.
-                    const uint32_t matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
+                    matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
                     transform4x4 = mpAnimationController->getGlobalMatrices()[matrixId];
 
                     // Verify that all meshes have matching tranforms.
@@ -3586,11 +3704,11 @@ namespace Falcor
                 // Verify that instance data has the correct instanceIndex and geometryIndex.
                 for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)meshList.size(); geometryIndex++)
                 {
-                    FALCOR_ASSERT((uint32_t)instanceDescs.size() == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
+                    FALCOR_ASSERT(instanceDescs.getCount() == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
                     FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[desc.instanceID + geometryIndex].geometryIndex);
                 }
 
-                instanceDescs.push_back(desc);
+                instanceDescs.add(desc, matrixId);
             }
         }
 
@@ -3627,11 +3745,11 @@ namespace Falcor
             // Verify that instance data has the correct instanceIndex and geometryIndex.
             for (uint32_t geometryIndex = 0; geometryIndex < (uint32_t)mCurveDesc.size(); geometryIndex++)
             {
-                FALCOR_ASSERT((uint32_t)instanceDescs.size() == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
+                FALCOR_ASSERT(instanceDescs.getCount() == mGeometryInstanceData[desc.instanceID + geometryIndex].instanceIndex);
                 FALCOR_ASSERT(geometryIndex == mGeometryInstanceData[desc.instanceID + geometryIndex].geometryIndex);
             }
 
-            instanceDescs.push_back(desc);
+            instanceDescs.add(desc, matrixId);
         }
 
         // One instance per SDF grid instance.
@@ -3671,10 +3789,10 @@ namespace Falcor
                 desc.setTransform(mpAnimationController->getGlobalMatrices()[instance.globalMatrixID]);
 
                 // Verify that instance data has the correct instanceIndex and geometryIndex.
-                FALCOR_ASSERT((uint32_t)instanceDescs.size() == instance.instanceIndex);
+                FALCOR_ASSERT(instanceDescs.getCount() == instance.instanceIndex);
                 FALCOR_ASSERT(0 == instance.geometryIndex);
 
-                instanceDescs.push_back(desc);
+                instanceDescs.add(desc, instance.globalMatrixID);
             }
 
             blasDataIndex += (sdfGridInstancesHaveUniqueBLASes ? mSDFGrids.size() : 1);
@@ -3701,7 +3819,7 @@ namespace Falcor
 
             float4x4 identityMat = float4x4::identity();
             std::memcpy(desc.transform, &identityMat, sizeof(desc.transform));
-            instanceDescs.push_back(desc);
+            instanceDescs.add(desc);
         }
     }
 
@@ -3723,12 +3841,20 @@ namespace Falcor
         if (it != mTlasCache.end()) tlas = it->second;
 
         // Prepare instance descs.
+        // These are only regenerated when the BLASes or the hit group layout changed. Otherwise, the transforms of
+        // moved instances have been updated in update(), and only the dirty ranges need to be uploaded.
         // Note if there are no instances, we'll build an empty TLAS.
-        fillInstanceDesc(mInstanceDescs, rayTypeCount, perMeshHitEntry);
+        if (!mInstanceDescsValid || mInstanceDescsRayTypeCount != rayTypeCount || mInstanceDescsPerMeshHitEntry != perMeshHitEntry)
+        {
+            fillInstanceDesc(mInstanceDescs, rayTypeCount, perMeshHitEntry);
+            mInstanceDescsValid = true;
+            mInstanceDescsRayTypeCount = rayTypeCount;
+            mInstanceDescsPerMeshHitEntry = perMeshHitEntry;
+        }
 
         RtAccelerationStructureBuildInputs inputs = {};
         inputs.kind = RtAccelerationStructureKind::TopLevel;
-        inputs.descCount = (uint32_t)mInstanceDescs.size();
+        inputs.descCount = mInstanceDescs.getCount();
         inputs.flags = RtAccelerationStructureBuildFlags::None;
 
         // Add build flags for dynamic scenes if TLAS should be updating instead of rebuilt
@@ -3789,10 +3915,23 @@ namespace Falcor
         // Upload instance data
         if (inputs.descCount > 0)
         {
-            GpuMemoryHeap::Allocation allocation = mpDevice->getUploadHeap()->allocate(inputs.descCount * sizeof(RtInstanceDesc), sizeof(RtInstanceDesc));
-            std::memcpy(allocation.pData, mInstanceDescs.data(), inputs.descCount * sizeof(RtInstanceDesc));
-            asDesc.inputs.instanceDescs = allocation.getGpuAddress();
-            mpDevice->getUploadHeap()->release(allocation);
+            const auto& descs = mInstanceDescs.getDescs();
+            size_t byteSize = inputs.descCount * sizeof(RtInstanceDesc);
+            if (!mpTlasInstanceDescs || mpTlasInstanceDescs->getSize() != byteSize)
+            {
+                mpTlasInstanceDescs = mpDevice->createBuffer(byteSize, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, descs.data());
+                mpTlasInstanceDescs->setName("Scene::mpTlasInstanceDescs");
+            }
+            else
+            {
+                for (const auto& range : mInstanceDescs.getDirtyRanges())
+                {
+                    mpTlasInstanceDescs->setBlob(descs.data() + range.offset, range.offset * sizeof(RtInstanceDesc), range.count * sizeof(RtInstanceDesc));
+                }
+            }
+            mInstanceDescs.clearDirty();
+            pRenderContext->resourceBarrier(mpTlasInstanceDescs.get(), Resource::State::NonPixelShader);
+            asDesc.inputs.instanceDescs = mpTlasInstanceDescs->getGpuAddress();
         }
         asDesc.scratchData = mpTlasScratch->getGpuAddress();
         asDesc.dest = tlas.pTlasObject.get();
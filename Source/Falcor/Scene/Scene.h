@@ -30,6 +30,7 @@
 #include "SceneTypes.slang"
 #include "HitInfo.h"
 #include "IScene.h"
+#include "TlasInstanceDescs.h"
 #include "Animation/Animation.h"
 #include "Animation/AnimationController.h"
 #include "Displacement/DisplacementUpdateTask.slang"
@@ -1133,6 +1134,10 @@ namespace Falcor
         */
         void updateBounds();
 
+        /** Mark the textures of visible materials as used by texture streaming, wanting mips that match their screen size.
+        */
+        void updateTextureStreaming();
+
         /** Update geometry instances.
         */
         void updateGeometryInstances(bool forceUpdate);
@@ -1168,7 +1173,7 @@ namespace Falcor
         /** Generate data for creating a TLAS.
             #SCENE TODO: Add argument to build descs based off a draw list.
         */
-        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+        void fillInstanceDesc(TlasInstanceDescs& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
 
         /** Generate top level acceleration structure for the scene. Automatically determines whether to build or refit.
             \param[in] rayCount Number of ray types in the shader. Required to setup how instances index into the Shader Table.
@@ -1216,6 +1221,7 @@ namespace Falcor
         void bindGeometry();
         void bindProceduralPrimitives();
         void bindGridVolumes();
+        void bindStreamedGrids(uint32_t volumeIndex);
         void bindSDFGrids();
         void bindLights();
         void bindSelectedCamera();
@@ -1303,6 +1309,14 @@ namespace Falcor
         std::vector<ref<GridVolume>> mGridVolumes;                  ///< All loaded grid volumes.
         std::vector<ref<Grid>> mGrids;                              ///< All loaded grids.
         std::unordered_map<ref<Grid>, SdfGridID> mGridIDs;          ///< Lookup table for grid IDs.
+
+        struct StreamedGrid
+        {
+            uint32_t volumeIndex;
+            GridVolume::GridSlot slot;
+            SdfGridID gridID;                                       ///< Grid ID whose grid is replaced as the streamed sequence plays back.
+        };
+        std::vector<StreamedGrid> mStreamedGrids;                   ///< Grid slots of volumes that stream their grid sequence.
         ref<LightCollection> mpLightCollection;                     ///< Class for managing emissive geometry. This is created lazily upon first use.
         ref<EnvMap> mpEnvMap;                                       ///< Environment map or nullptr if not loaded.
         bool mEnvMapChanged = false;                                ///< Flag indicating that the environment map has changed since last frame.
@@ -1365,7 +1379,11 @@ namespace Falcor
         UpdateMode mTlasUpdateMode = UpdateMode::Rebuild;   ///< How the TLAS should be updated when there are changes in the scene.
         UpdateMode mBlasUpdateMode = UpdateMode::Refit;     ///< How the BLAS should be updated when there are changes to meshes.
 
-        std::vector<RtInstanceDesc> mInstanceDescs;         ///< Shared between TLAS builds to avoid reallocating CPU memory.
+        TlasInstanceDescs mInstanceDescs;                   ///< Persistent instance descs, shared between TLAS builds. Transforms are updated incrementally.
+        bool mInstanceDescsValid = false;                   ///< True if mInstanceDescs has been filled for the current BLASes.
+        uint32_t mInstanceDescsRayTypeCount = 0;            ///< Ray type count mInstanceDescs has been filled for.
+        bool mInstanceDescsPerMeshHitEntry = false;         ///< Hit entry mode mInstanceDescs has been filled for.
+        ref<Buffer> mpTlasInstanceDescs;                    ///< GPU copy of mInstanceDescs. Only dirty ranges are uploaded.
 
         struct TlasData
         {
@@ -28,20 +28,30 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Image/TextureCookCache.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/TaskManager.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/ObjectIDPython.h"
 #include "Utils/NumericRange.h"
 #include <mikktspace.h>
+#include <algorithm>
+#include <array>
 #include <filesystem>
+#include <limits>
 #include <cmath>
+#include <cstring>
 #include <execution>
+#include <thread>
 
 namespace Falcor
 {
@@ -55,6 +65,13 @@ namespace Falcor
         // We'll log a warning if the maximum quantization error exceeds this value.
         const float kMaxTexelError = 0.5f;
 
+        // Default texture cook cache directory, relative to the app data directory.
+        const char kTextureCookCacheDirectory[] = "NVIDIA/Falcor/TextureCache";
+
+        // Default tolerances for vertex welding (see Flags::WeldVertices).
+        const float kDefaultWeldPositionTolerance = 0.f;
+        const float kDefaultWeldAttributeTolerance = 1e-6f;
+
         int largestAxis(const float3& v)
         {
             if (v.x >= v.y && v.x >= v.z) return 0;
@@ -164,11 +181,20 @@ namespace Falcor
             if (isZero(v.normal) || isZero(v.tangent.xyz())) zeroCount++;
         }
 
-        bool compareVertices(const SceneBuilder::Mesh::Vertex& lhs, const SceneBuilder::Mesh::Vertex& rhs, float threshold = 1e-6f)
+        bool compareVertices(const SceneBuilder::Mesh::Vertex& lhs, const SceneBuilder::Mesh::Vertex& rhs, float threshold = 1e-6f, float positionThreshold = 0.f)
         {
-            if (any(lhs.position != rhs.position)) return false; // Position need to be exact to avoid cracks
+            // Position need to be exact to avoid cracks, unless welding with a position tolerance.
+            if (positionThreshold > 0.f)
+            {
+                if (any(abs(lhs.position - rhs.position) > float3(positionThreshold))) return false;
+                if (std::abs(lhs.curveRadius - rhs.curveRadius) > positionThreshold) return false;
+            }
+            else
+            {
+                if (any(lhs.position != rhs.position)) return false;
+                if (lhs.curveRadius != rhs.curveRadius) return false;
+            }
             if (lhs.tangent.w != rhs.tangent.w) return false;
-            if (lhs.curveRadius != rhs.curveRadius) return false;
             if (any(lhs.boneIDs != rhs.boneIDs)) return false;
             if (any(abs(lhs.normal - rhs.normal) > float3(threshold))) return false;
             if (any(abs(lhs.tangent.xyz() - rhs.tangent.xyz()) > float3(threshold))) return false;
@@ -177,6 +203,124 @@ namespace Falcor
             return true;
         }
 
+        /** Cell of a position grid used for hash-based vertex welding.
+            With a tolerance of zero, each distinct position is its own cell. Otherwise the cell size is the tolerance,
+            so vertices within the tolerance of each other are in the same or in adjacent cells.
+        */
+        struct WeldCell
+        {
+            std::array<int64_t, 3> coords;
+
+            WeldCell(const float3& position, float tolerance)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    if (tolerance > 0.f)
+                    {
+                        coords[c] = (int64_t)std::clamp(std::floor((double)position[c] / tolerance), -9e18, 9e18);
+                    }
+                    else
+                    {
+                        float value = position[c] == 0.f ? 0.f : position[c]; // Map negative zero to zero.
+                        uint32_t bits;
+                        std::memcpy(&bits, &value, sizeof(bits));
+                        coords[c] = bits;
+                    }
+                }
+            }
+
+            WeldCell offset(int dx, int dy, int dz) const
+            {
+                WeldCell cell = *this;
+                cell.coords[0] += dx;
+                cell.coords[1] += dy;
+                cell.coords[2] += dz;
+                return cell;
+            }
+
+            bool operator==(const WeldCell& other) const { return coords == other.coords; }
+
+            uint64_t hash() const
+            {
+                uint64_t h = 0;
+                for (int64_t c : coords)
+                {
+                    h = (h ^ (uint64_t)c) * 0x9e3779b97f4a7c15ull;
+                    h ^= h >> 29;
+                }
+                return h;
+            }
+        };
+
+        /** Open-addressing hash table mapping position cells to the first vertex of the cell.
+            The vertices of a cell are chained through next-indices stored by the caller.
+            Uses linear probing and a load factor of at most 0.5. Each slot stores the upper hash bits
+            alongside the cell index so most mismatches are rejected without comparing full cells.
+        */
+        class VertexWeldTable
+        {
+        public:
+            static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+            VertexWeldTable(size_t maxCellCount)
+            {
+                size_t capacity = 16;
+                while (capacity < 2 * maxCellCount) capacity *= 2;
+                mSlots.resize(capacity, { 0, kInvalidIndex });
+                mCells.reserve(maxCellCount);
+                mHeads.reserve(maxCellCount);
+            }
+
+            /** Get the first vertex of a cell, or kInvalidIndex if the cell is empty.
+            */
+            uint32_t getHead(const WeldCell& cell) const
+            {
+                size_t slot = findSlot(cell);
+                uint32_t cellIndex = mSlots[slot].second;
+                return cellIndex == kInvalidIndex ? kInvalidIndex : mHeads[cellIndex];
+            }
+
+            /** Set the first vertex of a cell.
+            */
+            void setHead(const WeldCell& cell, uint32_t vertexIndex)
+            {
+                size_t slot = findSlot(cell);
+                auto& [slotTag, cellIndex] = mSlots[slot];
+                if (cellIndex == kInvalidIndex)
+                {
+                    FALCOR_ASSERT(mCells.size() < kInvalidIndex);
+                    slotTag = uint32_t(cell.hash() >> 32);
+                    cellIndex = (uint32_t)mCells.size();
+                    mCells.push_back(cell);
+                    mHeads.push_back(vertexIndex);
+                }
+                else
+                {
+                    mHeads[cellIndex] = vertexIndex;
+                }
+            }
+
+        private:
+            /** Find the slot holding the cell, or the empty slot where it would be inserted.
+            */
+            size_t findSlot(const WeldCell& cell) const
+            {
+                const uint64_t h = cell.hash();
+                const uint32_t tag = uint32_t(h >> 32);
+                const size_t mask = mSlots.size() - 1;
+
+                for (size_t slot = h & mask;; slot = (slot + 1) & mask)
+                {
+                    const auto& [slotTag, cellIndex] = mSlots[slot];
+                    if (cellIndex == kInvalidIndex || (slotTag == tag && mCells[cellIndex] == cell)) return slot;
+                }
+            }
+
+            std::vector<std::pair<uint32_t, uint32_t>> mSlots; ///< Pairs of hash tag and cell index.
+            std::vector<WeldCell> mCells;
+            std::vector<uint32_t> mHeads;                      ///< First vertex of each cell.
+        };
+
         std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
         {
             if (indices.empty()) return {};
@@ -191,13 +335,23 @@ namespace Falcor
             return indexData;
         }
 
-        SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
+        SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags, const Settings& settings)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            // Texture cooking doesn't affect the scene representation.
+            SceneBuilder::Flags cacheFlags =
+                buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::CookTextures));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
             sha1.update(&cacheFlags, sizeof(cacheFlags));
+            if (is_set(buildFlags, SceneBuilder::Flags::WeldVertices))
+            {
+                const float tolerances[2] = {
+                    settings.getOption("weldVertices:positionTolerance", kDefaultWeldPositionTolerance),
+                    settings.getOption("weldVertices:attributeTolerance", kDefaultWeldAttributeTolerance),
+                };
+                sha1.update(tolerances, sizeof(tolerances));
+            }
             return sha1.finalize();
 
         }
@@ -209,7 +363,34 @@ namespace Falcor
         , mFlags(flags)
     {
         mAssetResolver = AssetResolver::getDefaultResolver();
+        mAssetResolver.setResolveCallback(
+            [wpDependencies = std::weak_ptr<DependencySet>(mpDependencies)](const std::filesystem::path& path)
+            {
+                if (auto pDependencies = wpDependencies.lock()) pDependencies->add(path);
+            }
+        );
         mSceneData.pMaterials = std::make_unique<MaterialSystem>(mpDevice);
+
+        if (is_set(mFlags, Flags::CookTextures))
+        {
+            std::filesystem::path cacheDirectory =
+                mSettings.getOption<std::string>("textureCookCache:path", (getAppDataDirectory() / kTextureCookCacheDirectory).string());
+            mSceneData.pMaterials->getTextureManager().setCookCache(std::make_shared<TextureCookCache>(cacheDirectory));
+        }
+
+        if (is_set(mFlags, Flags::StreamTextures))
+        {
+            TextureManager::StreamingOptions options;
+            options.enabled = true;
+            uint32_t budgetMB = mSettings.getOption<uint32_t>("textureStreaming:budgetMB", uint32_t(options.budgetInBytes >> 20));
+            options.budgetInBytes = uint64_t(budgetMB) << 20;
+            options.tailSize = mSettings.getOption<uint32_t>("textureStreaming:tailSize", options.tailSize);
+            options.screenHeight = mSettings.getOption<uint32_t>("textureStreaming:screenHeight", options.screenHeight);
+            mSceneData.pMaterials->getTextureManager().setStreamingOptions(options);
+        }
+
+        if (is_set(mFlags, Flags::DeduplicateTextures))
+            mSceneData.pMaterials->getTextureManager().setDeduplicationEnabled(true);
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings, Flags flags)
@@ -222,7 +403,7 @@ namespace Falcor
         }
 
         // Compute scene cache key based on absolute scene path and build flags.
-        mSceneCacheKey = computeSceneCacheKey(resolvedPath, flags);
+        mSceneCacheKey = computeSceneCacheKey(resolvedPath, flags, mSettings);
 
         // Determine if scene cache should be written after import.
         bool useCache = is_set(flags, Flags::UseCache);
@@ -323,11 +504,33 @@ namespace Falcor
         mAssetResolverStack.pop_back();
     }
 
+    void SceneBuilder::addDependency(const std::filesystem::path& path)
+    {
+        mpDependencies->add(path);
+    }
+
+    void SceneBuilder::DependencySet::add(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec)) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        paths.insert(std::filesystem::absolute(path).lexically_normal());
+    }
+
     ref<Scene> SceneBuilder::getScene()
     {
         if (mpScene) return mpScene;
 
+        // Finish processing meshes that were added asynchronously.
+        waitForMeshes();
+
+        if (auto stats = getVertexMergeStats(); stats.meshCount > 0)
+        {
+            logInfo("Merged vertices in {} meshes: removed {} of {} vertices in {:.3f} s.", stats.meshCount, stats.getRemovedVertexCount(), stats.inputVertexCount, stats.mergeTime);
+        }
+
         // Finish loading textures. This blocks until all textures are loaded and assigned.
+        prioritizeVisibleTextures();
         mpMaterialTextureLoader.reset();
 
         // If no meshes were added, we create a dummy mesh to keep the scene generation working.
@@ -394,8 +597,25 @@ namespace Falcor
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
-            timeReport.measure("Writing cache");
+            bool hashDependencies = mSettings.getOption("sceneCache:hashDependencies", false);
+            SceneCache::DependencyList dependencies;
+            try
+            {
+                for (const auto& path : mpDependencies->paths)
+                    dependencies.push_back(SceneCache::Dependency::create(path, hashDependencies));
+            }
+            catch (const std::exception& e)
+            {
+                // A dependency may have been removed during the import. A cache without it could not be validated, so skip writing it.
+                logWarning("Skipping scene cache write, failed to record scene dependencies: {}", e.what());
+                mWriteSceneCache = false;
+            }
+
+            if (mWriteSceneCache)
+            {
+                SceneCache::writeCache(mSceneData, mSceneCacheKey, dependencies);
+                timeReport.measure("Writing cache");
+            }
         }
 
         // Create the scene object.
@@ -416,37 +636,114 @@ namespace Falcor
     }
 
     MeshID SceneBuilder::addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated)
+    {
+        return addProcessedMesh(processTriangleMesh(pTriangleMesh, pMaterial, isAnimated));
+    }
+
+    MeshID SceneBuilder::addMeshAsync(const Mesh& mesh)
+    {
+        // The mesh description only holds pointers to the caller's data, so it can be copied cheaply.
+        return addMeshAsync(mesh.pMaterial, [mesh](const SceneBuilder& builder) { return builder.processMesh(mesh); });
+    }
+
+    MeshID SceneBuilder::addTriangleMeshAsync(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated)
     {
         FALCOR_CHECK(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
 
-        Mesh mesh;
+        return addMeshAsync(pMaterial, [pTriangleMesh, pMaterial, isAnimated](const SceneBuilder& builder)
+        {
+            return builder.processTriangleMesh(pTriangleMesh, pMaterial, isAnimated);
+        });
+    }
 
-        const auto& indices = pTriangleMesh->getIndices();
-        const auto& vertices = pTriangleMesh->getVertices();
+    MeshID SceneBuilder::addMeshAsync(const ref<Material>& pMaterial, MeshTask task)
+    {
+        FALCOR_CHECK(task, "'task' is missing");
 
-        mesh.name = pTriangleMesh->getName();
-        mesh.faceCount = (uint32_t)(indices.size() / 3);
-        mesh.vertexCount = (uint32_t)vertices.size();
-        mesh.indexCount = (uint32_t)indices.size();
-        mesh.pIndices = indices.data();
-        mesh.topology = Vao::Topology::TriangleList;
-        mesh.isFrontFaceCW = pTriangleMesh->getFrontFaceCW();
-        mesh.pMaterial = pMaterial;
-        mesh.isAnimated = isAnimated;
+        // Reserve the mesh ID and material ID on the calling thread so that IDs don't depend on task scheduling.
+        MeshID meshID = reserveMesh(pMaterial);
 
-        std::vector<float3> positions(vertices.size());
-        std::vector<float3> normals(vertices.size());
-        std::vector<float2> texCoords(vertices.size());
-        std::transform(vertices.begin(), vertices.end(), positions.begin(), [] (const auto& v) { return v.position; });
-        std::transform(vertices.begin(), vertices.end(), normals.begin(), [] (const auto& v) { return v.normal; });
-        std::transform(vertices.begin(), vertices.end(), texCoords.begin(), [] (const auto& v) { return v.texCoord; });
+        mPendingMeshes.push_back(std::make_unique<PendingMesh>());
+        PendingMesh* pPending = mPendingMeshes.back().get();
+        pPending->meshID = meshID;
 
-        mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
-        mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
-        mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+        getTaskManager().addTask([this, pPending, task = std::move(task)]()
+        {
+            pPending->mesh = task(*this);
+        });
 
-        return addMesh(mesh);
+        return meshID;
+    }
+
+    std::vector<MeshID> SceneBuilder::addMeshes(const std::vector<Mesh>& meshes)
+    {
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(meshes.size());
+        for (const auto& mesh : meshes) meshIDs.push_back(addMeshAsync(mesh));
+        waitForMeshes();
+        return meshIDs;
+    }
+
+    void SceneBuilder::waitForMeshes()
+    {
+        if (mPendingMeshes.empty()) return;
+
+        // Take the pending meshes before waiting, so a mesh task exception doesn't leave them to be stored by a later call.
+        auto pendingMeshes = std::move(mPendingMeshes);
+        mPendingMeshes.clear();
+        try
+        {
+            getTaskManager().finish(nullptr);
+        }
+        catch (...)
+        {
+            // Detach the meshes of the failed batch from the scene graph, so getScene() removes them as unused.
+            for (const auto& pPending : pendingMeshes)
+            {
+                auto& spec = mMeshes[pPending->meshID.get()];
+                for (NodeID nodeID : spec.instances)
+                {
+                    auto& nodeMeshes = mSceneGraph[nodeID.get()].meshes;
+                    nodeMeshes.erase(std::remove(nodeMeshes.begin(), nodeMeshes.end(), pPending->meshID), nodeMeshes.end());
+                }
+                spec.instances.clear();
+                spec.isDiscarded = true;
+            }
+            throw;
+        }
+
+        // Store the meshes in ID order.
+        for (auto& pPending : pendingMeshes) setMeshData(pPending->meshID, std::move(pPending->mesh));
+    }
+
+    SceneBuilder::VertexMergeStats SceneBuilder::getVertexMergeStats() const
+    {
+        VertexMergeStats stats;
+        stats.meshCount = mMergeStats.meshCount;
+        stats.inputVertexCount = mMergeStats.inputVertexCount;
+        stats.outputVertexCount = mMergeStats.outputVertexCount;
+        stats.mergeTime = mMergeStats.timeInNanoseconds * 1e-9;
+        return stats;
+    }
+
+    void SceneBuilder::parallelFor(size_t count, const std::function<void(size_t)>& func)
+    {
+        if (count == 0) return;
+
+        // Spawn one worker per thread that pulls indices from a shared counter.
+        // A separate task manager is used, so this doesn't wait for (or rethrow from) pending mesh tasks.
+        std::atomic<size_t> nextIndex{0};
+        size_t workerCount = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+        TaskManager taskManager(false, 0, mpDevice->getProfiler());
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            taskManager.addTask([&nextIndex, &func, count]()
+            {
+                for (size_t index = nextIndex++; index < count; index = nextIndex++) func(index);
+            });
+        }
+        taskManager.finish(nullptr);
     }
 
     SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices, std::vector<float4>* pTangents) const
@@ -553,7 +850,68 @@ namespace Falcor
             pAttributeIndices->reserve(mesh.vertexCount);
         }
 
-        if (mesh.mergeDuplicateVertices)
+        const auto mergeStartTime = CpuTimer::getCurrentTimePoint();
+
+        // Global welding is skipped for animated meshes and for meshes whose attribute indices are requested, as those are
+        // used to remap vertex animation keyframes (e.g. USD time samples). Vertices that only coincide in the first frame
+        // must stay separate, which the default path ensures by only merging vertices sharing a position index.
+        const bool weldVertices = is_set(mFlags, Flags::WeldVertices) && !mesh.isAnimated && !pAttributeIndices;
+
+        if (mesh.mergeDuplicateVertices && weldVertices)
+        {
+            // Weld vertices globally by looking up the vertices in the same and adjacent position cells in a hash table.
+            // Unlike the default path below, this also merges vertices that don't share an original position index,
+            // e.g. meshes with face-varying positions or duplicated positions.
+            // The vertices of each cell are chained through the next-indices stored with the vertices, like in the default path.
+            const float positionTolerance = mSettings.getOption("weldVertices:positionTolerance", kDefaultWeldPositionTolerance);
+            const float attributeTolerance = mSettings.getOption("weldVertices:attributeTolerance", kDefaultWeldAttributeTolerance);
+            const int neighbourRange = positionTolerance > 0.f ? 1 : 0;
+
+            vertices.reserve(mesh.vertexCount);
+            VertexWeldTable table(mesh.indexCount);
+
+            for (uint32_t face = 0; face < mesh.faceCount; face++)
+            {
+                for (uint32_t vert = 0; vert < 3; vert++)
+                {
+                    const Mesh::Vertex v = mesh.getVertex(face, vert);
+                    const WeldCell cell(v.position, positionTolerance);
+
+                    auto findInCell = [&](const WeldCell& c)
+                    {
+                        for (uint32_t j = table.getHead(c); j != invalidIndex; j = vertices[j].second)
+                        {
+                            if (compareVertices(v, vertices[j].first, attributeTolerance, positionTolerance)) return j;
+                        }
+                        return invalidIndex;
+                    };
+
+                    // Search the vertex's own cell first, then the adjacent cells.
+                    uint32_t index = findInCell(cell);
+                    for (int dz = -neighbourRange; dz <= neighbourRange && index == invalidIndex; dz++)
+                    {
+                        for (int dy = -neighbourRange; dy <= neighbourRange && index == invalidIndex; dy++)
+                        {
+                            for (int dx = -neighbourRange; dx <= neighbourRange && index == invalidIndex; dx++)
+                            {
+                                if (dx != 0 || dy != 0 || dz != 0) index = findInCell(cell.offset(dx, dy, dz));
+                            }
+                        }
+                    }
+
+                    if (index == invalidIndex)
+                    {
+                        FALCOR_ASSERT(vertices.size() < std::numeric_limits<uint32_t>::max());
+                        index = (uint32_t)vertices.size();
+                        vertices.push_back({ v, table.getHead(cell) });
+                        table.setHead(cell, index);
+                    }
+
+                    indices[face * 3 + vert] = index;
+                }
+            }
+        }
+        else if (mesh.mergeDuplicateVertices)
         {
             vertices.reserve(mesh.vertexCount);
 
@@ -631,6 +989,15 @@ namespace Falcor
             indices.assign(mesh.pIndices, mesh.pIndices + mesh.indexCount);
         }
 
+        if (mesh.mergeDuplicateVertices)
+        {
+            double mergeTime = CpuTimer::calcDuration(mergeStartTime, CpuTimer::getCurrentTimePoint());
+            mMergeStats.meshCount++;
+            mMergeStats.inputVertexCount += mesh.indexCount;
+            mMergeStats.outputVertexCount += vertices.size();
+            mMergeStats.timeInNanoseconds += uint64_t(mergeTime * 1e6);
+        }
+
         FALCOR_ASSERT(vertices.size() > 0);
         FALCOR_ASSERT(indices.size() == mesh.indexCount);
         if (vertices.size() != mesh.vertexCount)
@@ -733,47 +1100,9 @@ namespace Falcor
 
     MeshID SceneBuilder::addProcessedMesh(const ProcessedMesh& mesh)
     {
-        const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
-
-        MeshSpec spec;
-
-        // Add the mesh to the scene.
-        spec.name = mesh.name;
-        spec.topology = mesh.topology;
-        spec.materialId = addMaterial(mesh.pMaterial);
-        spec.isFrontFaceCW = mesh.isFrontFaceCW;
-        spec.isAnimated = mesh.isAnimated;
-        spec.skeletonNodeID = mesh.skeletonNodeId;
-
-        spec.vertexCount = (uint32_t)mesh.staticData.size();
-        spec.staticVertexCount = (uint32_t)mesh.staticData.size();
-        spec.skinningVertexCount = (uint32_t)mesh.skinningData.size();
-
-        spec.indexData = std::move(mesh.indexData);
-        spec.staticData = std::move(mesh.staticData);
-        spec.skinningData = std::move(mesh.skinningData);
-
-        if (isIndexed)
-        {
-            spec.indexCount = (uint32_t)mesh.indexCount;
-            spec.use16BitIndices = mesh.use16BitIndices;
-        }
-
-        if (!spec.skinningData.empty())
-        {
-            FALCOR_ASSERT(spec.skinningVertexCount > 0);
-            spec.hasSkinningData = true;
-            spec.prevVertexCount = spec.skinningVertexCount;
-        }
-
-        mMeshes.push_back(spec);
-
-        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
-        {
-            FALCOR_THROW("Trying to build a scene that exceeds supported number of meshes");
-        }
-
-        return MeshID(mMeshes.size() - 1);
+        MeshID meshID = reserveMesh(mesh.pMaterial);
+        setMeshData(meshID, ProcessedMesh(mesh));
+        return meshID;
     }
 
     void SceneBuilder::addCachedMeshes(std::vector<CachedMesh>&& cachedMeshes)
@@ -937,7 +1266,7 @@ namespace Falcor
         mSceneData.pMaterials->replaceMaterial(pMaterial, pReplacement);
     }
 
-    void SceneBuilder::loadMaterialTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path)
+    void SceneBuilder::loadMaterialTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool loadAsSrgb)
     {
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
         if (!mpMaterialTextureLoader)
@@ -945,7 +1274,7 @@ namespace Falcor
             mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
         }
         std::filesystem::path resolvedPath = mAssetResolver.resolvePath(path);
-        mpMaterialTextureLoader->loadTexture(pMaterial, slot, resolvedPath);
+        mpMaterialTextureLoader->loadTexture(pMaterial, slot, resolvedPath, loadAsSrgb);
     }
 
     void SceneBuilder::waitForMaterialTextureLoading()
@@ -1095,6 +1424,7 @@ namespace Falcor
     {
         FALCOR_CHECK(nodeID.get() < mSceneGraph.size(), "'nodeID' ({}) is out of range", nodeID);
         FALCOR_CHECK(meshID.get() < mMeshes.size(), "'meshID' ({}) is out of range", meshID);
+        FALCOR_CHECK(!mMeshes[meshID.get()].isDiscarded, "'meshID' ({}) failed to load", meshID);
 
         mSceneGraph[nodeID.get()].meshes.push_back(meshID);
         mMeshes[meshID.get()].instances.insert(nodeID);
@@ -1128,6 +1458,95 @@ namespace Falcor
         mSceneData.sdfGridInstances.push_back(instance);
     }
 
+    TaskManager& SceneBuilder::getTaskManager()
+    {
+        if (!mpTaskManager) mpTaskManager = std::make_unique<TaskManager>(false, 0, mpDevice->getProfiler());
+        return *mpTaskManager;
+    }
+
+    MeshID SceneBuilder::reserveMesh(const ref<Material>& pMaterial)
+    {
+        MeshSpec spec;
+        spec.materialId = addMaterial(pMaterial);
+        mMeshes.push_back(spec);
+
+        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
+        {
+            FALCOR_THROW("Trying to build a scene that exceeds supported number of meshes");
+        }
+
+        return MeshID(mMeshes.size() - 1);
+    }
+
+    void SceneBuilder::setMeshData(MeshID meshID, ProcessedMesh&& mesh)
+    {
+        const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
+
+        // Note: The spec was created by reserveMesh() and may already have instances and a material assigned.
+        MeshSpec& spec = mMeshes[meshID.get()];
+
+        spec.name = mesh.name;
+        spec.topology = mesh.topology;
+        spec.isFrontFaceCW = mesh.isFrontFaceCW;
+        spec.isAnimated = mesh.isAnimated;
+        spec.skeletonNodeID = mesh.skeletonNodeId;
+
+        spec.vertexCount = (uint32_t)mesh.staticData.size();
+        spec.staticVertexCount = (uint32_t)mesh.staticData.size();
+        spec.skinningVertexCount = (uint32_t)mesh.skinningData.size();
+
+        spec.indexData = std::move(mesh.indexData);
+        spec.staticData = std::move(mesh.staticData);
+        spec.skinningData = std::move(mesh.skinningData);
+
+        if (isIndexed)
+        {
+            spec.indexCount = (uint32_t)mesh.indexCount;
+            spec.use16BitIndices = mesh.use16BitIndices;
+        }
+
+        if (!spec.skinningData.empty())
+        {
+            FALCOR_ASSERT(spec.skinningVertexCount > 0);
+            spec.hasSkinningData = true;
+            spec.prevVertexCount = spec.skinningVertexCount;
+        }
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated) const
+    {
+        FALCOR_CHECK(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
+        FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
+
+        Mesh mesh;
+
+        const auto& indices = pTriangleMesh->getIndices();
+        const auto& vertices = pTriangleMesh->getVertices();
+
+        mesh.name = pTriangleMesh->getName();
+        mesh.faceCount = (uint32_t)(indices.size() / 3);
+        mesh.vertexCount = (uint32_t)vertices.size();
+        mesh.indexCount = (uint32_t)indices.size();
+        mesh.pIndices = indices.data();
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.isFrontFaceCW = pTriangleMesh->getFrontFaceCW();
+        mesh.pMaterial = pMaterial;
+        mesh.isAnimated = isAnimated;
+
+        std::vector<float3> positions(vertices.size());
+        std::vector<float3> normals(vertices.size());
+        std::vector<float2> texCoords(vertices.size());
+        std::transform(vertices.begin(), vertices.end(), positions.begin(), [] (const auto& v) { return v.position; });
+        std::transform(vertices.begin(), vertices.end(), normals.begin(), [] (const auto& v) { return v.normal; });
+        std::transform(vertices.begin(), vertices.end(), texCoords.begin(), [] (const auto& v) { return v.texCoord; });
+
+        mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+        mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+        mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+
+        return processMesh(mesh);
+    }
+
     bool SceneBuilder::doesNodeHaveAnimation(NodeID nodeID) const
     {
         FALCOR_ASSERT(nodeID != NodeID::Invalid() && nodeID.get() < mSceneGraph.size());
@@ -1322,6 +1741,41 @@ namespace Falcor
         return true;
     }
 
+    void SceneBuilder::prioritizeVisibleTextures()
+    {
+        ref<Camera> pCamera = getSelectedCamera();
+        if (!mpMaterialTextureLoader || !pCamera) return;
+
+        // Compute the world transforms of all nodes. Parents are always added before their children.
+        std::vector<float4x4> worldTransforms(mSceneGraph.size());
+        for (size_t i = 0; i < mSceneGraph.size(); i++)
+        {
+            const auto& node = mSceneGraph[i];
+            worldTransforms[i] = node.parent.isValid() ? mul(worldTransforms[node.parent.get()], node.transform) : node.transform;
+        }
+
+        // Find the materials of mesh instances in the view frustum of the selected camera.
+        std::set<const Material*> visibleMaterials;
+        for (const auto& mesh : mMeshes)
+        {
+            AABB meshBB;
+            for (const auto& v : mesh.staticData) meshBB.include(v.position);
+            if (!meshBB.valid()) continue;
+
+            for (NodeID nodeID : mesh.instances)
+            {
+                if (!pCamera->isObjectCulled(meshBB.transform(worldTransforms[nodeID.get()])))
+                {
+                    visibleMaterials.insert(mSceneData.pMaterials->getMaterial(mesh.materialId).get());
+                    break;
+                }
+            }
+        }
+
+        // Load the textures of visible materials first.
+        mpMaterialTextureLoader->setMaterialPriority(visibleMaterials, 1);
+    }
+
     void SceneBuilder::prepareDisplacementMaps()
     {
         for (const auto& pMaterial : mSceneData.pMaterials->getMaterials())
@@ -2541,6 +2995,9 @@ namespace Falcor
 
         if (is_set(mFlags, Flags::DontOptimizeMaterials)) return;
 
+        // Streamed textures are only resident at their tail mips at this point, which are not representative of the full texture.
+        if (is_set(mFlags, Flags::StreamTextures)) return;
+
         mSceneData.pMaterials->optimizeMaterials();
     }
 
@@ -2962,6 +3419,10 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("WeldVertices", SceneBuilder::Flags::WeldVertices);
+        flags.value("CookTextures", SceneBuilder::Flags::CookTextures);
+        flags.value("StreamTextures", SceneBuilder::Flags::StreamTextures);
+        flags.value("DeduplicateTextures", SceneBuilder::Flags::DeduplicateTextures);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -2980,11 +3441,13 @@ namespace Falcor
         sceneBuilder.def_property("cameraSpeed", &SceneBuilder::getCameraSpeed, &SceneBuilder::setCameraSpeed);
         sceneBuilder.def("importScene", &SceneBuilder::import, "path"_a, "dict"_a = pybind11::dict());
         sceneBuilder.def("addTriangleMesh", &SceneBuilder::addTriangleMesh, "triangleMesh"_a, "material"_a, "isAnimated"_a = false);
+        sceneBuilder.def("addTriangleMeshAsync", &SceneBuilder::addTriangleMeshAsync, "triangleMesh"_a, "material"_a, "isAnimated"_a = false);
+        sceneBuilder.def("waitForMeshes", &SceneBuilder::waitForMeshes);
         sceneBuilder.def("addSDFGrid", &SceneBuilder::addSDFGrid, "sdfGrid"_a, "material"_a);
         sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
         sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
         sceneBuilder.def("getMaterial", &SceneBuilder::getMaterial, "name"_a);
-        sceneBuilder.def("loadMaterialTexture", &SceneBuilder::loadMaterialTexture, "material"_a, "slot"_a, "path"_a);
+        sceneBuilder.def("loadMaterialTexture", &SceneBuilder::loadMaterialTexture, "material"_a, "slot"_a, "path"_a, "loadAsSrgb"_a = true);
         sceneBuilder.def("waitForMaterialTextureLoading", &SceneBuilder::waitForMaterialTextureLoading);
         sceneBuilder.def("addGridVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID);
         sceneBuilder.def("addVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID); // PYTHONDEPRECATED
@@ -3010,5 +3473,6 @@ namespace Falcor
 
         sceneBuilder.def("getSettings", static_cast<Settings&(SceneBuilder::*)()>(&SceneBuilder::getSettings), pybind11::return_value_policy::reference);
         sceneBuilder.def_property_readonly("assetResolver", pybind11::overload_cast<>(&SceneBuilder::getAssetResolver), pybind11::return_value_policy::reference);
+        sceneBuilder.def("addDependency", &SceneBuilder::addDependency, "path"_a);
     }
 }
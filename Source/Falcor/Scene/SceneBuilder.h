@@ -45,13 +45,19 @@
 
 #include <pybind11/pytypes.h>
 
+#include <atomic>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
 namespace Falcor
 {
+    class TaskManager;
+
     class FALCOR_API SceneBuilder
     {
     public:
@@ -77,6 +83,10 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            WeldVertices                    = 0x20000,  ///< Merge duplicate vertices globally using a quantized vertex hash, instead of only merging vertices that share a position index. Animated meshes and meshes with vertex animation keyframes use the default merging. Tolerances are set with the 'weldVertices:positionTolerance' and 'weldVertices:attributeTolerance' options.
+            CookTextures                    = 0x40000,  ///< Load material textures from BC-compressed, pre-mipped DDS files in the texture cook cache, and cook textures that are not yet cached in the background. The cache directory is set with the 'textureCookCache:path' option.
+            StreamTextures                  = 0x80000,  ///< Stream mips of material textures within a memory budget. Textures are initially resident at a small tail mip. The budget is set with the 'textureStreaming:budgetMB' option and the tail size with 'textureStreaming:tailSize'. Disables material optimization.
+            DeduplicateTextures             = 0x100000, ///< Alias material textures with byte-identical source files or identical decoded images to a single texture.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -327,6 +337,18 @@ namespace Falcor
             NodeID parent{ NodeID::Invalid() };
         };
 
+        /** Statistics for merging of duplicate vertices in processMesh().
+        */
+        struct VertexMergeStats
+        {
+            uint64_t meshCount = 0;             ///< Number of meshes processed with vertex merging enabled.
+            uint64_t inputVertexCount = 0;      ///< Number of input vertices, counted per triangle corner.
+            uint64_t outputVertexCount = 0;     ///< Number of vertices after merging.
+            double mergeTime = 0.0;             ///< Time spent merging vertices in seconds, accumulated over all threads.
+
+            uint64_t getRemovedVertexCount() const { return inputVertexCount - outputVertexCount; }
+        };
+
         /** Constructor.
         */
         SceneBuilder(ref<Device> pDevice, const Settings& settings, Flags flags = Flags::Default);
@@ -368,6 +390,15 @@ namespace Falcor
         /// Pop the state of the asset resolver from the stack.
         void popAssetResolver();
 
+        /** Record a file the scene is built from.
+            Paths resolved through the builder's asset resolver are recorded automatically.
+            Importers need to call this for any other files they read (e.g. included scene files or meshes).
+            The recorded files are stored in the scene cache and used to detect stale caches.
+            This function is thread safe.
+            \param[in] path Path to an existing file.
+        */
+        void addDependency(const std::filesystem::path& path);
+
         /** Get the scene. Make sure to add all the objects before calling this function
             \return nullptr if something went wrong, otherwise a new Scene object
         */
@@ -444,6 +475,61 @@ namespace Falcor
         */
         MeshID addProcessedMesh(const ProcessedMesh& mesh);
 
+        /** Task creating a pre-processed mesh. Called on a worker thread of the builder's task pool.
+        */
+        using MeshTask = std::function<ProcessedMesh(const SceneBuilder& builder)>;
+
+        /** Add a mesh that is processed asynchronously on the builder's task pool.
+            The mesh ID is assigned immediately, so IDs follow the call order and are deterministic.
+            The returned ID can be used right away (e.g. for adding instances).
+            The data referenced by the mesh description must stay valid until waitForMeshes() returns.
+            \param mesh The mesh to add.
+            \return The ID of the mesh in the scene.
+        */
+        MeshID addMeshAsync(const Mesh& mesh);
+
+        /** Add a triangle mesh that is processed asynchronously on the builder's task pool.
+            The builder keeps a reference to the triangle mesh until it is processed.
+            \param pTriangleMesh The triangle mesh to add.
+            \param pMaterial The material to use for the mesh.
+            \param isAnimated True if the mesh vertices can be modified during rendering.
+            \return The ID of the mesh in the scene.
+        */
+        MeshID addTriangleMeshAsync(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated = false);
+
+        /** Add a mesh that is created and processed by a task on the builder's task pool.
+            This allows importers to convert their mesh data on worker threads as well.
+            \param pMaterial The material of the mesh. Must match the material of the processed mesh.
+            \param task Task returning the processed mesh, typically by calling processMesh().
+            \return The ID of the mesh in the scene.
+        */
+        MeshID addMeshAsync(const ref<Material>& pMaterial, MeshTask task);
+
+        /** Add a batch of meshes. The meshes are processed in parallel on the builder's task pool.
+            \param meshes The meshes to add.
+            \return The IDs of the meshes in the scene, in the same order as the input.
+        */
+        std::vector<MeshID> addMeshes(const std::vector<Mesh>& meshes);
+
+        /** Get statistics for merging of duplicate vertices in all meshes processed so far.
+        */
+        VertexMergeStats getVertexMergeStats() const;
+
+        /** Wait for all asynchronously added meshes to be processed and store them in the scene.
+            Rethrows an exception thrown by any of the mesh tasks. In that case the meshes added since the last call are
+            discarded: their instances are removed, their reserved mesh IDs can no longer be instanced and are removed by
+            getScene(), and later calls only wait for newly added meshes.
+            This is called automatically by getScene().
+        */
+        void waitForMeshes();
+
+        /** Run a function for a range of indices in parallel on the builder's task pool and wait for completion.
+            Used by importers to share the builder's worker threads instead of creating their own.
+            \param count Number of indices.
+            \param func Function called with each index in [0, count).
+        */
+        void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
         /** Add mesh vertex cache for animation.
             \param[in] cachedCurves The mesh vertex cache data (will be moved from).
         */
@@ -524,8 +610,9 @@ namespace Falcor
             \param[in] pMaterial Material to load texture into.
             \param[in] slot Slot to load texture into.
             \param[in] path Texture file path.
+            \param[in] loadAsSrgb Load the texture as sRGB if the slot is sRGB. Set to false for linear data in sRGB slots.
         */
-        void loadMaterialTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path);
+        void loadMaterialTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool loadAsSrgb = true);
 
         /** Wait until all material textures are loaded.
         */
@@ -708,6 +795,7 @@ namespace Falcor
             bool isFrontFaceCW = false;             ///< Indicate whether front-facing side has clockwise winding in object space.
             bool isDisplaced = false;               ///< True if mesh has displacement map.
             bool isAnimated = false;                ///< True if the mesh vertices can be modified during rendering (e.g., skinning or inverse rendering).
+            bool isDiscarded = false;               ///< True if the asynchronous processing of the mesh failed (see waitForMeshes()).
             AABB boundingBox;                       ///< Mesh bounding-box in object space.
             std::set<NodeID> instances;             ///< IDs of all nodes that instantiate this mesh.
 
@@ -778,6 +866,19 @@ namespace Falcor
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
 
+        /** Files the scene is built from.
+            Shared with the resolve callback of the asset resolver, which only holds a weak reference,
+            so copies of the resolver that outlive the builder don't record into a destroyed builder.
+        */
+        struct DependencySet
+        {
+            std::mutex mutex;
+            std::set<std::filesystem::path> paths;
+
+            void add(const std::filesystem::path& path);
+        };
+        std::shared_ptr<DependencySet> mpDependencies = std::make_shared<DependencySet>();
+
         SceneGraph mSceneGraph;
 
         MeshList mMeshes;
@@ -787,7 +888,29 @@ namespace Falcor
 
         std::unique_ptr<MaterialTextureLoader> mpMaterialTextureLoader;
 
+        struct PendingMesh
+        {
+            MeshID meshID;
+            ProcessedMesh mesh;
+        };
+
+        struct AtomicVertexMergeStats
+        {
+            std::atomic<uint64_t> meshCount{0};
+            std::atomic<uint64_t> inputVertexCount{0};
+            std::atomic<uint64_t> outputVertexCount{0};
+            std::atomic<uint64_t> timeInNanoseconds{0};
+        };
+
+        mutable AtomicVertexMergeStats mMergeStats;                 ///< Vertex merge statistics, updated by processMesh() which may run on worker threads.
+        std::unique_ptr<TaskManager> mpTaskManager;                 ///< Task pool used for asynchronous mesh processing.
+        std::vector<std::unique_ptr<PendingMesh>> mPendingMeshes;   ///< Meshes being processed asynchronously, in mesh ID order.
+
         // Helpers
+        TaskManager& getTaskManager();
+        MeshID reserveMesh(const ref<Material>& pMaterial);
+        void setMeshData(MeshID meshID, ProcessedMesh&& mesh);
+        ProcessedMesh processTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated) const;
         bool doesNodeHaveAnimation(NodeID nodeID) const;
         void updateLinkedObjects(NodeID oldNodeID, NodeID newNodeID);
         bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
@@ -812,6 +935,7 @@ namespace Falcor
         MeshGroupList splitMeshGroupMidpointMeshes(MeshGroup& meshGroup);
 
         // Post processing
+        void prioritizeVisibleTextures();
         void prepareDisplacementMaps();
         void prepareSceneGraph();
         void prepareMeshes();
@@ -30,11 +30,14 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/Common.h"
 
 #include <lz4_stream/lz4_stream.h>
 
 #include <fstream>
+#include <sstream>
 
 namespace Falcor
 {
@@ -43,7 +46,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 26;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -51,7 +54,16 @@ namespace Falcor
 
         const size_t kBlockSize = 1 * 1024 * 1024;
 
-        const char* kMagic = "FalcorS$";
+        /** Alignment of sections in the mapped format. Using the page size allows the OS to map sections directly.
+        */
+        const uint64_t kSectionAlignment = 4096;
+
+        /** Arrays smaller than this are kept inline in the compressed metadata section of the mapped format.
+        */
+        const size_t kMinSectionSize = 64 * 1024;
+
+        const char* kStreamMagic = "FalcorS$";
+        const char* kMappedMagic = "FalcorM$";
         struct Header
         {
             uint8_t magic[8]{};
@@ -59,23 +71,220 @@ namespace Falcor
 
             bool isValid() const
             {
-                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
+                return (isFormat(kStreamMagic) || isFormat(kMappedMagic)) && version == kVersion;
+            }
+
+            bool isFormat(const char* formatMagic) const
+            {
+                return std::memcmp(magic, formatMagic, sizeof(Header::magic)) == 0;
+            }
+
+            SceneCache::Format getFormat() const
+            {
+                return isFormat(kMappedMagic) ? SceneCache::Format::Mapped : SceneCache::Format::Stream;
+            }
+        };
+
+        enum class SectionCompression : uint32_t
+        {
+            None = 0,
+            LZ4 = 1,
+        };
+
+        /** Section table entry of the mapped format.
+            The section table directly follows the header. Section 0 holds the metadata stream,
+            all following sections hold bulk arrays referenced by index from the metadata stream.
+        */
+        struct SectionDesc
+        {
+            uint64_t offset{};              ///< Offset from start of file in bytes (multiple of kSectionAlignment).
+            uint64_t size{};                ///< Stored size in bytes.
+            uint64_t uncompressedSize{};    ///< Size in bytes after decompression.
+            SectionCompression compression{SectionCompression::None};
+            uint32_t reserved{};
+        };
+
+        struct SectionTable
+        {
+            uint32_t sectionCount{};
+            uint32_t reserved{};
+        };
+
+        /** Read-only stream buffer over a block of memory.
+        */
+        class MemoryStreamBuf : public std::streambuf
+        {
+        public:
+            MemoryStreamBuf(const void* data, size_t size)
+            {
+                char* p = const_cast<char*>(reinterpret_cast<const char*>(data));
+                setg(p, p, p + size);
             }
         };
+
+        void writePadding(std::ostream& fs, uint64_t offset)
+        {
+            static const char kZeros[kSectionAlignment] = {};
+            uint64_t pos = static_cast<uint64_t>(fs.tellp());
+            FALCOR_ASSERT(pos <= offset && offset - pos <= kSectionAlignment);
+            fs.write(kZeros, offset - pos);
+        }
     }
 
+    /** Collects bulk data sections while writing the mapped format.
+        Data is referenced and not copied, it has to stay valid until write() is called.
+    */
+    class SceneCache::SectionWriter
+    {
+    public:
+        SectionWriter() : mSections(1) {}
+
+        /** Add a bulk data section.
+            \return Returns the section index.
+        */
+        uint32_t addSection(const void* data, size_t size)
+        {
+            mSections.push_back({data, size, SectionCompression::None});
+            return static_cast<uint32_t>(mSections.size() - 1);
+        }
+
+        void setMetadata(std::string compressedMetadata, size_t uncompressedSize)
+        {
+            mMetadata = std::move(compressedMetadata);
+            mSections[0] = {mMetadata.data(), mMetadata.size(), SectionCompression::LZ4, uncompressedSize};
+        }
+
+        /** Write the section table followed by the aligned sections.
+            The section table is written at the current stream position.
+        */
+        void write(std::ostream& fs) const
+        {
+            uint64_t offset = static_cast<uint64_t>(fs.tellp()) + sizeof(SectionTable) + mSections.size() * sizeof(SectionDesc);
+
+            std::vector<SectionDesc> descs(mSections.size());
+            for (size_t i = 0; i < mSections.size(); ++i)
+            {
+                offset = align_to(kSectionAlignment, offset);
+                descs[i].offset = offset;
+                descs[i].size = mSections[i].size;
+                descs[i].uncompressedSize = mSections[i].compression == SectionCompression::None ? mSections[i].size : mSections[i].uncompressedSize;
+                descs[i].compression = mSections[i].compression;
+                offset += mSections[i].size;
+            }
+
+            SectionTable table;
+            table.sectionCount = static_cast<uint32_t>(descs.size());
+            fs.write(reinterpret_cast<const char*>(&table), sizeof(table));
+            fs.write(reinterpret_cast<const char*>(descs.data()), descs.size() * sizeof(SectionDesc));
+
+            for (size_t i = 0; i < mSections.size(); ++i)
+            {
+                writePadding(fs, descs[i].offset);
+                fs.write(reinterpret_cast<const char*>(mSections[i].data), mSections[i].size);
+            }
+        }
+
+    private:
+        struct Section
+        {
+            const void* data = nullptr;
+            size_t size = 0;
+            SectionCompression compression = SectionCompression::None;
+            size_t uncompressedSize = 0;
+        };
+
+        std::vector<Section> mSections;
+        std::string mMetadata;
+    };
+
+    /** Provides access to the sections of a memory-mapped cache file.
+    */
+    class SceneCache::SectionReader
+    {
+    public:
+        SectionReader(const std::filesystem::path& path, uint64_t sectionTableOffset)
+            : mFile(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan)
+        {
+            if (!mFile.isOpen()) FALCOR_THROW("Failed to open scene cache file '{}'.", path);
+
+            const uint8_t* base = getBase();
+            size_t fileSize = mFile.getMappedSize();
+            if (fileSize < sectionTableOffset + sizeof(SectionTable)) FALCOR_THROW("Truncated scene cache file '{}'.", path);
+
+            SectionTable table;
+            std::memcpy(&table, base + sectionTableOffset, sizeof(table));
+            size_t tableEnd = sectionTableOffset + sizeof(SectionTable) + size_t(table.sectionCount) * sizeof(SectionDesc);
+            if (table.sectionCount == 0 || tableEnd > fileSize) FALCOR_THROW("Invalid section table in scene cache file '{}'.", path);
+
+            mSections.resize(table.sectionCount);
+            std::memcpy(mSections.data(), base + sectionTableOffset + sizeof(SectionTable), mSections.size() * sizeof(SectionDesc));
+            for (const auto& desc : mSections)
+            {
+                if (desc.offset > fileSize || desc.size > fileSize - desc.offset) FALCOR_THROW("Section out of bounds in scene cache file '{}'.", path);
+            }
+        }
+
+        const SectionDesc& getSection(uint32_t index) const
+        {
+            if (index >= mSections.size()) FALCOR_THROW("Invalid scene cache section index {}.", index);
+            return mSections[index];
+        }
+
+        /// Get pointer to the stored (possibly compressed) data of a section.
+        const void* getData(uint32_t index) const { return getBase() + getSection(index).offset; }
+
+        /// Copy the uncompressed contents of a section to a destination buffer of the given size.
+        void copy(uint32_t index, void* dst, size_t size) const
+        {
+            const SectionDesc& desc = getSection(index);
+            if (desc.uncompressedSize != size) FALCOR_THROW("Scene cache section {} has unexpected size.", index);
+
+            switch (desc.compression)
+            {
+            case SectionCompression::None:
+                std::memcpy(dst, getData(index), size);
+                break;
+            case SectionCompression::LZ4:
+            {
+                MemoryStreamBuf buf(getData(index), desc.size);
+                std::istream is(&buf);
+                lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(is);
+                zs.read(reinterpret_cast<char*>(dst), size);
+                break;
+            }
+            default:
+                FALCOR_THROW("Unknown compression in scene cache section {}.", index);
+            }
+        }
+
+    private:
+        const uint8_t* getBase() const { return reinterpret_cast<const uint8_t*>(mFile.getData()); }
+
+        MemoryMappedFile mFile;
+        std::vector<SectionDesc> mSections;
+    };
+
     /** Wrapper around std::ostream to ease serialization of basic types.
     */
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
+        OutputStream(std::ostream& stream, SectionWriter* pSections = nullptr) : mStream(stream), mpSections(pSections) {}
 
         void write(const void* data, size_t len)
         {
             mStream.write(reinterpret_cast<const char*>(data), len);
         }
 
+        /** Write a block of bulk data.
+            When writing the mapped format, large blocks are stored in a separate section and only the section index is written to the stream.
+        */
+        void writeBulk(const void* data, size_t len)
+        {
+            if (mpSections && len >= kMinSectionSize) write(mpSections->addSection(data, len));
+            else write(data, len);
+        }
+
         template<typename T>
         void write(const T& value)
         {
@@ -101,7 +310,7 @@ namespace Falcor
             write(len);
             if constexpr (std::is_trivial<T>::value && !std::is_same<T, bool>::value)
             {
-                write(vec.data(), len * sizeof(T));
+                writeBulk(vec.data(), len * sizeof(T));
             }
             else
             {
@@ -130,6 +339,7 @@ namespace Falcor
 
     private:
         std::ostream& mStream;
+        SectionWriter* mpSections;
     };
 
     /** Wrapper around std::istream to ease serialization of basic types.
@@ -137,13 +347,21 @@ namespace Falcor
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        InputStream(std::istream& stream, const SectionReader* pSections = nullptr) : mStream(stream), mpSections(pSections) {}
 
         void read(void* data, size_t len)
         {
             mStream.read(reinterpret_cast<char*>(data), len);
         }
 
+        /** Read a block of bulk data written with OutputStream::writeBulk().
+        */
+        void readBulk(void* data, size_t len)
+        {
+            if (mpSections && len >= kMinSectionSize) mpSections->copy(read<uint32_t>(), data, len);
+            else read(data, len);
+        }
+
         template<typename T>
         void read(T& value)
         {
@@ -179,7 +397,7 @@ namespace Falcor
             vec.resize(len);
             if constexpr (std::is_trivial<T>::value && !std::is_same<T, bool>::value)
             {
-                read(vec.data(), len * sizeof(T));
+                readBulk(vec.data(), len * sizeof(T));
             }
             else
             {
@@ -213,8 +431,41 @@ namespace Falcor
 
     private:
         std::istream& mStream;
+        const SectionReader* mpSections;
     };
 
+    SceneCache::Dependency SceneCache::Dependency::create(const std::filesystem::path& path, bool computeHash)
+    {
+        Dependency dependency;
+        dependency.path = path;
+        dependency.size = std::filesystem::file_size(path);
+        dependency.lastWriteTime = std::filesystem::last_write_time(path).time_since_epoch().count();
+        if (computeHash)
+        {
+            MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+            if (dependency.size > 0 && !file.isOpen()) FALCOR_THROW("Failed to open '{}' for hashing.", path);
+            dependency.hash = SHA1::compute(file.getData(), file.getMappedSize());
+        }
+        return dependency;
+    }
+
+    bool SceneCache::Dependency::isUpToDate() const
+    {
+        std::error_code ec;
+        uint64_t currentSize = std::filesystem::file_size(path, ec);
+        if (ec || currentSize != size) return false;
+
+        auto currentTime = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        if (currentTime.time_since_epoch().count() == lastWriteTime) return true;
+
+        // File was touched, compare contents if we have a hash.
+        if (!hash) return false;
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (size > 0 && !file.isOpen()) return false;
+        return SHA1::compute(file.getData(), file.getMappedSize()) == *hash;
+    }
+
     bool SceneCache::hasValidCache(const Key& key)
     {
         auto cachePath = getCachePath(key);
@@ -227,10 +478,32 @@ namespace Falcor
         // Verify header.
         Header header;
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        if (fs.eof() || !header.isValid()) return false;
+
+        // Verify dependencies.
+        try
+        {
+            InputStream stream(fs);
+            auto dependencies = readDependencies(stream);
+            if (!fs) return false;
+            for (const auto& dependency : dependencies)
+            {
+                if (!dependency.isUpToDate())
+                {
+                    logInfo("Scene cache '{}' is out of date, '{}' has changed.", cachePath, dependency.path);
+                    return false;
+                }
+            }
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        return true;
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, const DependencyList& dependencies, Format format)
     {
         auto cachePath = getCachePath(key);
 
@@ -243,16 +516,16 @@ namespace Falcor
         std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
         if (fs.bad()) FALCOR_THROW("Failed to create scene cache file '{}'.", cachePath);
 
-        // Write header (uncompressed).
+        // Write header and dependencies (uncompressed).
         Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+        std::memcpy(header.magic, format == Format::Mapped ? kMappedMagic : kStreamMagic, sizeof(Header::magic));
         header.version = kVersion;
         fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        OutputStream stream(fs);
+        writeDependencies(stream, dependencies);
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
+        if (format == Format::Mapped) writeMappedCache(fs, sceneData);
+        else writeStreamCache(fs, sceneData);
         if (fs.bad()) FALCOR_THROW("Failed to write scene cache file to '{}'.", cachePath);
     }
 
@@ -266,17 +539,81 @@ namespace Falcor
         std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
         if (fs.bad()) FALCOR_THROW("Failed to open scene cache file '{}'.", cachePath);
 
-        // Read header (uncompressed).
+        // Read header and dependencies (uncompressed).
         Header header;
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
         if (!header.isValid()) FALCOR_THROW("Invalid header in scene cache file '{}'.", cachePath);
+        InputStream stream(fs);
+        readDependencies(stream);
 
+        if (header.getFormat() == Format::Mapped)
+        {
+            uint64_t sectionTableOffset = static_cast<uint64_t>(fs.tellg());
+            fs.close();
+            return readMappedCache(cachePath, sectionTableOffset, pDevice);
+        }
+
+        auto sceneData = readStreamCache(fs, pDevice);
+        if (fs.bad()) FALCOR_THROW("Failed to read scene cache file from '{}'.", cachePath);
+        return sceneData;
+    }
+
+    void SceneCache::writeStreamCache(std::ostream& fs, const Scene::SceneData& sceneData)
+    {
+        // Write cache (compressed).
+        lz4_stream::basic_ostream<kBlockSize> zs(fs);
+        OutputStream stream(zs);
+        writeSceneData(stream, sceneData);
+    }
+
+    void SceneCache::writeMappedCache(std::ostream& fs, const Scene::SceneData& sceneData)
+    {
+        // Serialize metadata to memory. Large arrays are collected as separate sections.
+        SectionWriter sections;
+        std::ostringstream metadata;
+        OutputStream stream(metadata, &sections);
+        writeSceneData(stream, sceneData);
+        std::string uncompressed = metadata.str();
+
+        // Compress metadata.
+        std::ostringstream compressed;
+        {
+            lz4_stream::basic_ostream<kBlockSize> zs(compressed);
+            zs.write(uncompressed.data(), uncompressed.size());
+        }
+        sections.setMetadata(compressed.str(), uncompressed.size());
+
+        // Write section table and sections (uncompressed bulk data).
+        sections.write(fs);
+    }
+
+    Scene::SceneData SceneCache::readStreamCache(std::istream& fs, ref<Device> pDevice)
+    {
         // Read cache (compressed).
         lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
         InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) FALCOR_THROW("Failed to read scene cache file from '{}'.", cachePath);
-        return sceneData;
+        return readSceneData(stream, pDevice);
+    }
+
+    Scene::SceneData SceneCache::readMappedCache(const std::filesystem::path& cachePath, uint64_t sectionTableOffset, ref<Device> pDevice)
+    {
+        SectionReader sections(cachePath, sectionTableOffset);
+
+        // Read metadata from section 0. Bulk sections are copied straight from the mapping.
+        const SectionDesc& metadata = sections.getSection(0);
+        MemoryStreamBuf buf(sections.getData(0), metadata.size);
+        std::istream is(&buf);
+        if (metadata.compression == SectionCompression::LZ4)
+        {
+            lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(is);
+            InputStream stream(zs, &sections);
+            return readSceneData(stream, pDevice);
+        }
+        else
+        {
+            InputStream stream(is, &sections);
+            return readSceneData(stream, pDevice);
+        }
     }
 
     std::filesystem::path SceneCache::getCachePath(const Key& key)
@@ -284,6 +621,33 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
+    // Dependencies
+
+    void SceneCache::writeDependencies(OutputStream& stream, const DependencyList& dependencies)
+    {
+        stream.write((uint32_t)dependencies.size());
+        for (const auto& dependency : dependencies)
+        {
+            stream.write(dependency.path);
+            stream.write(dependency.size);
+            stream.write(dependency.lastWriteTime);
+            stream.write(dependency.hash);
+        }
+    }
+
+    SceneCache::DependencyList SceneCache::readDependencies(InputStream& stream)
+    {
+        DependencyList dependencies(stream.read<uint32_t>());
+        for (auto& dependency : dependencies)
+        {
+            stream.read(dependency.path);
+            stream.read(dependency.size);
+            stream.read(dependency.lastWriteTime);
+            stream.read(dependency.hash);
+        }
+        return dependencies;
+    }
+
     // SceneData
 
     void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
@@ -844,8 +1208,11 @@ namespace Falcor
         stream.write(pGridVolume->mNodeID);
 
         stream.write(pGridVolume->mName);
-        for (const auto& gridSequence : pGridVolume->mGrids)
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridVolume::GridSlot::Count; ++slotIndex)
         {
+            // Streamed grid sequences are cached with the grid of the current frame only.
+            const auto& pGridStreamer = pGridVolume->mStreamers[slotIndex];
+            const auto& gridSequence = pGridStreamer ? GridVolume::GridSequence{ pGridStreamer->getGrid() } : pGridVolume->mGrids[slotIndex];
             stream.write((uint32_t)gridSequence.size());
             for (const auto& pGrid : gridSequence)
             {
@@ -42,6 +42,7 @@
 #include "Utils/CryptoUtils.h"
 
 #include <filesystem>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -59,7 +60,43 @@ namespace Falcor
     public:
         using Key = SHA1::MD;
 
+        /** Scene cache file format.
+        */
+        enum class Format
+        {
+            Stream, ///< Single lz4 compressed stream. All data is decompressed and copied on load.
+            Mapped, ///< Sectioned file with page aligned bulk data sections. Bulk data is read directly from a memory mapping on load.
+        };
+
+        /** Record of a file the cached scene was built from.
+            The list of dependencies is stored in the cache header and used to detect stale caches.
+        */
+        struct Dependency
+        {
+            std::filesystem::path path;     ///< Absolute file path.
+            uint64_t size = 0;              ///< File size in bytes.
+            int64_t lastWriteTime = 0;      ///< Last write time in ticks of the file clock.
+            std::optional<SHA1::MD> hash;   ///< Optional SHA-1 hash of the file contents.
+
+            /** Create a dependency record for an existing file.
+                \param[in] path Absolute file path.
+                \param[in] computeHash If true, the SHA-1 hash of the file contents is computed.
+                \return Returns the dependency record.
+            */
+            static Dependency create(const std::filesystem::path& path, bool computeHash = false);
+
+            /** Check if the file on disk still matches this record.
+                Size and last write time are compared first. If only the last write time differs
+                and a content hash is available, the hash decides.
+                \return Returns true if the file is unchanged.
+            */
+            bool isUpToDate() const;
+        };
+
+        using DependencyList = std::vector<Dependency>;
+
         /** Check if there is a valid scene cache for a given cache key.
+            This also checks that none of the files recorded in the cache have changed.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
         */
@@ -68,21 +105,38 @@ namespace Falcor
         /** Write a scene cache.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] dependencies Files the scene was built from.
+            \param[in] format File format to write.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, const DependencyList& dependencies = {}, Format format = Format::Mapped);
 
         /** Read a scene cache.
+            The file format is detected from the cache header.
             \param[in] pDevice GPU device.
             \param[in] key Cache key.
             \return Returns the loaded scene data.
         */
         static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
 
+        /** Get the path of the cache file for a given cache key.
+            \param[in] key Cache key.
+            \return Returns the cache file path.
+        */
+        static std::filesystem::path getCachePath(const Key& key);
+
     private:
         class OutputStream;
         class InputStream;
+        class SectionWriter;
+        class SectionReader;
 
-        static std::filesystem::path getCachePath(const Key& key);
+        static void writeStreamCache(std::ostream& fs, const Scene::SceneData& sceneData);
+        static void writeMappedCache(std::ostream& fs, const Scene::SceneData& sceneData);
+        static Scene::SceneData readStreamCache(std::istream& fs, ref<Device> pDevice);
+        static Scene::SceneData readMappedCache(const std::filesystem::path& cachePath, uint64_t sectionTableOffset, ref<Device> pDevice);
+
+        static void writeDependencies(OutputStream& stream, const DependencyList& dependencies);
+        static DependencyList readDependencies(InputStream& stream);
 
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
         static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TlasInstanceDescs.h"
+#include "Core/Error.h"
+#include <algorithm>
+
+namespace Falcor
+{
+void TlasInstanceDescs::clear()
+{
+    mDescs.clear();
+    mDynamicDescs.clear();
+    mDirtyRanges.clear();
+    mAllDirty = true;
+}
+
+void TlasInstanceDescs::add(const RtInstanceDesc& desc, uint32_t matrixID)
+{
+    if (matrixID != kStaticTransform)
+        mDynamicDescs.push_back({(uint32_t)mDescs.size(), matrixID});
+    mDescs.push_back(desc);
+    mAllDirty = true;
+}
+
+uint32_t TlasInstanceDescs::updateTransforms(const std::vector<float4x4>& globalMatrices, const std::vector<uint8_t>& matricesChanged)
+{
+    FALCOR_ASSERT(globalMatrices.size() == matricesChanged.size());
+
+    uint32_t updatedCount = 0;
+    for (const auto& dynamicDesc : mDynamicDescs)
+    {
+        FALCOR_ASSERT(dynamicDesc.matrixID < matricesChanged.size());
+        if (!matricesChanged[dynamicDesc.matrixID])
+            continue;
+
+        mDescs[dynamicDesc.index].setTransform(globalMatrices[dynamicDesc.matrixID]);
+        ++updatedCount;
+        if (mAllDirty)
+            continue;
+
+        // Dynamic descs are visited in index order, so the new index can only extend the last range or start a new one.
+        // Ranges from previous updates that haven't been cleared are merged when they are queried.
+        const uint32_t index = dynamicDesc.index;
+        if (!mDirtyRanges.empty())
+        {
+            Range& last = mDirtyRanges.back();
+            if (index >= last.offset && index <= last.offset + last.count + kMaxRangeGap)
+            {
+                last.count = std::max(last.count, index - last.offset + 1);
+                continue;
+            }
+        }
+        mDirtyRanges.push_back({index, 1});
+    }
+    return updatedCount;
+}
+
+const std::vector<TlasInstanceDescs::Range>& TlasInstanceDescs::getDirtyRanges() const
+{
+    if (mAllDirty)
+    {
+        mDirtyRanges.clear();
+        if (!mDescs.empty())
+            mDirtyRanges.push_back({0, (uint32_t)mDescs.size()});
+        return mDirtyRanges;
+    }
+
+    // Sort and merge ranges accumulated over several updates.
+    if (!std::is_sorted(mDirtyRanges.begin(), mDirtyRanges.end(), [](const Range& a, const Range& b) { return a.offset < b.offset; }))
+    {
+        std::sort(mDirtyRanges.begin(), mDirtyRanges.end(), [](const Range& a, const Range& b) { return a.offset < b.offset; });
+    }
+    size_t count = 0;
+    for (const Range& range : mDirtyRanges)
+    {
+        if (count > 0 && range.offset <= mDirtyRanges[count - 1].offset + mDirtyRanges[count - 1].count + kMaxRangeGap)
+        {
+            Range& last = mDirtyRanges[count - 1];
+            last.count = std::max(last.count, range.offset + range.count - last.offset);
+        }
+        else
+        {
+            mDirtyRanges[count++] = range;
+        }
+    }
+    mDirtyRanges.resize(count);
+    return mDirtyRanges;
+}
+
+void TlasInstanceDescs::clearDirty()
+{
+    mDirtyRanges.clear();
+    mAllDirty = false;
+}
+} // namespace Falcor
@@ -0,0 +1,105 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/RtAccelerationStructure.h"
+#include "Utils/Math/Matrix.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Persistent list of TLAS instance descs with dirty tracking.
+ *
+ * Each instance desc is associated with the global matrix its transform is taken from.
+ * When matrices change, only the transforms of the affected instance descs are rewritten,
+ * and the modified instance descs are reported as ranges, so that only those need to be uploaded.
+ */
+class FALCOR_API TlasInstanceDescs
+{
+public:
+    /// Matrix ID for instance descs with a fixed transform.
+    static constexpr uint32_t kStaticTransform = std::numeric_limits<uint32_t>::max();
+
+    /// Maximum number of clean instance descs between two dirty ones for them to be merged into the same range.
+    static constexpr uint32_t kMaxRangeGap = 16;
+
+    struct Range
+    {
+        uint32_t offset; ///< Index of the first instance desc.
+        uint32_t count;  ///< Number of instance descs.
+    };
+
+    /// Remove all instance descs.
+    void clear();
+
+    /**
+     * Add an instance desc. All instance descs are dirty after adding.
+     * @param[in] desc Instance desc. Its transform is used as is if matrixID is kStaticTransform.
+     * @param[in] matrixID Global matrix the transform is taken from, or kStaticTransform.
+     */
+    void add(const RtInstanceDesc& desc, uint32_t matrixID = kStaticTransform);
+
+    /**
+     * Update the transforms of instance descs whose global matrix changed, and mark them dirty.
+     * @param[in] globalMatrices Global matrices.
+     * @param[in] matricesChanged Flag per global matrix, non-zero if the matrix changed.
+     * @return Number of updated instance descs.
+     */
+    uint32_t updateTransforms(const std::vector<float4x4>& globalMatrices, const std::vector<uint8_t>& matricesChanged);
+
+    /// Get the instance descs.
+    const std::vector<RtInstanceDesc>& getDescs() const { return mDescs; }
+
+    /// Get the number of instance descs.
+    uint32_t getCount() const { return (uint32_t)mDescs.size(); }
+
+    /// Returns true if all instance descs are dirty.
+    bool isAllDirty() const { return mAllDirty; }
+
+    /// Get the sorted, non-overlapping ranges of dirty instance descs.
+    const std::vector<Range>& getDirtyRanges() const;
+
+    /// Mark all instance descs as clean.
+    void clearDirty();
+
+private:
+    struct DynamicDesc
+    {
+        uint32_t index;    ///< Index of the instance desc.
+        uint32_t matrixID; ///< Global matrix of the instance desc.
+    };
+
+    std::vector<RtInstanceDesc> mDescs;
+    std::vector<DynamicDesc> mDynamicDescs; ///< Instance descs with a transform from a global matrix, in index order.
+    mutable std::vector<Range> mDirtyRanges;
+    bool mAllDirty = false;
+};
+} // namespace Falcor
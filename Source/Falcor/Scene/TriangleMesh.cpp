@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TriangleMesh.h"
+#include "PlyReader.h"
 #include "GlobalState.h"
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
@@ -34,10 +35,144 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <numeric>
 
 namespace Falcor
 {
+    namespace
+    {
+        bool isPlyFile(const std::filesystem::path& path)
+        {
+            return hasExtension(path, "ply") || (hasExtension(path, "gz") && hasExtension(path.stem(), "ply"));
+        }
+
+        /** Merges vertices with bitwise identical attributes and remaps the indices.
+            Vertices keep the order of their first occurrence.
+        */
+        void joinIdenticalVertices(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices)
+        {
+            auto less = [&vertices](uint32_t a, uint32_t b)
+            { return std::memcmp(&vertices[a], &vertices[b], sizeof(TriangleMesh::Vertex)) < 0; };
+
+            // Sort the vertices to find the first occurrence of each unique vertex.
+            std::vector<uint32_t> order(vertices.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), less);
+            std::vector<uint32_t> remap(vertices.size());
+            for (size_t i = 0; i < order.size(); ++i)
+                remap[order[i]] = (i > 0 && !less(order[i - 1], order[i])) ? remap[order[i - 1]] : order[i];
+
+            TriangleMesh::VertexList joined;
+            for (uint32_t i = 0; i < (uint32_t)vertices.size(); ++i)
+            {
+                if (remap[i] == i)
+                {
+                    remap[i] = (uint32_t)joined.size();
+                    joined.push_back(vertices[i]);
+                }
+                else
+                {
+                    remap[i] = remap[remap[i]];
+                }
+            }
+
+            for (auto& index : indices)
+                index = remap[index];
+            vertices = std::move(joined);
+        }
+
+        /** Creates a triangle mesh from a PLY file using the native reader.
+            The result matches the ASSIMP import: texture coordinates are flipped and missing normals are generated.
+            Facet normals are generated by splitting vertices between triangles.
+            ImportFlags::JoinIdenticalVertices merges vertices with identical attributes afterwards.
+        */
+        ref<TriangleMesh> createFromPlyFile(const std::filesystem::path& path, TriangleMesh::ImportFlags importFlags)
+        {
+            PlyReader::Mesh mesh;
+            try
+            {
+                if (hasExtension(path, "gz"))
+                {
+                    auto decompressed = decompressFile(path);
+                    mesh = PlyReader::read(decompressed.data(), decompressed.size());
+                }
+                else
+                {
+                    mesh = PlyReader::read(path);
+                }
+            }
+            catch (const RuntimeError& e)
+            {
+                logWarning("Failed to load triangle mesh from '{}': {}", path, e.what());
+                return nullptr;
+            }
+
+            auto getTexCoord = [&mesh](uint32_t index)
+            {
+                return mesh.texCoords.empty() ? float2(0.f) : float2(mesh.texCoords[index].x, 1.f - mesh.texCoords[index].y);
+            };
+
+            TriangleMesh::VertexList vertices;
+            TriangleMesh::IndexList indices;
+
+            auto createMesh = [&]()
+            {
+                if (is_set(importFlags, TriangleMesh::ImportFlags::JoinIdenticalVertices))
+                    joinIdenticalVertices(vertices, indices);
+                return TriangleMesh::create(vertices, indices);
+            };
+
+            if (mesh.normals.empty() && !is_set(importFlags, TriangleMesh::ImportFlags::GenSmoothNormals))
+            {
+                vertices.reserve(mesh.indices.size());
+                indices.reserve(mesh.indices.size());
+                for (size_t i = 0; i < mesh.indices.size(); i += 3)
+                {
+                    const uint32_t triangle[3] = { mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2] };
+                    const float3& p0 = mesh.positions[triangle[0]];
+                    float3 normal = cross(mesh.positions[triangle[1]] - p0, mesh.positions[triangle[2]] - p0);
+                    float len = length(normal);
+                    normal = len > 0.f ? normal / len : float3(0.f, 0.f, 1.f);
+                    for (uint32_t index : triangle)
+                    {
+                        indices.push_back((uint32_t)vertices.size());
+                        vertices.push_back({ mesh.positions[index], normal, getTexCoord(index) });
+                    }
+                }
+                return createMesh();
+            }
+
+            std::vector<float3> normals = std::move(mesh.normals);
+            if (normals.empty())
+            {
+                // Accumulate area weighted face normals.
+                normals.resize(mesh.positions.size(), float3(0.f));
+                for (size_t i = 0; i < mesh.indices.size(); i += 3)
+                {
+                    const float3& p0 = mesh.positions[mesh.indices[i]];
+                    float3 normal = cross(mesh.positions[mesh.indices[i + 1]] - p0, mesh.positions[mesh.indices[i + 2]] - p0);
+                    for (size_t j = 0; j < 3; ++j)
+                        normals[mesh.indices[i + j]] += normal;
+                }
+                for (auto& normal : normals)
+                {
+                    float len = length(normal);
+                    normal = len > 0.f ? normal / len : float3(0.f, 0.f, 1.f);
+                }
+            }
+
+            vertices.resize(mesh.positions.size());
+            for (uint32_t i = 0; i < (uint32_t)vertices.size(); ++i)
+                vertices[i] = { mesh.positions[i], normals[i], getTexCoord(i) };
+            indices = std::move(mesh.indices);
+
+            return createMesh();
+        }
+    }
+
     ref<TriangleMesh> TriangleMesh::create()
     {
         return ref<TriangleMesh>(new TriangleMesh());
@@ -201,6 +336,9 @@ namespace Falcor
             return nullptr;
         }
 
+        if (isPlyFile(path) && !is_set(importFlags, ImportFlags::UseAssimp))
+            return createFromPlyFile(path, importFlags);
+
         Assimp::Importer importer;
 
         unsigned int flags =
@@ -330,6 +468,7 @@ namespace Falcor
         flags.value("Default", TriangleMesh::ImportFlags::Default);
         flags.value("GenSmoothNormals", TriangleMesh::ImportFlags::GenSmoothNormals);
         flags.value("JoinIdenticalVertices", TriangleMesh::ImportFlags::JoinIdenticalVertices);
+        flags.value("UseAssimp", TriangleMesh::ImportFlags::UseAssimp);
         ScriptBindings::addEnumBinaryOperators(flags);
 
         pybind11::class_<TriangleMesh, ref<TriangleMesh>> triangleMesh(m, "TriangleMesh");
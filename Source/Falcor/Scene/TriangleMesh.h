@@ -51,6 +51,7 @@ namespace Falcor
             None = 0x0,
             GenSmoothNormals = 0x1,
             JoinIdenticalVertices = 0x2,
+            UseAssimp = 0x4, ///< Always load through ASSIMP, even for formats with a native reader (PLY).
 
             Default = None
         };
@@ -111,9 +112,10 @@ namespace Falcor
 
         /** Creates a triangle mesh from a file.
             This is using ASSIMP to support a wide variety of asset formats.
+            PLY files (optionally gzip compressed) are loaded with a native reader instead, unless ImportFlags::UseAssimp is set.
             All geometry found in the asset is pre-transformed and merged into the same triangle mesh.
             \param[in] path File path to load mesh from (absolute or relative to working directory).
-            \param[in] flags Flags controlling ASSIMP mesh import options.
+            \param[in] flags Flags controlling mesh import options.
             \return Returns the triangle mesh or nullptr if the mesh failed to load.
         */
         static ref<TriangleMesh> createFromFile(const std::filesystem::path& path, ImportFlags flags);
@@ -29,8 +29,10 @@
 #include <algorithm>
 #include <cstdint>
 #include <climits>
+#include <emmintrin.h>
 
 // this file exposes a single function, CompressAlphaDxt5, which encodes a 4x4 set of uint8 alpha values into a single 64 bit BC4 encoded block
+// the range search and codebook fitting process all 16 values at once with SSE2
 static void CompressAlphaDxt5(uint8_t* tile, void* block);
 
 // derived from libsquish, alpha.cpp
@@ -62,9 +64,9 @@ static void FixRange(int& min, int& max, int steps)
         min = std::max(0, max - steps);
 }
 
-static int FitCodes(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
+static inline int FitCodesScalar(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
 {
-    // fit each alpha value to the codebook
+    // scalar reference for FitCodes
     int err = 0;
     for (int i = 0; i < 16; ++i)
     {
@@ -95,6 +97,55 @@ static int FitCodes(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
     return err;
 }
 
+static inline int HorizontalMinEpu8(__m128i v)
+{
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 1));
+    return _mm_cvtsi128_si32(v) & 0xff;
+}
+
+static inline int HorizontalMaxEpu8(__m128i v)
+{
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+    return _mm_cvtsi128_si32(v) & 0xff;
+}
+
+static inline int FitCodes(uint8_t const* tile, uint8_t const* codes, uint8_t* indices)
+{
+    // fit all 16 alpha values to the codebook at once
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tile));
+    const __m128i ones = _mm_set1_epi8(-1);
+    __m128i least = ones;
+    __m128i index = _mm_setzero_si128();
+    for (int j = 0; j < 8; ++j)
+    {
+        // absolute difference to this code, which orders codes like the squared error
+        const __m128i code = _mm_set1_epi8((char)codes[j]);
+        const __m128i dist = _mm_or_si128(_mm_subs_epu8(values, code), _mm_subs_epu8(code, values));
+
+        // keep the first code with the least error
+        const __m128i newLeast = _mm_min_epu8(dist, least);
+        const __m128i better = _mm_andnot_si128(_mm_cmpeq_epi8(newLeast, least), ones);
+        index = _mm_or_si128(_mm_and_si128(better, _mm_set1_epi8((char)j)), _mm_andnot_si128(better, index));
+        least = newLeast;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), index);
+
+    // sum the squared errors
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i least0 = _mm_unpacklo_epi8(least, zero);
+    const __m128i least1 = _mm_unpackhi_epi8(least, zero);
+    __m128i err = _mm_add_epi32(_mm_madd_epi16(least0, least0), _mm_madd_epi16(least1, least1));
+    err = _mm_add_epi32(err, _mm_shuffle_epi32(err, _MM_SHUFFLE(1, 0, 3, 2)));
+    err = _mm_add_epi32(err, _mm_shuffle_epi32(err, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(err);
+}
+
 static void WriteAlphaBlock(int alpha0, int alpha1, uint8_t const* indices, void* block)
 {
     uint8_t* bytes = reinterpret_cast<uint8_t*>(block);
@@ -187,23 +238,13 @@ static void WriteAlphaBlock7(int alpha0, int alpha1, uint8_t const* indices, voi
 static void CompressAlphaDxt5(uint8_t* tile, void* block)
 {
     // get the range for 5-alpha and 7-alpha interpolation
-    int min5 = 255;
-    int max5 = 0;
-    int min7 = 255;
-    int max7 = 0;
-    for (int i = 0; i < 16; ++i)
-    {
-        // incorporate into the min/max
-        int value = (int)(tile[i]);
-        if (value < min7)
-            min7 = value;
-        if (value > max7)
-            max7 = value;
-        if (value != 0 && value < min5)
-            min5 = value;
-        if (value != 255 && value > max5)
-            max5 = value;
-    }
+    // the 5-alpha range ignores 0 and 255, which are mapped to 255 and 0 respectively before the reduction
+    const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tile));
+    const __m128i ones = _mm_set1_epi8(-1);
+    int min7 = HorizontalMinEpu8(values);
+    int max7 = HorizontalMaxEpu8(values);
+    int min5 = HorizontalMinEpu8(_mm_or_si128(values, _mm_cmpeq_epi8(values, _mm_setzero_si128())));
+    int max5 = HorizontalMaxEpu8(_mm_andnot_si128(_mm_cmpeq_epi8(values, ones), values));
 
     // handle the case that no valid range was found
     if (min5 > max5)
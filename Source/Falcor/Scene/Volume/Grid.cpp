@@ -90,26 +90,69 @@ namespace Falcor
     }
 
     ref<Grid> Grid::createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    {
+        return createFromHandle(pDevice, readFromFile(path, gridname));
+    }
+
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readFromFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!std::filesystem::exists(path))
         {
             logWarning("Error when loading grid. Can't open grid file '{}'.", path);
-            return nullptr;
+            return {};
         }
 
+        nanovdb::GridHandle<nanovdb::HostBuffer> handle;
         if (hasExtension(path, "nvdb"))
         {
-            return createFromNanoVDBFile(pDevice, path, gridname);
+            handle = readNanoVDBFile(path, gridname);
         }
         else if (hasExtension(path, "vdb"))
         {
-            return createFromOpenVDBFile(pDevice, path, gridname);
+            handle = readOpenVDBFile(path, gridname);
         }
         else
         {
             logWarning("Error when loading grid. Unsupported grid file '{}'.", path);
-            return nullptr;
+            return {};
+        }
+
+        // Compute the grid statistics here so that it happens on the loading thread.
+        if (auto floatGrid = handle.grid<float>(); floatGrid && !floatGrid->hasMinMax())
+        {
+            nanovdb::gridStats(*floatGrid);
+        }
+
+        return handle;
+    }
+
+    ref<Grid> Grid::createFromHandle(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    {
+        if (!gridHandle || !gridHandle.grid<float>()) return nullptr;
+        return ref<Grid>(new Grid(pDevice, std::move(gridHandle)));
+    }
+
+    uint64_t Grid::DecodedGrid::getSize() const
+    {
+        return handle.size() + (pBricks ? pBricks->getHostSize() : 0);
+    }
+
+    Grid::DecodedGrid Grid::decodeFromFile(const std::filesystem::path& path, const std::string& gridname)
+    {
+        DecodedGrid decoded;
+        decoded.handle = readFromFile(path, gridname);
+        if (auto floatGrid = decoded.handle.grid<float>())
+        {
+            decoded.pBricks = std::make_shared<NanoVDBConverterBC4>(floatGrid);
+            decoded.pBricks->convertBricks();
         }
+        return decoded;
+    }
+
+    ref<Grid> Grid::createFromDecoded(ref<Device> pDevice, DecodedGrid decoded)
+    {
+        if (!decoded) return nullptr;
+        return ref<Grid>(new Grid(pDevice, std::move(decoded.handle), decoded.pBricks.get()));
     }
 
     void Grid::renderUI(Gui::Widgets& widget)
@@ -202,7 +245,7 @@ namespace Falcor
         return math::translate(float4x4(invAffine), -translation);
     }
 
-    Grid::Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    Grid::Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, NanoVDBConverterBC4* pBricks)
         : mpDevice(pDevice)
         , mGridHandle(std::move(gridHandle))
         , mpFloatGrid(mGridHandle.grid<float>())
@@ -221,42 +264,43 @@ namespace Falcor
             MemoryType::DeviceLocal,
             mGridHandle.data()
         );
+        // Bricks converted ahead of time (see decodeFromFile()) only need their textures created.
         using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert(mpDevice);
+        mBrickedGrid = pBricks ? pBricks->createTextures(mpDevice) : NanoVDBGridConverter(mpFloatGrid).convert(mpDevice);
     }
 
-    ref<Grid> Grid::createFromNanoVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         auto handle = nanovdb::io::readGrid(path.string(), gridname);
         if (!handle)
         {
             logWarning("Error when loading grid.");
-            return nullptr;
+            return {};
         }
 
         auto floatGrid = handle.grid<float>();
         if (!floatGrid || floatGrid->gridType() != nanovdb::GridType::Float)
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (floatGrid->isEmpty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return handle;
     }
 
-    ref<Grid> Grid::createFromOpenVDBFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::readOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         openvdb::initialize();
 
@@ -278,25 +322,23 @@ namespace Falcor
         if (!baseGrid)
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (!baseGrid->isType<openvdb::FloatGrid>())
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (baseGrid->empty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
-        auto handle = nanovdb::openToNanoVDB(floatGrid);
-
-        return ref<Grid>(new Grid(pDevice, std::move(handle)));
+        return nanovdb::openToNanoVDB(floatGrid);
     }
 
 
@@ -53,6 +53,8 @@
 namespace Falcor
 {
     struct ShaderVar;
+    template <typename TexelType, unsigned int kBitsPerTexel> struct NanoVDBToBricksConverter;
+    using NanoVDBConverterBC4 = NanoVDBToBricksConverter<uint64_t, 4>;
 
     /** Voxel grid based on NanoVDB.
     */
@@ -60,6 +62,20 @@ namespace Falcor
     {
         FALCOR_OBJECT(Grid)
     public:
+        /** Grid read into host memory and converted to bricks on the CPU, ready to be uploaded (see decodeFromFile()).
+        */
+        struct DecodedGrid
+        {
+            nanovdb::GridHandle<nanovdb::HostBuffer> handle;
+            std::shared_ptr<NanoVDBConverterBC4> pBricks;   ///< Converted bricks of the grid in handle.
+
+            explicit operator bool() const { return pBricks != nullptr; }
+
+            /** Get the host memory used by the decoded grid in bytes.
+            */
+            uint64_t getSize() const;
+        };
+
         /** Create a sphere voxel grid.
             \param[in] pDevice GPU device.
             \param[in] radius Radius of the sphere in world units.
@@ -89,6 +105,36 @@ namespace Falcor
         */
         static ref<Grid> createFromFile(ref<Device> pDevice, const std::filesystem::path& path, const std::string& gridname);
 
+        /** Read a grid from a file into host memory without creating any GPU resources.
+            This is safe to call from any thread and allows decoding grids ahead of time (see GridStreamer).
+            \param[in] path File path of the grid (absolute or relative to working directory).
+            \param[in] gridname Name of the grid to load.
+            \return NanoVDB grid handle, or an empty handle if the grid failed to load.
+        */
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readFromFile(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Create a grid from a NanoVDB grid handle, e.g. as returned by readFromFile().
+            \param[in] pDevice GPU device.
+            \param[in] gridHandle NanoVDB grid handle containing a float grid.
+            \return A new grid, or nullptr if the handle is empty.
+        */
+        static ref<Grid> createFromHandle(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+
+        /** Read a grid from a file and convert it to bricks without creating any GPU resources.
+            This is the expensive part of loading a grid and is safe to call from any thread (see GridStreamer).
+            \param[in] path File path of the grid (absolute or relative to working directory).
+            \param[in] gridname Name of the grid to load.
+            \return Decoded grid, or an empty one if the grid failed to load.
+        */
+        static DecodedGrid decodeFromFile(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Create a grid from a decoded grid, which only creates the GPU resources.
+            \param[in] pDevice GPU device.
+            \param[in] decoded Grid as returned by decodeFromFile().
+            \return A new grid, or nullptr if the decoded grid is empty.
+        */
+        static ref<Grid> createFromDecoded(ref<Device> pDevice, DecodedGrid decoded);
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -145,10 +191,10 @@ namespace Falcor
         float4x4 getInvTransform() const;
 
     private:
-        Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        Grid(ref<Device> pDevice, nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, NanoVDBConverterBC4* pBricks = nullptr);
 
-        static ref<Grid> createFromNanoVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
-        static ref<Grid> createFromOpenVDBFile(ref<Device>, const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> readOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
 
         ref<Device> mpDevice;
 
@@ -45,9 +45,13 @@
 #pragma warning(pop)
 #endif
 
+#include <emmintrin.h>
+
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <execution>
+#include <limits>
 #include <vector>
 
 namespace Falcor
@@ -57,6 +61,10 @@ namespace Falcor
     using NanoVDBConverterUNORM8 = NanoVDBToBricksConverter<uint8_t, 8>;
     using NanoVDBConverterUNORM16 = NanoVDBToBricksConverter<uint16_t, 16>;
 
+    /** Converts a NanoVDB float grid to bricks (see BrickedGrid).
+        Bricks are read directly from the NanoVDB leaf nodes, which are located through a dense brick -> leaf table
+        instead of tree lookups. The value range of each brick includes a one voxel apron, read from the neighbouring leaves.
+    */
     template <typename TexelType, unsigned int kBitsPerTexel>
     struct NanoVDBToBricksConverter
     {
@@ -64,17 +72,48 @@ namespace Falcor
         NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid);
         NanoVDBToBricksConverter(const NanoVDBToBricksConverter& rhs) = delete;
 
+        /** Convert the grid and create the brick textures.
+        */
         BrickedGrid convert(ref<Device> pDevice);
 
+        /** Convert the grid on the CPU without creating textures. This is called by convert().
+            This does not touch the GPU and is safe to call from any thread.
+        */
+        void convertBricks();
+
+        /** Create the brick textures from the data produced by convertBricks(). This is called by convert().
+        */
+        BrickedGrid createTextures(ref<Device> pDevice);
+
+        /** Get the host memory used by the converted data in bytes.
+        */
+        inline uint64_t getHostSize() const { return (mRangeData.size() + mPtrData.size()) * sizeof(uint32_t) + mAtlasData.size() * sizeof(TexelType); }
+
+        inline const std::vector<uint32_t>& getRangeData() const { return mRangeData; }
+        inline const std::vector<uint32_t>& getPtrData() const { return mPtrData; }
+        inline const std::vector<TexelType>& getAtlasData() const { return mAtlasData; }
+        inline int3 getLeafDim(int mip) const { return mLeafDim[mip]; }
+        inline uint32_t getMipOffset(int mip) const { return mip ? mLeafCount[mip - 1] : 0; }
+        inline uint32_t getNonEmptyCount() const { return mNonEmptyCount.load(); }
+        inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
+        inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
+
     private:
+        using LeafType = nanovdb::NanoLeaf<float>;
+        using AccessorType = nanovdb::FloatGrid::AccessorType;
+
         const static uint32_t kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int32_t kBC4Compress = kBitsPerTexel == 4;
 
+        void buildLeafTable();
         void convertSlice(int z);
         void computeMip(int mip);
+        void computeMipSlice(int mip, int z);
+
+        const LeafType* getLeaf(const int3& brick, AccessorType& a) const;
+        void computeBrickRange(const int3& brick, const LeafType* leaf, AccessorType& a, float& minorant, float& majorant) const;
+        void writeBrickBC4(const float* data, float minorant, float majorant, uint64_t* atlasdst) const;
 
-        inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
-        inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
         inline uint32_t getAtlasMaxBrick() const { return mAtlasSizeBricks.x * mAtlasSizeBricks.y * mAtlasSizeBricks.z; }
 
         inline ResourceFormat getAtlasFormat() {
@@ -97,13 +136,15 @@ namespace Falcor
             return float2(f16tof32(data16[0]), f16tof32(data16[1]));
         }
 
-        inline void expandMinorantMajorant(float value, float& min_inout, float& maj_inout)
+        inline void expandMinorantMajorant(float value, float& min_inout, float& maj_inout) const
         {
             if (value < min_inout) min_inout = value;
             if (value > maj_inout) maj_inout = value;
         }
 
         const nanovdb::FloatGrid* mpFloatGrid;
+        const LeafType* mpFirstLeaf;
+        std::vector<uint32_t> mLeafTable; ///< Leaf index + 1 for each brick at mip 0, or 0 if there is no leaf.
         uint3 mAtlasSizeBricks;
         int3 mLeafDim[4];
         int3 mBBMin, mBBMax, mPixDim;
@@ -119,6 +160,7 @@ namespace Falcor
     {
         mNonEmptyCount.store(0);
         mpFloatGrid = grid;
+        mpFirstLeaf = grid->tree().getFirstNode<LeafType>();
         auto& voxelbox = mpFloatGrid->indexBBox();
         mBBMin = (int3(voxelbox.min().x(), voxelbox.min().y(), voxelbox.min().z())) & (~7);
         mBBMax = (int3(voxelbox.max().x(), voxelbox.max().y(), voxelbox.max().z()) + 7) & (~7);
@@ -140,6 +182,143 @@ namespace Falcor
         mAtlasData.resize(kBC4Compress ? (leafTexelCount / 16) : leafTexelCount);
     }
 
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::buildLeafTable()
+    {
+        mLeafTable.assign(mLeafCount[0], 0);
+        const uint32_t leafCount = mpFirstLeaf ? mpFloatGrid->tree().nodeCount(0) : 0;
+        auto range = NumericRange<uint32_t>(0, leafCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i)
+        {
+            const nanovdb::Coord origin = mpFirstLeaf[i].origin();
+            const int3 brick = (int3(origin[0], origin[1], origin[2]) - mBBMin) / int(kBrickSize);
+            // Leaves outside the bounding box of the active voxels are only reachable as apron, which falls back to tree lookups.
+            if (any(brick < int3(0)) || any(brick >= mLeafDim[0])) return;
+            mLeafTable[(brick.z * mLeafDim[0].y + brick.y) * mLeafDim[0].x + brick.x] = i + 1;
+        });
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    const typename NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::LeafType* NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::getLeaf(const int3& brick, AccessorType& a) const
+    {
+        if (all(brick >= int3(0)) && all(brick < mLeafDim[0]))
+        {
+            uint32_t leafIndex = mLeafTable[(brick.z * mLeafDim[0].y + brick.y) * mLeafDim[0].x + brick.x];
+            return leafIndex ? mpFirstLeaf + (leafIndex - 1) : nullptr;
+        }
+        const int3 ijk = brick * int(kBrickSize) + mBBMin;
+        return a.probeLeaf(nanovdb::Coord(ijk.x, ijk.y, ijk.z));
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeBrickRange(const int3& brick, const LeafType* leaf, AccessorType& a, float& minorant, float& majorant) const
+    {
+        // The range covers the 10x10x10 voxels of the brick and its one voxel apron. For each of the 27 leaves overlapping that region,
+        // visit the voxels in the overlap. NanoVDB stores leaf values as [x][y][z], so full z-rows are read with vector loads.
+        // Regions without a leaf hold a single tile value, which is fetched with one tree lookup.
+        __m128 vmin = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        __m128 vmax = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+        float smin = std::numeric_limits<float>::infinity();
+        float smax = -std::numeric_limits<float>::infinity();
+
+        for (int dz = -1; dz <= 1; ++dz)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const int3 offset(dx, dy, dz);
+                    const LeafType* neighbour = (dx == 0 && dy == 0 && dz == 0) ? leaf : getLeaf(brick + offset, a);
+                    if (!neighbour)
+                    {
+                        const int3 ijk = (brick + offset) * int(kBrickSize) + mBBMin;
+                        expandMinorantMajorant(a.getValue(nanovdb::Coord(ijk.x, ijk.y, ijk.z)), smin, smax);
+                        continue;
+                    }
+
+                    // Voxel range of the overlap in the neighbour: the last layer before the brick, all layers, or the first layer after it.
+                    const int kLast = int(kBrickSize) - 1;
+                    const int3 lo(dx < 0 ? kLast : 0, dy < 0 ? kLast : 0, dz < 0 ? kLast : 0);
+                    const int3 hi(dx > 0 ? 0 : kLast, dy > 0 ? 0 : kLast, dz > 0 ? 0 : kLast);
+                    const float* data = neighbour->data()->mValues;
+                    for (int x = lo.x; x <= hi.x; ++x)
+                    {
+                        for (int y = lo.y; y <= hi.y; ++y)
+                        {
+                            const float* row = data + (x * kBrickSize + y) * kBrickSize;
+                            if (dz == 0)
+                            {
+                                const __m128 v0 = _mm_loadu_ps(row);
+                                const __m128 v1 = _mm_loadu_ps(row + 4);
+                                // The accumulator is the second operand, so NaNs are ignored like in expandMinorantMajorant().
+                                vmin = _mm_min_ps(v0, vmin);
+                                vmin = _mm_min_ps(v1, vmin);
+                                vmax = _mm_max_ps(v0, vmax);
+                                vmax = _mm_max_ps(v1, vmax);
+                            }
+                            else
+                            {
+                                expandMinorantMajorant(row[lo.z], smin, smax);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        alignas(16) float lanesMin[4];
+        alignas(16) float lanesMax[4];
+        _mm_store_ps(lanesMin, vmin);
+        _mm_store_ps(lanesMax, vmax);
+        for (int i = 0; i < 4; ++i)
+        {
+            smin = std::min(smin, lanesMin[i]);
+            smax = std::max(smax, lanesMax[i]);
+        }
+        minorant = smin;
+        majorant = smax;
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::writeBrickBC4(const float* data, float minorant, float majorant, uint64_t* atlasdst) const
+    {
+        // Quantize the brick to 8 bits with vector loads along z, transposing from NanoVDB's [x][y][z] layout to [z][y][x],
+        // so that the 4x4 tiles in the xy-plane are made of contiguous rows. Out of range values saturate instead of wrapping.
+        alignas(16) uint8_t quantized[kBrickSize][kBrickSize][kBrickSize];
+        const __m128 vminorant = _mm_set1_ps(minorant);
+        const __m128 vinvRange = _mm_set1_ps(255.f / (majorant - minorant));
+        for (int pixx = 0; pixx < kBrickSize; ++pixx)
+        {
+            for (int pixy = 0; pixy < kBrickSize; ++pixy)
+            {
+                const float* row = data + (pixx * kBrickSize + pixy) * kBrickSize;
+                const __m128i i0 = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(row), vminorant), vinvRange));
+                const __m128i i1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(row + 4), vminorant), vinvRange));
+                alignas(16) uint8_t lanes[16];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_setzero_si128()));
+                for (int pixz = 0; pixz < kBrickSize; ++pixz) quantized[pixz][pixy][pixx] = lanes[pixz];
+            }
+        }
+
+        uint3 atlasSizePixels = getAtlasSizePixels();
+        uint pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
+        for (int pixz = 0; pixz < kBrickSize; ++pixz)
+        {
+            for (int tiley = 0; tiley < kBrickSize; tiley += 4)
+            {
+                for (int tilex = 0; tilex < kBrickSize; tilex += 4)
+                {
+                    alignas(16) uint8_t tilevals[4][4];
+                    for (int pixy = 0; pixy < 4; ++pixy) std::memcpy(tilevals[pixy], &quantized[pixz][tiley + pixy][tilex], 4);
+                    CompressAlphaDxt5(&tilevals[0][0], atlasdst);
+                    atlasdst++;
+                }
+                atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
+            }
+            atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
+        }
+    }
+
     template <typename TexelType, unsigned int kBitsPerTexel>
     void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertSlice(int z)
     {
@@ -156,30 +335,22 @@ namespace Falcor
         {
             for (int x = 0; x < mLeafDim[0].x; ++x)
             {
-                nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
-                auto val = a.getValue(ijk);
-                auto leaf = a.probeLeaf(ijk);
-                float minorant = val, majorant = val;
+                const int3 brick(x, y, z);
+                const uint32_t leafIndex = mLeafTable[offset + y * mLeafDim[0].x + x];
+                const LeafType* leaf = leafIndex ? mpFirstLeaf + (leafIndex - 1) : nullptr;
+                float minorant, majorant;
                 uint myleaf = 0;
                 if (leaf)
                 {
-                    // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
-                    const float* data = leaf->data()->mValues;
-                    for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
-                    // We also need the 1-halo from neighbouring bricks. Fetch them in an order that maximises nanovdb's internal cache reuse.
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, kBrickSize)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, -1, j)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, kBrickSize, j)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
-
+                    // Nanovdb only stores minorant/majorant for active voxels, but we need all of them, including the 1-halo from neighbouring bricks.
+                    computeBrickRange(brick, leaf, a, minorant, majorant);
                     if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
                 }
+                else
+                {
+                    // Without a leaf the whole brick has the value of the tile containing it.
+                    minorant = majorant = a.getValue(nanovdb::Coord(x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z));
+                }
                 if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
                 {
                     *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
@@ -215,33 +386,8 @@ namespace Falcor
                     }
                     else {
                         // BC4 compression:
-                        float invRange = (255.f) / (majorant - minorant);
                         uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
-                        {
-                            for (int tiley = 0; tiley < kBrickSize; tiley += 4)
-                            {
-                                for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
-                                    uint8_t tilevals[4][4];
-                                    uint8_t tileminorant = 255, tilemajorant = 0;
-                                    for (int pixy = 0; pixy < 4; ++pixy)
-                                    {
-                                        for (int pixx = 0; pixx < 4; ++pixx)
-                                        {
-                                            float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
-                                            uint8_t voxel = uint8_t((f - minorant) * invRange);
-                                            tileminorant = std::min(tileminorant, voxel);
-                                            tilemajorant = std::max(tilemajorant, voxel);
-                                            tilevals[pixy][pixx] = voxel;
-                                        }
-                                    }
-                                    CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
-                                    atlasdst++;
-                                }
-                                atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
-                            }
-                            atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
-                        } // z slice loop
+                        writeBrickBC4(data, minorant, majorant, atlasdst);
                     } // bc4 compress?
                 } // non empty brick?
             } // x brick loop
@@ -251,8 +397,13 @@ namespace Falcor
     template <typename TexelType, unsigned int kBitsPerTexel>
     void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip)
     {
-        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1];
-        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
+        auto range = NumericRange<int>(0, mLeafDim[mip].z);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { computeMipSlice(mip, z); });
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMipSlice(int mip, int z)
+    {
         int3 leafdim_src = mLeafDim[mip - 1];
         uint32_t rowstride_src = leafdim_src.x;
         uint32_t slicestride_src = leafdim_src.y * rowstride_src;
@@ -261,43 +412,57 @@ namespace Falcor
         uint32_t rowstride_tgt = leafdim_tgt.x;
         uint32_t slicestride_tgt = leafdim_tgt.y * rowstride_tgt;
 
-        for (int z = 0; z < leafdim_tgt.z; ++z, rangesrc += slicestride_src)
+        // Each target slice reduces two source slices, so slices can be processed independently.
+        uint32_t* rangedst = mRangeData.data() + getMipOffset(mip) + z * slicestride_tgt;
+        const uint32_t* rangesrc = mRangeData.data() + getMipOffset(mip - 1) + 2 * z * slicestride_src;
+
+        for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
         {
-            for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
+            for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
             {
-                for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
-                {
-                    float2 majmin_dst = combineMajMin(
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
-                        ),
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
-                        )
-                    );
-                    *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
-                } // x
-            } // y
-        } // z
+                float2 majmin_dst = combineMajMin(
+                    combineMajMin(
+                        combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
+                        combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
+                    ),
+                    combineMajMin(
+                        combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
+                        combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
+                    )
+                );
+                *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
+            } // x
+        } // y
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(ref<Device> pDevice)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertBricks()
     {
-        auto t0 = CpuTimer::getCurrentTimePoint();
+        buildLeafTable();
         auto range = NumericRange<int>(0, mLeafDim[0].z);
         std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
         for (int mip = 1; mip < 4; ++mip) computeMip(mip);
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(ref<Device> pDevice)
+    {
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        convertBricks();
+        BrickedGrid bricks = createTextures(pDevice);
+
+        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
+        return bricks;
+    }
 
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::createTextures(ref<Device> pDevice)
+    {
         BrickedGrid bricks;
         bricks.range = pDevice->createTexture3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource);
         bricks.indirection = pDevice->createTexture3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource);
         bricks.atlas = pDevice->createTexture3D(getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource);
-
-        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
-        logDebug("Converted '{}' in {:.4}ms: mNonEmptyCount {} vs max {}", mpFloatGrid->gridName(), dt, mNonEmptyCount.load(), getAtlasMaxBrick());
         return bricks;
     }
 }
@@ -0,0 +1,386 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "GridStreamer.h"
+#include "Core/Error.h"
+#include "Utils/JobSystem.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace Falcor
+{
+namespace
+{
+double getElapsedSeconds(CpuTimer::TimePoint startTime)
+{
+    return CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+}
+} // namespace
+
+GridStreamer::GridStreamer(ref<Device> pDevice, std::vector<std::filesystem::path> paths, std::string gridname, const Options& options)
+    : mpDevice(pDevice), mPaths(std::move(paths)), mGridname(std::move(gridname)), mOptions(options), mFrames(mPaths.size())
+{}
+
+GridStreamer::~GridStreamer()
+{
+    // Cancel queued frames and wait for the submitted jobs, as they reference this object.
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (auto& frame : mFrames)
+        frame.wanted = false;
+    waitForJobs(lock);
+}
+
+const ref<Grid>& GridStreamer::setFrame(uint32_t frameIndex)
+{
+    if (mFrames.empty())
+    {
+        mpGrid = nullptr;
+        return mpGrid;
+    }
+
+    frameIndex = std::min(frameIndex, getFrameCount() - 1);
+    const bool changed = !mHasFrame || frameIndex != mFrame;
+
+    // Infer the playback step from the previous frame, taking wrap-around of looping playback into account.
+    if (mHasFrame && changed)
+    {
+        const int64_t count = getFrameCount();
+        int64_t delta = (int64_t)frameIndex - (int64_t)mFrame;
+        if (mOptions.loop && std::abs(delta) > count / 2)
+            delta += delta > 0 ? -count : count;
+        if (std::abs(delta) <= kMaxStep)
+            mStep = (int32_t)delta;
+    }
+    mFrame = frameIndex;
+    mHasFrame = true;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    Frame& frame = mFrames[frameIndex];
+    frame.wanted = true;
+
+    if (changed)
+    {
+        if (frame.state == FrameState::Uploaded)
+            mStats.hitCount++;
+        else
+            mStats.missCount++;
+    }
+
+    if (frame.state != FrameState::Uploaded)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        if (frame.state == FrameState::Empty || frame.state == FrameState::Queued)
+        {
+            // Decode on this thread rather than waiting for the job to be scheduled. A queued job will skip the frame.
+            frame.state = FrameState::Decoding;
+            lock.unlock();
+            auto decodeStartTime = CpuTimer::getCurrentTimePoint();
+            auto decoded = decode(frameIndex);
+            double decodeTime = getElapsedSeconds(decodeStartTime);
+            lock.lock();
+            storeDecoded(frame, std::move(decoded), decodeTime);
+        }
+        else if (frame.state == FrameState::Decoding)
+        {
+            mCondition.wait(lock, [&] { return frame.state != FrameState::Decoding; });
+        }
+
+        FALCOR_ASSERT(frame.state == FrameState::Decoded);
+        uploadFrame(frameIndex, lock);
+        mStats.stallTime += getElapsedSeconds(startTime);
+    }
+
+    frame.used = true;
+    if (frame.pGrid)
+        mpGrid = frame.pGrid;
+    else if (changed)
+        logWarning("Grid frame {} failed to load, {}.", frameIndex, mpGrid ? "keeping the grid of the previous frame" : "no grid is available");
+    updateWindow(lock);
+
+    return mpGrid;
+}
+
+void GridStreamer::waitForPrefetch()
+{
+    if (!mHasFrame)
+        return;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    waitForJobs(lock);
+    for (uint32_t frameIndex = 0; frameIndex < getFrameCount(); ++frameIndex)
+    {
+        if (mFrames[frameIndex].state == FrameState::Decoded)
+            uploadFrame(frameIndex, lock);
+    }
+}
+
+void GridStreamer::setOptions(const Options& options)
+{
+    mOptions = options;
+    if (mHasFrame)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        updateWindow(lock);
+    }
+}
+
+GridStreamer::Stats GridStreamer::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Stats stats = mStats;
+    for (const auto& frame : mFrames)
+    {
+        if (frame.state == FrameState::Queued || frame.state == FrameState::Decoding)
+            stats.pendingCount++;
+        if (frame.state == FrameState::Decoded || frame.state == FrameState::Uploaded)
+        {
+            stats.residentCount++;
+            stats.memoryUsage += frame.size;
+        }
+    }
+    return stats;
+}
+
+void GridStreamer::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats = Stats();
+}
+
+void GridStreamer::renderUI(Gui::Widgets& widget)
+{
+    Options options = mOptions;
+    bool changed = false;
+    changed |= widget.var("Prefetch frames", options.prefetchFrames, 0u, 256u);
+    changed |= widget.var("Keep frames", options.keepFrames, 0u, 256u);
+    changed |= widget.var("Uploads per frame", options.maxUploadsPerFrame, 1u, 16u);
+    uint32_t memoryLimitMB = (uint32_t)std::min<uint64_t>(options.memoryLimit >> 20, UINT32_MAX);
+    if (widget.var("Memory limit (MB)", memoryLimitMB, 1u))
+    {
+        options.memoryLimit = (uint64_t)memoryLimitMB << 20;
+        changed = true;
+    }
+    changed |= widget.checkbox("Loop", options.loop);
+    if (changed)
+        setOptions(options);
+
+    Stats stats = getStats();
+    widget.text(fmt::format(
+        "Step: {}\nHits: {}\nMisses: {}\nStall time: {:.3f} s\nDecode time: {:.3f} s\nUpload time: {:.3f} s\n"
+        "Decoded: {} ({} failed)\nEvicted: {} ({} unused)\nResident: {} frames, {}\nPending: {}",
+        mStep,
+        stats.hitCount,
+        stats.missCount,
+        stats.stallTime,
+        stats.decodeTime,
+        stats.uploadTime,
+        stats.decodedCount,
+        stats.failedCount,
+        stats.evictedCount,
+        stats.unusedCount,
+        stats.residentCount,
+        formatByteSize(stats.memoryUsage),
+        stats.pendingCount
+    ));
+    if (widget.button("Reset stats"))
+        resetStats();
+}
+
+int64_t GridStreamer::getWindowFrame(int64_t offset) const
+{
+    const int64_t count = getFrameCount();
+    const int64_t frameIndex = (int64_t)mFrame + offset * mStep;
+    if (mOptions.loop)
+        return ((frameIndex % count) + count) % count;
+    return frameIndex >= 0 && frameIndex < count ? frameIndex : -1;
+}
+
+void GridStreamer::updateWindow(std::unique_lock<std::mutex>& lock)
+{
+    // Collect the window in order of priority: the current frame, the frames ahead in playback direction, then the frames behind.
+    std::vector<uint32_t> window;
+    window.reserve(1 + mOptions.prefetchFrames + mOptions.keepFrames);
+    window.push_back(mFrame);
+    for (int64_t i = 1; i <= (int64_t)mOptions.prefetchFrames; ++i)
+        if (int64_t frameIndex = getWindowFrame(i); frameIndex >= 0)
+            window.push_back((uint32_t)frameIndex);
+    for (int64_t i = 1; i <= (int64_t)mOptions.keepFrames; ++i)
+        if (int64_t frameIndex = getWindowFrame(-i); frameIndex >= 0)
+            window.push_back((uint32_t)frameIndex);
+
+    // Select the frames to keep until the memory limit is reached. The current frame is always kept.
+    // Frames that are not decoded yet are budgeted with the largest frame size seen so far.
+    for (auto& frame : mFrames)
+        frame.wanted = false;
+    std::vector<uint32_t> wanted;
+    uint64_t memoryUsage = 0;
+    for (uint32_t frameIndex : window)
+    {
+        Frame& frame = mFrames[frameIndex];
+        if (frame.wanted)
+            continue; // Short looping sequences visit frames more than once.
+        bool loaded = frame.state == FrameState::Decoded || frame.state == FrameState::Uploaded;
+        uint64_t size = loaded ? frame.size : mFrameSizeEstimate;
+        if (!wanted.empty() && memoryUsage + size > mOptions.memoryLimit)
+            break;
+        memoryUsage += size;
+        frame.wanted = true;
+        wanted.push_back(frameIndex);
+    }
+
+    // Evict frames outside the window. Queued frames are skipped by their job, frames being decoded are evicted when done.
+    for (auto& frame : mFrames)
+    {
+        if (frame.wanted)
+            continue;
+        if (frame.state == FrameState::Queued)
+            frame.state = FrameState::Empty;
+        else if (frame.state == FrameState::Decoded || frame.state == FrameState::Uploaded)
+            evictFrame(frame);
+    }
+
+    // Queue missing frames, nearest first, below the priority of other work on the job system.
+    // Decoded frames are uploaded a few at a time to bound the cost per call.
+    uint32_t uploadCount = 0;
+    for (size_t i = 0; i < wanted.size(); ++i)
+    {
+        uint32_t frameIndex = wanted[i];
+        Frame& frame = mFrames[frameIndex];
+        if (frame.state == FrameState::Empty)
+        {
+            frame.state = FrameState::Queued;
+            mJobCount++;
+            JobSystem::getShared().submit([this, frameIndex]() { decodeFrame(frameIndex); }, -(int32_t)i);
+        }
+        else if (frame.state == FrameState::Decoded && uploadCount < mOptions.maxUploadsPerFrame)
+        {
+            uploadFrame(frameIndex, lock);
+            uploadCount++;
+        }
+    }
+}
+
+Grid::DecodedGrid GridStreamer::decode(uint32_t frameIndex) const
+{
+    try
+    {
+        return Grid::decodeFromFile(mPaths[frameIndex], mGridname);
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Error when loading grid frame {} from '{}': {}", frameIndex, mPaths[frameIndex], e.what());
+        return {};
+    }
+}
+
+void GridStreamer::storeDecoded(Frame& frame, Grid::DecodedGrid decoded, double decodeTime)
+{
+    mStats.decodeTime += decodeTime;
+    mStats.decodedCount++;
+    if (!decoded)
+        mStats.failedCount++;
+    frame.size = decoded.getSize();
+    frame.decoded = std::move(decoded);
+    frame.state = FrameState::Decoded;
+}
+
+void GridStreamer::waitForJobs(std::unique_lock<std::mutex>& lock)
+{
+    // Pending jobs are run on this thread, as the jobs waited for may be queued behind other work.
+    while (mJobCount > 0)
+    {
+        lock.unlock();
+        bool ranJob = JobSystem::getShared().runPendingJob();
+        lock.lock();
+        if (!ranJob)
+            mCondition.wait_for(lock, std::chrono::milliseconds(1), [&] { return mJobCount == 0; });
+    }
+}
+
+void GridStreamer::decodeFrame(uint32_t frameIndex)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    Frame& frame = mFrames[frameIndex];
+
+    // The frame may have been claimed by setFrame() or left the window while queued.
+    if (frame.state == FrameState::Queued && frame.wanted)
+    {
+        frame.state = FrameState::Decoding;
+        lock.unlock();
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        auto decoded = decode(frameIndex);
+        double decodeTime = getElapsedSeconds(startTime);
+        lock.lock();
+        storeDecoded(frame, std::move(decoded), decodeTime);
+        if (!frame.wanted)
+            evictFrame(frame);
+    }
+
+    // Notify while holding the lock, as the destructor may be waiting for the last job.
+    mJobCount--;
+    mCondition.notify_all();
+}
+
+void GridStreamer::uploadFrame(uint32_t frameIndex, std::unique_lock<std::mutex>& lock)
+{
+    Frame& frame = mFrames[frameIndex];
+    FALCOR_ASSERT(frame.state == FrameState::Decoded);
+
+    // Only the thread calling setFrame() touches decoded frames, so the lock can be released during the upload.
+    // The bricks were converted by the decode job, so this only creates the GPU resources.
+    auto decoded = std::move(frame.decoded);
+    lock.unlock();
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    ref<Grid> pGrid = Grid::createFromDecoded(mpDevice, std::move(decoded));
+    double uploadTime = getElapsedSeconds(startTime);
+    lock.lock();
+
+    mStats.uploadTime += uploadTime;
+    frame.pGrid = pGrid;
+    frame.size = pGrid ? pGrid->getGridHandle().size() + pGrid->getGridSizeInBytes() : 0;
+    frame.state = FrameState::Uploaded;
+    mFrameSizeEstimate = std::max(mFrameSizeEstimate, frame.size);
+}
+
+void GridStreamer::evictFrame(Frame& frame)
+{
+    mStats.evictedCount++;
+    if (!frame.used)
+        mStats.unusedCount++;
+    frame.decoded = Grid::DecodedGrid();
+    frame.pGrid = nullptr;
+    frame.size = 0;
+    frame.used = false;
+    frame.state = FrameState::Empty;
+}
+} // namespace Falcor
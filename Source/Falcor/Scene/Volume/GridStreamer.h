@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Grid.h"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/UI/Gui.h"
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Streams a sequence of grids from files for playback.
+ *
+ * Instead of loading the whole sequence up front, only a sliding window of frames around the current frame is kept in memory.
+ * Upcoming frames are read and converted to bricks on the shared JobSystem, in the direction and at the rate at which playback
+ * advances. Decoded frames only have their GPU resources created on the thread calling setFrame() (i.e. the render thread),
+ * a few per call, so that GPU resources are never created concurrently with rendering.
+ * Frames that fail to load are reported, and the grid of the last frame that loaded is kept in their place.
+ * Frames that leave the window are evicted, and prefetching stops early when the memory limit is reached.
+ */
+class FALCOR_API GridStreamer : public Object
+{
+    FALCOR_OBJECT(GridStreamer)
+public:
+    struct Options
+    {
+        /// Number of frames to prefetch ahead of the current frame, in playback direction.
+        uint32_t prefetchFrames = 8;
+        /// Number of frames behind the current frame to keep in memory.
+        uint32_t keepFrames = 1;
+        /// Maximum number of prefetched frames uploaded to the GPU per call to setFrame().
+        uint32_t maxUploadsPerFrame = 1;
+        /// Maximum host and GPU memory used by the streamed frames in bytes. The current frame is always kept.
+        uint64_t memoryLimit = 2ull << 30;
+        /// Wrap around at the end of the sequence when prefetching (for looping playback).
+        bool loop = true;
+    };
+
+    struct Stats
+    {
+        uint64_t hitCount = 0;      ///< Number of frame changes for which the frame was already uploaded.
+        uint64_t missCount = 0;     ///< Number of frame changes that had to wait for the frame to be decoded or uploaded.
+        double stallTime = 0.0;     ///< Total time spent waiting on missed frames in seconds.
+        double decodeTime = 0.0;    ///< Total time spent decoding frames in seconds (summed over all threads).
+        double uploadTime = 0.0;    ///< Total time spent uploading frames in seconds.
+        uint64_t decodedCount = 0;  ///< Number of decoded frames.
+        uint64_t evictedCount = 0;  ///< Number of evicted frames.
+        uint64_t unusedCount = 0;   ///< Number of frames evicted without ever becoming the current frame.
+        uint64_t failedCount = 0;   ///< Number of frames that failed to load.
+        uint32_t residentCount = 0; ///< Number of frames currently in memory.
+        uint32_t pendingCount = 0;  ///< Number of frames currently queued or being decoded.
+        uint64_t memoryUsage = 0;   ///< Memory used by the frames currently in memory in bytes.
+    };
+
+    /**
+     * Create a grid streamer. No frame is loaded until setFrame() is called.
+     * @param[in] pDevice GPU device.
+     * @param[in] paths File paths of the grids, one per frame (absolute or relative to working directory).
+     * @param[in] gridname Name of the grid to load from each file.
+     * @param[in] options Streaming options.
+     */
+    static ref<GridStreamer> create(ref<Device> pDevice, std::vector<std::filesystem::path> paths, std::string gridname, const Options& options)
+    {
+        return make_ref<GridStreamer>(pDevice, std::move(paths), std::move(gridname), options);
+    }
+
+    GridStreamer(ref<Device> pDevice, std::vector<std::filesystem::path> paths, std::string gridname, const Options& options);
+
+    /**
+     * Destructor. Waits for frames that are currently being decoded.
+     */
+    ~GridStreamer();
+
+    /**
+     * Make a frame the current frame, blocking until it is uploaded if it was not prefetched.
+     * The playback step (direction and rate) is inferred from the change to the previous frame and used to choose
+     * which frames to prefetch next. Jumps by more than kMaxStep frames are treated as seeks and keep the previous step.
+     * @param[in] frame Frame index. Clamped to the sequence length.
+     * @return The grid of the frame. If the frame failed to load, the grid of the last frame that loaded is kept
+     * (nullptr if no frame has loaded yet).
+     */
+    const ref<Grid>& setFrame(uint32_t frame);
+
+    /**
+     * Wait until the frames queued for prefetching are decoded and upload them, regardless of maxUploadsPerFrame.
+     * This makes playback deterministic, e.g. for offline rendering.
+     */
+    void waitForPrefetch();
+
+    /// Get the current frame index.
+    uint32_t getFrame() const { return mFrame; }
+
+    /// Get the grid of the current frame.
+    const ref<Grid>& getGrid() const { return mpGrid; }
+
+    /// Get the number of frames in the sequence.
+    uint32_t getFrameCount() const { return (uint32_t)mPaths.size(); }
+
+    /// Get the playback step inferred from the last frame changes.
+    int32_t getStep() const { return mStep; }
+
+    /// Set the streaming options. Takes effect immediately if a frame is set.
+    void setOptions(const Options& options);
+
+    const Options& getOptions() const { return mOptions; }
+
+    Stats getStats() const;
+
+    void resetStats();
+
+    void renderUI(Gui::Widgets& widget);
+
+    /// Maximum number of frames between two consecutive frames to count as playback rather than a seek.
+    static constexpr int32_t kMaxStep = 8;
+
+private:
+    enum class FrameState
+    {
+        Empty,    ///< Not in memory.
+        Queued,   ///< Queued for decoding on the job system.
+        Decoding, ///< Being decoded.
+        Decoded,  ///< Decoded into host memory, waiting for upload.
+        Uploaded, ///< Uploaded to the GPU (or failed to load, in which case pGrid is nullptr).
+    };
+
+    struct Frame
+    {
+        FrameState state = FrameState::Empty;
+        Grid::DecodedGrid decoded;
+        ref<Grid> pGrid;
+        uint64_t size = 0;    ///< Memory used by the frame in bytes.
+        bool wanted = false;  ///< True if the frame is inside the current window.
+        bool used = false;    ///< True if the frame has been the current frame since it was loaded.
+    };
+
+    /// Return the frame at the given offset from the current frame in steps, or -1 if outside the sequence.
+    int64_t getWindowFrame(int64_t offset) const;
+    /// Update the window around the current frame, evict frames outside it and queue missing frames. Expects the lock to be held.
+    void updateWindow(std::unique_lock<std::mutex>& lock);
+    /// Read a frame and convert it to bricks. Errors are logged and result in an empty decoded grid.
+    Grid::DecodedGrid decode(uint32_t frameIndex) const;
+    /// Store a decoded frame. Expects the lock to be held.
+    void storeDecoded(Frame& frame, Grid::DecodedGrid decoded, double decodeTime);
+    /// Wait for all submitted jobs to finish, running pending jobs on this thread. Expects the lock to be held.
+    void waitForJobs(std::unique_lock<std::mutex>& lock);
+    /// Job decoding a queued frame.
+    void decodeFrame(uint32_t frameIndex);
+    /// Upload a decoded frame. Expects the lock to be held and temporarily releases it.
+    void uploadFrame(uint32_t frameIndex, std::unique_lock<std::mutex>& lock);
+    /// Release the memory of a frame. Expects the lock to be held.
+    void evictFrame(Frame& frame);
+
+    ref<Device> mpDevice;
+    std::vector<std::filesystem::path> mPaths;
+    std::string mGridname;
+    Options mOptions;
+
+    uint32_t mFrame = 0;
+    bool mHasFrame = false;
+    int32_t mStep = 1;
+    ref<Grid> mpGrid;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<Frame> mFrames;
+    uint64_t mFrameSizeEstimate = 0; ///< Largest frame size seen so far, used to budget frames that are not loaded yet.
+    uint32_t mJobCount = 0;          ///< Number of submitted jobs that have not finished yet.
+    Stats mStats;
+};
+} // namespace Falcor
@@ -49,6 +49,35 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+
+        // Enumerate the grid files in a directory, sorted by length first, then alpha-numerically.
+        bool findGridFiles(const std::filesystem::path& path, std::vector<std::filesystem::path>& paths)
+        {
+            if (!std::filesystem::exists(path))
+            {
+                logWarning("'{}' does not exist.", path);
+                return false;
+            }
+            if (!std::filesystem::is_directory(path))
+            {
+                logWarning("'{}' is not a directory.", path);
+                return false;
+            }
+
+            for (auto it : std::filesystem::directory_iterator(path))
+            {
+                if (hasExtension(it.path(), "nvdb") || hasExtension(it.path(), "vdb")) paths.push_back(it.path());
+            }
+
+            auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
+                auto sa = a.string();
+                auto sb = b.string();
+                return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
+            };
+            std::sort(paths.begin(), paths.end(), cmp);
+
+            return true;
+        }
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -80,6 +109,14 @@ namespace Falcor
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
         }
 
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridSlot::Count; ++slotIndex)
+        {
+            if (const auto& pStreamer = mStreamers[slotIndex])
+            {
+                if (auto group = widget.group(slotIndex == (uint32_t)GridSlot::Density ? "Density Streaming" : "Emission Streaming")) pStreamer->renderUI(group);
+            }
+        }
+
         if (const auto& densityGrid = getDensityGrid())
         {
             if (auto group = widget.group("Density Grid")) densityGrid->renderUI(group);
@@ -146,33 +183,22 @@ namespace Falcor
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
     {
-        if (!std::filesystem::exists(path))
-        {
-            logWarning("'{}' does not exist.", path);
-            return 0;
-        }
-        if (!std::filesystem::is_directory(path))
-        {
-            logWarning("'{}' is not a directory.", path);
-            return 0;
-        }
-
-        // Enumerate grid files.
         std::vector<std::filesystem::path> paths;
-        for (auto it : std::filesystem::directory_iterator(path))
-        {
-            if (hasExtension(it.path(), "nvdb") || hasExtension(it.path(), "vdb")) paths.push_back(it.path());
-        }
+        if (!findGridFiles(path, paths)) return 0;
+        return loadGridSequence(slot, paths, gridname, keepEmpty);
+    }
 
-        // Sort by length first, then alpha-numerically.
-        auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
-            auto sa = a.string();
-            auto sb = b.string();
-            return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
-        };
-        std::sort(paths.begin(), paths.end(), cmp);
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridStreamer::Options& options)
+    {
+        setGridStreamer(slot, paths.empty() ? nullptr : GridStreamer::create(mpDevice, paths, gridname, options));
+        return (uint32_t)paths.size();
+    }
 
-        return loadGridSequence(slot, paths, gridname, keepEmpty);
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridStreamer::Options& options)
+    {
+        std::vector<std::filesystem::path> paths;
+        if (!findGridFiles(path, paths)) return 0;
+        return streamGridSequence(slot, paths, gridname, options);
     }
 
     void GridVolume::setGridSequence(GridSlot slot, const GridSequence& grids)
@@ -180,9 +206,10 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        if (mGrids[slotIndex] != grids)
+        if (mGrids[slotIndex] != grids || mStreamers[slotIndex])
         {
             mGrids[slotIndex] = grids;
+            mStreamers[slotIndex] = nullptr;
             updateSequence();
             updateBounds();
             markUpdates(UpdateFlags::GridsChanged);
@@ -197,6 +224,30 @@ namespace Falcor
         return mGrids[slotIndex];
     }
 
+    void GridVolume::setGridStreamer(GridSlot slot, const ref<GridStreamer>& pStreamer)
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        if (mStreamers[slotIndex] != pStreamer || !mGrids[slotIndex].empty())
+        {
+            mGrids[slotIndex].clear();
+            mStreamers[slotIndex] = pStreamer;
+            updateSequence();
+            updateStreamers();
+            updateBounds();
+            markUpdates(UpdateFlags::GridsChanged);
+        }
+    }
+
+    const ref<GridStreamer>& GridVolume::getGridStreamer(GridSlot slot) const
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        return mStreamers[slotIndex];
+    }
+
     void GridVolume::setGrid(GridSlot slot, const ref<Grid>& grid)
     {
         setGridSequence(slot, grid ? GridSequence{grid} : GridSequence{});
@@ -209,6 +260,8 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
+        if (mStreamers[slotIndex]) return mStreamers[slotIndex]->getGrid();
+
         const auto& gridSequence = mGrids[slotIndex];
         uint32_t gridIndex = std::min(mGridFrame, (uint32_t)gridSequence.size() - 1);
         return gridSequence.empty() ? kNullGrid : gridSequence[gridIndex];
@@ -221,6 +274,11 @@ namespace Falcor
         {
             std::copy_if(grids.begin(), grids.end(), std::inserter(uniqueGrids, uniqueGrids.begin()), [] (const auto& grid) { return grid != nullptr; });
         }
+        // Streamed slots only contribute the grid of the current frame.
+        for (const auto& pStreamer : mStreamers)
+        {
+            if (pStreamer && pStreamer->getGrid()) uniqueGrids.insert(pStreamer->getGrid());
+        }
         return std::vector<ref<Grid>>(uniqueGrids.begin(), uniqueGrids.end());
     }
 
@@ -229,6 +287,7 @@ namespace Falcor
         if (mGridFrame != gridFrame)
         {
             mGridFrame = gridFrame;
+            updateStreamers();
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -329,9 +388,19 @@ namespace Falcor
     {
         mGridFrameCount = 1;
         for (const auto& grids : mGrids) mGridFrameCount = std::max(mGridFrameCount, (uint32_t)grids.size());
+        for (const auto& pStreamer : mStreamers) if (pStreamer) mGridFrameCount = std::max(mGridFrameCount, pStreamer->getFrameCount());
         setGridFrame(std::min(mGridFrame, mGridFrameCount - 1));
     }
 
+    void GridVolume::updateStreamers()
+    {
+        // This blocks if the frame was not prefetched in time.
+        for (const auto& pStreamer : mStreamers)
+        {
+            if (pStreamer) pStreamer->setFrame(mGridFrame);
+        }
+    }
+
     void GridVolume::updateBounds()
     {
         AABB bounds;
@@ -422,6 +491,30 @@ namespace Falcor
             "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true
         ); // PYTHONDEPRECATED
 
+        volume.def("streamGridSequence",
+            [](GridVolume& self, GridVolume::GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, uint32_t prefetchFrames, uint64_t memoryLimit)
+            {
+                std::vector<std::filesystem::path> resolvedPaths;
+                for (const auto& path : paths)
+                    resolvedPaths.push_back(getActiveAssetResolver().resolvePath(path));
+                GridStreamer::Options options;
+                options.prefetchFrames = prefetchFrames;
+                options.memoryLimit = memoryLimit;
+                return self.streamGridSequence(slot, resolvedPaths, gridname, options);
+            },
+            "slot"_a, "paths"_a, "gridname"_a, "prefetchFrames"_a = GridStreamer::Options().prefetchFrames, "memoryLimit"_a = GridStreamer::Options().memoryLimit
+        );
+        volume.def("streamGridSequence",
+            [](GridVolume& self, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname, uint32_t prefetchFrames, uint64_t memoryLimit)
+            {
+                GridStreamer::Options options;
+                options.prefetchFrames = prefetchFrames;
+                options.memoryLimit = memoryLimit;
+                return self.streamGridSequence(slot, getActiveAssetResolver().resolvePath(path), gridname, options);
+            },
+            "slot"_a, "path"_a, "gridname"_a, "prefetchFrames"_a = GridStreamer::Options().prefetchFrames, "memoryLimit"_a = GridStreamer::Options().memoryLimit
+        );
+
         m.attr("Volume") = m.attr("GridVolume"); // PYTHONDEPRECATED
     }
 }
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Grid.h"
+#include "GridStreamer.h"
 #include "GridVolumeData.slang"
 #include "Core/Macros.h"
 #include "Utils/Math/AABB.h"
@@ -46,7 +47,8 @@ namespace Falcor
         The absorbing/scattering medium is defined by a density voxel grid and additional parameters.
         The emission is defined by an emission voxel grid and additional parameters.
         Grids are stored in grid slots (density, emission) and can either be static, using one grid per slot,
-        or dynamic, using a sequence of grids per slot.
+        or dynamic, using a sequence of grids per slot. Long sequences can be streamed from disk during playback
+        instead of being loaded up front (see GridStreamer).
     */
     class FALCOR_API GridVolume : public Animatable
     {
@@ -146,14 +148,45 @@ namespace Falcor
         */
         uint32_t loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty = true);
 
+        /** Stream a sequence of grids from files to a grid slot.
+            Only the grids around the current frame are kept in memory, upcoming frames are prefetched in the background.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the streamed sequence.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, const GridStreamer::Options& options = GridStreamer::Options());
+
+        /** Stream a sequence of grids from a directory to a grid slot.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] path Directory containing grid files. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] options Streaming options.
+            \return Returns the length of the streamed sequence.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, const GridStreamer::Options& options = GridStreamer::Options());
+
         /** Set the grid sequence for the specified slot.
         */
         void setGridSequence(GridSlot slot, const GridSequence& grids);
 
         /** Get the grid sequence for the specified slot.
+            Note: This is empty for streamed slots, use getGridStreamer() instead.
         */
         const GridSequence& getGridSequence(GridSlot slot) const;
 
+        /** Set the grid streamer for the specified slot.
+            Note: This will replace any existing grid sequence for that slot.
+        */
+        void setGridStreamer(GridSlot slot, const ref<GridStreamer>& pStreamer);
+
+        /** Get the grid streamer for the specified slot, or nullptr if the slot is not streamed.
+        */
+        const ref<GridStreamer>& getGridStreamer(GridSlot slot) const;
+
         /** Set the grid for the specified slot.
             Note: This will replace any existing grid sequence for that slot with just a single grid.
         */
@@ -284,6 +317,7 @@ namespace Falcor
 
     private:
         void updateSequence();
+        void updateStreamers();
         void updateBounds();
 
         void markUpdates(UpdateFlags updates);
@@ -292,6 +326,7 @@ namespace Falcor
         ref<Device> mpDevice;
         std::string mName;
         std::array<GridSequence, (size_t)GridSlot::Count> mGrids;
+        std::array<ref<GridStreamer>, (size_t)GridSlot::Count> mStreamers;
         uint32_t mGridFrame = 0;
         uint32_t mGridFrameCount = 1;
         double mFrameRate = 30.f;
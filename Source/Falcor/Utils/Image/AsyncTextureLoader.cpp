@@ -26,25 +26,31 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "AsyncTextureLoader.h"
+#include "ImageIO.h"
 #include "Core/API/Device.h"
-#include "Utils/Threading.h"
+#include "Core/Platform/OS.h"
+#include "Utils/JobSystem.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/Timing/Profiler.h"
+#include <chrono>
+#include <cstring>
 
 namespace Falcor
 {
 namespace
 {
 constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
-}
+constexpr uint64_t kMaxDecodedBytes = 1ull << 30; ///< No new loads are started while more decoded data is waiting for upload.
+} // namespace
 
-AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount) : mpDevice(pDevice)
-{
-    runWorkers(threadCount);
-}
+AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t maxConcurrentLoads)
+    : mpDevice(pDevice), mJobSystem(JobSystem::getShared()), mMaxConcurrentLoads(std::max<size_t>(maxConcurrentLoads, 1))
+{}
 
 AsyncTextureLoader::~AsyncTextureLoader()
 {
-    terminateWorkers();
-
+    waitForAllLoads();
     mpDevice->wait();
 }
 
@@ -53,13 +59,14 @@ std::future<ref<Texture>> AsyncTextureLoader::loadMippedFromFiles(
     bool loadAsSrgb,
     ResourceBindFlags bindFlags,
     Bitmap::ImportFlags importFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    int32_t priority,
+    RequestID* pRequestID
 )
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, importFlags, callback});
-    mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    return addRequest(
+        LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, importFlags, callback, {}, priority}, pRequestID
+    );
 }
 
 std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
@@ -68,114 +75,301 @@ std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
     bool loadAsSrgb,
     ResourceBindFlags bindFlags,
     Bitmap::ImportFlags importFlags,
-    LoadCallback callback
+    LoadCallback callback,
+    int32_t priority,
+    RequestID* pRequestID
 )
+{
+    return addRequest(
+        LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, importFlags, callback, {}, priority}, pRequestID
+    );
+}
+
+bool AsyncTextureLoader::setPriority(RequestID requestID, int32_t priority)
 {
     std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, importFlags, callback});
-    mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    auto it = mPendingRequests.find(requestID);
+    if (it == mPendingRequests.end())
+        return false;
+
+    mPendingOrder.erase({-it->second.priority, requestID});
+    it->second.priority = priority;
+    mPendingOrder.insert({-priority, requestID});
+    return true;
+}
+
+bool AsyncTextureLoader::cancel(RequestID requestID)
+{
+    LoadRequest request;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mPendingRequests.find(requestID);
+        if (it == mPendingRequests.end())
+            return false;
+
+        mPendingOrder.erase({-it->second.priority, requestID});
+        request = std::move(it->second);
+        mPendingRequests.erase(it);
+        mStats.cancelledCount++;
+        mCondition.notify_all();
+    }
+
+    request.promise.set_value(nullptr);
+    if (request.callback)
+        request.callback(nullptr);
+    return true;
 }
 
-void AsyncTextureLoader::runWorkers(size_t threadCount)
+size_t AsyncTextureLoader::uploadCompletedLoads()
 {
-    // Create a barrier to synchronize worker threads before issuing a global flush.
-    mFlushBarrier = std::make_shared<Barrier>(
-        threadCount,
-        [&]()
+    std::vector<DecodedLoad> loads;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        loads = std::move(mDecodedLoads);
+        mDecodedLoads.clear();
+    }
+
+    for (auto& load : loads)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        ref<Texture> pTexture;
+        try
         {
-            mpDevice->wait();
-            mFlushPending = false;
-            mUploadCounter = 0;
+            pTexture = upload(load);
         }
-    );
+        catch (const std::exception& e)
+        {
+            logWarning("Error loading texture '{}': {}", load.request.paths[0], e.what());
+        }
+        double uploadTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+
+        // Release the decoded data before calling back, so the next loads can start.
+        uint64_t decodedBytes = load.decodedBytes;
+        load.mips.clear();
+        load.combinedData = {};
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDecodedBytes -= decodedBytes;
+            mStats.uploadTime += uploadTime;
+            if (pTexture)
+            {
+                mStats.uploadedBytes += pTexture->getTextureSizeInBytes();
+                mStats.loadedCount++;
+            }
+            else
+            {
+                mStats.failedCount++;
+            }
+            scheduleJobs();
+        }
+
+        load.request.promise.set_value(pTexture);
+        if (load.request.callback)
+            load.request.callback(pTexture);
+    }
+
+    if (!loads.empty())
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCondition.notify_all();
+    }
+    return loads.size();
+}
+
+void AsyncTextureLoader::waitForAllLoads()
+{
+    // Pending jobs are run on this thread while waiting, as the loads may be queued behind other work.
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mPendingRequests.empty() || mQueuedJobCount > 0 || mRunningJobCount > 0 || !mDecodedLoads.empty())
+    {
+        lock.unlock();
+        bool madeProgress = uploadCompletedLoads() > 0 || mJobSystem.runPendingJob();
+        lock.lock();
+        if (!madeProgress)
+            mCondition.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+AsyncTextureLoader::Stats AsyncTextureLoader::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Stats stats = mStats;
+    stats.pendingCount = mPendingRequests.size();
+    return stats;
+}
+
+std::future<ref<Texture>> AsyncTextureLoader::addRequest(LoadRequest&& request, RequestID* pRequestID)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    RequestID requestID = mNextRequestID++;
+    auto future = request.promise.get_future();
+    mPendingOrder.insert({-request.priority, requestID});
+    mPendingRequests.emplace(requestID, std::move(request));
+    mStats.requestCount++;
+    scheduleJobs();
+
+    if (pRequestID)
+        *pRequestID = requestID;
+    return future;
+}
 
-    for (size_t i = 0; i < threadCount; ++i)
+void AsyncTextureLoader::scheduleJobs()
+{
+    // Each job decodes the highest priority pending request at the time it starts.
+    // This way requests can be reprioritized or cancelled after they have been scheduled.
+    // Decoded data is held until it is uploaded, so no new jobs are started while too much is waiting.
+    while (mQueuedJobCount < mPendingRequests.size() && mQueuedJobCount + mRunningJobCount < mMaxConcurrentLoads &&
+           mDecodedBytes < kMaxDecodedBytes)
     {
-        mThreads.emplace_back(&AsyncTextureLoader::runWorker, this);
+        mQueuedJobCount++;
+        int32_t priority = -mPendingOrder.begin()->first;
+        mJobSystem.submit([this]() { runJob(); }, priority);
     }
 }
 
-void AsyncTextureLoader::runWorker()
+void AsyncTextureLoader::runJob()
 {
-    // This function is the entry point for worker threads.
-    // The workers wait on the load request queue and load a texture when woken up.
-    // To avoid the upload heap growing too large, we synchronize the threads and
-    // issue a global GPU flush at regular intervals.
+    std::unique_lock<std::mutex> lock(mMutex);
+    mQueuedJobCount--;
 
-    while (true)
+    // Requests may have been cancelled since the job was scheduled.
+    if (mPendingOrder.empty())
     {
-        // Wait on condition until more work is ready.
-        std::unique_lock<std::mutex> lock(mMutex);
-        mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
+        mCondition.notify_all();
+        return;
+    }
 
-        // Sync thread if a flush is pending.
-        if (mFlushPending)
-        {
-            lock.unlock();
-            mFlushBarrier->wait();
-            mCondition.notify_one();
-            continue;
-        }
+    RequestID requestID = mPendingOrder.begin()->second;
+    mPendingOrder.erase(mPendingOrder.begin());
+    DecodedLoad load;
+    load.request = std::move(mPendingRequests.at(requestID));
+    mPendingRequests.erase(requestID);
+    mRunningJobCount++;
+    lock.unlock();
 
-        // Terminate thread unless there is more work to do.
-        if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending)
-            break;
+    // Decode the texture (this part is running in parallel).
+    try
+    {
+        decode(load);
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Error loading texture '{}': {}", load.request.paths[0], e.what());
+        load.mips.clear();
+    }
+
+    // Queue the texture for upload. Notify while holding the lock, as the destructor may be waiting for the last job.
+    lock.lock();
+    mRunningJobCount--;
+    mDecodedBytes += load.decodedBytes;
+    mDecodedLoads.push_back(std::move(load));
+    scheduleJobs();
+    mCondition.notify_all();
+}
 
-        // Go back waiting if queue is currently empty.
-        if (mLoadRequestQueue.empty())
-            continue;
+void AsyncTextureLoader::decode(DecodedLoad& load)
+{
+    FALCOR_PROFILE_CPU(mpDevice->getProfiler(), "AsyncTextureLoader::decode");
 
-        // Pop next load request from queue.
-        auto request = std::move(mLoadRequestQueue.front());
-        mLoadRequestQueue.pop();
+    const LoadRequest& request = load.request;
 
-        lock.unlock();
+    // DDS files are loaded directly into a texture on upload, so they are accounted as uploads only.
+    if (request.paths.size() == 1 && hasExtension(request.paths[0], "dds"))
+        return;
 
-        // Load the textures (this part is running in parallel).
-        ref<Texture> pTexture;
-        if (request.paths.size() == 1)
-        {
-            pTexture = Texture::createFromFile(
-                mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags, request.importFlags
-            );
-        }
+    // Decode all mip levels.
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    auto& mips = load.mips;
+    for (const auto& mipPath : request.paths)
+    {
+        Bitmap::UniqueConstPtr pBitmap;
+        if (!std::filesystem::exists(mipPath))
+            logWarning("Error when loading image file. File '{}' does not exist.", mipPath);
+        else if (hasExtension(mipPath, "dds"))
+            pBitmap = ImageIO::loadBitmapFromDDS(mipPath);
         else
+            pBitmap = Bitmap::createFromFile(mipPath, true, request.importFlags);
+        if (!pBitmap)
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags, request.importFlags);
+            if (request.paths.size() > 1)
+                logWarning("Error loading mip {}. Loading failed for image file '{}'.", mips.size(), mipPath);
+            break;
         }
+        load.decodedBytes += pBitmap->getSize();
+        mips.push_back(std::move(pBitmap));
+    }
+    double decodeTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
 
-        request.promise.set_value(pTexture);
-
-        if (request.callback)
+    // Convert to texture data. Explicit mips must match in format and halve in size, and are combined into a single buffer.
+    startTime = CpuTimer::getCurrentTimePoint();
+    for (size_t mip = 1; mip < mips.size(); ++mip)
+    {
+        const Bitmap& prev = *mips[mip - 1];
+        const Bitmap& curr = *mips[mip];
+        if (curr.getFormat() != prev.getFormat() || std::max(prev.getWidth() / 2, 1u) != curr.getWidth() ||
+            std::max(prev.getHeight() / 2, 1u) != curr.getHeight())
         {
-            request.callback(pTexture);
+            logWarning("Error loading mip {} from file '{}'. Mips must match in format and halve in size.", mip, request.paths[mip]);
+            mips.resize(mip);
+            break;
         }
+    }
 
-        lock.lock();
-
-        // Issue a global flush if necessary.
-        // TODO: It would be better to check the size of the upload heap instead.
-        if (!mTerminate && pTexture != nullptr && ++mUploadCounter >= kUploadsPerFlush)
+    if (mips.size() > 1)
+    {
+        size_t offset = 0;
+        for (const auto& pMip : mips)
+            offset += pMip->getSize();
+        load.combinedData.resize(offset);
+        offset = 0;
+        for (const auto& pMip : mips)
         {
-            mFlushPending = true;
-            mCondition.notify_all();
+            std::memcpy(load.combinedData.data() + offset, pMip->getData(), pMip->getSize());
+            offset += pMip->getSize();
         }
-
-        mCondition.notify_one();
     }
+    double convertTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.decodedBytes += load.decodedBytes;
+    mStats.decodeTime += decodeTime;
+    mStats.convertTime += convertTime;
 }
 
-void AsyncTextureLoader::terminateWorkers()
+ref<Texture> AsyncTextureLoader::upload(const DecodedLoad& load)
 {
+    FALCOR_PROFILE_CPU(mpDevice->getProfiler(), "AsyncTextureLoader::upload");
+
+    const LoadRequest& request = load.request;
+    const std::filesystem::path& path = request.paths[0];
+
+    ref<Texture> pTexture;
+    if (request.paths.size() == 1 && hasExtension(path, "dds"))
     {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mTerminate = true;
+        pTexture = Texture::createFromFile(mpDevice, path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+    }
+    else if (!load.mips.empty())
+    {
+        const auto& mips = load.mips;
+        ResourceFormat format = request.loadAsSRGB ? linearToSrgbFormat(mips[0]->getFormat()) : mips[0]->getFormat();
+        uint32_t mipLevels = mips.size() > 1 ? (uint32_t)mips.size() : (request.generateMipLevels ? Texture::kMaxPossible : 1);
+        const void* pData = mips.size() > 1 ? load.combinedData.data() : mips[0]->getData();
+        pTexture = mpDevice->createTexture2D(mips[0]->getWidth(), mips[0]->getHeight(), format, 1, mipLevels, pData, request.bindFlags);
+        if (pTexture)
+        {
+            pTexture->setSourcePath(path);
+            pTexture->setImportFlags(request.importFlags);
+        }
     }
 
-    mCondition.notify_all();
+    // Issue a global flush if necessary.
+    // TODO: It would be better to check the size of the upload heap instead.
+    if (pTexture && ++mUploadCounter >= kUploadsPerFlush)
+    {
+        mpDevice->wait();
+        mUploadCounter = 0;
+    }
 
-    for (auto& thread : mThreads)
-        thread.join();
+    return pTexture;
 }
 } // namespace Falcor
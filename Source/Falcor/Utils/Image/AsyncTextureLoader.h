@@ -34,33 +34,65 @@
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <map>
 #include <mutex>
-#include <queue>
+#include <set>
 #include <thread>
 #include <vector>
 #include <fstd/span.h>
 
 namespace Falcor
 {
-class Barrier;
+class JobSystem;
 
 /**
- * Utility class to load textures asynchronously using multiple worker threads.
+ * Utility class to load textures asynchronously on the shared job system.
+ *
+ * Requests are started in priority order (highest first, then in submission order).
+ * Pending requests can be reprioritized or cancelled. Each load is split into three stages:
+ * decode (reading and decoding the image files), convert (preparing the texture data) and upload.
+ * Decode and convert run on the job system. Falcor doesn't support parallel GPU work submission, so uploads are
+ * done by uploadCompletedLoads() or waitForAllLoads() on the thread that owns the device. Futures and callbacks
+ * are fulfilled by these calls, or by cancel(). The GPU is flushed at regular intervals to keep the upload heap from growing.
  */
 class FALCOR_API AsyncTextureLoader
 {
 public:
     using LoadCallback = std::function<void(ref<Texture> pTexture)>;
+    using RequestID = uint64_t;
+
+    static constexpr RequestID kInvalidRequestID = 0;
+
+    struct Stats
+    {
+        uint64_t requestCount = 0;   ///< Number of load requests.
+        uint64_t loadedCount = 0;    ///< Number of textures loaded.
+        uint64_t failedCount = 0;    ///< Number of textures that failed to load.
+        uint64_t cancelledCount = 0; ///< Number of cancelled requests.
+        uint64_t pendingCount = 0;   ///< Number of requests that have not started yet.
+        uint64_t decodedBytes = 0;   ///< Size of decoded image data in bytes.
+        uint64_t uploadedBytes = 0;  ///< Size of uploaded texture data in bytes.
+        double decodeTime = 0.0;     ///< Time spent decoding in seconds, summed over all threads.
+        double convertTime = 0.0;    ///< Time spent converting in seconds, summed over all threads.
+        double uploadTime = 0.0;     ///< Time spent uploading in seconds, summed over all threads.
+
+        /// Decode throughput in bytes of decoded data per second and thread.
+        double getDecodeThroughput() const { return decodeTime > 0.0 ? decodedBytes / decodeTime : 0.0; }
+        /// Convert throughput in bytes of decoded data per second and thread.
+        double getConvertThroughput() const { return convertTime > 0.0 ? decodedBytes / convertTime : 0.0; }
+        /// Upload throughput in bytes per second.
+        double getUploadThroughput() const { return uploadTime > 0.0 ? uploadedBytes / uploadTime : 0.0; }
+    };
 
     /**
      * Constructor.
-     * @param[in] threadCount Number of worker threads.
+     * @param[in] maxConcurrentLoads Maximum number of textures loaded concurrently.
      */
-    AsyncTextureLoader(ref<Device> pDevice, size_t threadCount = std::thread::hardware_concurrency());
+    AsyncTextureLoader(ref<Device> pDevice, size_t maxConcurrentLoads = std::thread::hardware_concurrency());
 
     /**
      * Destructor.
-     * Blocks until all threads have terminated.
+     * Blocks until all requests have finished, see waitForAllLoads().
      */
     ~AsyncTextureLoader();
 
@@ -70,15 +102,19 @@ public:
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] importFlags Optional flags for the file import.
-     * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] callback Function called after the texture load has finished or was cancelled.
+     * @param[in] priority Request priority. Higher priority requests are started first.
+     * @param[out] pRequestID Optional ID of the request, for use with setPriority() and cancel().
+     * @return A future to a new texture, or nullptr if the texture failed to load or the request was cancelled.
      */
     std::future<ref<Texture>> loadMippedFromFiles(
         fstd::span<const std::filesystem::path> paths,
         bool loadAsSRGB,
         ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        int32_t priority = 0,
+        RequestID* pRequestID = nullptr
     );
 
     /**
@@ -88,8 +124,10 @@ public:
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] importFlags Optional flags for the file import.
-     * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] callback Function called after the texture load has finished or was cancelled.
+     * @param[in] priority Request priority. Higher priority requests are started first.
+     * @param[out] pRequestID Optional ID of the request, for use with setPriority() and cancel().
+     * @return A future to a new texture, or nullptr if the texture failed to load or the request was cancelled.
      */
     std::future<ref<Texture>> loadFromFile(
         const std::filesystem::path& path,
@@ -97,14 +135,40 @@ public:
         bool loadAsSRGB,
         ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
-        LoadCallback callback = {}
+        LoadCallback callback = {},
+        int32_t priority = 0,
+        RequestID* pRequestID = nullptr
     );
 
-private:
-    void runWorkers(size_t threadCount);
-    void runWorker();
-    void terminateWorkers();
+    /**
+     * Change the priority of a pending request.
+     * @return True if the request is still pending.
+     */
+    bool setPriority(RequestID requestID, int32_t priority);
+
+    /**
+     * Cancel a pending request. The future is fulfilled and the callback is called with nullptr.
+     * Requests that have already started are not affected.
+     * @return True if the request was cancelled.
+     */
+    bool cancel(RequestID requestID);
 
+    /**
+     * Upload the textures of all requests that have finished decoding, and call their callbacks.
+     * Must be called from the thread that owns the device.
+     * @return Number of finished requests.
+     */
+    size_t uploadCompletedLoads();
+
+    /**
+     * Block until all requests have finished, uploading their textures on the calling thread.
+     * Must be called from the thread that owns the device.
+     */
+    void waitForAllLoads();
+
+    Stats getStats() const;
+
+private:
     struct LoadRequest
     {
         std::vector<std::filesystem::path> paths;
@@ -114,20 +178,41 @@ private:
         Bitmap::ImportFlags importFlags;
         LoadCallback callback;
         std::promise<ref<Texture>> promise;
+        int32_t priority;
     };
 
+    /// Request that has finished decoding and is waiting for its upload.
+    struct DecodedLoad
+    {
+        LoadRequest request;
+        std::vector<Bitmap::UniqueConstPtr> mips; ///< Decoded mips. Empty if decoding failed or for DDS files, which are loaded on upload.
+        std::vector<uint8_t> combinedData;         ///< Data of all mips combined into a single buffer if there is more than one mip.
+        uint64_t decodedBytes = 0;                 ///< Size of decoded image data in bytes.
+    };
+
+    std::future<ref<Texture>> addRequest(LoadRequest&& request, RequestID* pRequestID);
+    void scheduleJobs();
+    void runJob();
+    void decode(DecodedLoad& load);
+    ref<Texture> upload(const DecodedLoad& load);
+
     ref<Device> mpDevice;
+    JobSystem& mJobSystem;
+    const size_t mMaxConcurrentLoads;
 
-    std::mutex mMutex;                      ///< Mutex for synchronizing access to shared resources.
-    std::condition_variable mCondition;     ///< Condition variable for workers to wait on.
-    std::shared_ptr<Barrier> mFlushBarrier; ///< Barrier for flushing the GPU to upload textures.
-    std::vector<std::thread> mThreads;      ///< Worker threads.
+    mutable std::mutex mMutex;          ///< Mutex for synchronizing access to shared resources.
+    std::condition_variable mCondition; ///< Condition variable to wait on for all requests to finish.
 
     // Internal state. Do not access outside of critical section.
-    std::queue<LoadRequest> mLoadRequestQueue; ///< Texture loading request queue.
+    std::map<RequestID, LoadRequest> mPendingRequests;     ///< Requests that have not started yet.
+    std::set<std::pair<int32_t, RequestID>> mPendingOrder; ///< Pending requests ordered by (-priority, ID).
+    RequestID mNextRequestID = kInvalidRequestID + 1;      ///< ID of the next request.
+    size_t mQueuedJobCount = 0;                            ///< Number of jobs submitted to the job system that have not started yet.
+    size_t mRunningJobCount = 0;                           ///< Number of jobs currently decoding a texture.
+    std::vector<DecodedLoad> mDecodedLoads;                ///< Requests that are waiting for their upload.
+    uint64_t mDecodedBytes = 0;                            ///< Size of decoded image data waiting for upload in bytes.
+    Stats mStats;                                          ///< Load statistics.
 
-    bool mTerminate = false;     ///< Flag to terminate worker threads.
-    bool mFlushPending = false;  ///< Flag to indicate a GPU flush is pending.
-    uint32_t mUploadCounter = 0; ///< Counter to issue a flush every few uploads.
+    uint32_t mUploadCounter = 0; ///< Counter to issue a flush every few uploads. Only accessed by the uploading thread.
 };
 } // namespace Falcor
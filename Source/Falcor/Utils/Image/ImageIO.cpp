@@ -331,11 +331,18 @@ void setImage(
 }
 
 // Saves image data to a DDS file using the specified compression mode. Optionally generates mips.
-void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::CompressionMode mode, bool generateMips)
+// If isSrgb is set, generated mips are filtered in linear space.
+void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::CompressionMode mode, bool generateMips, bool isSrgb = false)
 {
     nvtt::CompressionOptions compressionOptions;
     nvtt::Format format = convertModeToNvttFormat(mode);
     compressionOptions.setFormat(format);
+
+    // BC4, BC5 and BC6 have no sRGB variants, so their data is always stored and filtered as linear.
+    bool hasSrgbVariant =
+        format != nvtt::Format::Format_BC4 && format != nvtt::Format::Format_BC5 && format != nvtt::Format::Format_BC6S;
+    isSrgb = isSrgb && hasSrgbVariant;
+
     if (format == nvtt::Format::Format_RGBA && !isCompressedFormat(image.format))
     {
         if (getFormatType(image.format) == FormatType::Float)
@@ -364,7 +371,7 @@ void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::Co
     {
         outputOptions.setContainer(nvtt::Container::Container_DDS10);
     }
-    outputOptions.setSrgbFlag(isSrgbFormat(image.format));
+    outputOptions.setSrgbFlag(hasSrgbVariant && (isSrgb || isSrgbFormat(image.format)));
 
     nvtt::Context context;
     if (!context.outputHeader(
@@ -389,9 +396,24 @@ void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::Co
         {
             FALCOR_THROW("Failed to compress file.");
         }
+
+        // Filtering sRGB encoded data directly darkens the mips, so keep a linear copy to build the mips from.
+        nvtt::Surface linear;
+        if (generateMips && isSrgb)
+        {
+            linear = tmp;
+            linear.toLinearFromSrgb();
+        }
+
         for (uint32_t m = 1; m < image.mipLevels; ++m)
         {
-            if (generateMips)
+            if (generateMips && isSrgb)
+            {
+                linear.buildNextMipmap(nvtt::MipmapFilter::MipmapFilter_Box);
+                tmp = linear;
+                tmp.toSrgb();
+            }
+            else if (generateMips)
             {
                 tmp.buildNextMipmap(nvtt::MipmapFilter::MipmapFilter_Box);
             }
@@ -619,7 +641,7 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
     return pTex;
 }
 
-void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode, bool generateMips)
+void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode, bool generateMips, bool isSrgb)
 {
     if (!hasExtension(path, "dds"))
     {
@@ -687,7 +709,7 @@ void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap,
             mode = convertFormatToMode(image.format);
         }
 
-        exportDDS(path, image, mode, generateMips);
+        exportDDS(path, image, mode, generateMips, isSrgb);
     }
     catch (const RuntimeError& e)
     {
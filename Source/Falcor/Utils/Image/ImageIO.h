@@ -97,12 +97,15 @@ public:
      * @param[in] bitmap Bitmap object to save.
      * @param[in] mode Block compression mode. By default, will save data as-is and will not decompress if already compressed.
      * @param[in] if true, generate and save full mipmap chain; requires the caller to have initialized COM.
+     * @param[in] isSrgb If true, the bitmap holds sRGB encoded color. Generated mips are filtered in linear space and the file is
+     * flagged as sRGB.
      */
     static void saveToDDS(
         const std::filesystem::path& path,
         const Bitmap& bitmap,
         CompressionMode mode = CompressionMode::None,
-        bool generateMips = false
+        bool generateMips = false,
+        bool isSrgb = false
     );
 
     /**
@@ -0,0 +1,250 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureCookCache.h"
+#include "Core/Error.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include "Utils/TaskManager.h"
+#include <functional>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+/// Version of the cooked texture layout. Increment when the cooking process changes to invalidate existing cache entries.
+const uint32_t kCookVersion = 2;
+
+/// Job system priority of cook jobs. Cooking only benefits later loads, so it yields to other work.
+const int32_t kCookPriority = -1;
+
+/// Cache key from the SHA-1 digest of the source file contents and the cook parameters.
+std::string computeKeyFromDigest(const SHA1::MD& digest, const TextureCookCache::CookParams& params)
+{
+    SHA1 sha1;
+    sha1.update(kCookVersion);
+    sha1.update(params.generateMipLevels);
+    sha1.update(params.loadAsSRGB);
+    sha1.update(uint32_t(params.importFlags));
+    sha1.update(uint32_t(params.compression));
+    sha1.update(digest.data(), digest.size());
+    return SHA1::toString(sha1.finalize());
+}
+} // namespace
+
+TextureCookCache::TextureCookCache(const std::filesystem::path& cacheDirectory) : mCacheDirectory(cacheDirectory)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(mCacheDirectory, ec);
+    if (ec)
+        FALCOR_THROW("Failed to create texture cook cache directory '{}': {}", mCacheDirectory, ec.message());
+
+    mpTaskManager = std::make_unique<TaskManager>(false, kCookPriority);
+}
+
+TextureCookCache::~TextureCookCache()
+{
+    mShutdown = true;
+    waitForCooking();
+}
+
+std::filesystem::path TextureCookCache::lookup(const std::filesystem::path& sourcePath, const CookParams& params)
+{
+    if (mShutdown)
+        return {};
+
+    SHA1::MD digest;
+    if (!getSourceHash(sourcePath, digest))
+        return {};
+    std::string key = computeKeyFromDigest(digest, params);
+
+    std::filesystem::path cookedPath = getCookedPath(key);
+    if (std::filesystem::exists(cookedPath))
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.hitCount++;
+        return cookedPath;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.missCount++;
+
+    // Schedule cooking unless a job for the same content is already scheduled (or has failed).
+    if (mScheduledKeys.insert(key).second)
+    {
+        mStats.pendingCount++;
+        mpTaskManager->addTask([this, sourcePath, params, key, cookedPath]() { cook(sourcePath, params, key, cookedPath); });
+    }
+
+    return {};
+}
+
+void TextureCookCache::waitForCooking()
+{
+    mpTaskManager->finish(nullptr);
+}
+
+TextureCookCache::Stats TextureCookCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+bool TextureCookCache::isCookable(const std::filesystem::path& sourcePath, ResourceBindFlags bindFlags)
+{
+    return !hasExtension(sourcePath, "dds") && bindFlags == ResourceBindFlags::ShaderResource;
+}
+
+ImageIO::CompressionMode TextureCookCache::selectCompressionMode(
+    ResourceFormat format,
+    uint32_t width,
+    uint32_t height,
+    ImageIO::CompressionMode requested
+)
+{
+    using CompressionMode = ImageIO::CompressionMode;
+
+    if (requested == CompressionMode::None || isCompressedFormat(format))
+        return CompressionMode::None;
+
+    // The DX spec requires the base level of block compressed textures to be a multiple of 4.
+    if (width % 4 != 0 || height % 4 != 0)
+        return CompressionMode::None;
+
+    // Two channel formats are only supported by BC5 (see ImageIO::saveToDDS()).
+    uint32_t channelCount = getFormatChannelCount(format);
+    if (channelCount == 2)
+        return CompressionMode::BC5;
+
+    bool isFloat = getFormatType(format) == FormatType::Float;
+    if (requested == CompressionMode::BC4 || requested == CompressionMode::BC5)
+        return requested;
+    if (isFloat)
+        return CompressionMode::BC6;
+    if (channelCount == 1)
+        return CompressionMode::BC4;
+
+    return requested;
+}
+
+std::string TextureCookCache::computeKey(const void* data, size_t size, const CookParams& params)
+{
+    return computeKeyFromDigest(SHA1::compute(data, size), params);
+}
+
+bool TextureCookCache::getSourceHash(const std::filesystem::path& sourcePath, SHA1::MD& digest)
+{
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(sourcePath, ec);
+    if (ec || size == 0)
+        return false;
+    std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mSourceHashes.find(sourcePath);
+        if (it != mSourceHashes.end() && it->second.size == size && it->second.lastWriteTime == lastWriteTime)
+        {
+            digest = it->second.digest;
+            return true;
+        }
+    }
+
+    // Hash the source file contents. This is much cheaper than decoding the image.
+    {
+        MemoryMappedFile file(sourcePath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen() || file.getSize() == 0)
+            return false;
+        digest = SHA1::compute(file.getData(), file.getSize());
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSourceHashes[sourcePath] = SourceHash{size, lastWriteTime, digest};
+    return true;
+}
+
+void TextureCookCache::cook(
+    const std::filesystem::path& sourcePath,
+    const CookParams& params,
+    const std::string& key,
+    const std::filesystem::path& cookedPath
+)
+{
+    // Write to a temporary file and move it in place when done, so lookups never see partially written files.
+    std::filesystem::path tempPath =
+        mCacheDirectory / fmt::format("{}.{}.tmp.dds", key, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    bool success = false;
+    uint64_t cookedBytes = 0;
+    if (!mShutdown)
+    {
+        try
+        {
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(sourcePath, true, params.importFlags);
+            if (!pBitmap)
+                FALCOR_THROW("Failed to load image.");
+
+            ImageIO::CompressionMode mode =
+                selectCompressionMode(pBitmap->getFormat(), pBitmap->getWidth(), pBitmap->getHeight(), params.compression);
+            ImageIO::saveToDDS(tempPath, *pBitmap, mode, params.generateMipLevels, params.loadAsSRGB);
+
+            std::filesystem::rename(tempPath, cookedPath);
+            cookedBytes = std::filesystem::file_size(cookedPath);
+            success = true;
+
+            logDebug("Cooked texture '{}' to '{}'.", sourcePath, cookedPath);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to cook texture '{}': {}", sourcePath, e.what());
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.pendingCount--;
+    if (success)
+    {
+        mStats.cookedCount++;
+        mStats.cookedBytes += cookedBytes;
+    }
+    else if (!mShutdown)
+    {
+        mStats.failedCount++;
+    }
+}
+
+std::filesystem::path TextureCookCache::getCookedPath(const std::string& key) const
+{
+    return mCacheDirectory / (key + ".dds");
+}
+} // namespace Falcor
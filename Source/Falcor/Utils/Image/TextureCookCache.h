@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Core/API/Resource.h"
+#include "Utils/CryptoUtils.h"
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace Falcor
+{
+class TaskManager;
+
+/**
+ * Content-addressed cache of cooked textures.
+ *
+ * Cooking decodes a source image (PNG, JPG, EXR, ...) once, builds the mip chain on the CPU (filtered in linear space
+ * for sRGB images), block compresses all mips and stores the result as a DDS file. Cooked files are named by the SHA-1
+ * of the source file contents and the cook parameters, so renamed or copied source files share a cache entry and
+ * modified files are cooked again. The content hash of each source file is remembered for the lifetime of the cache
+ * and only recomputed when the file size or modification time changes.
+ *
+ * Lookups never block on cooking. On a miss, a cook job is scheduled on a background TaskManager and the caller loads
+ * the source image as usual. Later lookups return the cooked file.
+ */
+class FALCOR_API TextureCookCache
+{
+public:
+    /// Parameters affecting the cooked result.
+    struct CookParams
+    {
+        bool generateMipLevels = true;                                         ///< Cook the full mip chain.
+        bool loadAsSRGB = false;                                               ///< Image holds sRGB encoded color.
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None;           ///< Flags for importing the source image.
+        ImageIO::CompressionMode compression = ImageIO::CompressionMode::None; ///< Requested compression, see selectCompressionMode().
+    };
+
+    struct Stats
+    {
+        uint64_t hitCount = 0;        ///< Number of lookups that found a cooked texture.
+        uint64_t missCount = 0;       ///< Number of lookups that did not find a cooked texture.
+        uint64_t cookedCount = 0;     ///< Number of textures cooked by this cache instance.
+        uint64_t failedCount = 0;     ///< Number of textures that failed to cook.
+        uint64_t pendingCount = 0;    ///< Number of scheduled or running cook jobs.
+        uint64_t cookedBytes = 0;     ///< Total size in bytes of the DDS files written by this cache instance.
+    };
+
+    /**
+     * Constructor.
+     * @param[in] cacheDirectory Directory for storing cooked textures. Created if it doesn't exist.
+     */
+    TextureCookCache(const std::filesystem::path& cacheDirectory);
+
+    /**
+     * Destructor.
+     * Cook jobs that have not started yet are skipped. Blocks until running jobs have finished.
+     */
+    ~TextureCookCache();
+
+    const std::filesystem::path& getCacheDirectory() const { return mCacheDirectory; }
+
+    /**
+     * Look up the cooked version of a texture.
+     * If the texture is not cooked yet, a background cook job is scheduled (once per cache entry).
+     * @param[in] sourcePath Full path of the source image.
+     * @param[in] params Cook parameters.
+     * @return Path of the cooked DDS file, or an empty path if not available.
+     */
+    std::filesystem::path lookup(const std::filesystem::path& sourcePath, const CookParams& params);
+
+    /**
+     * Block until all scheduled cook jobs have finished.
+     */
+    void waitForCooking();
+
+    Stats getStats() const;
+
+    /**
+     * Check if a texture can be cooked.
+     * DDS files are loaded directly. Block compressed textures can only be bound as shader resources.
+     */
+    static bool isCookable(const std::filesystem::path& sourcePath, ResourceBindFlags bindFlags);
+
+    /**
+     * Select the compression mode for an image.
+     * HDR images use BC6 instead of BC7, one and two channel images use BC4 and BC5. Images whose dimensions are not a
+     * multiple of 4 are stored uncompressed, as compressing them would require cropping.
+     * @param[in] format Format of the decoded source image.
+     * @param[in] width Image width.
+     * @param[in] height Image height.
+     * @param[in] requested Requested compression mode.
+     * @return Compression mode to use.
+     */
+    static ImageIO::CompressionMode selectCompressionMode(
+        ResourceFormat format,
+        uint32_t width,
+        uint32_t height,
+        ImageIO::CompressionMode requested
+    );
+
+    /**
+     * Compute the cache key of a texture.
+     * @param[in] data Source file contents.
+     * @param[in] size Size of source file contents in bytes.
+     * @param[in] params Cook parameters.
+     * @return Cache key (40-character hexadecimal string).
+     */
+    static std::string computeKey(const void* data, size_t size, const CookParams& params);
+
+private:
+    /// Content hash of a source file, valid as long as the file size and modification time are unchanged.
+    struct SourceHash
+    {
+        uintmax_t size = 0;
+        std::filesystem::file_time_type lastWriteTime;
+        SHA1::MD digest;
+    };
+
+    bool getSourceHash(const std::filesystem::path& sourcePath, SHA1::MD& digest);
+    void cook(
+        const std::filesystem::path& sourcePath,
+        const CookParams& params,
+        const std::string& key,
+        const std::filesystem::path& cookedPath
+    );
+    std::filesystem::path getCookedPath(const std::string& key) const;
+
+    std::filesystem::path mCacheDirectory;
+    std::unique_ptr<TaskManager> mpTaskManager;
+    std::atomic<bool> mShutdown{false};
+
+    mutable std::mutex mMutex;
+    std::set<std::string> mScheduledKeys; ///< Keys that have been scheduled for cooking by this instance (including failed ones).
+    std::map<std::filesystem::path, SourceHash> mSourceHashes; ///< Content hashes of looked up source files.
+    Stats mStats;
+};
+} // namespace Falcor
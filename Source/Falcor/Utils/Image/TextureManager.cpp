@@ -26,30 +26,232 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureManager.h"
+#include "TextureCookCache.h"
+#include "TextureResidencyManager.h"
 #include "Core/AssetResolver.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+#include "Utils/JobSystem.h"
 #include "Utils/Logger.h"
 #include "Utils/NumericRange.h"
+#include "Utils/Math/ScalarTypes.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <execution>
 
-// Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
-// Until then `TextureManager` should only called from the main thread.
-#define DISABLE_ASYNC_TEXTURE_LOADER
-
 namespace Falcor
 {
 namespace
 {
 const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
 static_assert(TextureManager::CpuTextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+/**
+ * Texel layout supported by the CPU mip generator for streamed textures.
+ */
+struct TexelLayout
+{
+    enum class Type
+    {
+        Unorm8,
+        Float16,
+        Float32,
+    };
+
+    Type type;
+    uint32_t channelCount;
+    bool isSrgb;
+};
+
+/**
+ * Get the texel layout of a format, or false if mips can't be generated on the CPU for the format.
+ */
+bool getTexelLayout(ResourceFormat format, TexelLayout& layout)
+{
+    if (isCompressedFormat(format) || isDepthStencilFormat(format))
+        return false;
+
+    uint32_t channelCount = getFormatChannelCount(format);
+    uint32_t bits = getNumChannelBits(format, 0);
+    for (uint32_t i = 1; i < channelCount; ++i)
+    {
+        if (getNumChannelBits(format, i) != bits)
+            return false;
+    }
+    if (channelCount == 0 || channelCount * bits != getFormatBytesPerBlock(format) * 8)
+        return false;
+
+    FormatType type = getFormatType(format);
+    if ((type == FormatType::Unorm || type == FormatType::UnormSrgb) && bits == 8)
+        layout.type = TexelLayout::Type::Unorm8;
+    else if (type == FormatType::Float && bits == 16)
+        layout.type = TexelLayout::Type::Float16;
+    else if (type == FormatType::Float && bits == 32)
+        layout.type = TexelLayout::Type::Float32;
+    else
+        return false;
+
+    layout.channelCount = channelCount;
+    layout.isSrgb = isSrgbFormat(format);
+    return true;
+}
+
+float srgbToLinear(float v)
+{
+    return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float v)
+{
+    return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.f / 2.4f) - 0.055f;
+}
+
+/**
+ * Generate the next mip level with a 2x2 box filter. Odd dimensions clamp to the last row/column.
+ * sRGB color channels are filtered in linear space.
+ */
+void generateMip(
+    const TexelLayout& layout,
+    const uint8_t* pSrc,
+    uint32_t srcWidth,
+    uint32_t srcHeight,
+    uint8_t* pDst,
+    uint32_t dstWidth,
+    uint32_t dstHeight
+)
+{
+    static const std::array<float, 256> kSrgbToLinear = []()
+    {
+        std::array<float, 256> table;
+        for (uint32_t i = 0; i < 256; ++i)
+            table[i] = srgbToLinear(i / 255.f);
+        return table;
+    }();
+
+    const uint32_t channelCount = layout.channelCount;
+    const uint32_t colorChannelCount = layout.isSrgb ? std::min(channelCount, 3u) : 0;
+
+    auto load = [&](uint32_t x, uint32_t y, uint32_t c) -> float
+    {
+        size_t index = ((size_t)y * srcWidth + x) * channelCount + c;
+        switch (layout.type)
+        {
+        case TexelLayout::Type::Unorm8:
+            return c < colorChannelCount ? kSrgbToLinear[pSrc[index]] : pSrc[index] / 255.f;
+        case TexelLayout::Type::Float16:
+            return float(float16_t::fromBits(reinterpret_cast<const uint16_t*>(pSrc)[index]));
+        default:
+            return reinterpret_cast<const float*>(pSrc)[index];
+        }
+    };
+
+    auto store = [&](uint32_t x, uint32_t y, uint32_t c, float v)
+    {
+        size_t index = ((size_t)y * dstWidth + x) * channelCount + c;
+        switch (layout.type)
+        {
+        case TexelLayout::Type::Unorm8:
+            v = std::clamp(c < colorChannelCount ? linearToSrgb(v) : v, 0.f, 1.f);
+            pDst[index] = (uint8_t)(v * 255.f + 0.5f);
+            break;
+        case TexelLayout::Type::Float16:
+            reinterpret_cast<uint16_t*>(pDst)[index] = float16_t(v).toBits();
+            break;
+        default:
+            reinterpret_cast<float*>(pDst)[index] = v;
+            break;
+        }
+    };
+
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        uint32_t y0 = std::min(2 * y, srcHeight - 1);
+        uint32_t y1 = std::min(2 * y + 1, srcHeight - 1);
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            uint32_t x0 = std::min(2 * x, srcWidth - 1);
+            uint32_t x1 = std::min(2 * x + 1, srcWidth - 1);
+            for (uint32_t c = 0; c < channelCount; ++c)
+            {
+                float v = load(x0, y0, c) + load(x1, y0, c) + load(x0, y1, c) + load(x1, y1, c);
+                store(x, y, c, 0.25f * v);
+            }
+        }
+    }
+}
+
+/**
+ * Generate mip levels firstMip to lastMip of an image with the CPU mip generator.
+ * Only the returned levels and two intermediate levels are held in memory.
+ * @return Texel data of the mip levels, stored contiguously.
+ */
+std::vector<uint8_t> generateMipRange(
+    const TexelLayout& layout,
+    uint32_t bytesPerTexel,
+    const uint8_t* pImage,
+    uint32_t width,
+    uint32_t height,
+    uint32_t firstMip,
+    uint32_t lastMip
+)
+{
+    auto mipWidth = [&](uint32_t mip) { return std::max(1u, width >> mip); };
+    auto mipHeight = [&](uint32_t mip) { return std::max(1u, height >> mip); };
+    auto mipSize = [&](uint32_t mip) { return (size_t)mipWidth(mip) * mipHeight(mip) * bytesPerTexel; };
+
+    size_t size = 0;
+    for (uint32_t mip = firstMip; mip <= lastMip; ++mip)
+        size += mipSize(mip);
+    std::vector<uint8_t> data(size);
+
+    uint8_t* pDst = data.data();
+    if (firstMip == 0)
+    {
+        std::memcpy(pDst, pImage, mipSize(0));
+        pDst += mipSize(0);
+    }
+
+    std::array<std::vector<uint8_t>, 2> scratch;
+    const uint8_t* pSrc = pImage;
+    for (uint32_t mip = 1; mip <= lastMip; ++mip)
+    {
+        uint8_t* pMip = pDst;
+        if (mip >= firstMip)
+        {
+            pDst += mipSize(mip);
+        }
+        else
+        {
+            // Levels more detailed than firstMip alternate between the scratch buffers.
+            scratch[mip & 1].resize(mipSize(mip));
+            pMip = scratch[mip & 1].data();
+        }
+        generateMip(layout, pSrc, mipWidth(mip - 1), mipHeight(mip - 1), pMip, mipWidth(mip), mipHeight(mip));
+        pSrc = pMip;
+    }
+
+    return data;
+}
 } // namespace
 
 TextureManager::TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount)
-    : mpDevice(pDevice), mAsyncTextureLoader(pDevice, threadCount), mMaxTextureCount(std::min(maxTextureCount, kMaxTextureHandleCount))
+    : mpDevice(pDevice)
+    , mpResidencyManager(std::make_unique<TextureResidencyManager>(mStreamingOptions.budgetInBytes))
+    , mAsyncTextureLoader(pDevice, threadCount)
+    , mMaxTextureCount(std::min(maxTextureCount, kMaxTextureHandleCount))
 {}
 
-TextureManager::~TextureManager() {}
+TextureManager::~TextureManager()
+{
+    // Wait for texture and mip loads in flight, as the jobs reference this object.
+    waitForAllTexturesLoading();
+    waitForStreamingLoads();
+}
 
 TextureManager::CpuTextureHandle TextureManager::addTexture(const ref<Texture>& pTexture)
 {
@@ -113,7 +315,8 @@ TextureManager::CpuTextureHandle TextureManager::loadUdimTexture(
     bool async,
     Bitmap::ImportFlags importFlags,
     const AssetResolver* assetResolver,
-    size_t* loadedTextureCount
+    size_t* loadedTextureCount,
+    ImageIO::CompressionMode cookCompression
 )
 {
     std::string filename = path.filename().string();
@@ -125,7 +328,9 @@ TextureManager::CpuTextureHandle TextureManager::loadUdimTexture(
 
     auto pos = filename.find("<UDIM>");
     if (pos == std::string::npos)
-        return loadTexture(path, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, assetResolver, loadedTextureCount);
+        return loadTexture(
+            path, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, assetResolver, loadedTextureCount, nullptr, cookCompression
+        );
 
     std::filesystem::path dirpath = path.parent_path();
     filename.replace(pos, 6, "[1-9][0-9][0-9][0-9]");
@@ -168,7 +373,9 @@ TextureManager::CpuTextureHandle TextureManager::loadUdimTexture(
         maxIndex = std::max<size_t>(maxIndex, udim);
         udimIndices.push_back(udim);
         // Do not pass on assetResolver as paths are already resolved, nor loadedTextureCount as we've already set it above.
-        handles.push_back(loadTexture(it, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags));
+        handles.push_back(
+            loadTexture(it, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, nullptr, nullptr, nullptr, cookCompression)
+        );
 
         FALCOR_CHECK(udim >= 1001, "Texture {} is not a valid UDIM texture, as it violates the valid UDIM range of 1001-9999", it);
     }
@@ -194,13 +401,15 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
     Bitmap::ImportFlags importFlags,
     const AssetResolver* assetResolver,
     size_t* loadedTextureCount,
-    const Object* owner
+    const Object* owner,
+    ImageIO::CompressionMode cookCompression
 )
 {
     if (path.string().find("<UDIM>") != std::string::npos)
     {
-        CpuTextureHandle handle =
-            loadUdimTexture(path, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, assetResolver, loadedTextureCount);
+        CpuTextureHandle handle = loadUdimTexture(
+            path, generateMipLevels, loadAsSRGB, bindFlags, async, importFlags, assetResolver, loadedTextureCount, cookCompression
+        );
 
         std::lock_guard<std::mutex> lock(mMutex);
         registerOwner(handle, owner);
@@ -260,7 +469,27 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
     }
 
     std::unique_lock<std::mutex> lock(mMutex);
-    const TextureKey textureKey(paths, generateMipLevels, loadAsSRGB, bindFlags, importFlags);
+    // The cook compression only affects the loaded texture if cooking is enabled.
+    if (!mpCookCache)
+        cookCompression = ImageIO::CompressionMode::None;
+    const TextureKey textureKey(paths, generateMipLevels, loadAsSRGB, bindFlags, importFlags, cookCompression);
+
+    // With deduplication enabled, textures with byte-identical source files are aliased to the same handle.
+    // The source files are hashed without holding the mutex so that parallel loads are not serialized on file reads.
+    std::optional<SHA1::MD> contentHash;
+    if (mDeduplicationEnabled && mKeyToHandle.find(textureKey) == mKeyToHandle.end())
+    {
+        lock.unlock();
+        contentHash = computeContentHash(textureKey);
+        lock.lock();
+
+        // Another thread may have added the same key while the mutex was released.
+        if (contentHash && mKeyToHandle.find(textureKey) == mKeyToHandle.end())
+        {
+            if (auto it = mContentHashToHandle.find(*contentHash); it != mContentHashToHandle.end())
+                addAlias(textureKey, it->second);
+        }
+    }
 
     if (auto it = mKeyToHandle.find(textureKey); it != mKeyToHandle.end())
     {
@@ -278,74 +507,114 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
 
             // Add to key-to-handle map.
             mKeyToHandle[textureKey] = handle;
+            if (contentHash)
+                mContentHashToHandle[*contentHash] = handle;
 
             // Return early.
             return handle;
         }
 
-#ifndef DISABLE_ASYNC_TEXTURE_LOADER
-        mLoadRequestsInProgress++;
-
-        // Texture is not already managed. Add new texture desc.
-        TextureDesc desc = {TextureState::Referenced, nullptr};
-        handle = addDesc(desc);
-
-        // Add to key-to-handle map.
-        mKeyToHandle[textureKey] = handle;
-
-        // Function called by the async texture loader when loading finishes.
-        // It's called by a worker thread so needs to acquire the mutex before changing any state.
-        auto callback = [=](ref<Texture> pTexture)
+        // Falcor doesn't support parallel GPU work submission. Textures are decoded by the async texture loader
+        // and uploaded on the main thread when waiting for them. Loads that need the decoded image here are done right away.
+        const bool needsDecodedImage =
+            mDeduplicationEnabled || (mStreamingOptions.enabled && generateMipLevels && bindFlags == ResourceBindFlags::ShaderResource);
+        if (async && !needsDecodedImage)
         {
-            std::unique_lock<std::mutex> lock(mMutex);
+            mLoadRequestsInProgress++;
 
-            // Mark texture as loaded.
-            auto& desc = getDesc(handle);
-            desc.state = TextureState::Loaded;
-            desc.pTexture = pTexture;
-
-            // Add to texture-to-handle map.
-            if (pTexture)
-                mTextureToHandle[pTexture.get()] = handle;
+            // Texture is not already managed. Add new texture desc.
+            TextureDesc desc = {TextureState::Referenced, nullptr};
+            handle = addDesc(desc);
 
-            mLoadRequestsInProgress--;
-            mCondition.notify_all();
-        };
+            // Add to key-to-handle map.
+            mKeyToHandle[textureKey] = handle;
+            if (contentHash)
+                mContentHashToHandle[*contentHash] = handle;
 
-        // Issue load request to texture loader.
-        if (paths.size() > 1)
-        {
-            mAsyncTextureLoader.loadMippedFromFiles(paths, loadAsSRGB, bindFlags, importFlags, callback);
-        }
-        else
-        {
-            mAsyncTextureLoader.loadFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags, callback);
-        }
-#else
-        // Load texture from main thread.
-        ref<Texture> pTexture;
-        if (paths.size() > 1)
-        {
-            pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags, importFlags);
+            // Function called by the async texture loader when loading finishes.
+            // It's called while waiting for textures to load, so needs to acquire the mutex before changing any state.
+            auto callback = [=](ref<Texture> pTexture)
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+
+                // Mark texture as loaded.
+                auto& desc = getDesc(handle);
+                desc.state = TextureState::Loaded;
+                desc.pTexture = pTexture;
+
+                // Add to texture-to-handle map.
+                if (pTexture)
+                    mTextureToHandle[pTexture.get()] = handle;
+
+                mLoadRequests.erase(handle);
+                mLoadRequestsInProgress--;
+                mCondition.notify_all();
+            };
+
+            // Issue load request to texture loader.
+            // The callback can't run before the request ID is recorded below as it needs to acquire the mutex.
+            AsyncTextureLoader::RequestID requestID = AsyncTextureLoader::kInvalidRequestID;
+            if (paths.size() > 1)
+            {
+                mAsyncTextureLoader.loadMippedFromFiles(paths, loadAsSRGB, bindFlags, importFlags, callback, 0, &requestID);
+            }
+            else if (auto cookedPath = findCookedTexture(textureKey); !cookedPath.empty())
+            {
+                // Load the cooked texture, but report the source image as the texture's source path.
+                auto cookedCallback = [callback, sourcePath = paths[0]](ref<Texture> pTexture)
+                {
+                    if (pTexture)
+                        pTexture->setSourcePath(sourcePath);
+                    callback(pTexture);
+                };
+                mAsyncTextureLoader.loadFromFile(
+                    cookedPath, false, loadAsSRGB, bindFlags, Bitmap::ImportFlags::None, cookedCallback, 0, &requestID
+                );
+            }
+            else
+            {
+                mAsyncTextureLoader.loadFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags, callback, 0, &requestID);
+            }
+            mLoadRequests[handle] = requestID;
         }
         else
         {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags);
-        }
+            // Load texture from main thread.
+            StreamedTexture streamed;
+            PixelDedupResult pixelDedup;
+            ref<Texture> pTexture = createTexture(textureKey, &streamed, mDeduplicationEnabled ? &pixelDedup : nullptr);
 
-        // Add new texture desc.
-        TextureDesc desc = {TextureState::Loaded, pTexture};
-        handle = addDesc(desc);
+            if (pixelDedup.alias)
+            {
+                // The decoded image is identical to a managed texture.
+                handle = pixelDedup.alias;
+                addAlias(textureKey, handle);
+            }
+            else
+            {
+                // Add new texture desc.
+                TextureDesc desc = {TextureState::Loaded, pTexture};
+                handle = addDesc(desc);
 
-        // Add to key-to-handle map.
-        mKeyToHandle[textureKey] = handle;
+                if (streamed.pTailTexture)
+                    registerStreamedTexture(handle, std::move(streamed));
 
-        // Add to texture-to-handle map.
-        if (pTexture)
-            mTextureToHandle[pTexture.get()] = handle;
+                // Add to key-to-handle map.
+                mKeyToHandle[textureKey] = handle;
+
+                // Add to texture-to-handle map.
+                if (pTexture)
+                    mTextureToHandle[pTexture.get()] = handle;
+
+                if (pixelDedup.pixelHash && pTexture)
+                    mPixelHashToHandle[*pixelDedup.pixelHash] = handle;
+            }
+
+            if (contentHash && (pTexture || pixelDedup.alias))
+                mContentHashToHandle[*contentHash] = handle;
 
-        mCondition.notify_all();
-#endif
+            mCondition.notify_all();
+        }
     }
 
     registerOwner(handle, owner);
@@ -365,15 +634,25 @@ void TextureManager::waitForTextureLoading(const CpuTextureHandle& handle)
         return;
 
     // Acquire mutex and wait for texture state to change.
+    // Textures loaded asynchronously are uploaded on this thread, so keep uploading while waiting.
     std::unique_lock<std::mutex> lock(mMutex);
-    mCondition.wait(lock, [&]() { return getDesc(handle).state == TextureState::Loaded; });
+    while (getDesc(handle).state != TextureState::Loaded)
+    {
+        lock.unlock();
+        size_t uploadCount = mAsyncTextureLoader.uploadCompletedLoads();
+        lock.lock();
+        if (uploadCount == 0)
+            mCondition.wait_for(lock, std::chrono::milliseconds(1), [&]() { return getDesc(handle).state == TextureState::Loaded; });
+    }
 
     mpDevice->wait();
 }
 
 void TextureManager::waitForAllTexturesLoading()
 {
-    // Acquire mutex and wait for all in-progress requests to finish.
+    // Upload all textures loaded asynchronously, then wait for all in-progress requests to finish.
+    mAsyncTextureLoader.waitForAllLoads();
+
     std::unique_lock<std::mutex> lock(mMutex);
     mCondition.wait(lock, [&]() { return mLoadRequestsInProgress == 0; });
 
@@ -391,6 +670,7 @@ void TextureManager::endDeferredLoading()
     {
         TextureKey key;
         CpuTextureHandle handle;
+        StreamedTexture streamed;
     };
 
     // Get a list of textures to load.
@@ -399,7 +679,7 @@ void TextureManager::endDeferredLoading()
     {
         auto& desc = getDesc(handle);
         if (desc.state == TextureState::Referenced)
-            jobs.push_back(Job{key, handle});
+            jobs.push_back(Job{key, handle, {}});
     }
 
     // Early out if there are no textures to load.
@@ -416,21 +696,10 @@ void TextureManager::endDeferredLoading()
         jobRange.end(),
         [&](size_t i)
         {
-            const auto& job = jobs[i];
+            auto& job = jobs[i];
             auto& desc = getDesc(job.handle);
-            if (job.key.fullPaths.size() == 1)
-            {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags
-                );
-                logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
-            }
-            else
-            {
-                desc.pTexture =
-                    Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags);
-                logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
-            }
+            desc.pTexture = createTexture(job.key, &job.streamed);
+            logDebug("Loading {}texture from '{}'", job.key.fullPaths.size() > 1 ? "mipped " : "", job.key.fullPaths[0]);
             if (texturesLoaded.fetch_add(1) % 10 == 9)
             {
                 logDebug("Flush");
@@ -442,11 +711,13 @@ void TextureManager::endDeferredLoading()
     mpDevice->wait();
 
     // Mark loaded textures and add them to lookup table.
-    for (const auto& job : jobs)
+    for (auto& job : jobs)
     {
         auto& desc = getDesc(job.handle);
         desc.state = desc.pTexture ? TextureState::Loaded : TextureState::Invalid;
         mTextureToHandle[desc.pTexture.get()] = job.handle;
+        if (job.streamed.pTailTexture)
+            registerStreamedTexture(job.handle, std::move(job.streamed));
     }
 }
 
@@ -488,9 +759,16 @@ void TextureManager::removeNonUdimTexture(const CpuTextureHandle& handle)
 
     // Remove handle from maps.
     // Note not all handles exist in key-to-handle map so search for it. This can be optimized if needed.
-    auto it = std::find_if(mKeyToHandle.begin(), mKeyToHandle.end(), [handle](const auto& keyVal) { return keyVal.second == handle; });
-    if (it != mKeyToHandle.end())
-        mKeyToHandle.erase(it);
+    // With deduplication, multiple keys and hashes can map to the same handle.
+    auto eraseHandle = [handle](auto& map)
+    {
+        for (auto it = map.begin(); it != map.end();)
+            it = it->second == handle ? map.erase(it) : std::next(it);
+    };
+    eraseHandle(mKeyToHandle);
+    eraseHandle(mContentHashToHandle);
+    eraseHandle(mPixelHashToHandle);
+    mAliasCounts.erase(handle);
 
     if (desc.pTexture)
     {
@@ -498,6 +776,14 @@ void TextureManager::removeNonUdimTexture(const CpuTextureHandle& handle)
         mTextureToHandle.erase(desc.pTexture.get());
     }
 
+    // Streamed textures are also referenced by their tail texture, which is what materials hold on to.
+    if (auto it = mStreamedTextures.find(handle.getID()); it != mStreamedTextures.end())
+    {
+        mTextureToHandle.erase(it->second.pTailTexture.get());
+        mpResidencyManager->removeTexture(handle.getID());
+        mStreamedTextures.erase(it);
+    }
+
     // Clear texture desc.
     desc = {};
 
@@ -509,6 +795,25 @@ void TextureManager::removeTextures(const Object* object)
 {
     FALCOR_CHECK(object != nullptr, "Missing object.");
 
+    // Cancel pending loads of textures that are only used by this object so we don't wait for them to finish.
+    // The cancellation callback acquires the mutex, so the requests are cancelled without holding it.
+    std::vector<AsyncTextureLoader::RequestID> requestIDs;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (auto obj = mObjectToHandles.find(object); obj != mObjectToHandles.end())
+        {
+            for (auto handle : obj->second)
+            {
+                auto it = mHandleToObjects.find(handle);
+                auto request = mLoadRequests.find(handle);
+                if (it != mHandleToObjects.end() && it->second.size() == 1 && request != mLoadRequests.end())
+                    requestIDs.push_back(request->second);
+            }
+        }
+    }
+    for (auto requestID : requestIDs)
+        mAsyncTextureLoader.cancel(requestID);
+
     waitForAllTexturesLoading();
 
     std::lock_guard<std::mutex> lock(mMutex);
@@ -642,9 +947,435 @@ TextureManager::Stats TextureManager::getStats() const
         if (isCompressedFormat(t.pTexture->getFormat()))
             s.textureCompressedCount++;
     }
+
+    for (const auto& [handle, aliasCount] : mAliasCounts)
+    {
+        const auto& pTexture = mTextureDescs[handle.getID()].pTexture;
+        s.dedupedTextureCount += aliasCount;
+        if (pTexture)
+            s.dedupedMemoryInBytes += aliasCount * pTexture->getTextureSizeInBytes();
+    }
+
+    TextureResidencyManager::Stats streamingStats = mpResidencyManager->getStats();
+    s.streamedTextureCount = streamingStats.textureCount;
+    s.streamingResidentBytes = streamingStats.residentBytes;
+    s.streamingPendingRequestCount = streamingStats.pendingRequestCount;
+    s.streamingEvictionCount = streamingStats.evictionCount;
+    s.loaderStats = mAsyncTextureLoader.getStats();
     return s;
 }
 
+void TextureManager::setCookCache(std::shared_ptr<TextureCookCache> pCookCache)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mpCookCache = std::move(pCookCache);
+}
+
+std::filesystem::path TextureManager::findCookedTexture(const TextureKey& key) const
+{
+    if (!mpCookCache || key.fullPaths.size() != 1 || !TextureCookCache::isCookable(key.fullPaths[0], key.bindFlags))
+        return {};
+
+    TextureCookCache::CookParams params;
+    params.generateMipLevels = key.generateMipLevels;
+    params.loadAsSRGB = key.loadAsSRGB;
+    params.importFlags = key.importFlags;
+    params.compression = key.cookCompression;
+    return mpCookCache->lookup(key.fullPaths[0], params);
+}
+
+void TextureManager::setDeduplicationEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDeduplicationEnabled = enabled;
+}
+
+void TextureManager::setStreamingOptions(const StreamingOptions& options)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStreamingOptions = options;
+    mpResidencyManager->setBudget(options.budgetInBytes);
+}
+
+void TextureManager::setTexturePriority(const CpuTextureHandle& handle, uint32_t priority)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!handle || handle.isUdim())
+        return;
+    if (auto it = mLoadRequests.find(handle); it != mLoadRequests.end())
+        mAsyncTextureLoader.setPriority(it->second, (int32_t)std::min(priority, (uint32_t)INT32_MAX));
+    if (auto it = mStreamedTextures.find(handle.getID()); it != mStreamedTextures.end())
+    {
+        it->second.priority = priority;
+        mpResidencyManager->setPriority(handle.getID(), priority);
+    }
+}
+
+void TextureManager::markTextureUsed(const CpuTextureHandle& handle, uint32_t wantedMip)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (handle && !handle.isUdim() && mpResidencyManager->hasTexture(handle.getID()))
+        mpResidencyManager->markUsed(handle.getID(), wantedMip);
+}
+
+void TextureManager::markTexturesUsed(const std::vector<std::pair<const Texture*, float>>& textures)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mStreamedTextures.empty())
+        return;
+
+    for (const auto& [pTexture, screenSize] : textures)
+    {
+        auto it = mTextureToHandle.find(pTexture);
+        if (it == mTextureToHandle.end())
+            continue;
+        auto streamed = mStreamedTextures.find(it->second.getID());
+        if (streamed == mStreamedTextures.end())
+            continue;
+
+        // The wanted mip is clamped to the tail mip by the residency manager.
+        float screenPixels = std::max(screenSize * mStreamingOptions.screenHeight, 1.f);
+        float texels = (float)std::max(streamed->second.width, streamed->second.height);
+        uint32_t wantedMip = texels > screenPixels ? (uint32_t)std::floor(std::log2(texels / screenPixels)) : 0;
+        mpResidencyManager->markUsed(streamed->first, wantedMip);
+    }
+}
+
+bool TextureManager::updateStreaming()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mStreamedTextures.empty())
+        return false;
+
+    // Collect the mips loaded in the background. A texture has at most one load in flight.
+    std::map<uint32_t, StreamedMipLoad> loads;
+    std::vector<StreamedMipLoad> completedLoads = std::move(mCompletedMipLoads);
+    mCompletedMipLoads.clear();
+    for (auto& load : completedLoads)
+    {
+        // Discard loads of textures that were removed in the meantime.
+        auto it = mStreamedTextures.find(load.textureID);
+        if (it == mStreamedTextures.end() || it->second.loadSerial != load.serial)
+            continue;
+
+        it->second.loadSerial = 0;
+        if (load.data.empty())
+        {
+            mpResidencyManager->cancelLoad(load.textureID, load.mip);
+            continue;
+        }
+
+        mpResidencyManager->completeLoad(load.textureID, load.mip);
+        uint32_t textureID = load.textureID;
+        loads.emplace(textureID, std::move(load));
+    }
+
+    TextureResidencyManager::Update update = mpResidencyManager->update(mStreamingOptions.maxLoadsPerUpdate);
+
+    // Re-create each texture whose residency changed once, holding its resident mips.
+    // Mips held by the current texture are copied, which still holds all of them as textures with a load in flight are not evicted.
+    std::set<uint32_t> changedIDs;
+    for (const auto& [textureID, load] : loads)
+        changedIDs.insert(textureID);
+    for (const auto& eviction : update.evictions)
+        changedIDs.insert(eviction.textureID);
+
+    for (uint32_t textureID : changedIDs)
+    {
+        const StreamedTexture& streamed = mStreamedTextures.at(textureID);
+        CpuTextureHandle handle(textureID);
+        auto& desc = getDesc(handle);
+        uint32_t residentMip = mpResidencyManager->getResidentMip(textureID);
+
+        ref<Texture> pTexture = streamed.pTailTexture;
+        if (residentMip != streamed.tailMip)
+        {
+            auto it = loads.find(textureID);
+            uint32_t currentMip = streamed.getMipCount() - desc.pTexture->getMipCount();
+            pTexture = createStreamedTexture(
+                streamed, residentMip, desc.pTexture.get(), currentMip, it != loads.end() ? &it->second : nullptr
+            );
+        }
+
+        if (desc.pTexture != streamed.pTailTexture)
+            mTextureToHandle.erase(desc.pTexture.get());
+        desc.pTexture = std::move(pTexture);
+        mTextureToHandle[desc.pTexture.get()] = handle;
+    }
+
+    for (const auto& load : update.loads)
+        loadStreamedMips(load.textureID, mStreamedTextures.at(load.textureID), load.mip);
+
+    if (changedIDs.empty())
+        return false;
+
+    logDebug("Texture streaming: Loaded mips of {} and evicted mips of {} textures.", loads.size(), update.evictions.size());
+    return true;
+}
+
+void TextureManager::waitForStreamingLoads()
+{
+    // Pending jobs are run on this thread, as the mip loads may be queued behind other work.
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mStreamingJobCount > 0)
+    {
+        lock.unlock();
+        bool ranJob = JobSystem::getShared().runPendingJob();
+        lock.lock();
+        if (!ranJob)
+            mCondition.wait_for(lock, std::chrono::milliseconds(1), [&] { return mStreamingJobCount == 0; });
+    }
+}
+
+void TextureManager::loadStreamedMips(uint32_t textureID, StreamedTexture& streamed, uint32_t mip)
+{
+    FALCOR_ASSERT(streamed.loadSerial == 0);
+    uint64_t serial = mNextLoadSerial++;
+    streamed.loadSerial = serial;
+    mStreamingJobCount++;
+
+    // The job decodes the source image once and filters it down to the requested mips. Only those mips are kept.
+    uint32_t residentMip = mpResidencyManager->getResidentMip(textureID);
+    FALCOR_ASSERT(mip < residentMip);
+    JobSystem::getShared().submit(
+        [this,
+         textureID,
+         mip,
+         residentMip,
+         serial,
+         path = streamed.sourcePath,
+         importFlags = streamed.importFlags,
+         width = streamed.width,
+         height = streamed.height,
+         format = streamed.format]()
+        {
+            std::vector<uint8_t> data;
+            TexelLayout layout;
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true, importFlags);
+            if (pBitmap && pBitmap->getWidth() == width && pBitmap->getHeight() == height &&
+                pBitmap->getRowPitch() == getFormatRowPitch(format, width) && getTexelLayout(format, layout))
+            {
+                data = generateMipRange(layout, getFormatBytesPerBlock(format), pBitmap->getData(), width, height, mip, residentMip - 1);
+            }
+            else
+            {
+                logWarning("Failed to load mips {}-{} of streamed texture '{}'.", mip, residentMip - 1, path);
+            }
+
+            // Notify while holding the lock, as the destructor may be waiting for the last job.
+            std::lock_guard<std::mutex> lock(mMutex);
+            mCompletedMipLoads.push_back({textureID, mip, serial, std::move(data)});
+            mStreamingJobCount--;
+            mCondition.notify_all();
+        },
+        (int32_t)std::min(streamed.priority, (uint32_t)INT32_MAX)
+    );
+}
+
+ref<Texture> TextureManager::createStreamedTexture(
+    const StreamedTexture& streamed,
+    uint32_t mostDetailedMip,
+    const Texture* pSrc,
+    uint32_t srcMostDetailedMip,
+    const StreamedMipLoad* pLoad
+) const
+{
+    FALCOR_ASSERT(mostDetailedMip < streamed.getMipCount());
+    FALCOR_ASSERT(pSrc && (mostDetailedMip >= srcMostDetailedMip || (pLoad && pLoad->mip <= mostDetailedMip)));
+    ref<Texture> pTexture = mpDevice->createTexture2D(
+        std::max(1u, streamed.width >> mostDetailedMip),
+        std::max(1u, streamed.height >> mostDetailedMip),
+        streamed.format,
+        1,
+        streamed.getMipCount() - mostDetailedMip,
+        nullptr,
+        streamed.bindFlags
+    );
+    pTexture->setSourcePath(streamed.sourcePath);
+    pTexture->setImportFlags(streamed.importFlags);
+
+    RenderContext* pRenderContext = mpDevice->getRenderContext();
+    for (uint32_t mip = mostDetailedMip; mip < streamed.getMipCount(); ++mip)
+    {
+        uint32_t dstSubresource = pTexture->getSubresourceIndex(0, mip - mostDetailedMip);
+        if (mip < srcMostDetailedMip)
+        {
+            // The loaded data holds the mips from pLoad->mip on, tightly packed.
+            uint64_t offset = 0;
+            for (uint32_t i = pLoad->mip; i < mip; ++i)
+                offset += streamed.mipSizes[i];
+            pRenderContext->updateSubresourceData(pTexture.get(), dstSubresource, pLoad->data.data() + offset);
+        }
+        else
+        {
+            pRenderContext->copySubresource(
+                pTexture.get(), dstSubresource, pSrc, pSrc->getSubresourceIndex(0, mip - srcMostDetailedMip)
+            );
+        }
+    }
+    return pTexture;
+}
+
+void TextureManager::registerStreamedTexture(const CpuTextureHandle& handle, StreamedTexture&& streamed)
+{
+    mpResidencyManager->addTexture(handle.getID(), streamed.mipSizes, streamed.tailMip);
+    mStreamedTextures[handle.getID()] = std::move(streamed);
+}
+
+ref<Texture> TextureManager::createTexture(const TextureKey& key, StreamedTexture* pStreamed, PixelDedupResult* pPixelDedup) const
+{
+    if (key.fullPaths.size() > 1)
+        return Texture::createMippedFromFiles(mpDevice, key.fullPaths, key.loadAsSRGB, key.bindFlags, key.importFlags);
+
+    if (auto cookedPath = findCookedTexture(key); !cookedPath.empty())
+    {
+        // The cooked texture holds the full mip chain, so don't generate mips.
+        ref<Texture> pTexture = Texture::createFromFile(mpDevice, cookedPath, false, key.loadAsSRGB, key.bindFlags);
+        if (pTexture)
+        {
+            // Report the source image as the texture's source path, so it is identified the same way as an uncooked texture.
+            pTexture->setSourcePath(key.fullPaths[0]);
+            return pTexture;
+        }
+        logWarning("Failed to load cooked texture '{}'. Loading '{}' instead.", cookedPath, key.fullPaths[0]);
+    }
+
+    // Decode plain image files here if the decoded image is needed for streaming or deduplication.
+    // Otherwise leave it to the texture loader.
+    const std::filesystem::path& path = key.fullPaths[0];
+    const bool stream =
+        pStreamed && mStreamingOptions.enabled && key.generateMipLevels && key.bindFlags == ResourceBindFlags::ShaderResource;
+    if ((stream || pPixelDedup) && !hasExtension(path, "dds"))
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true, key.importFlags);
+        if (!pBitmap)
+            return nullptr;
+
+        if (pPixelDedup)
+        {
+            SHA1 sha1;
+            sha1.update(pBitmap->getWidth());
+            sha1.update(pBitmap->getHeight());
+            sha1.update(pBitmap->getFormat());
+            sha1.update(key.generateMipLevels);
+            sha1.update(key.loadAsSRGB);
+            sha1.update(key.bindFlags);
+            sha1.update(key.cookCompression);
+            sha1.update(pBitmap->getData(), pBitmap->getSize());
+            pPixelDedup->pixelHash = sha1.finalize();
+
+            if (auto it = mPixelHashToHandle.find(*pPixelDedup->pixelHash); it != mPixelHashToHandle.end())
+            {
+                pPixelDedup->alias = it->second;
+                return nullptr;
+            }
+        }
+
+        if (stream)
+        {
+            if (ref<Texture> pTexture = createStreamedTexture(key, *pBitmap, *pStreamed))
+                return pTexture;
+        }
+
+        ResourceFormat format = key.loadAsSRGB ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+        ref<Texture> pTexture = mpDevice->createTexture2D(
+            pBitmap->getWidth(),
+            pBitmap->getHeight(),
+            format,
+            1,
+            key.generateMipLevels ? Texture::kMaxPossible : 1,
+            pBitmap->getData(),
+            key.bindFlags
+        );
+        pTexture->setSourcePath(path);
+        pTexture->setImportFlags(key.importFlags);
+        return pTexture;
+    }
+
+    return Texture::createFromFile(mpDevice, path, key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags);
+}
+
+ref<Texture> TextureManager::createStreamedTexture(const TextureKey& key, const Bitmap& bitmap, StreamedTexture& streamed) const
+{
+    // Only the tail mips are generated and uploaded here. More detailed mips are loaded from the file when requested.
+    ResourceFormat format = key.loadAsSRGB ? linearToSrgbFormat(bitmap.getFormat()) : bitmap.getFormat();
+    TexelLayout layout;
+    if (!getTexelLayout(format, layout) || bitmap.getRowPitch() != getFormatRowPitch(format, bitmap.getWidth()))
+        return nullptr;
+
+    streamed.sourcePath = key.fullPaths[0];
+    streamed.width = bitmap.getWidth();
+    streamed.height = bitmap.getHeight();
+    streamed.format = format;
+    streamed.bindFlags = key.bindFlags;
+    streamed.importFlags = key.importFlags;
+
+    // Compute mip sizes and find the tail mip.
+    const uint32_t bytesPerTexel = getFormatBytesPerBlock(format);
+    uint32_t mipCount = 1 + (uint32_t)std::floor(std::log2(std::max(streamed.width, streamed.height)));
+    streamed.mipSizes.resize(mipCount);
+    streamed.tailMip = mipCount - 1;
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        uint32_t w = std::max(1u, streamed.width >> mip);
+        uint32_t h = std::max(1u, streamed.height >> mip);
+        streamed.mipSizes[mip] = (uint64_t)w * h * bytesPerTexel;
+        if (std::max(w, h) <= mStreamingOptions.tailSize)
+            streamed.tailMip = std::min(streamed.tailMip, mip);
+    }
+
+    std::vector<uint8_t> tailData =
+        generateMipRange(layout, bytesPerTexel, bitmap.getData(), streamed.width, streamed.height, streamed.tailMip, mipCount - 1);
+    streamed.pTailTexture = mpDevice->createTexture2D(
+        std::max(1u, streamed.width >> streamed.tailMip),
+        std::max(1u, streamed.height >> streamed.tailMip),
+        format,
+        1,
+        mipCount - streamed.tailMip,
+        tailData.data(),
+        streamed.bindFlags
+    );
+    streamed.pTailTexture->setSourcePath(streamed.sourcePath);
+    streamed.pTailTexture->setImportFlags(streamed.importFlags);
+
+    logDebug(
+        "Loaded streamed texture: size={}x{} mips={} tailMip={} format={} path={}",
+        streamed.width,
+        streamed.height,
+        mipCount,
+        streamed.tailMip,
+        to_string(format),
+        streamed.sourcePath
+    );
+    return streamed.pTailTexture;
+}
+
+std::optional<SHA1::MD> TextureManager::computeContentHash(const TextureKey& key) const
+{
+    SHA1 sha1;
+    sha1.update(key.generateMipLevels);
+    sha1.update(key.loadAsSRGB);
+    sha1.update(key.bindFlags);
+    sha1.update(key.importFlags);
+    sha1.update(key.cookCompression);
+    for (const auto& path : key.fullPaths)
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen())
+            return {};
+        sha1.update(uint64_t(file.getSize()));
+        sha1.update(file.getData(), file.getSize());
+    }
+    return sha1.finalize();
+}
+
+void TextureManager::addAlias(const TextureKey& key, const CpuTextureHandle& handle)
+{
+    mKeyToHandle[key] = handle;
+    mAliasCounts[handle]++;
+    logDebug("Texture '{}' is identical to a managed texture. Reusing it.", key.fullPaths[0]);
+}
+
 TextureManager::CpuTextureHandle TextureManager::addDesc(const TextureDesc& desc)
 {
     CpuTextureHandle handle;
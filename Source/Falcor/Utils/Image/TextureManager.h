@@ -27,23 +27,28 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "ImageIO.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
 #include "Core/Program/ShaderVar.h"
 #include "Scene/Material/TextureHandle.slang"
+#include "Utils/CryptoUtils.h"
 #include <condition_variable>
 #include <limits>
 #include <map>
 #include <set>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 namespace Falcor
 {
 class AssetResolver;
+class TextureCookCache;
+class TextureResidencyManager;
 
 /**
  * Multi-threaded texture manager.
@@ -68,11 +73,34 @@ public:
 
     struct Stats
     {
-        uint64_t textureCount = 0;             ///< Number of unique textures. A texture can be referenced by multiple materials.
-        uint64_t textureCompressedCount = 0;   ///< Number of unique compressed textures.
-        uint64_t textureTexelCount = 0;        ///< Total number of texels in all textures.
-        uint64_t textureTexelChannelCount = 0; ///< Total number of texel channels in all textures.
-        uint64_t textureMemoryInBytes = 0;     ///< Total memory in bytes used by the textures.
+        uint64_t textureCount = 0;                 ///< Number of unique textures. A texture can be referenced by multiple materials.
+        uint64_t textureCompressedCount = 0;       ///< Number of unique compressed textures.
+        uint64_t textureTexelCount = 0;            ///< Total number of texels in all textures.
+        uint64_t textureTexelChannelCount = 0;     ///< Total number of texel channels in all textures.
+        uint64_t textureMemoryInBytes = 0;         ///< Total memory in bytes used by the textures.
+        uint64_t streamedTextureCount = 0;         ///< Number of textures with streamed mips.
+        uint64_t streamingResidentBytes = 0;       ///< Memory in bytes used by resident mips of streamed textures.
+        uint64_t streamingPendingRequestCount = 0; ///< Number of streamed textures not yet resident at their wanted mip.
+        uint64_t streamingEvictionCount = 0;       ///< Total number of mips evicted to stay within the streaming budget.
+        uint64_t dedupedTextureCount = 0;          ///< Number of texture loads aliased to an identical texture by content deduplication.
+        uint64_t dedupedMemoryInBytes = 0;         ///< Memory in bytes saved by content deduplication.
+        AsyncTextureLoader::Stats loaderStats;     ///< Statistics of the asynchronous texture loader.
+    };
+
+    /**
+     * Mip streaming options.
+     * Streamed textures are created at a small tail mip, and only the tail mips are kept after loading. More detailed
+     * mips are read from the source file by background jobs requested by updateStreaming(), and are swapped in by a
+     * later call once loaded. All streamed textures share a memory budget. Mips are evicted based on texture priority
+     * and least recent use (see TextureResidencyManager). Textures found in the cook cache are loaded whole and not streamed.
+     */
+    struct StreamingOptions
+    {
+        bool enabled = false;                ///< Stream mips of textures loaded from a single image file with a generated mip chain.
+        uint64_t budgetInBytes = 1ull << 31; ///< Memory budget for resident mips of streamed textures.
+        uint32_t tailSize = 64;              ///< Textures are initially resident at the first mip with both dimensions <= tailSize.
+        uint32_t maxLoadsPerUpdate = 8;      ///< Maximum number of mip loads requested per call to updateStreaming().
+        uint32_t screenHeight = 1080;        ///< Screen height in pixels, used to turn screen sizes into wanted mips in markTexturesUsed().
     };
 
     /**
@@ -142,7 +170,7 @@ public:
      * Constructor.
      * @param[in] pDevice GPU device.
      * @param[in] maxTextureCount Maximum number of textures that can be simultaneously managed.
-     * @param[in] threadCount Number of worker threads.
+     * @param[in] threadCount Maximum number of concurrent texture loads on the shared job system.
      */
     TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount = std::thread::hardware_concurrency());
 
@@ -160,6 +188,9 @@ public:
      * Requst loading a texture from file.
      * This will add the texture to the set of managed textures. The function returns a handle immediately.
      * If asynchronous loading is requested, the texture data will not be available until loading completes.
+     * Asynchronously loaded textures are decoded in the background and uploaded by waitForTextureLoading() or
+     * waitForAllTexturesLoading(), which must be called from the main thread. Textures that need their decoded
+     * image for streaming or pixel deduplication are always loaded synchronously.
      * The returned handle is valid for the entire lifetime of the texture, until removeTexture() is called.
      * @param[in] path File path of the texture. This can be a full path or a relative path from a data directory.
      * @param[in] generateMipLevels Whether the full mip-chain should be generated.
@@ -169,6 +200,8 @@ public:
      * @param[in] importFlags Optional flags for the file import.
      * @param[in] assetResolver Optional asset resolver for resolving file paths.
      * @param[out] loadedTextureCount Optionally can provided the number of actually loaded textures (2+ can happen with UDIMs)
+     * @param[in] owner Optional object using the texture. Textures are removed with removeTextures() when all owners are removed.
+     * @param[in] cookCompression Block compression to use if the texture is cooked (see setCookCache()).
      * @return Unique handle to the texture, or an invalid handle if the texture can't be found.
      */
     CpuTextureHandle loadTexture(
@@ -180,7 +213,8 @@ public:
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
         const AssetResolver* assetResolver = nullptr,
         size_t* loadedTextureCount = nullptr,
-        const Object* owner = nullptr
+        const Object* owner = nullptr,
+        ImageIO::CompressionMode cookCompression = ImageIO::CompressionMode::None
     );
 
     /**
@@ -279,6 +313,87 @@ public:
      */
     Stats getStats() const;
 
+    /**
+     * Set the texture cook cache.
+     * When set, textures loaded from a single image file are loaded from their cooked DDS version if available.
+     * Otherwise the source image is loaded and cooking is scheduled in the background, so later loads use the cooked version.
+     * @param[in] pCookCache Cook cache, or nullptr to disable cooking.
+     */
+    void setCookCache(std::shared_ptr<TextureCookCache> pCookCache);
+
+    /**
+     * Get the texture cook cache.
+     * @return Cook cache, or nullptr if cooking is disabled.
+     */
+    const std::shared_ptr<TextureCookCache>& getCookCache() const { return mpCookCache; }
+
+    /**
+     * Enable content deduplication.
+     * When enabled, a texture requested under a new path is aliased to the handle of an already managed texture if
+     * its source files are byte-identical, or, for textures loaded on the main thread, if the decoded images are
+     * identical. This avoids redundant decoding, uploads and descriptors. Only affects textures loaded afterwards.
+     * @param[in] enabled True to enable deduplication.
+     */
+    void setDeduplicationEnabled(bool enabled);
+
+    /**
+     * Check if content deduplication is enabled.
+     */
+    bool isDeduplicationEnabled() const { return mDeduplicationEnabled; }
+
+    /**
+     * Set the mip streaming options.
+     * Enabling or disabling streaming only affects textures loaded afterwards. The budget applies immediately.
+     * Note that streamed textures initially only hold the tail mips. Texture analysis done at load time (e.g. material
+     * optimization) therefore sees a low resolution version of the texture.
+     * @param[in] options Streaming options.
+     */
+    void setStreamingOptions(const StreamingOptions& options);
+
+    /**
+     * Get the mip streaming options.
+     */
+    const StreamingOptions& getStreamingOptions() const { return mStreamingOptions; }
+
+    /**
+     * Set the priority of a texture. Higher priority textures are loaded first if their load request is still pending.
+     * Streamed textures with higher priority are also made resident first and evicted last.
+     * @param[in] handle Texture handle.
+     * @param[in] priority Priority.
+     */
+    void setTexturePriority(const CpuTextureHandle& handle, uint32_t priority);
+
+    /**
+     * Mark a texture as used, which updates its least recently used timestamp for mip eviction.
+     * This is a no-op for textures that are not streamed.
+     * @param[in] handle Texture handle.
+     * @param[in] wantedMip Most detailed mip level the texture is wanted at.
+     */
+    void markTextureUsed(const CpuTextureHandle& handle, uint32_t wantedMip = 0);
+
+    /**
+     * Mark textures as used, wanting the mip that matches their size on screen. Textures that are not streamed are ignored.
+     * The wanted mip is the coarsest mip with at least one texel per pixel, assuming the texture is mapped once across
+     * the given screen size. Scene reports the textures of materials visible from the camera every update.
+     * @param[in] textures Textures as returned by getTexture(), including the tail textures held by materials, each with
+     * its size on screen as a fraction of the screen height (see StreamingOptions::screenHeight).
+     */
+    void markTexturesUsed(const std::vector<std::pair<const Texture*, float>>& textures);
+
+    /**
+     * Update mip residency of streamed textures.
+     * Mips loaded in the background since the last call are swapped in, evictions are applied and new loads are
+     * requested. Textures with changed residency are replaced by new texture objects holding the resident mips, so the
+     * texture descriptors must be rebound with bindShaderData() if this function returns true.
+     * @return True if any texture was replaced.
+     */
+    bool updateStreaming();
+
+    /**
+     * Wait for all mip loads in flight to finish. The loaded mips are swapped in by the next call to updateStreaming().
+     */
+    void waitForStreamingLoads();
+
 private:
     size_t getUdimRange(size_t requiredSize);
     void freeUdimRange(size_t rangeStart);
@@ -300,7 +415,8 @@ private:
         bool async = true,
         Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None,
         const AssetResolver* assetResolver = nullptr,
-        size_t* loadedTextureCount = nullptr
+        size_t* loadedTextureCount = nullptr,
+        ImageIO::CompressionMode cookCompression = ImageIO::CompressionMode::None
     );
 
     /**
@@ -313,15 +429,22 @@ private:
         bool loadAsSRGB;
         ResourceBindFlags bindFlags;
         Bitmap::ImportFlags importFlags;
+        ImageIO::CompressionMode cookCompression;
 
         TextureKey(
             const std::vector<std::filesystem::path>& paths,
             bool mips,
             bool srgb,
             ResourceBindFlags flags,
-            Bitmap::ImportFlags importFlags
+            Bitmap::ImportFlags importFlags,
+            ImageIO::CompressionMode cookCompression = ImageIO::CompressionMode::None
         )
-            : fullPaths(paths), generateMipLevels(mips), loadAsSRGB(srgb), bindFlags(flags), importFlags(importFlags)
+            : fullPaths(paths)
+            , generateMipLevels(mips)
+            , loadAsSRGB(srgb)
+            , bindFlags(flags)
+            , importFlags(importFlags)
+            , cookCompression(cookCompression)
         {}
 
         bool operator<(const TextureKey& rhs) const
@@ -334,11 +457,112 @@ private:
                 return loadAsSRGB < rhs.loadAsSRGB;
             else if (importFlags != rhs.importFlags)
                 return importFlags < rhs.importFlags;
+            else if (cookCompression != rhs.cookCompression)
+                return cookCompression < rhs.cookCompression;
             else
                 return bindFlags < rhs.bindFlags;
         }
     };
 
+    /**
+     * Look up the cooked version of a texture.
+     * @return Path of the cooked texture, or an empty path if cooking is disabled or the cooked texture is not yet available.
+     */
+    std::filesystem::path findCookedTexture(const TextureKey& key) const;
+
+    /**
+     * CPU-side state of a streamed texture. No texel data is kept, more detailed mips are loaded from the source file.
+     */
+    struct StreamedTexture
+    {
+        std::filesystem::path sourcePath;
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        ResourceFormat format = ResourceFormat::Unknown;
+        ResourceBindFlags bindFlags = ResourceBindFlags::None;
+        std::vector<uint64_t> mipSizes; ///< Size in bytes of each mip level.
+        uint32_t tailMip = 0;           ///< Most detailed mip level that is always resident.
+        ref<Texture> pTailTexture;      ///< Texture holding the tail mips.
+        uint32_t priority = 0;          ///< Job priority of mip loads.
+        uint64_t loadSerial = 0;        ///< Serial number of the mip load in flight, or 0 if none.
+
+        uint32_t getMipCount() const { return (uint32_t)mipSizes.size(); }
+    };
+
+    /**
+     * Mip levels loaded by a background job, waiting to be swapped in by updateStreaming().
+     */
+    struct StreamedMipLoad
+    {
+        uint32_t textureID;
+        uint32_t mip;              ///< Most detailed loaded mip level. All mips down to the resident mip are loaded.
+        uint64_t serial;           ///< Serial number of the load, used to discard loads of removed textures.
+        std::vector<uint8_t> data; ///< Texel data of the loaded mip levels, most detailed first, or empty if the load failed.
+    };
+
+    /**
+     * Result of decoded image deduplication in createTexture().
+     */
+    struct PixelDedupResult
+    {
+        std::optional<SHA1::MD> pixelHash; ///< Hash of the decoded image, if the texture was loaded from a decoded image.
+        CpuTextureHandle alias;            ///< Handle of an identical managed texture, or an invalid handle.
+    };
+
+    /**
+     * Create a texture from file(s), using the cooked version if available.
+     * @param[in] key Texture key.
+     * @param[out] pStreamed If non-null and streaming is enabled, streamable textures are returned as their tail texture
+     * and the mip chain is written to pStreamed. The caller must register it with registerStreamedTexture().
+     * @param[out] pPixelDedup If non-null, the decoded image is hashed and looked up among the managed textures. If an
+     * identical texture exists, nullptr is returned and its handle is written to pPixelDedup. The caller must hold the mutex.
+     */
+    ref<Texture> createTexture(const TextureKey& key, StreamedTexture* pStreamed = nullptr, PixelDedupResult* pPixelDedup = nullptr) const;
+
+    /**
+     * Create a streamed texture from a decoded image.
+     * @return Tail texture, or nullptr if the format is not supported for streaming.
+     */
+    ref<Texture> createStreamedTexture(const TextureKey& key, const Bitmap& bitmap, StreamedTexture& streamed) const;
+
+    /**
+     * Create a texture holding the mip levels of a streamed texture starting at the given mip.
+     * Mip levels held by pSrc are copied on the GPU. More detailed levels are uploaded from a finished load.
+     * @param[in] streamed Streamed texture.
+     * @param[in] mostDetailedMip Most detailed mip level of the new texture.
+     * @param[in] pSrc Texture holding the mip levels of the streamed texture starting at srcMostDetailedMip.
+     * @param[in] srcMostDetailedMip Most detailed mip level held by pSrc.
+     * @param[in] pLoad Loaded mip levels from mostDetailedMip or a more detailed level down to srcMostDetailedMip.
+     * Only needed if mostDetailedMip < srcMostDetailedMip.
+     */
+    ref<Texture> createStreamedTexture(
+        const StreamedTexture& streamed,
+        uint32_t mostDetailedMip,
+        const Texture* pSrc,
+        uint32_t srcMostDetailedMip,
+        const StreamedMipLoad* pLoad = nullptr
+    ) const;
+
+    void registerStreamedTexture(const CpuTextureHandle& handle, StreamedTexture&& streamed);
+
+    /**
+     * Request mip levels of a streamed texture to be loaded by a background job. The caller must hold the mutex.
+     * The source image is decoded once and all mips from mip down to the resident mip are generated from it.
+     */
+    void loadStreamedMips(uint32_t textureID, StreamedTexture& streamed, uint32_t mip);
+
+    /**
+     * Compute a hash of the source file contents and load flags of a texture.
+     * @return Content hash, or nothing if a file can't be read.
+     */
+    std::optional<SHA1::MD> computeContentHash(const TextureKey& key) const;
+
+    /**
+     * Alias a texture key to an already managed texture found by content deduplication.
+     */
+    void addAlias(const TextureKey& key, const CpuTextureHandle& handle);
+
     CpuTextureHandle addDesc(const TextureDesc& desc);
     TextureDesc& getDesc(const CpuTextureHandle& handle);
     void registerOwner(const CpuTextureHandle& handle, const Object* owner);
@@ -367,9 +591,24 @@ private:
     using Handles = std::set<CpuTextureHandle>;
     std::map<CpuTextureHandle, Objects> mHandleToObjects; ///< Map from texture handle to set of objects using the handle.
     std::map<const Object*, Handles> mObjectToHandles;    ///< Map from object to set of texture handles used by the object.
+    std::map<CpuTextureHandle, AsyncTextureLoader::RequestID> mLoadRequests; ///< Pending async load requests.
 
     bool mUseDeferredLoading = false;
 
+    std::shared_ptr<TextureCookCache> mpCookCache; ///< Cache of cooked textures, or nullptr if cooking is disabled.
+
+    StreamingOptions mStreamingOptions;
+    std::unique_ptr<TextureResidencyManager> mpResidencyManager; ///< Mip residency of streamed textures, indexed by handle ID.
+    std::map<uint32_t, StreamedTexture> mStreamedTextures;        ///< Map from handle ID to streamed texture data.
+    std::vector<StreamedMipLoad> mCompletedMipLoads;              ///< Mip loads finished since the last updateStreaming().
+    size_t mStreamingJobCount = 0;                                ///< Number of mip load jobs in flight.
+    uint64_t mNextLoadSerial = 1;                                 ///< Serial number of the next mip load.
+
+    bool mDeduplicationEnabled = false;
+    std::map<SHA1::MD, CpuTextureHandle> mContentHashToHandle; ///< Map from source file content hash to handle.
+    std::map<SHA1::MD, CpuTextureHandle> mPixelHashToHandle;   ///< Map from decoded image hash to handle.
+    std::map<CpuTextureHandle, uint64_t> mAliasCounts;         ///< Number of texture loads aliased to each handle by deduplication.
+
     AsyncTextureLoader mAsyncTextureLoader; ///< Utility for asynchronous texture loading.
     size_t mLoadRequestsInProgress = 0;     ///< Number of load requests currently in progress.
 
@@ -0,0 +1,266 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureResidencyManager.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+namespace Falcor
+{
+TextureResidencyManager::TextureResidencyManager(uint64_t budgetInBytes) : mBudget(budgetInBytes) {}
+
+void TextureResidencyManager::addTexture(uint32_t textureID, std::vector<uint64_t> mipSizes, uint32_t tailMip, uint32_t priority)
+{
+    FALCOR_CHECK(!hasTexture(textureID), "Texture {} is already added.", textureID);
+    FALCOR_CHECK(tailMip < mipSizes.size(), "Tail mip {} is out of range.", tailMip);
+
+    TextureState state;
+    state.mipSizes = std::move(mipSizes);
+    state.tailMip = tailMip;
+    state.residentMip = tailMip;
+    state.wantedMip = 0;
+    state.priority = priority;
+    state.lastUsed = mClock;
+
+    mResidentBytes += std::accumulate(state.mipSizes.begin() + tailMip, state.mipSizes.end(), uint64_t(0));
+    mTextures.emplace(textureID, std::move(state));
+}
+
+void TextureResidencyManager::removeTexture(uint32_t textureID)
+{
+    auto it = mTextures.find(textureID);
+    if (it == mTextures.end())
+        return;
+
+    const TextureState& state = it->second;
+    mResidentBytes -= std::accumulate(state.mipSizes.begin() + state.residentMip, state.mipSizes.end(), uint64_t(0));
+    if (state.pendingMip != kInvalidMip)
+        mPendingBytes -= getRangeSize(state, state.pendingMip, state.residentMip);
+    mTextures.erase(it);
+}
+
+void TextureResidencyManager::setPriority(uint32_t textureID, uint32_t priority)
+{
+    getTexture(textureID).priority = priority;
+}
+
+void TextureResidencyManager::markUsed(uint32_t textureID, uint32_t wantedMip)
+{
+    TextureState& state = getTexture(textureID);
+    state.wantedMip = std::min(wantedMip, state.tailMip);
+    state.lastUsed = mClock;
+}
+
+TextureResidencyManager::Update TextureResidencyManager::update(uint32_t maxLoads)
+{
+    Update update;
+
+    // Enforce the budget, e.g. after it has been lowered.
+    while (mResidentBytes + mPendingBytes > mBudget)
+    {
+        uint32_t victimID = findVictim(kInvalidID);
+        if (victimID == kInvalidID)
+            break;
+        evict(victimID, update);
+    }
+
+    // Gather textures that want more detail, most important first.
+    std::vector<uint32_t> candidates;
+    for (const auto& [id, state] : mTextures)
+    {
+        if (state.residentMip > state.wantedMip && state.pendingMip == kInvalidMip)
+            candidates.push_back(id);
+    }
+    std::stable_sort(
+        candidates.begin(),
+        candidates.end(),
+        [&](uint32_t a, uint32_t b)
+        {
+            const TextureState& sa = mTextures.at(a);
+            const TextureState& sb = mTextures.at(b);
+            if (isMoreImportant(sa, sb) != isMoreImportant(sb, sa))
+                return isMoreImportant(sa, sb);
+            // Prefer textures that are further from their wanted mip.
+            return sa.residentMip - sa.wantedMip > sb.residentMip - sb.wantedMip;
+        }
+    );
+
+    for (uint32_t id : candidates)
+    {
+        if (update.loads.size() >= maxLoads)
+            break;
+
+        // Load all mips down to the wanted mip at once. Make room by evicting less important textures.
+        TextureState& state = mTextures.at(id);
+        uint32_t mip = state.wantedMip;
+        while (mResidentBytes + mPendingBytes + getRangeSize(state, mip, state.residentMip) > mBudget)
+        {
+            uint32_t victimID = findVictim(id);
+            if (victimID == kInvalidID)
+                break;
+            evict(victimID, update);
+        }
+
+        // Load fewer mips if they still don't fit.
+        while (mip < state.residentMip && mResidentBytes + mPendingBytes + getRangeSize(state, mip, state.residentMip) > mBudget)
+            mip++;
+        if (mip == state.residentMip)
+            continue;
+
+        state.pendingMip = mip;
+        mPendingBytes += getRangeSize(state, mip, state.residentMip);
+        update.loads.push_back({id, mip});
+    }
+
+    mClock++;
+    return update;
+}
+
+void TextureResidencyManager::completeLoad(uint32_t textureID, uint32_t mip)
+{
+    TextureState& state = getTexture(textureID);
+    FALCOR_CHECK(state.pendingMip == mip, "Texture {} has no pending load for mip {}.", textureID, mip);
+
+    uint64_t size = getRangeSize(state, mip, state.residentMip);
+    mPendingBytes -= size;
+    mResidentBytes += size;
+    state.residentMip = mip;
+    state.pendingMip = kInvalidMip;
+    mLoadCount++;
+}
+
+void TextureResidencyManager::cancelLoad(uint32_t textureID, uint32_t mip)
+{
+    TextureState& state = getTexture(textureID);
+    FALCOR_CHECK(state.pendingMip == mip, "Texture {} has no pending load for mip {}.", textureID, mip);
+
+    mPendingBytes -= getRangeSize(state, mip, state.residentMip);
+    state.pendingMip = kInvalidMip;
+    state.wantedMip = state.residentMip;
+}
+
+uint32_t TextureResidencyManager::getResidentMip(uint32_t textureID) const
+{
+    auto it = mTextures.find(textureID);
+    return it != mTextures.end() ? it->second.residentMip : kInvalidMip;
+}
+
+TextureResidencyManager::Stats TextureResidencyManager::getStats() const
+{
+    Stats stats;
+    stats.budgetInBytes = mBudget;
+    stats.residentBytes = mResidentBytes;
+    stats.pendingBytes = mPendingBytes;
+    stats.textureCount = mTextures.size();
+    for (const auto& [id, state] : mTextures)
+    {
+        if (state.residentMip > state.wantedMip)
+            stats.pendingRequestCount++;
+    }
+    stats.loadCount = mLoadCount;
+    stats.evictionCount = mEvictionCount;
+    return stats;
+}
+
+TextureResidencyManager::TextureState& TextureResidencyManager::getTexture(uint32_t textureID)
+{
+    auto it = mTextures.find(textureID);
+    FALCOR_CHECK(it != mTextures.end(), "Unknown texture {}.", textureID);
+    return it->second;
+}
+
+bool TextureResidencyManager::isMoreImportant(const TextureState& a, const TextureState& b)
+{
+    return std::tie(a.priority, a.lastUsed) > std::tie(b.priority, b.lastUsed);
+}
+
+uint64_t TextureResidencyManager::getRangeSize(const TextureState& state, uint32_t firstMip, uint32_t endMip)
+{
+    return std::accumulate(state.mipSizes.begin() + firstMip, state.mipSizes.begin() + endMip, uint64_t(0));
+}
+
+uint32_t TextureResidencyManager::findVictim(uint32_t candidateID) const
+{
+    const TextureState* pCandidate = candidateID != kInvalidID ? &mTextures.at(candidateID) : nullptr;
+
+    uint32_t victimID = kInvalidID;
+    const TextureState* pVictim = nullptr;
+    for (const auto& [id, state] : mTextures)
+    {
+        // Only textures with evictable mips and no load in flight can be evicted.
+        if (id == candidateID || state.residentMip >= state.tailMip || state.pendingMip != kInvalidMip)
+            continue;
+
+        // Mips more detailed than wanted can always be evicted. Otherwise the texture must be less important than the candidate.
+        bool unwanted = state.residentMip < state.wantedMip;
+        if (pCandidate && !unwanted && !isMoreImportant(*pCandidate, state))
+            continue;
+
+        if (!pVictim)
+        {
+            victimID = id;
+            pVictim = &state;
+            continue;
+        }
+
+        bool victimUnwanted = pVictim->residentMip < pVictim->wantedMip;
+        if (unwanted != victimUnwanted)
+        {
+            if (unwanted)
+            {
+                victimID = id;
+                pVictim = &state;
+            }
+        }
+        else if (isMoreImportant(*pVictim, state))
+        {
+            victimID = id;
+            pVictim = &state;
+        }
+    }
+
+    return victimID;
+}
+
+void TextureResidencyManager::evict(uint32_t textureID, Update& update)
+{
+    TextureState& state = mTextures.at(textureID);
+    FALCOR_ASSERT(state.residentMip < state.tailMip);
+
+    mResidentBytes -= state.mipSizes[state.residentMip];
+    state.residentMip++;
+    mEvictionCount++;
+
+    auto it = std::find_if(update.evictions.begin(), update.evictions.end(), [&](const Request& r) { return r.textureID == textureID; });
+    if (it != update.evictions.end())
+        it->mip = state.residentMip;
+    else
+        update.evictions.push_back({textureID, state.residentMip});
+}
+} // namespace Falcor
@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU-side residency bookkeeping for mip streaming.
+ *
+ * Each texture has a tail mip that is always resident. More detailed mips are made resident by a single load of all
+ * mips down to the mip the texture is wanted at (mip 0 by default), or as many of them as fit. Resident mips of all
+ * textures share a memory budget. When a load doesn't fit, the most detailed mips of other textures are evicted.
+ * Eviction candidates are ordered by:
+ * 1. Mips that are more detailed than wanted.
+ * 2. Lower priority.
+ * 3. Least recently used.
+ * Textures are only evicted to make room for a load if they are less important than the texture being loaded.
+ *
+ * The class only tracks state. The caller performs the actual loads and evictions returned by update() and reports
+ * finished loads with completeLoad(). This class is not thread-safe.
+ */
+class FALCOR_API TextureResidencyManager
+{
+public:
+    static constexpr uint32_t kInvalidMip = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t kInvalidID = std::numeric_limits<uint32_t>::max();
+
+    struct Request
+    {
+        uint32_t textureID; ///< Texture ID.
+        uint32_t mip;       ///< For loads: most detailed mip to load (down to the resident mip). For evictions: new resident mip.
+    };
+
+    struct Update
+    {
+        std::vector<Request> loads;     ///< Mips to load. Report completion with completeLoad().
+        std::vector<Request> evictions; ///< Textures whose most detailed mips were evicted (one entry per texture).
+
+        bool empty() const { return loads.empty() && evictions.empty(); }
+    };
+
+    struct Stats
+    {
+        uint64_t budgetInBytes = 0;       ///< Memory budget.
+        uint64_t residentBytes = 0;       ///< Memory used by resident mips.
+        uint64_t pendingBytes = 0;        ///< Memory reserved for mips being loaded.
+        uint64_t textureCount = 0;        ///< Number of streamed textures.
+        uint64_t pendingRequestCount = 0; ///< Number of textures that are not yet resident at their wanted mip.
+        uint64_t loadCount = 0;           ///< Total number of completed loads.
+        uint64_t evictionCount = 0;       ///< Total number of evicted mips.
+    };
+
+    /**
+     * Constructor.
+     * @param[in] budgetInBytes Memory budget for all resident mips.
+     */
+    explicit TextureResidencyManager(uint64_t budgetInBytes);
+
+    void setBudget(uint64_t budgetInBytes) { mBudget = budgetInBytes; }
+    uint64_t getBudget() const { return mBudget; }
+
+    /**
+     * Add a texture. The tail mip and all coarser mips are resident immediately, even if the budget is exceeded.
+     * @param[in] textureID Unique texture ID.
+     * @param[in] mipSizes Size in bytes of each mip level, starting with mip 0.
+     * @param[in] tailMip Most detailed mip level that is always resident.
+     * @param[in] priority Priority of the texture. Higher priority textures are loaded first and evicted last.
+     */
+    void addTexture(uint32_t textureID, std::vector<uint64_t> mipSizes, uint32_t tailMip, uint32_t priority = 0);
+
+    /**
+     * Remove a texture. Pending loads for the texture are discarded.
+     */
+    void removeTexture(uint32_t textureID);
+
+    bool hasTexture(uint32_t textureID) const { return mTextures.find(textureID) != mTextures.end(); }
+
+    void setPriority(uint32_t textureID, uint32_t priority);
+
+    /**
+     * Mark a texture as used. This updates its LRU timestamp.
+     * @param[in] textureID Texture ID.
+     * @param[in] wantedMip Most detailed mip level the texture is wanted at. Clamped to the tail mip.
+     */
+    void markUsed(uint32_t textureID, uint32_t wantedMip = 0);
+
+    /**
+     * Determine the next loads and the evictions needed to make room for them.
+     * Evictions are applied to the bookkeeping immediately. Loads reserve memory until they are completed.
+     * Advances the LRU clock.
+     * @param[in] maxLoads Maximum number of loads to issue.
+     * @return List of loads and evictions.
+     */
+    Update update(uint32_t maxLoads);
+
+    /**
+     * Report that a load returned by update() has finished.
+     */
+    void completeLoad(uint32_t textureID, uint32_t mip);
+
+    /**
+     * Report that a load returned by update() has failed. The texture won't request more detailed mips.
+     */
+    void cancelLoad(uint32_t textureID, uint32_t mip);
+
+    /**
+     * Get the most detailed resident mip level of a texture.
+     * @return Mip level, or kInvalidMip if the texture doesn't exist.
+     */
+    uint32_t getResidentMip(uint32_t textureID) const;
+
+    Stats getStats() const;
+
+private:
+    struct TextureState
+    {
+        std::vector<uint64_t> mipSizes;
+        uint32_t tailMip = 0;
+        uint32_t residentMip = 0;
+        uint32_t wantedMip = 0;
+        uint32_t pendingMip = kInvalidMip;
+        uint32_t priority = 0;
+        uint64_t lastUsed = 0;
+    };
+
+    TextureState& getTexture(uint32_t textureID);
+    static bool isMoreImportant(const TextureState& a, const TextureState& b);
+    static uint64_t getRangeSize(const TextureState& state, uint32_t firstMip, uint32_t endMip);
+    uint32_t findVictim(uint32_t candidateID) const;
+    void evict(uint32_t textureID, Update& update);
+
+    std::map<uint32_t, TextureState> mTextures;
+    uint64_t mBudget = 0;
+    uint64_t mResidentBytes = 0;
+    uint64_t mPendingBytes = 0;
+    uint64_t mClock = 0;
+    uint64_t mLoadCount = 0;
+    uint64_t mEvictionCount = 0;
+};
+} // namespace Falcor
@@ -0,0 +1,189 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "JobSystem.h"
+#include "Core/Error.h"
+#include "Utils/Logger.h"
+#include <algorithm>
+
+namespace Falcor
+{
+namespace
+{
+// Job system and queue index of the current worker thread.
+thread_local const JobSystem* tWorkerJobSystem = nullptr;
+thread_local size_t tWorkerIndex = 0;
+} // namespace
+
+JobSystem::JobSystem(size_t threadCount)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    for (size_t i = 0; i < threadCount; ++i)
+        mQueues.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < threadCount; ++i)
+        mThreads.emplace_back(&JobSystem::runWorker, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mTerminate = true;
+    }
+    mSleepCondition.notify_all();
+
+    for (auto& thread : mThreads)
+        thread.join();
+}
+
+JobSystem& JobSystem::getShared()
+{
+    // Intentionally leaked, so worker threads are not joined during static destruction.
+    static JobSystem* spJobSystem = new JobSystem();
+    return *spJobSystem;
+}
+
+void JobSystem::submit(Job&& job, int32_t priority)
+{
+    FALCOR_ASSERT(job);
+
+    // Count the job before queuing it so the count never drops below the number of queued jobs.
+    // Increment under the sleep mutex so that a worker can't miss the wakeup between checking and waiting.
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mPendingCount++;
+    }
+
+    size_t queueIndex = isWorkerThread() ? tWorkerIndex : mNextQueue.fetch_add(1) % mQueues.size();
+    {
+        Queue& queue = *mQueues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.heap.push_back(Entry{priority, mSequence.fetch_add(1), std::move(job)});
+        std::push_heap(queue.heap.begin(), queue.heap.end());
+    }
+    mSleepCondition.notify_one();
+}
+
+bool JobSystem::runPendingJob()
+{
+    Job job;
+    if (!popJob(isWorkerThread() ? tWorkerIndex : 0, job))
+        return false;
+    runJob(job);
+    return true;
+}
+
+bool JobSystem::isWorkerThread() const
+{
+    return tWorkerJobSystem == this;
+}
+
+JobSystem::Stats JobSystem::getStats() const
+{
+    Stats stats;
+    stats.executedCount = mExecutedCount.load();
+    stats.stolenCount = mStolenCount.load();
+    return stats;
+}
+
+bool JobSystem::popJob(size_t queueIndex, Job& job)
+{
+    while (mPendingCount > 0)
+    {
+        // Find the queue with the highest priority job. The own queue is preferred for jobs of equal priority.
+        size_t bestIndex = mQueues.size();
+        int32_t bestPriority = 0;
+        for (size_t i = 0; i < mQueues.size(); ++i)
+        {
+            size_t index = (queueIndex + i) % mQueues.size();
+            Queue& queue = *mQueues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.heap.empty() && (bestIndex == mQueues.size() || queue.heap.front().priority > bestPriority))
+            {
+                bestIndex = index;
+                bestPriority = queue.heap.front().priority;
+            }
+        }
+
+        if (bestIndex == mQueues.size())
+            break;
+
+        // The queue may have been emptied in the meantime, in which case we search again.
+        Queue& queue = *mQueues[bestIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.heap.empty())
+            continue;
+        std::pop_heap(queue.heap.begin(), queue.heap.end());
+        job = std::move(queue.heap.back().job);
+        queue.heap.pop_back();
+        mPendingCount--;
+        if (bestIndex != queueIndex)
+            mStolenCount++;
+        return true;
+    }
+
+    return false;
+}
+
+void JobSystem::runJob(Job& job)
+{
+    try
+    {
+        job();
+    }
+    catch (const std::exception& e)
+    {
+        logError("JobSystem: Job failed with exception: {}", e.what());
+    }
+    catch (...)
+    {
+        logError("JobSystem: Job failed with unknown exception.");
+    }
+    mExecutedCount++;
+}
+
+void JobSystem::runWorker(size_t index)
+{
+    tWorkerJobSystem = this;
+    tWorkerIndex = index;
+
+    while (true)
+    {
+        Job job;
+        if (popJob(index, job))
+        {
+            runJob(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mSleepCondition.wait(lock, [&]() { return mTerminate || mPendingCount > 0; });
+        if (mTerminate && mPendingCount == 0)
+            break;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,142 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Work-stealing job system with job priorities.
+ *
+ * Each worker thread owns a queue ordered by priority (highest first), then submission order.
+ * Jobs submitted from a worker thread go to its own queue, other submissions are distributed round-robin.
+ * Workers run the highest priority job of all queues, preferring their own queue for jobs of equal priority,
+ * so a job never waits behind lower priority work on another thread.
+ *
+ * A process-wide instance is shared by TaskManager and AsyncTextureLoader, so concurrent
+ * users don't oversubscribe the CPU.
+ */
+class FALCOR_API JobSystem
+{
+public:
+    using Job = std::function<void()>;
+
+    struct Stats
+    {
+        uint64_t executedCount = 0; ///< Number of executed jobs.
+        uint64_t stolenCount = 0;   ///< Number of jobs executed by a worker other than the one they were queued on.
+    };
+
+    /**
+     * Constructor.
+     * @param[in] threadCount Number of worker threads.
+     */
+    explicit JobSystem(size_t threadCount = std::thread::hardware_concurrency());
+
+    /**
+     * Destructor. Runs all pending jobs and joins the worker threads.
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * Get the process-wide job system.
+     */
+    static JobSystem& getShared();
+
+    /**
+     * Submit a job. Exceptions thrown by the job are logged and otherwise ignored.
+     * @param[in] job Job to run.
+     * @param[in] priority Job priority. Higher priority jobs run first.
+     */
+    void submit(Job&& job, int32_t priority = 0);
+
+    /**
+     * Run a pending job on the calling thread.
+     * Threads that block on jobs of the same job system should call this while waiting to avoid deadlocks.
+     * @return True if a job was run.
+     */
+    bool runPendingJob();
+
+    /**
+     * Check if the calling thread is a worker thread of this job system.
+     */
+    bool isWorkerThread() const;
+
+    size_t getThreadCount() const { return mThreads.size(); }
+
+    Stats getStats() const;
+
+private:
+    struct Entry
+    {
+        int32_t priority;
+        uint64_t sequence;
+        Job job;
+
+        /// Heap order: highest priority first, then lowest sequence number.
+        bool operator<(const Entry& other) const
+        {
+            return priority != other.priority ? priority < other.priority : sequence > other.sequence;
+        }
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::vector<Entry> heap;
+    };
+
+    bool popJob(size_t queueIndex, Job& job);
+    void runJob(Job& job);
+    void runWorker(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mSleepMutex;
+    std::condition_variable mSleepCondition;
+    bool mTerminate = false;
+
+    std::atomic<size_t> mPendingCount{0};
+    std::atomic<uint64_t> mSequence{0};
+    std::atomic<size_t> mNextQueue{0};
+    std::atomic<uint64_t> mExecutedCount{0};
+    std::atomic<uint64_t> mStolenCount{0};
+};
+} // namespace Falcor
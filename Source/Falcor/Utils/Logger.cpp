@@ -29,21 +29,49 @@
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <map>
 #include <string>
 #include <mutex>
 #include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace Falcor
 {
 namespace
 {
+using Clock = std::chrono::steady_clock;
+
+// Capacity of the message queue. Callers wait for the writer thread when the queue is full.
+const uint64_t kQueueCapacity = 4096;
+
+// Maximum number of messages written to the outputs at once.
+const size_t kMaxBatchSize = 256;
+
+// Time after which the idle writer thread checks the queue even without being woken up.
+const std::chrono::milliseconds kWriterIdleTimeout(100);
+
+// Maximum time Logger::shutdown() spends writing pending messages.
+const std::chrono::seconds kShutdownFlushTimeout(1);
+
+// Number of messages reported per call site and period for Frequency::Limited.
+const uint32_t kRateLimitCount = 100;
+const std::chrono::seconds kRateLimitPeriod(1);
+
 std::mutex sMutex;
-Logger::Level sVerbosity = Logger::Level::Info;
-Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
+std::atomic<Logger::Level> sVerbosity{Logger::Level::Info};
+std::atomic<Logger::OutputFlags> sOutputs{
+    Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow
+};
 std::filesystem::path sLogFilePath;
 
 bool sInitialized = false;
+bool sLogFileCreated = false;
 FILE* sLogFile = nullptr;
 
 std::filesystem::path generateLogFilePath()
@@ -62,10 +90,12 @@ FILE* openLogFile()
         sLogFilePath = generateLogFilePath();
     }
 
-    pFile = std::fopen(sLogFilePath.string().c_str(), "w");
+    // Append when reopening the file after a shutdown, so that late messages don't clear the log.
+    pFile = std::fopen(sLogFilePath.string().c_str(), sLogFileCreated ? "a" : "w");
     if (pFile != nullptr)
     {
         // Success
+        sLogFileCreated = true;
         return pFile;
     }
 
@@ -84,21 +114,383 @@ void printToLogFile(const std::string& s)
 
     if (sLogFile)
     {
-        std::fprintf(sLogFile, "%s", s.c_str());
+        std::fwrite(s.data(), 1, s.size(), sLogFile);
         std::fflush(sLogFile);
     }
 }
-} // namespace
 
-void Logger::shutdown()
+struct LogMessage
 {
-    if (sLogFile)
+    Logger::Level level = Logger::Level::Info;
+    Logger::OutputFlags outputs = Logger::OutputFlags::None;
+    std::string text;
+};
+
+/**
+ * Write messages to their outputs.
+ * Consecutive messages are concatenated so that each output is written and flushed once per batch.
+ */
+void writeMessages(const LogMessage* pMessages, size_t count)
+{
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    std::string console;
+    std::string file;
+    std::string debugWindow;
+    std::ostream* pConsole = nullptr;
+    bool debuggerPresent = isDebuggerPresent();
+
+    auto flushConsole = [&]()
     {
-        fclose(sLogFile);
-        sLogFile = nullptr;
-        sInitialized = false;
+        if (pConsole && !console.empty())
+        {
+            *pConsole << console;
+            pConsole->flush();
+        }
+        console.clear();
+    };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LogMessage& message = pMessages[i];
+
+        // Write to console, keeping the order of messages when switching between stdout and stderr.
+        if (is_set(message.outputs, Logger::OutputFlags::Console))
+        {
+            std::ostream* pStream = message.level > Logger::Level::Error ? &std::cout : &std::cerr;
+            if (pStream != pConsole)
+            {
+                flushConsole();
+                pConsole = pStream;
+            }
+            console += message.text;
+        }
+
+        // Write to file.
+        if (is_set(message.outputs, Logger::OutputFlags::File))
+            file += message.text;
+
+        // Write to debug window if debugger is attached.
+        if (is_set(message.outputs, Logger::OutputFlags::DebugWindow) && debuggerPresent)
+            debugWindow += message.text;
+    }
+
+    flushConsole();
+    if (!file.empty())
+        printToLogFile(file);
+    if (!debugWindow.empty())
+        printToDebugWindow(debugWindow);
+}
+
+/**
+ * Bounded multi-producer single-consumer queue of log messages.
+ * Each slot holds a sequence number telling whether it is free for the producer of a given write index
+ * or filled for the consumer, so producers only contend on the shared write index.
+ */
+class MessageQueue
+{
+public:
+    MessageQueue() : mSlots(new Slot[kQueueCapacity])
+    {
+        for (uint64_t i = 0; i < kQueueCapacity; ++i)
+            mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /// Push a message, returns false if the queue is full.
+    bool tryPush(LogMessage& message)
+    {
+        uint64_t index = mWriteIndex.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = mSlots[index % kQueueCapacity];
+            int64_t diff = (int64_t)slot.sequence.load(std::memory_order_acquire) - (int64_t)index;
+            if (diff == 0)
+            {
+                if (mWriteIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed))
+                {
+                    slot.message = std::move(message);
+                    slot.sequence.store(index + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                index = mWriteIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Pop a message, returns false if the queue is empty. Must only be called by the consumer.
+    bool tryPop(LogMessage& message)
+    {
+        Slot& slot = mSlots[mReadIndex % kQueueCapacity];
+        if (slot.sequence.load(std::memory_order_acquire) != mReadIndex + 1)
+            return false;
+        message = std::move(slot.message);
+        slot.sequence.store(mReadIndex + kQueueCapacity, std::memory_order_release);
+        ++mReadIndex;
+        return true;
+    }
+
+    /// Check if the next message is ready. Must only be called by the consumer.
+    bool isReady() const { return mSlots[mReadIndex % kQueueCapacity].sequence.load(std::memory_order_acquire) == mReadIndex + 1; }
+
+    /// Get the number of messages pushed (or being pushed) so far.
+    uint64_t getPushCount() const { return mWriteIndex.load(std::memory_order_acquire); }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        LogMessage message;
+    };
+
+    std::unique_ptr<Slot[]> mSlots;
+    alignas(64) std::atomic<uint64_t> mWriteIndex{0};
+    alignas(64) uint64_t mReadIndex = 0;
+};
+
+/// Log the reports of rate limited messages whose period has ended. Called periodically by the writer thread.
+void logExpiredRateLimitReports();
+
+/**
+ * Background thread writing queued messages to the outputs.
+ * The thread is started on the first message and stopped by Logger::shutdown() or at process exit.
+ */
+class LogWriter
+{
+public:
+    static LogWriter& get()
+    {
+        // Never destroyed, so messages logged during static destruction are still handled.
+        static LogWriter* spWriter = new LogWriter();
+        return *spWriter;
+    }
+
+    /**
+     * Queue a message for the writer thread.
+     * @return Returns false if the writer thread is not available, in which case the message is not consumed.
+     */
+    bool post(LogMessage& message)
+    {
+        // Messages logged by the writer thread itself are written directly, the queue may be full.
+        if (tIsWriterThread || !ensureRunning())
+            return false;
+
+        while (!mQueue.tryPush(message))
+        {
+            // The queue is full, let the writer catch up.
+            if (!mRunning.load(std::memory_order_acquire))
+                return false;
+            wake();
+            std::this_thread::yield();
+        }
+
+        // Pairs with the fence in run() so that either the writer sees the message or we see it sleeping.
+        // Only the first message after the writer went to sleep wakes it up.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mSleeping.load(std::memory_order_relaxed) && mSleeping.exchange(false, std::memory_order_relaxed))
+            wake();
+        return true;
+    }
+
+    /// Wait until all messages queued so far are written.
+    void flush()
+    {
+        if (tIsWriterThread || !mRunning.load(std::memory_order_acquire))
+            return;
+
+        uint64_t target = mQueue.getPushCount();
+        wake();
+        std::unique_lock<std::mutex> lock(mFlushMutex);
+        mFlushCondition.wait(lock, [&]() { return mWrittenCount >= target || mFinished; });
+    }
+
+    /**
+     * Stop the writer thread after writing pending messages, waiting for at most kShutdownFlushTimeout.
+     * @param[in] disable Write all further messages synchronously (used at process exit).
+     */
+    void stop(bool disable)
+    {
+        std::lock_guard<std::mutex> controlLock(mControlMutex);
+        mDisabled = mDisabled || disable;
+        if (!mRunning.load(std::memory_order_relaxed))
+            return;
+
+        // At process exit, don't wait for an idle thread. It may already have been terminated by the OS.
+        if (disable)
+        {
+            std::lock_guard<std::mutex> lock(mFlushMutex);
+            if (mWrittenCount == mQueue.getPushCount())
+            {
+                mThread.detach();
+                mRunning.store(false, std::memory_order_release);
+                return;
+            }
+        }
+
+        Clock::time_point deadline = Clock::now() + kShutdownFlushTimeout;
+        mDeadline = deadline;
+        mStopRequested.store(true, std::memory_order_release);
+        wake();
+
+        // Wait with a bound as well, as the thread may already be gone during process exit.
+        std::unique_lock<std::mutex> lock(mFlushMutex);
+        bool finished = mFlushCondition.wait_until(lock, deadline + kWriterIdleTimeout, [&]() { return mFinished; });
+        uint64_t droppedCount = mDroppedCount;
+        mDroppedCount = 0;
+        lock.unlock();
+
+        if (finished)
+        {
+            mThread.join();
+        }
+        else
+        {
+            // The thread is stuck, so it can't be restarted safely.
+            mThread.detach();
+            mDisabled = true;
+        }
+
+        mRunning.store(false, std::memory_order_release);
+        mStopRequested.store(false, std::memory_order_relaxed);
+        mFinished = false;
+
+        if (droppedCount > 0)
+            std::fprintf(stderr, "(Warning) Logger dropped %llu messages on shutdown.\n", (unsigned long long)droppedCount);
+    }
+
+private:
+    LogWriter() = default;
+
+    bool ensureRunning()
+    {
+        if (mRunning.load(std::memory_order_acquire))
+            return true;
+
+        std::lock_guard<std::mutex> controlLock(mControlMutex);
+        if (mRunning.load(std::memory_order_relaxed))
+            return true;
+        if (mDisabled)
+            return false;
+
+        try
+        {
+            mThread = std::thread([this]() { run(); });
+        }
+        catch (const std::system_error&)
+        {
+            mDisabled = true;
+            return false;
+        }
+        mRunning.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void wake()
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        mWakeCondition.notify_one();
     }
+
+    void run()
+    {
+        tIsWriterThread = true;
+
+        std::vector<LogMessage> batch;
+        batch.reserve(kMaxBatchSize);
+        LogMessage message;
+        Clock::time_point nextReportTime = Clock::now() + kWriterIdleTimeout;
+
+        while (true)
+        {
+            // Report suppressed messages of call sites that went quiet, instead of waiting for their next message.
+            if (Clock::now() >= nextReportTime)
+            {
+                logExpiredRateLimitReports();
+                nextReportTime = Clock::now() + kWriterIdleTimeout;
+            }
+
+            while (batch.size() < kMaxBatchSize && mQueue.tryPop(message))
+                batch.push_back(std::move(message));
+
+            bool stopRequested = mStopRequested.load(std::memory_order_acquire);
+            if (!batch.empty())
+            {
+                bool drop = stopRequested && Clock::now() > mDeadline;
+                if (!drop)
+                    writeMessages(batch.data(), batch.size());
+
+                std::lock_guard<std::mutex> lock(mFlushMutex);
+                mWrittenCount += batch.size();
+                if (drop)
+                    mDroppedCount += batch.size();
+                mFlushCondition.notify_all();
+                batch.clear();
+                continue;
+            }
+
+            if (stopRequested)
+                break;
+
+            // Sleep until new messages arrive.
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!mQueue.isReady() && !mStopRequested.load(std::memory_order_acquire))
+                mWakeCondition.wait_for(lock, kWriterIdleTimeout);
+            mSleeping.store(false, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(mFlushMutex);
+        mFinished = true;
+        mFlushCondition.notify_all();
+    }
+
+    MessageQueue mQueue;
+
+    std::mutex mControlMutex; ///< Serializes starting and stopping the thread.
+    std::thread mThread;
+    std::atomic<bool> mRunning{false};
+    std::atomic<bool> mStopRequested{false};
+    Clock::time_point mDeadline; ///< Deadline for writing pending messages, published by mStopRequested.
+    bool mDisabled = false;
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::atomic<bool> mSleeping{false};
+
+    std::mutex mFlushMutex;
+    std::condition_variable mFlushCondition;
+    uint64_t mWrittenCount = 0;
+    uint64_t mDroppedCount = 0;
+    bool mFinished = false;
+
+    static thread_local bool tIsWriterThread;
+};
+
+thread_local bool LogWriter::tIsWriterThread = false;
+
+/// Writes pending messages when the process exits without calling Logger::shutdown().
+struct LogWriterExitGuard
+{
+    ~LogWriterExitGuard() { LogWriter::get().stop(true); }
+} sLogWriterExitGuard;
+
+void postMessage(Logger::Level level, std::string text)
+{
+    LogMessage message{level, sOutputs.load(std::memory_order_relaxed), std::move(text)};
+    LogWriter& writer = LogWriter::get();
+    if (!writer.post(message))
+        writeMessages(&message, 1);
+    else if (level == Logger::Level::Fatal)
+        writer.flush();
 }
+} // namespace
 
 inline const char* getLogLevelString(Logger::Level level)
 {
@@ -146,64 +538,208 @@ private:
     std::set<std::string, std::less<>> mStrings;
 };
 
-void Logger::log(Level level, const std::string_view msg, Frequency frequency)
+class MessageRateLimiter
 {
-    std::lock_guard<std::mutex> lock(sMutex);
-    if (level <= sVerbosity)
+public:
+    static MessageRateLimiter& instance()
     {
-        std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+        // Never destroyed, as the writer thread may still take reports during static destruction.
+        static MessageRateLimiter* spInstance = new MessageRateLimiter();
+        return *spInstance;
+    }
 
-        if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(s))
-            return;
+    /**
+     * Count a message against the rate limit of its call site.
+     * @param[in] pSite Call site key.
+     * @param[in] sample Message (or format string) shown when reporting suppressed messages.
+     * @param[out] report Report of messages suppressed in the previous period, or empty.
+     * @return Returns true if the message should be logged.
+     */
+    bool acquire(Logger::Level level, const void* pSite, std::string_view sample, std::string& report)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mSites.find(pSite);
+        if (it == mSites.end())
+            it = mSites.emplace(pSite, Site{level, std::string(sample)}).first;
+        return acquire(it->second, report);
+    }
+
+    /// Count a message against the rate limit of the exact string.
+    bool acquire(Logger::Level level, std::string_view msg, std::string& report)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mMessages.find(msg);
+        if (it == mMessages.end())
+            it = mMessages.emplace(std::string(msg), Site{level, std::string(msg)}).first;
+        return acquire(it->second, report);
+    }
 
-        // Write to console.
-        if (is_set(sOutputs, OutputFlags::Console))
+    /**
+     * Take the reports of suppressed messages.
+     * @param[in] expiredOnly Only take the reports of call sites whose period has ended, and start a new period for them.
+     */
+    std::vector<std::pair<Logger::Level, std::string>> takeReports(bool expiredOnly = false)
+    {
+        std::vector<std::pair<Logger::Level, std::string>> reports;
+        Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto takeReport = [&](Site& site)
         {
-            auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
-            os << s;
-            os.flush();
-        }
+            if (site.suppressed == 0)
+                return;
+            if (expiredOnly)
+            {
+                if (now - site.periodStart < kRateLimitPeriod)
+                    return;
+                site.periodStart = now;
+                site.count = 0;
+            }
+            reports.emplace_back(site.level, formatReport(site));
+            site.suppressed = 0;
+        };
+        for (auto& it : mSites)
+            takeReport(it.second);
+        for (auto& it : mMessages)
+            takeReport(it.second);
+        return reports;
+    }
 
-        // Write to file.
-        if (is_set(sOutputs, OutputFlags::File))
+private:
+    struct Site
+    {
+        Logger::Level level;
+        std::string sample;
+        Clock::time_point periodStart = Clock::now();
+        uint32_t count = 0;
+        uint64_t suppressed = 0;
+    };
+
+    MessageRateLimiter() = default;
+
+    static std::string formatReport(const Site& site)
+    {
+        return fmt::format("Suppressed {} messages like: {}", site.suppressed, site.sample);
+    }
+
+    bool acquire(Site& site, std::string& report)
+    {
+        Clock::time_point now = Clock::now();
+        if (now - site.periodStart >= kRateLimitPeriod)
         {
-            printToLogFile(s);
+            if (site.suppressed > 0)
+                report = formatReport(site);
+            site.periodStart = now;
+            site.count = 0;
+            site.suppressed = 0;
         }
 
-        // Write to debug window if debugger is attached.
-        if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
+        if (site.count < kRateLimitCount)
         {
-            printToDebugWindow(s);
+            site.count++;
+            return true;
         }
+        site.suppressed++;
+        return false;
     }
+
+    std::mutex mMutex;
+    std::unordered_map<const void*, Site> mSites;
+    std::map<std::string, Site, std::less<>> mMessages;
+};
+
+namespace
+{
+void logExpiredRateLimitReports()
+{
+    for (const auto& [level, report] : MessageRateLimiter::instance().takeReports(true))
+        Logger::log(level, report);
 }
+} // namespace
 
-void Logger::setVerbosity(Level level)
+void Logger::shutdown()
 {
+    for (const auto& [level, report] : MessageRateLimiter::instance().takeReports())
+        log(level, report);
+
+    LogWriter::get().stop(false);
+
     std::lock_guard<std::mutex> lock(sMutex);
-    sVerbosity = level;
+    if (sLogFile)
+    {
+        fclose(sLogFile);
+        sLogFile = nullptr;
+        sInitialized = false;
+    }
+}
+
+void Logger::flush()
+{
+    LogWriter::get().flush();
+}
+
+bool Logger::isEnabled(Level level)
+{
+    return level <= sVerbosity.load(std::memory_order_relaxed);
+}
+
+bool Logger::checkRateLimit(Level level, std::string_view format)
+{
+    std::string report;
+    bool allowed = MessageRateLimiter::instance().acquire(level, format.data(), format, report);
+    if (!report.empty())
+        log(level, report);
+    return allowed;
+}
+
+void Logger::log(Level level, const std::string_view msg, Frequency frequency)
+{
+    if (!isEnabled(level))
+        return;
+
+    if (frequency == Frequency::Limited)
+    {
+        std::string report;
+        bool allowed = MessageRateLimiter::instance().acquire(level, msg, report);
+        if (!report.empty())
+            log(level, report);
+        if (!allowed)
+            return;
+    }
+
+    std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+
+    if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(s))
+        return;
+
+    // Formatting and deduplication run on the calling thread, writing to the outputs on the writer thread.
+    postMessage(level, std::move(s));
+}
+
+void Logger::setVerbosity(Level level)
+{
+    sVerbosity.store(level, std::memory_order_relaxed);
 }
 
 Logger::Level Logger::getVerbosity()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
-    return sVerbosity;
+    return sVerbosity.load(std::memory_order_relaxed);
 }
 
 void Logger::setOutputs(OutputFlags outputs)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
-    sOutputs = outputs;
+    sOutputs.store(outputs, std::memory_order_relaxed);
 }
 
 Logger::OutputFlags Logger::getOutputs()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
-    return sOutputs;
+    return sOutputs.load(std::memory_order_relaxed);
 }
 
 void Logger::setLogFilePath(const std::filesystem::path& path)
 {
+    // Write pending messages to the previous file.
+    flush();
+
     std::lock_guard<std::mutex> lock(sMutex);
     if (sLogFile)
     {
@@ -212,6 +748,7 @@ void Logger::setLogFilePath(const std::filesystem::path& path)
         sInitialized = false;
     }
     sLogFilePath = path;
+    sLogFileCreated = false;
 }
 
 std::filesystem::path Logger::getLogFilePath()
@@ -256,6 +793,7 @@ FALCOR_SCRIPT_BINDING(Logger)
         [](pybind11::object, std::filesystem::path path) { Logger::setLogFilePath(path); }
     );
 
+    logger.def_static("flush", &Logger::flush);
     logger.def_static(
         "log",
         [](Logger::Level level, const std::string_view msg) { Logger::log(level, msg, Logger::Frequency::Always); },
@@ -37,6 +37,8 @@ namespace Falcor
 /**
  * Container class for logging messages.
  * Messages are only printed to the selected outputs if they match the verbosity level.
+ * Messages are queued and written to the outputs by a background thread. Fatal messages
+ * are written before returning, use flush() to wait for all other pending messages.
  */
 class FALCOR_API Logger
 {
@@ -55,8 +57,10 @@ public:
 
     enum class Frequency
     {
-        Always, ///< Reports the message always
-        Once,   ///< Reports the message only first time the exact string appears
+        Always,  ///< Reports the message always
+        Once,    ///< Reports the message only first time the exact string appears
+        Limited, ///< Reports the message at most 100 times per second per call site (or exact string), counting the rest
+                 ///< and reporting their number when the period ends
     };
 
     /// Log output.
@@ -70,9 +74,15 @@ public:
 
     /**
      * Shutdown the logger and close the log file.
+     * Pending messages are written for at most one second before they are dropped.
      */
     static void shutdown();
 
+    /**
+     * Wait until all pending messages are written to the outputs.
+     */
+    static void flush();
+
     /**
      * Set the logger verbosity.
      * @param level Log level.
@@ -109,6 +119,23 @@ public:
      */
     static std::filesystem::path getLogFilePath();
 
+    /**
+     * Check if messages of a given level are logged with the current verbosity.
+     * This is used to skip formatting of messages that are filtered out.
+     * @param[in] level Log level.
+     * @return Returns true if messages of the given level are logged.
+     */
+    static bool isEnabled(Level level);
+
+    /**
+     * Count a message against the rate limit of its call site (see Frequency::Limited).
+     * This is used to skip formatting of messages that are suppressed.
+     * @param[in] level Log level, used for reporting suppressed messages.
+     * @param[in] format Format string of the message. Its address identifies the call site.
+     * @return Returns true if the message should be logged.
+     */
+    static bool checkRateLimit(Level level, std::string_view format);
+
     /**
      * Log a message.
      * @param[in] level Log level.
@@ -134,7 +161,8 @@ inline void logDebug(const std::string_view msg)
 template<typename... Args>
 inline void logDebug(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Debug, fmt::format(format, std::forward<Args>(args)...));
+    if (Logger::isEnabled(Logger::Level::Debug))
+        Logger::log(Logger::Level::Debug, fmt::format(format, std::forward<Args>(args)...));
 }
 
 inline void logInfo(const std::string_view msg)
@@ -145,7 +173,8 @@ inline void logInfo(const std::string_view msg)
 template<typename... Args>
 inline void logInfo(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Info, fmt::format(format, std::forward<Args>(args)...));
+    if (Logger::isEnabled(Logger::Level::Info))
+        Logger::log(Logger::Level::Info, fmt::format(format, std::forward<Args>(args)...));
 }
 
 inline void logWarning(const std::string_view msg)
@@ -156,7 +185,8 @@ inline void logWarning(const std::string_view msg)
 template<typename... Args>
 inline void logWarning(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...));
+    if (Logger::isEnabled(Logger::Level::Warning))
+        Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...));
 }
 
 inline void logWarningOnce(const std::string_view msg)
@@ -167,7 +197,22 @@ inline void logWarningOnce(const std::string_view msg)
 template<typename... Args>
 inline void logWarningOnce(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once);
+    if (Logger::isEnabled(Logger::Level::Warning))
+        Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once);
+}
+
+inline void logWarningLimited(const std::string_view msg)
+{
+    Logger::log(Logger::Level::Warning, msg, Logger::Frequency::Limited);
+}
+
+template<typename... Args>
+inline void logWarningLimited(fmt::format_string<Args...> format, Args&&... args)
+{
+    // Check the rate limit of the call site before formatting the message.
+    fmt::string_view str = format;
+    if (Logger::isEnabled(Logger::Level::Warning) && Logger::checkRateLimit(Logger::Level::Warning, {str.data(), str.size()}))
+        Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...));
 }
 
 inline void logError(const std::string_view msg)
@@ -178,7 +223,8 @@ inline void logError(const std::string_view msg)
 template<typename... Args>
 inline void logError(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...));
+    if (Logger::isEnabled(Logger::Level::Error))
+        Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...));
 }
 
 inline void logErrorOnce(const std::string_view msg)
@@ -189,7 +235,22 @@ inline void logErrorOnce(const std::string_view msg)
 template<typename... Args>
 inline void logErrorOnce(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once);
+    if (Logger::isEnabled(Logger::Level::Error))
+        Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...), Logger::Frequency::Once);
+}
+
+inline void logErrorLimited(const std::string_view msg)
+{
+    Logger::log(Logger::Level::Error, msg, Logger::Frequency::Limited);
+}
+
+template<typename... Args>
+inline void logErrorLimited(fmt::format_string<Args...> format, Args&&... args)
+{
+    // Check the rate limit of the call site before formatting the message.
+    fmt::string_view str = format;
+    if (Logger::isEnabled(Logger::Level::Error) && Logger::checkRateLimit(Logger::Level::Error, {str.data(), str.size()}))
+        Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...));
 }
 
 inline void logFatal(const std::string_view msg)
@@ -200,7 +261,8 @@ inline void logFatal(const std::string_view msg)
 template<typename... Args>
 inline void logFatal(fmt::format_string<Args...> format, Args&&... args)
 {
-    Logger::log(Logger::Level::Fatal, fmt::format(format, std::forward<Args>(args)...));
+    if (Logger::isEnabled(Logger::Level::Fatal))
+        Logger::log(Logger::Level::Fatal, fmt::format(format, std::forward<Args>(args)...));
 }
 
 } // namespace Falcor
@@ -326,6 +326,26 @@ template<typename T>
     return inverse * oneOverDet;
 }
 
+/// Compute inverse of an affine 4x4 matrix, i.e. a matrix with a last row of (0, 0, 0, 1).
+/// Only the upper 3x3 part needs a full inverse, which makes this considerably cheaper than the general 4x4 inverse.
+template<typename T>
+[[nodiscard]] inline matrix<T, 4, 4> inverseAffine(const matrix<T, 4, 4>& m)
+{
+    matrix<T, 3, 3> a = inverse(matrix<T, 3, 3>{
+        m[0][0], m[0][1], m[0][2], //
+        m[1][0], m[1][1], m[1][2], //
+        m[2][0], m[2][1], m[2][2], //
+    });
+    vector<T, 3> t(m[0][3], m[1][3], m[2][3]);
+
+    return matrix<T, 4, 4>{
+        a[0][0], a[0][1], a[0][2], -dot(a[0], t), //
+        a[1][0], a[1][1], a[1][2], -dot(a[1], t), //
+        a[2][0], a[2][1], a[2][2], -dot(a[2], t), //
+        T(0),    T(0),    T(0),    T(1),          //
+    };
+}
+
 /// Compute the (X * Y * Z) euler angles of a 4x4 matrix.
 template<typename T>
 void extractEulerAngleXYZ(const matrix<T, 4, 4>& m, float& angleX, float& angleY, float& angleZ)
@@ -753,6 +773,23 @@ template<typename T>
     return m;
 }
 
+/// Creates a transform matrix from a translation, rotation and scaling. This is equivalent to T * R * S,
+/// but avoids the two full matrix products.
+template<typename T>
+[[nodiscard]] inline matrix<T, 4, 4> matrixFromTRS(const vector<T, 3>& t, const quat<T>& r, const vector<T, 3>& s)
+{
+    matrix<T, 3, 3> rot = matrixFromQuat(r);
+    matrix<T, 4, 4> m = matrix<T, 4, 4>::identity();
+    for (int i = 0; i < 3; ++i)
+    {
+        m[i][0] = rot[i][0] * s.x;
+        m[i][1] = rot[i][1] * s.y;
+        m[i][2] = rot[i][2] * s.z;
+        m[i][3] = t[i];
+    }
+    return m;
+}
+
 template<typename T, int R, int C>
 [[nodiscard]] std::string to_string(const matrix<T, R, C>& m)
 {
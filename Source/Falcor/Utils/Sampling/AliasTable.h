@@ -29,6 +29,7 @@
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 #include "Core/Program/ShaderVar.h"
+#include "AliasTableBuilder.h"
 #include <memory>
 #include <random>
 
@@ -36,6 +37,7 @@ namespace Falcor
 {
 /**
  * Implements the alias method for sampling from a discrete probability distribution.
+ * The table is built on the CPU by AliasTableBuilder, this class holds the GPU copy.
  */
 class FALCOR_API AliasTable
 {
@@ -45,10 +47,23 @@ public:
      * The weights don't need to be normalized to sum up to 1.
      * @param[in] pDevice GPU device.
      * @param[in] weights The weights we'd like to sample each entry proportional to.
-     * @param[in] rng The random number generator to use when creating the table.
+     * @param[in] rng Unused, the table is built deterministically. Kept for compatibility.
      */
     AliasTable(ref<Device> pDevice, std::vector<float> weights, std::mt19937& rng);
 
+    /**
+     * Create an alias table from a table built on the CPU.
+     * @param[in] pDevice GPU device.
+     * @param[in] builder Builder holding the table. Pending weight changes must be built first.
+     */
+    AliasTable(ref<Device> pDevice, const AliasTableBuilder& builder);
+
+    /**
+     * Upload a rebuilt table. The GPU buffers are reused if the number of weights is unchanged.
+     * @param[in] builder Builder holding the table. Pending weight changes must be built first.
+     */
+    void update(const AliasTableBuilder& builder);
+
     /**
      * Bind the alias table data to a given shader var.
      * @param[in] var The shader variable to set the data into.
@@ -66,17 +81,9 @@ public:
     double getWeightSum() const { return mWeightSum; }
 
 private:
-    // Item structure for the mpItems buffer.
-    struct Item
-    {
-        float threshold; ///< If rand() < threshold, pick indexB (else pick indexA)
-        uint32_t indexA; ///< The "redirect" index, if uniform sampling would overweight indexB.
-        uint32_t indexB; ///< The original / permutation index, sampled uniformly in [0...mCount-1]
-        uint32_t _pad;
-    };
-
-    uint32_t mCount;       ///< Number of items in the alias table.
-    double mWeightSum;     ///< Total weight of all elements used to create the alias table.
+    ref<Device> mpDevice;
+    uint32_t mCount = 0;     ///< Number of items in the alias table.
+    double mWeightSum = 0.0; ///< Total weight of all elements used to create the alias table.
     ref<Buffer> mpItems;   ///< Buffer containing table items.
     ref<Buffer> mpWeights; ///< Buffer containing item weights.
 };
@@ -0,0 +1,362 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AliasTableBuilder.h"
+#include "Core/Error.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <execution>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+/// Number of weights per chunk. Chunks are the unit of parallel work and of reuse on partial updates.
+const uint32_t kChunkSize = 16384;
+} // namespace
+
+// The table is built with the parallel sweeping method from Hübschle-Schneider and Sanders 2022, "Parallel Weighted
+// Random Sampling," ACM Transactions on Mathematical Software 48(3).
+//
+// Every entry below the average weight (light) gets the bucket at its own index, and the rest of that bucket is
+// filled by the current above-average entry (heavy). Once the residual weight of a heavy drops to the average or
+// below, it becomes a bucket itself and the next heavy fills the rest. Done sequentially, this is a merge of the
+// light and heavy lists: with X(a) = a * avg - sum of the first a lights and Y(b) = sum of the first b + 1 heavies
+// - (b + 1) * avg, light a is taken before heavy b iff X(a) < Y(b). Both sequences are non-decreasing, so the
+// state after any number of buckets is found by a binary search over the merge path, and disjoint bucket ranges
+// are swept in parallel. Residuals are computed from prefix sums rather than by repeated subtraction, so rounding
+// errors don't accumulate along the sweep.
+AliasTableBuilder::AliasTableBuilder(std::vector<float> weights)
+{
+    setWeights(std::move(weights));
+    build();
+}
+
+void AliasTableBuilder::setWeights(std::vector<float> weights)
+{
+    // Use >= since we reserve 0xFFFFFFFFu as an invalid index.
+    if (weights.size() >= std::numeric_limits<uint32_t>::max())
+        FALCOR_THROW("Too many entries for alias table.");
+
+    mWeights = std::move(weights);
+    const uint32_t count = getCount();
+    const uint32_t chunkCount = div_round_up(count, kChunkSize);
+    mChunks.assign(chunkCount, Chunk{});
+    mItems.resize(count);
+    mEntries.resize(count);
+    mPrefix.resize(count);
+    mLightOffsets.resize(chunkCount + 1);
+    mHeavyOffsets.resize(chunkCount + 1);
+    mLightSumOffsets.resize(chunkCount + 1);
+    mHeavySumOffsets.resize(chunkCount + 1);
+    mDirty = true;
+}
+
+void AliasTableBuilder::setWeight(uint32_t index, float weight)
+{
+    FALCOR_ASSERT(index < getCount());
+    if (mWeights[index] == weight)
+        return;
+    mWeights[index] = weight;
+    mChunks[index / kChunkSize].dirty = true;
+    mDirty = true;
+}
+
+void AliasTableBuilder::build()
+{
+    if (!mDirty)
+        return;
+    mDirty = false;
+    mPartitionedChunkCount = 0;
+
+    const uint32_t count = getCount();
+    const uint32_t chunkCount = (uint32_t)mChunks.size();
+    if (count == 0)
+    {
+        mWeightSum = 0.0;
+        return;
+    }
+
+    // Sum the weights of the modified chunks in parallel, then add up the chunk sums in a fixed order.
+    // This keeps the sum, and with it the whole table, independent of which chunks were modified.
+    auto chunkRange = NumericRange<uint32_t>(0, chunkCount);
+    std::for_each(
+        std::execution::par,
+        chunkRange.begin(),
+        chunkRange.end(),
+        [&](uint32_t c)
+        {
+            Chunk& chunk = mChunks[c];
+            if (!chunk.dirty)
+                return;
+            const uint32_t begin = c * kChunkSize;
+            const uint32_t end = std::min(begin + kChunkSize, count);
+            double sum = 0.0;
+            for (uint32_t i = begin; i < end; ++i)
+                sum += mWeights[i];
+            chunk.weightSum = sum;
+        }
+    );
+    mWeightSum = 0.0;
+    for (const Chunk& chunk : mChunks)
+        mWeightSum += chunk.weightSum;
+
+    // Without any weight, sample uniformly.
+    if (!(mWeightSum > 0.0))
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            mItems[i] = {1.f, i, i, 0};
+        for (Chunk& chunk : mChunks)
+            chunk.dirty = true;
+        return;
+    }
+    mAverage = mWeightSum / double(count);
+
+    // Partition the chunks into light and heavy entries. An unmodified chunk only needs to be partitioned again
+    // if the new average moved across one of its weights.
+    std::vector<uint8_t> partitioned(chunkCount, 0);
+    std::for_each(
+        std::execution::par,
+        chunkRange.begin(),
+        chunkRange.end(),
+        [&](uint32_t c)
+        {
+            Chunk& chunk = mChunks[c];
+            if (chunk.dirty || !(double(chunk.maxLight) < mAverage && double(chunk.minHeavy) >= mAverage))
+            {
+                partitionChunk(c);
+                partitioned[c] = 1;
+            }
+        }
+    );
+    for (uint8_t p : partitioned)
+        mPartitionedChunkCount += p;
+
+    mLightOffsets[0] = mHeavyOffsets[0] = 0;
+    mLightSumOffsets[0] = mHeavySumOffsets[0] = 0.0;
+    for (uint32_t c = 0; c < chunkCount; ++c)
+    {
+        mLightOffsets[c + 1] = mLightOffsets[c] + mChunks[c].lightCount;
+        mHeavyOffsets[c + 1] = mHeavyOffsets[c] + mChunks[c].heavyCount;
+        mLightSumOffsets[c + 1] = mLightSumOffsets[c] + mChunks[c].lightSum;
+        mHeavySumOffsets[c + 1] = mHeavySumOffsets[c] + mChunks[c].heavySum;
+    }
+
+    // The largest weight is at least the average, up to rounding of the sum. If rounding made all entries light,
+    // they are all within precision of the average.
+    if (mHeavyOffsets[chunkCount] == 0)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            mItems[i] = {1.f, i, i, 0};
+        return;
+    }
+
+    // Split the buckets into one range per chunk and sweep the ranges in parallel.
+    std::vector<uint32_t> splits(chunkCount + 1);
+    auto splitRange = NumericRange<uint32_t>(0, chunkCount + 1);
+    std::for_each(
+        std::execution::par,
+        splitRange.begin(),
+        splitRange.end(),
+        [&](uint32_t t) { splits[t] = findSplit(uint64_t(count) * t / chunkCount); }
+    );
+    std::for_each(
+        std::execution::par,
+        chunkRange.begin(),
+        chunkRange.end(),
+        [&](uint32_t t)
+        {
+            const uint64_t begin = uint64_t(count) * t / chunkCount;
+            const uint64_t end = uint64_t(count) * (t + 1) / chunkCount;
+            sweep(splits[t], splits[t + 1], uint32_t(begin - splits[t]), uint32_t(end - splits[t + 1]));
+        }
+    );
+}
+
+void AliasTableBuilder::partitionChunk(uint32_t c)
+{
+    Chunk& chunk = mChunks[c];
+    const uint32_t begin = c * kChunkSize;
+    const uint32_t end = std::min(begin + kChunkSize, getCount());
+
+    // Count the lights first, so both lists keep the index order within the chunk.
+    // The weights are random with respect to the average, so both loops are written without branches.
+    uint32_t lightCount = 0;
+    float maxLight = -std::numeric_limits<float>::infinity();
+    float minHeavy = std::numeric_limits<float>::infinity();
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const float w = mWeights[i];
+        const bool isLight = double(w) < mAverage;
+        lightCount += isLight;
+        maxLight = std::max(maxLight, isLight ? w : -std::numeric_limits<float>::infinity());
+        minHeavy = std::min(minHeavy, isLight ? std::numeric_limits<float>::infinity() : w);
+    }
+    chunk.lightCount = lightCount;
+    chunk.heavyCount = end - begin - lightCount;
+    chunk.maxLight = maxLight;
+    chunk.minHeavy = minHeavy;
+
+    uint32_t light = begin;
+    uint32_t heavy = begin + lightCount;
+    double lightSum = 0.0;
+    double heavySum = 0.0;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const float w = mWeights[i];
+        const bool isLight = double(w) < mAverage;
+        lightSum += isLight ? w : 0.f;
+        heavySum += isLight ? 0.f : w;
+        const uint32_t pos = isLight ? light : heavy;
+        mEntries[pos] = i;
+        mPrefix[pos] = isLight ? lightSum : heavySum;
+        light += isLight;
+        heavy += !isLight;
+    }
+    chunk.lightSum = lightSum;
+    chunk.heavySum = heavySum;
+    chunk.dirty = false;
+}
+
+AliasTableBuilder::Cursor AliasTableBuilder::locate(bool heavy, uint32_t rank) const
+{
+    // Find the last chunk starting at or before rank. This skips empty chunks, and maps the end of the list to
+    // the sentinel past the last chunk.
+    const auto& offsets = heavy ? mHeavyOffsets : mLightOffsets;
+    const uint32_t chunkCount = (uint32_t)mChunks.size();
+    const uint32_t chunk = uint32_t(std::upper_bound(offsets.begin(), offsets.end(), rank) - offsets.begin()) - 1;
+    if (chunk == chunkCount)
+        return {rank, chunk, getCount(), getCount(), std::numeric_limits<uint32_t>::max()};
+    const uint32_t first = chunk * kChunkSize + (heavy ? mChunks[chunk].lightCount : 0);
+    return {rank, chunk, first + rank - offsets[chunk], first, offsets[chunk + 1]};
+}
+
+void AliasTableBuilder::advance(bool heavy, Cursor& cursor) const
+{
+    cursor.rank++;
+    cursor.pos++;
+    if (cursor.rank == cursor.end)
+        cursor = locate(heavy, cursor.rank);
+}
+
+double AliasTableBuilder::sumBefore(bool heavy, const Cursor& cursor) const
+{
+    const double offset = heavy ? mHeavySumOffsets[cursor.chunk] : mLightSumOffsets[cursor.chunk];
+    return cursor.pos > cursor.first ? offset + mPrefix[cursor.pos - 1] : offset;
+}
+
+double AliasTableBuilder::sumThrough(bool heavy, const Cursor& cursor) const
+{
+    const double offset = heavy ? mHeavySumOffsets[cursor.chunk] : mLightSumOffsets[cursor.chunk];
+    return offset + mPrefix[cursor.pos];
+}
+
+bool AliasTableBuilder::takeLight(uint32_t lightRank, double lightSum, uint32_t heavyRank, double heavySum) const
+{
+    // The last heavy fills its own bucket at the very end.
+    if (heavyRank + 1 == mHeavyOffsets.back())
+        return true;
+    return double(lightRank) * mAverage - lightSum < heavySum - double(heavyRank + 1) * mAverage;
+}
+
+uint32_t AliasTableBuilder::findSplit(uint64_t bucket) const
+{
+    const uint32_t lightCount = mLightOffsets.back();
+    const uint32_t heavyCount = mHeavyOffsets.back();
+    const uint32_t k = uint32_t(bucket);
+
+    // Find the number of lights among the first k buckets of the merge.
+    uint32_t lo = k > heavyCount ? k - heavyCount : 0;
+    uint32_t hi = std::min(k, lightCount);
+    while (lo < hi)
+    {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        const uint32_t heavyRank = k - 1 - mid;
+        const double lightSum = sumBefore(false, locate(false, mid));
+        const double heavySum = sumThrough(true, locate(true, heavyRank));
+        if (takeLight(mid, lightSum, heavyRank, heavySum))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void AliasTableBuilder::sweep(uint32_t lightBegin, uint32_t lightEnd, uint32_t heavyBegin, uint32_t heavyEnd)
+{
+    if (lightBegin == lightEnd && heavyBegin == heavyEnd)
+        return;
+
+    // There is a current heavy for every bucket, as the last heavy is also the last bucket.
+    const uint32_t lastHeavy = mHeavyOffsets.back() - 1;
+    Cursor light = locate(false, lightBegin);
+    Cursor heavy = locate(true, heavyBegin);
+    double lightSum = sumBefore(false, light);
+    double heavySum = sumThrough(true, heavy);
+    uint32_t heavyIndex = mEntries[heavy.pos];
+
+    // The end point of the range is given, so each entry gets exactly one bucket even if rounding made the merge
+    // order ambiguous.
+    while (light.rank < lightEnd || heavy.rank < heavyEnd)
+    {
+        bool isLight;
+        if (light.rank == lightEnd)
+            isLight = false;
+        else if (heavy.rank == heavyEnd)
+            isLight = true;
+        else
+            isLight = takeLight(light.rank, lightSum, heavy.rank, heavySum);
+
+        if (isLight)
+        {
+            const uint32_t lightIndex = mEntries[light.pos];
+            mItems[lightIndex] = {float(mWeights[lightIndex] / mAverage), heavyIndex, lightIndex, 0};
+            advance(false, light);
+            lightSum = sumBefore(false, light);
+        }
+        else if (heavy.rank == lastHeavy)
+        {
+            // The last heavy holds exactly the average weight, up to rounding.
+            mItems[heavyIndex] = {1.f, heavyIndex, heavyIndex, 0};
+            advance(true, heavy);
+        }
+        else
+        {
+            // The heavy has dropped to the average or below, its residual makes a bucket with the next heavy.
+            const double residual = lightSum + heavySum - double(light.rank + heavy.rank) * mAverage;
+            const float threshold = std::clamp(float(residual / mAverage), 0.f, 1.f);
+            advance(true, heavy);
+            heavySum = sumThrough(true, heavy);
+            const uint32_t nextIndex = mEntries[heavy.pos];
+            mItems[heavyIndex] = {threshold, nextIndex, heavyIndex, 0};
+            heavyIndex = nextIndex;
+        }
+    }
+}
+} // namespace Falcor
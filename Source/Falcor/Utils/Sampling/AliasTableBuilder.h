@@ -0,0 +1,175 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Builds alias tables on the CPU for sampling from a discrete probability distribution.
+ *
+ * The table is built in parallel: the weights are summed and split into below- and above-average
+ * entries per chunk, and the buckets are then filled by independent sweeps over disjoint ranges.
+ * When only some weights change, chunks whose entries keep their classification are reused.
+ *
+ * The builder does not touch the GPU, see AliasTable for uploading the result.
+ */
+class FALCOR_API AliasTableBuilder
+{
+public:
+    /**
+     * Table item. The layout matches AliasTable::Item in AliasTable.slang.
+     */
+    struct Item
+    {
+        float threshold; ///< If rand() < threshold, pick indexB (else pick indexA)
+        uint32_t indexA; ///< The "redirect" index, if uniform sampling would overweight indexB.
+        uint32_t indexB; ///< The original index, sampled uniformly in [0...count-1]
+        uint32_t _pad;
+    };
+    static_assert(sizeof(Item) == 16);
+
+    AliasTableBuilder() = default;
+
+    /**
+     * Create a builder and build the table.
+     * The weights don't need to be normalized to sum up to 1.
+     * @param[in] weights The weights we'd like to sample each entry proportional to.
+     */
+    explicit AliasTableBuilder(std::vector<float> weights);
+
+    /**
+     * Replace all weights. The table is rebuilt on the next call to build().
+     * @param[in] weights The weights we'd like to sample each entry proportional to.
+     */
+    void setWeights(std::vector<float> weights);
+
+    /**
+     * Change a single weight. The table is rebuilt on the next call to build().
+     * @param[in] index Index of the weight.
+     * @param[in] weight New weight.
+     */
+    void setWeight(uint32_t index, float weight);
+
+    /**
+     * Build the table if any weights changed since the last build.
+     */
+    void build();
+
+    /**
+     * Check if there are weight changes that are not built yet.
+     */
+    bool isDirty() const { return mDirty; }
+
+    /**
+     * Sample from the table, same as AliasTable::sample() on the GPU.
+     * @param[in] index Uniform random index in [0..count).
+     * @param[in] rnd Uniform random number in [0..1).
+     * @return Returns the sampled item index.
+     */
+    uint32_t sample(uint32_t index, float rnd) const
+    {
+        const Item& item = mItems[index];
+        return rnd >= item.threshold ? item.indexA : item.indexB;
+    }
+
+    /**
+     * Get the number of weights in the table.
+     */
+    uint32_t getCount() const { return (uint32_t)mWeights.size(); }
+
+    /**
+     * Get the total sum of all weights in the table.
+     */
+    double getWeightSum() const { return mWeightSum; }
+
+    /**
+     * Get the weights.
+     */
+    const std::vector<float>& getWeights() const { return mWeights; }
+
+    /**
+     * Get the table items. Item i always has indexB == i.
+     */
+    const std::vector<Item>& getItems() const { return mItems; }
+
+    /**
+     * Get the number of chunks that were partitioned again in the last build.
+     */
+    uint32_t getPartitionedChunkCount() const { return mPartitionedChunkCount; }
+
+private:
+    struct Chunk
+    {
+        double weightSum = 0.0;
+        double lightSum = 0.0;
+        double heavySum = 0.0;
+        uint32_t lightCount = 0;
+        uint32_t heavyCount = 0;
+        float maxLight = 0.f; ///< Largest below-average weight, used to check if the partition is still valid.
+        float minHeavy = 0.f; ///< Smallest above-average weight, used to check if the partition is still valid.
+        bool dirty = true;
+    };
+
+    /// Position in the chunked list of light or heavy entries.
+    struct Cursor
+    {
+        uint32_t rank;  ///< Position in the list.
+        uint32_t chunk; ///< Chunk containing the entry.
+        uint32_t pos;   ///< Position in mEntries.
+        uint32_t first; ///< Position of the first entry of the chunk in mEntries.
+        uint32_t end;   ///< Rank past the last entry of the chunk.
+    };
+
+    void partitionChunk(uint32_t chunk);
+    Cursor locate(bool heavy, uint32_t rank) const;
+    void advance(bool heavy, Cursor& cursor) const;
+    double sumBefore(bool heavy, const Cursor& cursor) const;
+    double sumThrough(bool heavy, const Cursor& cursor) const;
+    bool takeLight(uint32_t lightRank, double lightSum, uint32_t heavyRank, double heavySum) const;
+    uint32_t findSplit(uint64_t bucket) const;
+    void sweep(uint32_t lightBegin, uint32_t lightEnd, uint32_t heavyBegin, uint32_t heavyEnd);
+
+    std::vector<float> mWeights;
+    std::vector<Item> mItems;
+    double mWeightSum = 0.0;
+    double mAverage = 0.0;
+    bool mDirty = false;
+    uint32_t mPartitionedChunkCount = 0;
+
+    std::vector<Chunk> mChunks;
+    std::vector<uint32_t> mEntries;       ///< Indices of the light entries of each chunk, followed by its heavy entries.
+    std::vector<double> mPrefix;          ///< Inclusive prefix sums of the light and the heavy weights of each chunk.
+    std::vector<uint32_t> mLightOffsets;  ///< Number of light entries in all previous chunks.
+    std::vector<uint32_t> mHeavyOffsets;  ///< Number of heavy entries in all previous chunks.
+    std::vector<double> mLightSumOffsets; ///< Sum of light weights in all previous chunks.
+    std::vector<double> mHeavySumOffsets; ///< Sum of heavy weights in all previous chunks.
+};
+} // namespace Falcor
@@ -26,31 +26,65 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TaskManager.h"
+#include "JobSystem.h"
+#include "Utils/Timing/Profiler.h"
+#include <thread>
+#include <chrono>
+#include <utility>
 
 namespace Falcor
 {
 
-TaskManager::TaskManager(bool startPaused)
+TaskManager::TaskManager(bool startPaused, int32_t priority, Profiler* pProfiler)
+    : mJobSystem(JobSystem::getShared()), mPriority(priority), mpProfiler(pProfiler), mPaused(startPaused)
+{}
+
+TaskManager::~TaskManager()
 {
-    if (startPaused)
-        mThreadPool.pause();
+    // Wait for every submitted job to fully exit, as the jobs reference this object.
+    // finish() may return before the last job has released the lock, and paused tasks are simply dropped.
+    // Pending jobs are run on this thread, as ours may be queued behind other work.
+    std::unique_lock<std::mutex> l(mTaskMutex);
+    while (mSubmittedJobs > 0)
+    {
+        l.unlock();
+        bool ranJob = mJobSystem.runPendingJob();
+        l.lock();
+        if (!ranJob)
+            mGpuTaskCond.wait_for(l, std::chrono::milliseconds(1), [&] { return mSubmittedJobs == 0; });
+    }
 }
 
 void TaskManager::addTask(CpuTask&& task)
 {
     std::lock_guard<std::mutex> l(mTaskMutex);
     ++mCurrentlyScheduled;
-    mThreadPool.push_task(
+    if (mPaused)
+        mPausedTasks.push_back(std::move(task));
+    else
+        submitCpuTask(std::move(task));
+}
+
+void TaskManager::submitCpuTask(CpuTask&& task)
+{
+    // Called with mTaskMutex held.
+    ++mSubmittedJobs;
+    mJobSystem.submit(
         [task = std::move(task), this]() mutable
         {
             ++mCurrentlyRunning;
             --mCurrentlyScheduled;
             executeCpuTask(std::move(task));
-            size_t running = --mCurrentlyRunning;
-            // If nothing is running, lets wake up and try to exit.
-            if (running == 0)
-                mGpuTaskCond.notify_all();
-        }
+            // Release the task's captures while the manager is still guaranteed to be alive.
+            task = nullptr;
+            // Publish the counts and notify under the lock, so the waiter can't miss the wake up,
+            // and the destructor can't complete before this job is done touching the manager.
+            std::lock_guard<std::mutex> l(mTaskMutex);
+            --mCurrentlyRunning;
+            --mSubmittedJobs;
+            mGpuTaskCond.notify_all();
+        },
+        mPriority
     );
 }
 
@@ -64,7 +98,14 @@ void TaskManager::addTask(GpuTask&& task)
 
 void TaskManager::finish(RenderContext* renderContext)
 {
-    mThreadPool.unpause();
+    {
+        std::lock_guard<std::mutex> l(mTaskMutex);
+        mPaused = false;
+        for (auto& task : mPausedTasks)
+            submitCpuTask(std::move(task));
+        mPausedTasks.clear();
+    }
+
     while (true)
     {
         while (true)
@@ -90,6 +131,15 @@ void TaskManager::finish(RenderContext* renderContext)
             // If there are absolutely no tasks, go finish
             if (mCurrentlyRunning == 0 && mCurrentlyScheduled == 0)
                 break;
+            // When called from a job, help with pending jobs instead of blocking a worker thread that our tasks may be waiting for.
+            if (mJobSystem.isWorkerThread())
+            {
+                l.unlock();
+                if (!mJobSystem.runPendingJob())
+                    std::this_thread::yield();
+                l.lock();
+                continue;
+            }
             // Otherwise wait for either a new GPU task, or last running to notify us to check
             mGpuTaskCond.wait(l);
         }
@@ -108,13 +158,19 @@ void TaskManager::storeException()
 
 void TaskManager::rethrowException()
 {
-    std::lock_guard<std::mutex> l(mExceptionMutex);
-    if (mException)
-        std::rethrow_exception(mException);
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> l(mExceptionMutex);
+        // Reset the stored exception, so a reused manager doesn't rethrow it on every later finish().
+        std::swap(exception, mException);
+    }
+    if (exception)
+        std::rethrow_exception(exception);
 }
 
 void TaskManager::executeCpuTask(CpuTask&& task)
 {
+    FALCOR_PROFILE_CPU(mpProfiler, "TaskManager::cpuTask");
     try
     {
         task();
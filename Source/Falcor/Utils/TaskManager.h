@@ -29,18 +29,23 @@
 
 #include "Core/Macros.h"
 
-#include <BS_thread_pool/BS_thread_pool.hpp>
-
 #include <functional>
 #include <mutex>
 #include <condition_variable>
 #include <vector>
 #include <atomic>
 #include <exception>
+#include <cstdint>
 
 namespace Falcor
 {
 class RenderContext;
+class JobSystem;
+class Profiler;
+
+/**
+ * Runs CPU tasks on the shared job system (see JobSystem) and GPU tasks on the thread calling finish().
+ */
 class FALCOR_API TaskManager
 {
 public:
@@ -48,7 +53,16 @@ public:
     using GpuTask = std::function<void(RenderContext* renderContext)>;
 
 public:
-    TaskManager(bool startPaused = false);
+    /**
+     * Constructor.
+     * @param[in] startPaused If true, CPU tasks are held back until finish() is called.
+     * @param[in] priority Job system priority of the CPU tasks.
+     * @param[in] pProfiler Optional profiler recording the CPU tasks (CPU time only).
+     */
+    TaskManager(bool startPaused = false, int32_t priority = 0, Profiler* pProfiler = nullptr);
+
+    /// Waits for all submitted CPU tasks to exit. Tasks still held back by a paused manager are discarded.
+    ~TaskManager();
 
     /// Adds a CPU only task to the manager, if unpaused, the task starts right away
     void addTask(CpuTask&& task);
@@ -63,15 +77,23 @@ public:
 private:
     /// Thread safe way to store an exception
     void storeException();
-    /// Thread safe way to retrow a stored exception
+    /// Thread safe way to retrow a stored exception, clearing it so it is only thrown once
     void rethrowException();
     /// CPU task execution wrapped so it stores exception if the task throws
     void executeCpuTask(CpuTask&& task);
+    /// Submit a CPU task to the job system
+    void submitCpuTask(CpuTask&& task);
 
 private:
-    BS::thread_pool mThreadPool;
+    JobSystem& mJobSystem;
+    int32_t mPriority;
+    Profiler* mpProfiler;
+    bool mPaused;
+    std::vector<CpuTask> mPausedTasks;
     std::atomic_size_t mCurrentlyRunning{0};
     std::atomic_size_t mCurrentlyScheduled{0};
+    /// Number of jobs submitted to the job system that have not yet exited, guarded by mTaskMutex.
+    size_t mSubmittedJobs = 0;
 
     std::mutex mTaskMutex;
     std::condition_variable mGpuTaskCond;
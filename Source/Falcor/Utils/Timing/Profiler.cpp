@@ -31,7 +31,12 @@
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <thread>
 
 namespace Falcor
 {
@@ -46,6 +51,18 @@ const float kSigma = 0.98f;
 // for computing statistics (min, max, mean, stddev) over the recent history.
 const size_t kMaxHistorySize = 512;
 
+// Maximum nesting depth of events tracked per thread. Deeper events are ignored.
+const uint32_t kMaxEventDepth = 64;
+
+// Capacity of the per-thread record buffers. Records exceeding the capacity between two calls
+// to endFrame() are dropped.
+const uint64_t kLaneCapacity = 4096;
+
+// Maximum length of event names passed to the PIX markers.
+const size_t kMaxPixNameLength = 255;
+
+std::atomic<uint64_t> sNextProfilerInstanceID{1};
+
 pybind11::dict toPython(const Profiler::Stats& stats)
 {
     pybind11::dict d;
@@ -98,6 +115,168 @@ pybind11::dict toPython(const std::vector<Profiler::Event*>& events)
 
     return result;
 }
+
+void appendJsonString(fmt::memory_buffer& buf, std::string_view str)
+{
+    buf.push_back('"');
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            buf.push_back('\\');
+            buf.push_back(c);
+        }
+        else if ((unsigned char)c < 0x20)
+            fmt::format_to(std::back_inserter(buf), "\\u{:04x}", (unsigned int)c);
+        else
+            buf.push_back(c);
+    }
+    buf.push_back('"');
+}
+} // namespace
+
+struct Profiler::EventNode
+{
+    uint32_t id;              ///< Interned event ID.
+    const EventNode* pParent; ///< Parent node (nullptr for the root).
+    std::string name;         ///< Event name.
+    std::string path;         ///< Nested event name.
+};
+
+struct Profiler::ThreadLane
+{
+    struct Record
+    {
+        const EventNode* pNode;
+        CpuTimer::TimePoint start;
+        CpuTimer::TimePoint end;
+        bool gpu; ///< Event measured through Event::start()/end() and only recorded for the capture.
+    };
+
+    struct OpenEvent
+    {
+        const EventNode* pNode; ///< Event node, or the parent node if the event is invalid.
+        Event* pEvent;          ///< Event measuring GPU time, nullptr for CPU only events.
+        CpuTimer::TimePoint start;
+        bool valid;
+    };
+
+    std::thread::id threadID;
+    uint32_t index;
+    std::string name;
+
+    // Stack of open events, only accessed by the owning thread.
+    OpenEvent stack[kMaxEventDepth];
+    uint32_t depth = 0;
+
+    // Single producer (owning thread), single consumer (thread calling endFrame()) ring buffer.
+    std::unique_ptr<Record[]> records{new Record[kLaneCapacity]};
+    std::atomic<uint64_t> writeIndex{0};
+    std::atomic<uint64_t> readIndex{0};
+    std::atomic<uint64_t> droppedCount{0};
+
+    const EventNode* getParent(const EventNode* pRoot) const
+    {
+        return depth == 0 ? pRoot : stack[std::min(depth, kMaxEventDepth) - 1].pNode;
+    }
+
+    void push(const Record& record)
+    {
+        uint64_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) >= kLaneCapacity)
+        {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        records[write % kLaneCapacity] = record;
+        writeIndex.store(write + 1, std::memory_order_release);
+    }
+};
+
+namespace
+{
+/**
+ * Process-wide registry of interned event paths.
+ * Nodes are never freed, which allows call sites to cache them in static storage independent of the profiler instance.
+ */
+class EventRegistry
+{
+public:
+    static EventRegistry& get()
+    {
+        static EventRegistry* spRegistry = new EventRegistry();
+        return *spRegistry;
+    }
+
+    const Profiler::EventNode* getRoot() const { return mpRoot; }
+
+    /**
+     * Find or create the node for an event nested in the given parent.
+     * @return Returns the node, or nullptr if the name is invalid.
+     */
+    const Profiler::EventNode* intern(const Profiler::EventNode* pParent, std::string_view name, Profiler::EventSite* pSite)
+    {
+        if (pSite)
+        {
+            const Profiler::EventNode* pNode = pSite->pNode.load(std::memory_order_acquire);
+            if (pNode && pNode->pParent == pParent && pNode->name == name)
+                return pNode;
+        }
+
+        const Profiler::EventNode* pNode = find(pParent, name);
+        if (pNode && pSite)
+            pSite->pNode.store(pNode, std::memory_order_release);
+        return pNode;
+    }
+
+    std::vector<std::string> getPaths() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::vector<std::string> paths;
+        paths.reserve(mNodes.size());
+        for (const auto& pNode : mNodes)
+            paths.push_back(pNode->path);
+        return paths;
+    }
+
+private:
+    EventRegistry() { mpRoot = mNodes.emplace_back(new Profiler::EventNode{0, nullptr, "", ""}).get(); }
+
+    static size_t hashKey(const Profiler::EventNode* pParent, std::string_view name)
+    {
+        return std::hash<std::string_view>()(name) ^ (pParent->id * 0x9e3779b97f4a7c15ull);
+    }
+
+    const Profiler::EventNode* find(const Profiler::EventNode* pParent, std::string_view name)
+    {
+        size_t key = hashKey(pParent, name);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto range = mIndex.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second->pParent == pParent && it->second->name == name)
+                return it->second;
+        }
+
+        // '/' is used as a "path delimiter", so it cannot be used in the event name.
+        if (name.find('/') != std::string_view::npos)
+        {
+            logWarning("Profiler event names must not contain '/'. Ignoring this profiler event.");
+            return nullptr;
+        }
+
+        auto pNode = new Profiler::EventNode{(uint32_t)mNodes.size(), pParent, std::string(name), pParent->path + "/" + std::string(name)};
+        mNodes.emplace_back(pNode);
+        mIndex.emplace(key, pNode);
+        return pNode;
+    }
+
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<Profiler::EventNode>> mNodes; ///< Nodes by ID.
+    std::unordered_multimap<size_t, Profiler::EventNode*> mIndex;
+    const Profiler::EventNode* mpRoot = nullptr;
+};
 } // namespace
 
 // Profiler::Stats
@@ -192,6 +371,13 @@ void Profiler::Event::end(uint32_t frameIndex)
     frameData.valid = true;
 }
 
+void Profiler::Event::addCpuTime(uint32_t frameIndex, float time)
+{
+    auto& frameData = mFrameData[frameIndex % 2];
+    frameData.cpuTotalTime += time;
+    frameData.valid = true;
+}
+
 void Profiler::Event::endFrame(uint32_t frameIndex)
 {
     // Resolve GPU timers for the current frame measurements.
@@ -257,7 +443,60 @@ void Profiler::Capture::writeToFile(const std::filesystem::path& path) const
     ofs.write(json.data(), json.size());
 }
 
-Profiler::Capture::Capture(size_t reservedEvents, size_t reservedFrames) : mReservedFrames(reservedFrames)
+std::string Profiler::Capture::toTraceJsonString() const
+{
+    fmt::memory_buffer buf;
+    auto out = std::back_inserter(buf);
+
+    fmt::format_to(out, "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    auto separator = [&]()
+    {
+        if (!first)
+            buf.push_back(',');
+        buf.push_back('\n');
+        first = false;
+    };
+
+    for (size_t i = 0; i < mThreadNames.size(); ++i)
+    {
+        separator();
+        fmt::format_to(out, "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":", i);
+        appendJsonString(buf, mThreadNames[i]);
+        fmt::format_to(out, "}}}}");
+    }
+
+    for (const auto& span : mSpans)
+    {
+        std::string_view path = span.eventID < mEventPaths.size() ? mEventPaths[span.eventID] : std::string_view();
+        std::string_view name = path.substr(path.find_last_of('/') + 1);
+        separator();
+        fmt::format_to(out, "{{\"name\":");
+        appendJsonString(buf, name);
+        fmt::format_to(
+            out,
+            ",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":0,\"tid\":{},\"args\":{{\"path\":",
+            span.start,
+            span.duration,
+            span.threadIndex
+        );
+        appendJsonString(buf, path);
+        fmt::format_to(out, "}}}}");
+    }
+
+    fmt::format_to(out, "\n]}}\n");
+    return fmt::to_string(buf);
+}
+
+void Profiler::Capture::writeTraceToFile(const std::filesystem::path& path) const
+{
+    auto json = toTraceJsonString();
+    std::ofstream ofs(path);
+    ofs.write(json.data(), json.size());
+}
+
+Profiler::Capture::Capture(size_t reservedEvents, size_t reservedFrames)
+    : mReservedFrames(reservedFrames), mStartTime(CpuTimer::getCurrentTimePoint())
 {
     // Speculativly allocate event record storage.
     mLanes.resize(reservedEvents * 2);
@@ -297,10 +536,21 @@ void Profiler::Capture::captureEvents(const std::vector<Event*>& events)
     ++mFrameCount;
 }
 
-void Profiler::Capture::finalize()
+void Profiler::Capture::captureSpan(uint32_t eventID, uint32_t threadIndex, CpuTimer::TimePoint start, CpuTimer::TimePoint end)
+{
+    // Convert from milliseconds to microseconds as used by the trace format.
+    double startTime = CpuTimer::calcDuration(mStartTime, start) * 1000.0;
+    double duration = CpuTimer::calcDuration(start, end) * 1000.0;
+    mSpans.push_back({eventID, threadIndex, startTime, duration});
+}
+
+void Profiler::Capture::finalize(std::vector<std::string> eventPaths, std::vector<std::string> threadNames)
 {
     FALCOR_ASSERT(!mFinalized);
 
+    mEventPaths = std::move(eventPaths);
+    mThreadNames = std::move(threadNames);
+
     for (auto& lane : mLanes)
     {
         lane.stats = Stats::compute(lane.records.data(), lane.records.size());
@@ -311,71 +561,183 @@ void Profiler::Capture::finalize()
 
 // Profiler
 
-Profiler::Profiler(ref<Device> pDevice) : mpDevice(pDevice)
+Profiler::Profiler(ref<Device> pDevice) : mpDevice(pDevice), mInstanceID(sNextProfilerInstanceID.fetch_add(1))
 {
     mpFence = mpDevice->createFence();
     mpFence->breakStrongReferenceToDevice();
+
+    setThreadName("Main");
 }
 
-void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
+Profiler::~Profiler() = default;
+
+void Profiler::startEvent(RenderContext* pRenderContext, std::string_view name, Flags flags, EventSite* pSite)
 {
-    if (mEnabled && is_set(flags, Flags::Internal))
+    if (isEnabled() && is_set(flags, Flags::Internal))
     {
-        // '/' is used as a "path delimiter", so it cannot be used in the event name.
-        if (name.find('/') != std::string::npos)
+        ThreadLane& lane = getThreadLane();
+        if (lane.depth >= kMaxEventDepth)
         {
-            logWarning("Profiler event names must not contain '/'. Ignoring this profiler event.");
-            return;
+            if (lane.depth++ == kMaxEventDepth)
+                logWarning("Profiler events are nested deeper than {} levels. Ignoring nested events.", kMaxEventDepth);
         }
-
-        mCurrentEventName = mCurrentEventName + "/" + name;
-
-        Event* pEvent = getEvent(mCurrentEventName);
-        FALCOR_ASSERT(pEvent != nullptr);
-        if (!mPaused)
-            pEvent->start(*this, mFrameIndex);
-
-        if (std::find(mCurrentFrameEvents.begin(), mCurrentFrameEvents.end(), pEvent) == mCurrentFrameEvents.end())
+        else
         {
-            mCurrentFrameEvents.push_back(pEvent);
+            EventRegistry& registry = EventRegistry::get();
+            const EventNode* pParent = lane.getParent(registry.getRoot());
+            const EventNode* pNode = registry.intern(pParent, name, pSite);
+
+            // Invalid events are pushed with the parent node so that nested events and endEvent() stay balanced.
+            ThreadLane::OpenEvent& open = lane.stack[lane.depth++];
+            open.pNode = pNode ? pNode : pParent;
+            open.pEvent = nullptr;
+            open.valid = pNode != nullptr;
+
+            if (pNode && pRenderContext)
+            {
+                Event* pEvent = getEvent(pNode);
+                if (!isPaused())
+                    pEvent->start(*this, mFrameIndex);
+                registerFrameEvent(pEvent);
+                open.pEvent = pEvent;
+            }
+            open.start = CpuTimer::getCurrentTimePoint();
         }
     }
-    if (is_set(flags, Flags::Pix))
+    if (is_set(flags, Flags::Pix) && pRenderContext)
     {
-        FALCOR_ASSERT(pRenderContext);
-        pRenderContext->getLowLevelData()->beginDebugEvent(name.c_str());
+        // Copy to a null-terminated buffer as expected by the debug event API.
+        char buffer[kMaxPixNameLength + 1];
+        size_t length = std::min(name.size(), kMaxPixNameLength);
+        std::memcpy(buffer, name.data(), length);
+        buffer[length] = '\0';
+        pRenderContext->getLowLevelData()->beginDebugEvent(buffer);
     }
 }
 
-void Profiler::endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
+void Profiler::endEvent(RenderContext* pRenderContext, std::string_view name, Flags flags)
 {
-    if (mEnabled && is_set(flags, Flags::Internal))
+    if (isEnabled() && is_set(flags, Flags::Internal))
     {
-        // '/' is used as a "path delimiter", so it cannot be used in the event name.
-        if (name.find('/') != std::string::npos)
-            return;
-
-        Event* pEvent = getEvent(mCurrentEventName);
-        FALCOR_ASSERT(pEvent != nullptr);
-        if (!mPaused)
-            pEvent->end(mFrameIndex);
-
-        mCurrentEventName.erase(mCurrentEventName.find_last_of("/"));
+        ThreadLane& lane = getThreadLane();
+        if (lane.depth > kMaxEventDepth)
+        {
+            --lane.depth;
+        }
+        else if (lane.depth > 0)
+        {
+            CpuTimer::TimePoint end = CpuTimer::getCurrentTimePoint();
+            const ThreadLane::OpenEvent& open = lane.stack[--lane.depth];
+            if (open.valid && !isPaused())
+            {
+                if (open.pEvent)
+                {
+                    open.pEvent->end(mFrameIndex);
+                    // Events measured through Event::end() only need a record for the capture.
+                    if (mpCapture)
+                        lane.push({open.pNode, open.start, end, true});
+                }
+                else
+                {
+                    lane.push({open.pNode, open.start, end, false});
+                }
+            }
+        }
     }
 
-    if (is_set(flags, Flags::Pix))
+    if (is_set(flags, Flags::Pix) && pRenderContext)
     {
-        FALCOR_ASSERT(pRenderContext)
         pRenderContext->getLowLevelData()->endDebugEvent();
     }
 }
 
+void Profiler::setThreadName(std::string_view name)
+{
+    ThreadLane& lane = getThreadLane();
+    std::lock_guard<std::mutex> lock(mLaneMutex);
+    lane.name = name;
+}
+
 Profiler::Event* Profiler::getEvent(const std::string& name)
 {
     auto event = findEvent(name);
     return event ? event : createEvent(name);
 }
 
+Profiler::Event* Profiler::getEvent(const EventNode* pNode)
+{
+    if (pNode->id >= mEventsByID.size())
+        mEventsByID.resize(pNode->id + 1, nullptr);
+    Event*& pEvent = mEventsByID[pNode->id];
+    if (!pEvent)
+        pEvent = getEvent(pNode->path);
+    return pEvent;
+}
+
+void Profiler::registerFrameEvent(Event* pEvent)
+{
+    if (pEvent->mRegisteredFrame != mFrameIndex)
+    {
+        pEvent->mRegisteredFrame = mFrameIndex;
+        mCurrentFrameEvents.push_back(pEvent);
+    }
+}
+
+Profiler::ThreadLane& Profiler::getThreadLane()
+{
+    struct LaneCache
+    {
+        uint64_t instanceID = 0;
+        ThreadLane* pLane = nullptr;
+    };
+    thread_local LaneCache tCache;
+
+    if (tCache.instanceID == mInstanceID)
+        return *tCache.pLane;
+
+    std::lock_guard<std::mutex> lock(mLaneMutex);
+    std::thread::id threadID = std::this_thread::get_id();
+    auto it = std::find_if(mLanes.begin(), mLanes.end(), [threadID](const auto& pLane) { return pLane->threadID == threadID; });
+    if (it == mLanes.end())
+    {
+        auto pLane = std::make_unique<ThreadLane>();
+        pLane->threadID = threadID;
+        pLane->index = (uint32_t)mLanes.size();
+        pLane->name = fmt::format("Thread {}", pLane->index);
+        it = mLanes.insert(mLanes.end(), std::move(pLane));
+    }
+    tCache.instanceID = mInstanceID;
+    tCache.pLane = it->get();
+    return **it;
+}
+
+void Profiler::drainThreadLanes()
+{
+    std::lock_guard<std::mutex> lock(mLaneMutex);
+    for (auto& pLane : mLanes)
+    {
+        ThreadLane& lane = *pLane;
+        uint64_t read = lane.readIndex.load(std::memory_order_relaxed);
+        uint64_t write = lane.writeIndex.load(std::memory_order_acquire);
+        for (; read < write; ++read)
+        {
+            const ThreadLane::Record& record = lane.records[read % kLaneCapacity];
+            if (!record.gpu)
+            {
+                Event* pEvent = getEvent(record.pNode);
+                pEvent->addCpuTime(mFrameIndex, (float)CpuTimer::calcDuration(record.start, record.end));
+                registerFrameEvent(pEvent);
+            }
+            if (mpCapture)
+                mpCapture->captureSpan(record.pNode->id, lane.index, record.start, record.end);
+        }
+        lane.readIndex.store(read, std::memory_order_release);
+
+        if (uint64_t dropped = lane.droppedCount.exchange(0, std::memory_order_relaxed))
+            logWarning("Profiler dropped {} events recorded on thread '{}'.", dropped, lane.name);
+    }
+}
+
 void Profiler::endFrame(RenderContext* pRenderContext)
 {
     if (mPaused)
@@ -387,6 +749,8 @@ void Profiler::endFrame(RenderContext* pRenderContext)
     if (mFenceValue != uint64_t(-1))
         mpFence->wait();
 
+    drainThreadLanes();
+
     for (Event* pEvent : mCurrentFrameEvents)
     {
         pEvent->endFrame(mFrameIndex);
@@ -399,7 +763,9 @@ void Profiler::endFrame(RenderContext* pRenderContext)
     if (mpCapture)
         mpCapture->captureEvents(mCurrentFrameEvents);
 
-    mLastFrameEvents = std::move(mCurrentFrameEvents);
+    // Swap the event lists to reuse their storage.
+    std::swap(mLastFrameEvents, mCurrentFrameEvents);
+    mCurrentFrameEvents.clear();
     ++mFrameIndex;
 
     if (mPendingReset)
@@ -426,7 +792,15 @@ std::shared_ptr<Profiler::Capture> Profiler::endCapture()
     std::shared_ptr<Capture> pCapture;
     std::swap(pCapture, mpCapture);
     if (pCapture)
-        pCapture->finalize();
+    {
+        std::vector<std::string> threadNames;
+        {
+            std::lock_guard<std::mutex> lock(mLaneMutex);
+            for (const auto& pLane : mLanes)
+                threadNames.push_back(pLane->name);
+        }
+        pCapture->finalize(EventRegistry::get().getPaths(), std::move(threadNames));
+    }
     return pCapture;
 }
 
@@ -453,16 +827,30 @@ void Profiler::breakStrongReferenceToDevice()
     mpDevice.breakStrongReference();
 }
 
-ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags)
-    : mpRenderContext(pRenderContext), mName(name), mFlags(flags)
+ScopedProfilerEvent::ScopedProfilerEvent(
+    RenderContext* pRenderContext,
+    std::string_view name,
+    Profiler::Flags flags,
+    Profiler::EventSite* pSite
+)
+    : mpRenderContext(pRenderContext), mFlags(flags)
 {
     FALCOR_ASSERT(mpRenderContext);
-    mpRenderContext->getProfiler()->startEvent(mpRenderContext, mName, mFlags);
+    mpProfiler = mpRenderContext->getProfiler();
+    mpProfiler->startEvent(mpRenderContext, name, mFlags, pSite);
+}
+
+ScopedProfilerEvent::ScopedProfilerEvent(Profiler* pProfiler, std::string_view name, Profiler::EventSite* pSite)
+    : mpProfiler(pProfiler), mpRenderContext(nullptr), mFlags(Profiler::Flags::Internal)
+{
+    if (mpProfiler)
+        mpProfiler->startEvent(nullptr, name, mFlags, pSite);
 }
 
 ScopedProfilerEvent::~ScopedProfilerEvent()
 {
-    mpRenderContext->getProfiler()->endEvent(mpRenderContext, mName, mFlags);
+    if (mpProfiler)
+        mpProfiler->endEvent(mpRenderContext, {}, mFlags);
 }
 
 /// Implements a Python context manager for profiling events.
@@ -484,12 +872,16 @@ FALCOR_SCRIPT_BINDING(Profiler)
 
     using namespace pybind11::literals;
 
-    auto endCapture = [](Profiler* pProfiler)
+    auto endCapture = [](Profiler* pProfiler, std::optional<std::filesystem::path> tracePath)
     {
         std::optional<pybind11::dict> result;
         auto pCapture = pProfiler->endCapture();
         if (pCapture)
+        {
             result = toPython(*pCapture);
+            if (tracePath)
+                pCapture->writeTraceToFile(*tracePath);
+        }
         return result;
     };
 
@@ -499,7 +891,7 @@ FALCOR_SCRIPT_BINDING(Profiler)
     profiler.def_property_readonly("is_capturing", &Profiler::isCapturing);
     profiler.def_property_readonly("events", [](const Profiler& profiler) { return toPython(profiler.getEvents()); });
     profiler.def("start_capture", &Profiler::startCapture, "reserved_frames"_a = 1000);
-    profiler.def("end_capture", endCapture);
+    profiler.def("end_capture", endCapture, "trace_path"_a = std::nullopt);
     profiler.def("end_frame", [](Profiler& self) { self.endFrame(self.getDevice()->getRenderContext()); });
     profiler.def("reset_stats", &Profiler::resetStats);
 
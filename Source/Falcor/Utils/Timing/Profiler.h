@@ -30,9 +30,12 @@
 #include "Core/Macros.h"
 #include "Core/API/GpuTimer.h"
 #include "Core/API/Fence.h"
+#include <atomic>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -46,6 +49,12 @@ class RenderContext;
  * It automatically creates event hierarchies based on the order and nesting of the calls made.
  * This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
  * ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+ *
+ * Event paths are interned into integer IDs. The FALCOR_PROFILE macros cache the interned ID per call site,
+ * so recording an event with a constant name does not allocate or hash any strings.
+ * Events started without a render context only measure CPU time and may be recorded from any thread.
+ * Each thread records into its own lock-free lane, which is drained on the thread calling endFrame().
+ * Events measuring GPU time must be recorded on the thread calling endFrame().
  */
 class FALCOR_API Profiler
 {
@@ -59,6 +68,18 @@ public:
         Default = Internal | Pix
     };
 
+    /// Interned event path. Nodes are owned by a process-wide registry and are never freed.
+    struct EventNode;
+
+    /// Per-thread recording lane.
+    struct ThreadLane;
+
+    /// Per call site cache of the interned event, see FALCOR_PROFILE.
+    struct EventSite
+    {
+        std::atomic<const EventNode*> pNode{nullptr};
+    };
+
     struct Stats
     {
         float min;
@@ -90,6 +111,7 @@ public:
 
         void start(Profiler& profiler, uint32_t frameIndex);
         void end(uint32_t frameIndex);
+        void addCpuTime(uint32_t frameIndex, float time);
         void endFrame(uint32_t frameIndex);
 
         std::string mName; ///< Nested event name.
@@ -105,7 +127,8 @@ public:
         size_t mHistoryWriteIndex = 0;      ///< History write index.
         size_t mHistorySize = 0;            ///< History size.
 
-        uint32_t mTriggered = 0; ///< Keeping track of nested calls to start().
+        uint32_t mTriggered = 0;                      ///< Keeping track of nested calls to start().
+        uint32_t mRegisteredFrame = uint32_t(-1); ///< Last frame the event was registered in.
 
         struct FrameData
         {
@@ -133,22 +156,47 @@ public:
             std::vector<float> records;
         };
 
+        /// CPU time span of a single event occurrence.
+        struct Span
+        {
+            uint32_t eventID;     ///< Interned event ID (index into getEventPaths()).
+            uint32_t threadIndex; ///< Recording thread (index into getThreadNames()).
+            double start;         ///< Start time in microseconds relative to the start of the capture.
+            double duration;      ///< Duration in microseconds.
+        };
+
         Capture(size_t reservedEvents, size_t reservedFrames);
 
         size_t getFrameCount() const { return mFrameCount; }
         const std::vector<Lane>& getLanes() const { return mLanes; }
 
+        const std::vector<Span>& getSpans() const { return mSpans; }
+        const std::vector<std::string>& getEventPaths() const { return mEventPaths; }
+        const std::vector<std::string>& getThreadNames() const { return mThreadNames; }
+
         std::string toJsonString() const;
         void writeToFile(const std::filesystem::path& path) const;
 
+        /**
+         * Convert the captured spans to the Chrome trace event format (also loaded by Perfetto).
+         * @return Returns the trace as a JSON string.
+         */
+        std::string toTraceJsonString() const;
+        void writeTraceToFile(const std::filesystem::path& path) const;
+
     private:
         void captureEvents(const std::vector<Event*>& events);
-        void finalize();
+        void captureSpan(uint32_t eventID, uint32_t threadIndex, CpuTimer::TimePoint start, CpuTimer::TimePoint end);
+        void finalize(std::vector<std::string> eventPaths, std::vector<std::string> threadNames);
 
         size_t mReservedFrames = 0;
         size_t mFrameCount = 0;
         std::vector<Event*> mEvents;
         std::vector<Lane> mLanes;
+        CpuTimer::TimePoint mStartTime;
+        std::vector<Span> mSpans;
+        std::vector<std::string> mEventPaths;
+        std::vector<std::string> mThreadNames;
         bool mFinalized = false;
 
         friend class Profiler;
@@ -158,6 +206,7 @@ public:
      * Constructor.
      */
     Profiler(ref<Device> pDevice);
+    ~Profiler();
 
     const Device* getDevice() const { return mpDevice.get(); }
 
@@ -165,25 +214,25 @@ public:
      * Check if the profiler is enabled.
      * @return Returns true if the profiler is enabled.
      */
-    bool isEnabled() const { return mEnabled; }
+    bool isEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
 
     /**
      * Enable/disable the profiler.
      * @param[in] enabled True to enable the profiler.
      */
-    void setEnabled(bool enabled) { mEnabled = enabled; }
+    void setEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
 
     /**
      * Check if the profiler is paused.
      * @return Returns true if the profiler is paused.
      */
-    bool isPaused() const { return mPaused; }
+    bool isPaused() const { return mPaused.load(std::memory_order_relaxed); }
 
     /**
      * Pause/resume the profiler.
      * @param[in] paused True to pause the profiler.
      */
-    void setPaused(bool paused) { mPaused = paused; }
+    void setPaused(bool paused) { mPaused.store(paused, std::memory_order_relaxed); }
 
     /**
      * Start profile capture.
@@ -211,19 +260,26 @@ public:
 
     /**
      * Start profiling a new event and update the events hierarchies.
-     * @param[in] pRenderContext Render context for measuring GPU time.
+     * @param[in] pRenderContext Render context for measuring GPU time. If nullptr, only CPU time is measured.
      * @param[in] name The event name.
      * @param[in] flags The event flags.
+     * @param[in] pSite Optional call site cache for the interned event.
      */
-    void startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
+    void startEvent(RenderContext* pRenderContext, std::string_view name, Flags flags = Flags::Default, EventSite* pSite = nullptr);
 
     /**
      * Finish profiling a new event and update the events hierarchies.
-     * @param[in] pRenderContext Render context for measuring GPU time.
+     * @param[in] pRenderContext Render context for measuring GPU time. Must match the call to startEvent().
      * @param[in] name The event name.
      * @param[in] flags The event flags.
      */
-    void endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
+    void endEvent(RenderContext* pRenderContext, std::string_view name, Flags flags = Flags::Default);
+
+    /**
+     * Set the name of the calling thread as shown in trace exports.
+     * @param[in] name The thread name.
+     */
+    void setThreadName(std::string_view name);
 
     /**
      * Get the event, or create a new one if the event does not yet exist.
@@ -261,19 +317,38 @@ private:
      */
     Event* findEvent(const std::string& name);
 
+    /**
+     * Get the event for an interned event path, creating it if needed.
+     * Note: Must only be called on the thread calling endFrame().
+     */
+    Event* getEvent(const EventNode* pNode);
+
+    /// Register an event as active in the current frame.
+    void registerFrameEvent(Event* pEvent);
+
+    /// Get the recording lane of the calling thread, creating it if needed.
+    ThreadLane& getThreadLane();
+
+    /// Drain the records of all thread lanes. Called from endFrame().
+    void drainThreadLanes();
+
     BreakableReference<Device> mpDevice;
 
-    bool mEnabled = false;
-    bool mPaused = false;
+    const uint64_t mInstanceID; ///< Unique profiler instance ID, used to validate thread-local lane caches.
+
+    std::atomic<bool> mEnabled{false};
+    std::atomic<bool> mPaused{false};
 
     std::unordered_map<std::string, std::shared_ptr<Event>> mEvents; ///< Events by name.
+    std::vector<Event*> mEventsByID;                                 ///< Events by interned event ID.
     std::vector<Event*> mCurrentFrameEvents;                         ///< Events registered for current frame.
     std::vector<Event*> mLastFrameEvents;                            ///< Events from last frame.
-    std::string mCurrentEventName;                                   ///< Current nested event name.
-    uint32_t mCurrentLevel = 0;                                      ///< Current nesting level.
     uint32_t mFrameIndex = 0;                                        ///< Current frame index.
     bool mPendingReset = false;                                      ///< Reset profiler stats at the next call to endFrame().
 
+    std::mutex mLaneMutex;                           ///< Protects the list of thread lanes.
+    std::vector<std::unique_ptr<ThreadLane>> mLanes; ///< Recording lanes, one per thread.
+
     std::shared_ptr<Capture> mpCapture; ///< Currently active capture.
 
     ref<Fence> mpFence;
@@ -291,22 +366,45 @@ FALCOR_ENUM_CLASS_OPERATORS(Profiler::Flags);
 class FALCOR_API ScopedProfilerEvent
 {
 public:
-    ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags = Profiler::Flags::Default);
+    ScopedProfilerEvent(
+        RenderContext* pRenderContext,
+        std::string_view name,
+        Profiler::Flags flags = Profiler::Flags::Default,
+        Profiler::EventSite* pSite = nullptr
+    );
+
+    /**
+     * Constructor for events measuring CPU time only. Can be used on any thread.
+     * @param[in] pProfiler Profiler to record to. If nullptr, no event is recorded.
+     * @param[in] name The event name.
+     * @param[in] pSite Optional call site cache for the interned event.
+     */
+    ScopedProfilerEvent(Profiler* pProfiler, std::string_view name, Profiler::EventSite* pSite = nullptr);
+
     ~ScopedProfilerEvent();
 
 private:
+    Profiler* mpProfiler;
     RenderContext* mpRenderContext;
-    const std::string mName;
     Profiler::Flags mFlags;
 };
 } // namespace Falcor
 
 #if FALCOR_ENABLE_PROFILER
-#define FALCOR_PROFILE(_pRenderContext, _name) \
-    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, _name)
+#define FALCOR_PROFILE_SITE FALCOR_CONCAT_STRINGS(_profileSite, __LINE__)
+#define FALCOR_PROFILE(_pRenderContext, _name)                                         \
+    static Falcor::Profiler::EventSite FALCOR_PROFILE_SITE;                            \
+    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(        \
+        _pRenderContext, _name, Falcor::Profiler::Flags::Default, &FALCOR_PROFILE_SITE \
+    )
 #define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags) \
-    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, _name, _flags)
+    static Falcor::Profiler::EventSite FALCOR_PROFILE_SITE;   \
+    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, _name, _flags, &FALCOR_PROFILE_SITE)
+#define FALCOR_PROFILE_CPU(_pProfiler, _name)               \
+    static Falcor::Profiler::EventSite FALCOR_PROFILE_SITE; \
+    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pProfiler, _name, &FALCOR_PROFILE_SITE)
 #else
 #define FALCOR_PROFILE(_pRenderContext, _name)
 #define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags)
+#define FALCOR_PROFILE_CPU(_pProfiler, _name)
 #endif
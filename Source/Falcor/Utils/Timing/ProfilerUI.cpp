@@ -277,6 +277,8 @@ void ProfilerUI::renderOptions()
             if (saveFileDialog(filters, path))
             {
                 pCapture->writeToFile(path);
+                // Write the CPU timeline next to the capture, viewable in chrome://tracing or Perfetto.
+                pCapture->writeTraceToFile(std::filesystem::path(path).replace_extension(".trace.json"));
             }
         }
     }
@@ -41,6 +41,11 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+        const std::string kMaxPendingWrites = "maxPendingWrites";
+
+        // Default number of captured images that may wait to be written before capturing blocks.
+        const size_t kDefaultMaxPendingWrites = 8;
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -50,6 +55,22 @@ namespace Mogwai
             for (auto p : pair) v.push_back(p.first);
             return v;
         }
+
+        uint32_t getWriterThreadCount()
+        {
+            return std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+        }
+
+        /** Read back a texture into a write job. The file name and format are filled in by the caller.
+        */
+        ImageWriteQueue::Job readbackImage(const ref<Texture>& pTex)
+        {
+            ImageWriteQueue::Job job;
+            job.width = pTex->getWidth();
+            job.height = pTex->getHeight();
+            job.data = pTex->readImageData(0, 0, job.resourceFormat);
+            return job;
+        }
     }
 
     MOGWAI_EXTENSION(FrameCapture);
@@ -63,6 +84,7 @@ namespace Mogwai
         : CaptureTrigger(pRenderer, "Frame Capture")
     {
         mpImageProcessing = std::make_unique<ImageProcessing>(pRenderer->getDevice());
+        mpWriteQueue = std::make_unique<ImageWriteQueue>(getWriterThreadCount(), kDefaultMaxPendingWrites);
     }
 
     void FrameCapture::renderUI(Gui* pGui)
@@ -77,6 +99,17 @@ namespace Mogwai
             w.tooltip("Capture all available outputs instead of the marked ones only.");
 
             if (w.button("Capture Current Frame")) capture();
+
+            auto stats = mpWriteQueue->getStats();
+            std::string text = fmt::format("Pending writes: {}\n", stats.queueDepth);
+            text += fmt::format("Images written: {}\n", stats.writtenCount);
+            if (uint64_t count = stats.writtenCount + stats.failedCount; count > 0) text += fmt::format("Avg encode time: {:.2f} ms\n", stats.totalEncodeTime / count);
+            text += fmt::format("Total stall time: {:.2f} ms", stats.totalStallTime);
+            w.text(text);
+
+            uint32_t maxPendingWrites = (uint32_t)mpWriteQueue->getMaxPendingJobs();
+            if (w.var("Max Pending Writes", maxPendingWrites, 1u)) mpWriteQueue->setMaxPendingJobs(maxPendingWrites);
+            w.tooltip("Maximum number of captured images waiting to be written before rendering blocks.");
         }
     }
 
@@ -95,6 +128,7 @@ namespace Mogwai
         auto printGraph = [](FrameCapture* pFC, RenderGraph* pGraph) { pybind11::print(pFC->graphFramesStr(pGraph)); };
         frameCapture.def(kPrintFrames.c_str(), printGraph, "graph"_a);
         frameCapture.def(kCapture.c_str(), &FrameCapture::capture);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
         auto printAllGraphs = [](FrameCapture* pFC)
         {
             std::string s;
@@ -111,6 +145,9 @@ namespace Mogwai
         frameCapture.def_property("captureAllOutputs",
             [](FrameCapture* pFC){ return pFC->mCaptureAllOutputs;},
             [](FrameCapture* pFC, bool all){ pFC->mCaptureAllOutputs = all; });
+        frameCapture.def_property(kMaxPendingWrites.c_str(),
+            [](FrameCapture* pFC){ return pFC->mpWriteQueue->getMaxPendingJobs(); },
+            [](FrameCapture* pFC, size_t count){ pFC->mpWriteQueue->setMaxPendingJobs(count); });
     }
 
     std::string FrameCapture::getScriptVar() const
@@ -241,14 +278,15 @@ namespace Mogwai
                 mpImageProcessing->copyColorChannel(pRenderContext, pOutput->getSRV(0, 1, 0, 1), pTex->getUAV(), mask);
             }
 
-            // Write output image.
+            // Read back the image and queue it for writing. Conversion and encoding happen on the writer threads.
             auto ext = Bitmap::getFileExtFromResourceFormat(pTex->getFormat());
-            auto fileformat = Bitmap::getFormatFromFileExtension(ext);
-            std::string filename = basename + suffix + "." + ext;
-            Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
-            if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
+            ImageWriteQueue::Job job = readbackImage(pTex);
+            job.path = basename + suffix + "." + ext;
+            job.fileFormat = Bitmap::getFormatFromFileExtension(ext);
+            if (job.fileFormat == Bitmap::FileFormat::DdsFile) FALCOR_THROW("Frame capture does not support saving to DDS.");
+            if (mask == TextureChannelFlags::RGBA) job.exportFlags |= Bitmap::ExportFlags::ExportAlpha;
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+            mpWriteQueue->enqueue(std::move(job));
         }
     }
 
@@ -272,6 +310,11 @@ namespace Mogwai
         return s;
     }
 
+    void FrameCapture::flush()
+    {
+        mpWriteQueue->flush();
+    }
+
     void FrameCapture::capture()
     {
         auto pGraph = mpRenderer->getActiveGraph();
@@ -28,6 +28,7 @@
 #pragma once
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
+#include "ImageWriteQueue.h"
 #include "Utils/Image/ImageProcessing.h"
 
 namespace Mogwai
@@ -43,6 +44,14 @@ namespace Mogwai
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
         void capture();
 
+        /** Wait until all captured frames have been written to disk.
+        */
+        void flush();
+
+        /** Get statistics of the image writer.
+        */
+        ImageWriteQueue::Stats getWriteStats() const { return mpWriteQueue->getStats(); }
+
     private:
         FrameCapture(Renderer* pRenderer);
 
@@ -54,5 +63,6 @@ namespace Mogwai
 
         bool mCaptureAllOutputs = false;
         std::unique_ptr<ImageProcessing> mpImageProcessing;
+        std::unique_ptr<ImageWriteQueue> mpWriteQueue;  ///< Encodes and writes captured images on worker threads.
     };
 }
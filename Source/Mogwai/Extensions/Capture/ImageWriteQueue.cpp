@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ImageWriteQueue.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace Mogwai
+{
+    ImageWriteQueue::ImageWriteQueue(uint32_t threadCount, size_t maxPendingJobs)
+        : mMaxPendingJobs(std::max<size_t>(maxPendingJobs, 1))
+    {
+        FALCOR_CHECK(threadCount > 0, "'threadCount' must be at least 1.");
+        mThreads.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; i++) mThreads.emplace_back(&ImageWriteQueue::workerMain, this);
+    }
+
+    ImageWriteQueue::~ImageWriteQueue()
+    {
+        flush();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+        mJobAvailable.notify_all();
+
+        for (auto& thread : mThreads) thread.join();
+    }
+
+    void ImageWriteQueue::enqueue(Job&& job)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        // Apply back-pressure when the workers can't keep up.
+        if (mJobs.size() + mActiveJobs >= mMaxPendingJobs)
+        {
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            mSpaceAvailable.wait(lock, [this] { return mJobs.size() + mActiveJobs < mMaxPendingJobs; });
+            mStats.totalStallTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        }
+
+        mJobs.push_back(std::move(job));
+        mStats.maxQueueDepth = std::max(mStats.maxQueueDepth, mJobs.size() + mActiveJobs);
+        lock.unlock();
+
+        mJobAvailable.notify_one();
+    }
+
+    void ImageWriteQueue::flush()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mIdle.wait(lock, [this] { return mJobs.empty() && mActiveJobs == 0; });
+    }
+
+    void ImageWriteQueue::setMaxPendingJobs(size_t maxPendingJobs)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mMaxPendingJobs = std::max<size_t>(maxPendingJobs, 1);
+        }
+        mSpaceAvailable.notify_all();
+    }
+
+    size_t ImageWriteQueue::getMaxPendingJobs() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mMaxPendingJobs;
+    }
+
+    ImageWriteQueue::Stats ImageWriteQueue::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Stats stats = mStats;
+        stats.queueDepth = mJobs.size() + mActiveJobs;
+        return stats;
+    }
+
+    void ImageWriteQueue::workerMain()
+    {
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mJobAvailable.wait(lock, [this] { return mTerminate || !mJobs.empty(); });
+                if (mJobs.empty()) return; // Terminating and all jobs are done.
+                job = std::move(mJobs.front());
+                mJobs.pop_front();
+                mActiveJobs++;
+            }
+
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            bool success = true;
+            try
+            {
+                Bitmap::saveImage(job.path, job.width, job.height, job.fileFormat, job.exportFlags, job.resourceFormat, true, job.data.data());
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to write frame capture '{}': {}", job.path, e.what());
+                success = false;
+            }
+            double encodeTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+            // Release the image data before signaling, so that the memory bound holds.
+            job.data = {};
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mActiveJobs--;
+                if (success) mStats.writtenCount++;
+                else mStats.failedCount++;
+                mStats.lastEncodeTime = encodeTime;
+                mStats.totalEncodeTime += encodeTime;
+                // Notify while holding the lock, so that a waiter can't destroy the queue in between.
+                mSpaceAvailable.notify_one();
+                if (mJobs.empty() && mActiveJobs == 0) mIdle.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "../../Mogwai.h"
+#include "Utils/Image/Bitmap.h"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Mogwai
+{
+    /** Bounded queue of images waiting to be written to disk.
+        Worker threads do the format conversion and encoding. When the queue is full, enqueue() blocks
+        until a worker has picked up a job, which keeps the memory held by pending images bounded.
+    */
+    class ImageWriteQueue
+    {
+    public:
+        struct Job
+        {
+            std::filesystem::path path;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            Bitmap::FileFormat fileFormat = Bitmap::FileFormat::PngFile;
+            Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::None;
+            ResourceFormat resourceFormat = ResourceFormat::Unknown;
+            std::vector<uint8_t> data;      ///< Top-down image data in 'resourceFormat'.
+        };
+
+        struct Stats
+        {
+            size_t queueDepth = 0;          ///< Number of jobs waiting or being encoded.
+            size_t maxQueueDepth = 0;       ///< Largest queue depth observed.
+            uint64_t writtenCount = 0;      ///< Number of images written.
+            uint64_t failedCount = 0;       ///< Number of images that failed to be written.
+            double lastEncodeTime = 0.0;    ///< Time in ms spent converting and encoding the last image.
+            double totalEncodeTime = 0.0;   ///< Time in ms spent converting and encoding all images.
+            double totalStallTime = 0.0;    ///< Time in ms the renderer was blocked waiting for space in the queue.
+        };
+
+        /** Constructor. Starts the worker threads.
+            \param[in] threadCount Number of worker threads.
+            \param[in] maxPendingJobs Maximum number of jobs in the queue before enqueue() blocks.
+        */
+        ImageWriteQueue(uint32_t threadCount, size_t maxPendingJobs);
+
+        /** Destructor. Writes all pending images before returning.
+        */
+        ~ImageWriteQueue();
+
+        ImageWriteQueue(const ImageWriteQueue&) = delete;
+        ImageWriteQueue& operator=(const ImageWriteQueue&) = delete;
+
+        /** Add a job to the queue. Blocks while the queue is full.
+        */
+        void enqueue(Job&& job);
+
+        /** Wait until all queued images have been written.
+        */
+        void flush();
+
+        /** Set the maximum number of jobs in the queue before enqueue() blocks.
+        */
+        void setMaxPendingJobs(size_t maxPendingJobs);
+        size_t getMaxPendingJobs() const;
+
+        Stats getStats() const;
+
+    private:
+        void workerMain();
+
+        mutable std::mutex mMutex;
+        std::condition_variable mJobAvailable;  ///< Signaled when a job is added or the queue shuts down.
+        std::condition_variable mSpaceAvailable; ///< Signaled when a job is picked up or the limit changes.
+        std::condition_variable mIdle;          ///< Signaled when all jobs have completed.
+
+        std::deque<Job> mJobs;
+        size_t mActiveJobs = 0;
+        size_t mMaxPendingJobs;
+        bool mTerminate = false;
+        Stats mStats;
+
+        std::vector<std::thread> mThreads;
+    };
+}
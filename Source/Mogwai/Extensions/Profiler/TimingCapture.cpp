@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Falcor.h"
 #include "TimingCapture.h"
+#include "../Capture/FrameCapture.h"
 
 namespace Mogwai
 {
@@ -50,7 +51,7 @@ namespace Mogwai
         pybind11::class_<TimingCapture> timingCapture(m, "TimingCapture");
 
         // Members
-        timingCapture.def(kCaptureFrameTime.c_str(), &TimingCapture::captureFrameTime, "path"_a);
+        timingCapture.def(kCaptureFrameTime.c_str(), &TimingCapture::captureFrameTime, "path"_a, "includeCaptureStats"_a = false);
     }
 
     std::string TimingCapture::getScriptVar() const
@@ -63,11 +64,15 @@ namespace Mogwai
         recordPreviousFrameTime();
     }
 
-    void TimingCapture::captureFrameTime(std::filesystem::path path)
+    void TimingCapture::captureFrameTime(std::filesystem::path path, bool includeCaptureStats)
     {
         if (mFrameTimeFile.is_open())
             mFrameTimeFile.close();
 
+        mIncludeCaptureStats = includeCaptureStats;
+        mPrevCompletedCount = 0;
+        mPrevTotalEncodeTime = 0.0;
+
         if (!path.empty())
         {
             if (std::filesystem::exists(path))
@@ -80,6 +85,10 @@ namespace Mogwai
             {
                 logError("Failed to open file '{}' for writing. Ignoring call.", path);
             }
+            else if (mIncludeCaptureStats)
+            {
+                mFrameTimeFile << "frameTime,captureQueueDepth,captureEncodeTime" << std::endl;
+            }
         }
     }
 
@@ -89,7 +98,26 @@ namespace Mogwai
 
         // The FrameRate object is updated at the start of each frame, the first valid time is available on the second frame.
         auto& frameRate = mpRenderer->getFrameRate();
-        if (frameRate.getFrameCount() > 1)
-            mFrameTimeFile << frameRate.getLastFrameTime() << std::endl;
+        if (frameRate.getFrameCount() <= 1) return;
+
+        mFrameTimeFile << frameRate.getLastFrameTime();
+        if (mIncludeCaptureStats)
+        {
+            ImageWriteQueue::Stats stats;
+            for (const auto& pExtension : mpRenderer->getExtensions())
+            {
+                if (auto pFrameCapture = dynamic_cast<const FrameCapture*>(pExtension.get())) stats = pFrameCapture->getWriteStats();
+            }
+
+            // Average encode time of the images that were completed since the last record.
+            uint64_t completedCount = stats.writtenCount + stats.failedCount;
+            uint64_t count = completedCount - mPrevCompletedCount;
+            double encodeTime = count > 0 ? (stats.totalEncodeTime - mPrevTotalEncodeTime) / count : 0.0;
+            mPrevCompletedCount = completedCount;
+            mPrevTotalEncodeTime = stats.totalEncodeTime;
+
+            mFrameTimeFile << "," << stats.queueDepth << "," << encodeTime;
+        }
+        mFrameTimeFile << std::endl;
     }
 }
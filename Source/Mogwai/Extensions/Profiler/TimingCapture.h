@@ -45,10 +45,15 @@ namespace Mogwai
         TimingCapture(Renderer *pRenderer) : Extension(pRenderer, "Timing Capture") {}
 
         /** Start capture frame times to file, or end capture if path is empty.
+            \param[in] path Output file path.
+            \param[in] includeCaptureStats Also write the frame capture queue depth and average encode time (in ms) of the images written during the frame.
         */
-        void captureFrameTime(std::filesystem::path path);
+        void captureFrameTime(std::filesystem::path path, bool includeCaptureStats = false);
         void recordPreviousFrameTime();
 
         std::ofstream   mFrameTimeFile;     ///< Frame times are appended to this file when it's open.
+        bool            mIncludeCaptureStats = false;
+        uint64_t        mPrevCompletedCount = 0;      ///< Number of images completed by the frame capture writer at the last record.
+        double          mPrevTotalEncodeTime = 0.0;
     };
 }
@@ -1,5 +1,7 @@
 #include "DDGIPass.h"
 #include "RenderGraph/RenderPassStandardFlags.h"
+#include <map>
+#include <numeric>
 #include <vector>
 
 namespace
@@ -14,6 +16,14 @@ const std::string kVisualizeShader = "RenderPasses/DDGIPass/VisualizeProbe.ps.sl
 constexpr char kOrigin[] = "origin";
 constexpr char kSpacing[] = "spacing";
 constexpr char kProbeCounts[] = "probeCounts";
+constexpr char kOptimizeProbePlacement[] = "optimizeProbePlacement";
+constexpr char kPlacementVoxelsPerProbe[] = "placementVoxelsPerProbe";
+constexpr char kPlacementMaxVoxelCount[] = "placementMaxVoxelCount";
+constexpr char kPlacementMaxOffset[] = "placementMaxOffset";
+constexpr char kPlacementMinClearance[] = "placementMinClearance";
+constexpr char kPlacementBackfaceThreshold[] = "placementBackfaceThreshold";
+constexpr char kPlacementCullInside[] = "placementCullInside";
+constexpr char kPlacementCullFar[] = "placementCullFar";
 constexpr char kTileResTrace[] = "tileResTrace";
 constexpr char kTileResRadiance[] = "tileResRadiance";
 constexpr char kTileResIrradiance[] = "tileResIrradiance";
@@ -23,6 +33,9 @@ constexpr char kGIIntensity[] = "giIntensity";
 constexpr char kVisualize[] = "visualizeProbes";
 constexpr char kProbeVizRadius[] = "probeVizRadius";
 constexpr char kProbeVizColor[] = "probeVizColor";
+
+// Probe placement runs on the CPU. While probe settings are edited in the UI, it is deferred until no edit happened for this long.
+const double kPlacementDebounceTime = 250.0; // ms
 } // namespace
 
 extern "C" FALCOR_API_EXPORT void registerPlugin(PluginRegistry& registry)
@@ -52,6 +65,22 @@ void DDGIPass::parseProperties(const Properties& props)
             mOpt.spacing = value, mDirty |= DDGIDirtyFlags::Probes;
         else if (key == kProbeCounts)
             mOpt.probeCounts = value, mDirty |= (DDGIDirtyFlags::Probes | DDGIDirtyFlags::Atlases);
+        else if (key == kOptimizeProbePlacement)
+            mOpt.optimizeProbePlacement = value, mDirty |= DDGIDirtyFlags::Probes;
+        else if (key == kPlacementVoxelsPerProbe)
+            mPlacementOptions.voxelsPerProbe = value, mDirty |= DDGIDirtyFlags::Probes;
+        else if (key == kPlacementMaxVoxelCount)
+            mPlacementOptions.maxVoxelCount = value, mDirty |= DDGIDirtyFlags::Probes;
+        else if (key == kPlacementMaxOffset)
+            mPlacementOptions.maxOffset = value, mDirty |= DDGIDirtyFlags::Probes;
+        else if (key == kPlacementMinClearance)
+            mPlacementOptions.minClearance = value, mDirty |= DDGIDirtyFlags::Probes;
+        else if (key == kPlacementBackfaceThreshold)
+            mPlacementOptions.backfaceThreshold = value, mDirty |= DDGIDirtyFlags::Probes;
+        else if (key == kPlacementCullInside)
+            mPlacementOptions.cullInside = value, mDirty |= DDGIDirtyFlags::Probes;
+        else if (key == kPlacementCullFar)
+            mPlacementOptions.cullFar = value, mDirty |= DDGIDirtyFlags::Probes;
         else if (key == kTileResTrace)
             mOpt.tileResTrace = value, mDirty |= DDGIDirtyFlags::Atlases;
         else if (key == kTileResRadiance)
@@ -81,6 +110,14 @@ Properties DDGIPass::getProperties() const
     props[kOrigin] = mOpt.origin;
     props[kSpacing] = mOpt.spacing;
     props[kProbeCounts] = mOpt.probeCounts;
+    props[kOptimizeProbePlacement] = mOpt.optimizeProbePlacement;
+    props[kPlacementVoxelsPerProbe] = mPlacementOptions.voxelsPerProbe;
+    props[kPlacementMaxVoxelCount] = mPlacementOptions.maxVoxelCount;
+    props[kPlacementMaxOffset] = mPlacementOptions.maxOffset;
+    props[kPlacementMinClearance] = mPlacementOptions.minClearance;
+    props[kPlacementBackfaceThreshold] = mPlacementOptions.backfaceThreshold;
+    props[kPlacementCullInside] = mPlacementOptions.cullInside;
+    props[kPlacementCullFar] = mPlacementOptions.cullFar;
     props[kTileResTrace] = mOpt.tileResTrace;
     props[kTileResRadiance] = mOpt.tileResRadiance;
     props[kTileResIrradiance] = mOpt.tileResIrradiance;
@@ -123,6 +160,12 @@ void DDGIPass::setScene(RenderContext* pRenderContext, const ref<Scene>& pScene)
     mpBlendVars = nullptr;
     mDirty |= DDGIDirtyFlags::BlendProgram;
 
+    mScenePositions.clear();
+    mSceneIndices.clear();
+    mSceneTrianglesValid = false;
+    mProbeEditTime.reset();
+    mPlacementPending = false;
+
     if (!mpScene)
         return;
 
@@ -147,11 +190,21 @@ void DDGIPass::rebuildIfNeeded(RenderContext* ctx)
         prepareProbePositionsBuffer();
     }
 
+    const bool clearTraceAtlases = is_set(mDirty, DDGIDirtyFlags::Probes) || is_set(mDirty, DDGIDirtyFlags::Atlases);
+
     if (is_set(mDirty, DDGIDirtyFlags::Atlases))
     {
         prepareAtlases();
     }
 
+    // Tiles of inactive probes are never traced, make them read as misses.
+    if (clearTraceAtlases)
+    {
+        ctx->clearUAV(mpHitPosAtlas->getUAV().get(), float4(0.f));
+        ctx->clearUAV(mpHitNormalAtlas->getUAV().get(), float4(0.f));
+        ctx->clearUAV(mpHitAlbedoAtlas->getUAV().get(), float4(0.f));
+    }
+
     if (is_set(mDirty, DDGIDirtyFlags::RtPrograms))
     {
         prepareTraceProgram();
@@ -177,6 +230,18 @@ void DDGIPass::prepareProbePositionsBuffer()
         );
         mpProbePositions->setName("DDGI::ProbePositions");
     }
+
+    if (const uint32_t probeCount = getProbeCount(); !mpProbeStates || mpProbeStates->getElementCount() < probeCount)
+    {
+        mpActiveProbes = mpDevice->createStructuredBuffer(
+            sizeof(uint32_t), probeCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false
+        );
+        mpActiveProbes->setName("DDGI::ActiveProbes");
+        mpProbeStates = mpDevice->createStructuredBuffer(
+            sizeof(uint32_t), probeCount, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false
+        );
+        mpProbeStates->setName("DDGI::ProbeStates");
+    }
 }
 
 void DDGIPass::prepareAtlases()
@@ -362,10 +427,128 @@ void DDGIPass::prepareBlendResources(const RenderData& rd)
     }
 }
 
+void DDGIPass::collectSceneTriangles()
+{
+    mScenePositions.clear();
+    mSceneIndices.clear();
+    mSceneTrianglesValid = true;
+
+    // Mesh data only lives on the GPU. Read back each mesh once and transform it by all of its instances.
+    std::vector<std::vector<float3>> meshPositions(mpScene->getMeshCount());
+    std::vector<std::vector<uint3>> meshTriangles(mpScene->getMeshCount());
+    std::map<std::string, ref<Buffer>> buffers;
+    uint32_t bufferElementCount = 0;
+
+    const auto& globalMatrices = mpScene->getAnimationController()->getGlobalMatrices();
+    for (uint32_t instanceID = 0; instanceID < mpScene->getGeometryInstanceCount(); ++instanceID)
+    {
+        const auto& instance = mpScene->getGeometryInstance(instanceID);
+        if (instance.getType() != Scene::GeometryType::TriangleMesh && instance.getType() != Scene::GeometryType::DisplacedTriangleMesh)
+            continue;
+
+        const MeshID meshID = MeshID::fromSlang(instance.geometryID);
+        const auto& mesh = mpScene->getMesh(meshID);
+        auto& positions = meshPositions[meshID.get()];
+        auto& triangles = meshTriangles[meshID.get()];
+        if (positions.empty())
+        {
+            if (const uint32_t count = std::max(mesh.vertexCount, mesh.getTriangleCount()); count > bufferElementCount)
+            {
+                bufferElementCount = count;
+                for (const char* name : {"triangleIndices", "positions", "texcrds"})
+                {
+                    buffers[name] = mpDevice->createStructuredBuffer(
+                        sizeof(float3),
+                        count,
+                        ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess,
+                        MemoryType::DeviceLocal,
+                        nullptr,
+                        false
+                    );
+                }
+            }
+            mpScene->getMeshVerticesAndIndices(meshID, buffers);
+            positions = buffers["positions"]->getElements<float3>(0, mesh.vertexCount);
+            triangles = buffers["triangleIndices"]->getElements<uint3>(0, mesh.getTriangleCount());
+        }
+
+        // Wind triangles counter-clockwise in world space.
+        const float4x4& transform = globalMatrices[instance.globalMatrixID];
+        const bool flip = instance.isWorldFrontFaceCW();
+        const uint32_t base = (uint32_t)mScenePositions.size();
+        for (const float3& p : positions)
+            mScenePositions.push_back(transformPoint(transform, p));
+        for (const uint3& t : triangles)
+            mSceneIndices.insert(mSceneIndices.end(), {base + t.x, base + (flip ? t.z : t.y), base + (flip ? t.y : t.z)});
+    }
+}
+
+void DDGIPass::updateProbePlacement()
+{
+    if (!mSceneTrianglesValid)
+        collectSceneTriangles();
+
+    ProbePlacement::Grid grid;
+    grid.origin = mOpt.origin;
+    grid.spacing = mOpt.spacing;
+    grid.probeCounts = mOpt.probeCounts;
+
+    const auto startTime = CpuTimer::getCurrentTimePoint();
+    mPlacement = ProbePlacement::compute(grid, mScenePositions, mSceneIndices, mPlacementOptions);
+    const double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    logInfo(
+        "DDGIPass: Placed {} probes in {:.1f} ms. {} active, {} moved, {} inside geometry, {} far from surfaces ({:.1f}% culled).",
+        mPlacement.getProbeCount(),
+        duration,
+        mPlacement.getActiveCount(),
+        mPlacement.movedCount,
+        mPlacement.insideCount,
+        mPlacement.farCount,
+        mPlacement.getCulledFraction() * 100.f
+    );
+
+    std::vector<float3> positions(mPlacement.getProbeCount());
+    std::vector<uint32_t> states(mPlacement.getProbeCount());
+    for (uint32_t i = 0; i < mPlacement.getProbeCount(); ++i)
+    {
+        const uint3 counts = grid.probeCounts;
+        const uint3 probe(i % counts.x, (i / counts.x) % counts.y, i / (counts.x * counts.y));
+        positions[i] = ProbePlacement::getGridPosition(grid, probe) + mPlacement.offsets[i];
+        states[i] = (uint32_t)mPlacement.states[i];
+    }
+    mpProbePositions->setBlob(positions.data(), 0, positions.size() * sizeof(float3));
+    mpProbeStates->setBlob(states.data(), 0, states.size() * sizeof(uint32_t));
+    if (!mPlacement.activeProbes.empty())
+        mpActiveProbes->setBlob(mPlacement.activeProbes.data(), 0, mPlacement.activeProbes.size() * sizeof(uint32_t));
+    mActiveProbeCount = mPlacement.getActiveCount();
+}
+
 void DDGIPass::stageGenerateProbes(RenderContext* ctx)
 {
     FALCOR_PROFILE(ctx, "DDGI::GenerateProbes");
 
+    // Use the regular grid while probe settings are being edited, the deferred placement is triggered from execute().
+    mPlacementPending = mOpt.optimizeProbePlacement && mProbeEditTime &&
+                        CpuTimer::calcDuration(*mProbeEditTime, CpuTimer::getCurrentTimePoint()) < kPlacementDebounceTime;
+
+    if (mOpt.optimizeProbePlacement && !mPlacementPending)
+    {
+        updateProbePlacement();
+        mProbeEditTime.reset();
+        mDirty &= ~DDGIDirtyFlags::Probes;
+        return;
+    }
+
+    // All probes are active.
+    mPlacement = {};
+    mActiveProbeCount = getProbeCount();
+    std::vector<uint32_t> activeProbes(mActiveProbeCount);
+    std::iota(activeProbes.begin(), activeProbes.end(), 0u);
+    mpActiveProbes->setBlob(activeProbes.data(), 0, activeProbes.size() * sizeof(uint32_t));
+    std::vector<uint32_t> states(mActiveProbeCount, (uint32_t)ProbePlacement::ProbeState::Active);
+    mpProbeStates->setBlob(states.data(), 0, states.size() * sizeof(uint32_t));
+
     const auto var = mpGenerateProbesPass->getRootVar();
     var["DDGIConstants"]["gOrigin"] = mOpt.origin;
     var["DDGIConstants"]["gSpacing"] = mOpt.spacing;
@@ -395,14 +578,16 @@ void DDGIPass::stageTraceProbeGBuffer(RenderContext* ctx) const
     var["DDGIConstants"]["gMaxRayDistance"] = mOpt.maxRayDistance;
 
     var["gProbePositions"] = mpProbePositions;
+    var["gActiveProbes"] = mpActiveProbes;
 
     var["gHitPosAtlas"] = mpHitPosAtlas;
     var["gHitNormalAtlas"] = mpHitNormalAtlas;
     var["gHitAlbedoAtlas"] = mpHitAlbedoAtlas;
 
-    const uint32_t totalProbes = getProbeCount();
+    if (mActiveProbeCount == 0)
+        return;
 
-    mpScene->raytrace(ctx, mpTraceProgram.get(), mpTraceVars, uint3(mOpt.tileResTrace, mOpt.tileResTrace, totalProbes));
+    mpScene->raytrace(ctx, mpTraceProgram.get(), mpTraceVars, uint3(mOpt.tileResTrace, mOpt.tileResTrace, mActiveProbeCount));
 }
 
 void DDGIPass::stageComputeRadiance(RenderContext* ctx) const
@@ -485,6 +670,7 @@ void DDGIPass::stageBlend(RenderContext* ctx, const RenderData& rd)
     var["gEmissiveIn"] = emissiveIn;
 
     var["gProbePositions"] = mpProbePositions;
+    var["gProbeStates"] = mpProbeStates;
     var["gIrradianceAtlas"] = mpIrradianceAtlas;
 
     if (!mpLinearSampler)
@@ -554,15 +740,25 @@ void DDGIPass::stageVisualize(RenderContext* ctx, const RenderData& rd)
     var["PerFrameCB"]["gCameraPos"] = cam->getPosition();
 
     var["gProbePositions"] = mpProbePositions;
+    var["gActiveProbes"] = mpActiveProbes;
 
     const uint32_t indexCount = static_cast<uint32_t>(mpProbeSphere->getIndices().size());
-    const uint32_t instCount = getProbeCount();
+    const uint32_t instCount = mActiveProbeCount;
+    if (instCount == 0)
+        return;
 
     ctx->drawIndexedInstanced(mpVizState.get(), mpVizVars.get(), indexCount, instCount, 0, 0, 0);
 }
 
 void DDGIPass::execute(RenderContext* pRenderContext, const RenderData& renderData)
 {
+    // Run the deferred probe placement once the UI edits have settled.
+    if (mPlacementPending && CpuTimer::calcDuration(*mProbeEditTime, CpuTimer::getCurrentTimePoint()) >= kPlacementDebounceTime)
+    {
+        mDirty |= DDGIDirtyFlags::Probes;
+        mOptionsChanged = true;
+    }
+
     auto& dict = renderData.getDictionary();
     if (mOptionsChanged)
     {
@@ -626,6 +822,20 @@ void DDGIPass::renderUI(Gui::Widgets& widget)
     }
 
     widget.text("Total Probes: " + std::to_string(getProbeCount()));
+
+    dirtyProbes |= widget.checkbox("Optimize Probe Placement", mOpt.optimizeProbePlacement);
+    widget.tooltip("Move probes out of geometry and cull probes that are enclosed or far from surfaces.");
+    if (mOpt.optimizeProbePlacement)
+    {
+        dirtyProbes |= widget.var("Placement Voxels Per Probe", mPlacementOptions.voxelsPerProbe, 1u, 32u);
+        dirtyProbes |= widget.var("Min Clearance (cells)", mPlacementOptions.minClearance, 0.f, 0.5f, 0.01f);
+        if (mPlacementPending)
+            widget.text("Active Probes: placement pending");
+        else
+            widget.text(fmt::format(
+                "Active Probes: {} ({} moved, {:.1f}% culled)", mActiveProbeCount, mPlacement.movedCount, mPlacement.getCulledFraction() * 100.f
+            ));
+    }
     widget.separator();
 
     dirtyAtlases |= widget.var("TileRes Trace", mOpt.tileResTrace, 4u, 64u);
@@ -646,6 +856,7 @@ void DDGIPass::renderUI(Gui::Widgets& widget)
     {
         mDirty |= DDGIDirtyFlags::Probes;
         mOptionsChanged = true;
+        mProbeEditTime = CpuTimer::getCurrentTimePoint();
     }
     if (dirtyAtlases)
     {
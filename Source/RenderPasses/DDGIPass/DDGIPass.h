@@ -8,6 +8,9 @@
 #include "Core/Program/Program.h"
 #include "Core/Program/ProgramVars.h"
 #include "Scene/TriangleMesh.h"
+#include "Rendering/Utils/ProbePlacement.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <optional>
 
 using namespace Falcor;
 
@@ -48,6 +51,7 @@ private:
         float3 origin = float3(0.f);
         float3 spacing = float3(1.f);
         uint3 probeCounts = uint3(8, 8, 8);
+        bool optimizeProbePlacement = false; // offset probes out of geometry and cull unused ones on the CPU
 
         // Trace/Radiance/Irradiance
         uint32_t tileResTrace = 16;     // per-probe tile resolution for trace outputs
@@ -101,6 +105,8 @@ private:
     void prepareTraceProgram();
     void prepareVizResources();
     void prepareBlendResources(const RenderData& rd);
+    void collectSceneTriangles();
+    void updateProbePlacement();
 
     // Helpers
     uint32_t getProbeCount() const { return mOpt.probeCounts.x * mOpt.probeCounts.y * mOpt.probeCounts.z; }
@@ -141,8 +147,20 @@ private:
     ref<Texture> mpVizFboColor;
     ref<Texture> mpVizFboDepth;
 
+    // Probe placement
+    ProbePlacement::Options mPlacementOptions;
+    ProbePlacement::Result mPlacement;
+    std::vector<float3> mScenePositions; // world-space triangle soup of the scene
+    std::vector<uint32_t> mSceneIndices;
+    bool mSceneTrianglesValid = false;
+    uint32_t mActiveProbeCount = 0;
+    std::optional<CpuTimer::TimePoint> mProbeEditTime; // last probe edit in the UI, placement waits until edits settle
+    bool mPlacementPending = false;                     // regular grid is used until the deferred placement runs
+
     // GPU Resources
     ref<Buffer> mpProbePositions;
+    ref<Buffer> mpActiveProbes; // uint per active probe: probe index
+    ref<Buffer> mpProbeStates;  // uint per probe: ProbePlacement::ProbeState
 
     // Trace outputs (probe-space "GBuffer" atlases)
     ref<Texture> mpHitPosAtlas;    // RGBA32Float: xyz=wsPos
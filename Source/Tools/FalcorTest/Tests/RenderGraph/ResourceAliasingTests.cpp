@@ -0,0 +1,171 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/ResourceAliasing.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+using Request = ResourceAliasingPlanner::Request;
+
+Request makeRequest(uint32_t firstUse, uint32_t lastUse, uint64_t size, uint64_t key = 0, bool canAlias = true)
+{
+    Request r;
+    r.firstUse = firstUse;
+    r.lastUse = lastUse;
+    r.size = size;
+    r.key = key;
+    r.canAlias = canAlias;
+    return r;
+}
+
+bool overlaps(const Request& a, const Request& b)
+{
+    return a.firstUse <= b.lastUse && b.firstUse <= a.lastUse;
+}
+} // namespace
+
+CPU_TEST(ResourceAliasing_Chain)
+{
+    // Each pass reads the output of the previous pass, so only two resources are alive at any time.
+    std::vector<Request> requests;
+    for (uint32_t i = 0; i < 8; i++)
+        requests.push_back(makeRequest(i, i + 1, 100));
+
+    auto plan = ResourceAliasingPlanner::plan(requests);
+    ASSERT_EQ(plan.slots.size(), requests.size());
+    EXPECT_EQ(plan.getSlotCount(), 2);
+    for (uint32_t i = 0; i < 8; i++)
+        EXPECT_EQ(plan.slots[i], i % 2);
+    EXPECT_EQ(plan.requestedSize, 800);
+    EXPECT_EQ(plan.allocatedSize, 200);
+    EXPECT_EQ(plan.getSavedSize(), 600);
+}
+
+CPU_TEST(ResourceAliasing_Constraints)
+{
+    std::vector<Request> requests = {
+        makeRequest(0, 0, 10, 0),
+        makeRequest(1, 1, 10, 1),            // Different key, can't reuse slot 0.
+        makeRequest(2, 2, 10, 0),            // Reuses slot 0.
+        makeRequest(3, 3, 10, 0, false),     // Not aliasable, gets its own slot.
+        makeRequest(4, uint32_t(-1), 10, 0), // Reuses slot 0 until the end.
+        makeRequest(5, 5, 10, 0),            // Slot 0 is still in use, so a new slot is needed.
+    };
+
+    auto plan = ResourceAliasingPlanner::plan(requests);
+    EXPECT_EQ(plan.slots[0], 0);
+    EXPECT_EQ(plan.slots[1], 1);
+    EXPECT_EQ(plan.slots[2], 0);
+    EXPECT_EQ(plan.slots[3], 2);
+    EXPECT_EQ(plan.slots[4], 0);
+    EXPECT_EQ(plan.slots[5], 3);
+    EXPECT_EQ(plan.getSlotCount(), 4);
+    EXPECT_EQ(plan.allocatedSize, 40);
+}
+
+CPU_TEST(ResourceAliasing_Empty)
+{
+    auto plan = ResourceAliasingPlanner::plan({});
+    EXPECT(plan.slots.empty());
+    EXPECT_EQ(plan.getSlotCount(), 0);
+    EXPECT_EQ(plan.getSavedSize(), 0);
+}
+
+CPU_TEST(ResourceAliasing_Random)
+{
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint32_t> timeDist(0, 63);
+    std::uniform_int_distribution<uint32_t> lengthDist(0, 8);
+    std::uniform_int_distribution<uint32_t> keyDist(0, 3);
+
+    std::vector<Request> requests;
+    for (uint32_t i = 0; i < 500; i++)
+    {
+        uint32_t first = timeDist(rng);
+        uint32_t key = keyDist(rng);
+        requests.push_back(makeRequest(first, first + lengthDist(rng), 16 * (key + 1), key, (i % 10) != 0));
+    }
+
+    auto plan = ResourceAliasingPlanner::plan(requests);
+    ASSERT_EQ(plan.slots.size(), requests.size());
+
+    // Requests sharing a slot must have the same key and disjoint lifetimes.
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        for (size_t j = i + 1; j < requests.size(); j++)
+        {
+            if (plan.slots[i] != plan.slots[j])
+                continue;
+            EXPECT(requests[i].canAlias && requests[j].canAlias);
+            EXPECT_EQ(requests[i].key, requests[j].key);
+            EXPECT(!overlaps(requests[i], requests[j]));
+        }
+    }
+
+    // The number of aliased slots per key must equal the maximum number of overlapping lifetimes.
+    std::map<uint64_t, uint32_t> maxOverlap;
+    for (uint32_t t = 0; t < 64 + 8; t++)
+    {
+        std::map<uint64_t, uint32_t> alive;
+        for (const auto& r : requests)
+            if (r.canAlias && r.firstUse <= t && t <= r.lastUse)
+                alive[r.key]++;
+        for (const auto& [key, count] : alive)
+            maxOverlap[key] = std::max(maxOverlap[key], count);
+    }
+
+    std::map<uint64_t, std::vector<uint32_t>> slotsPerKey;
+    uint32_t exclusiveCount = 0;
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        if (requests[i].canAlias)
+            slotsPerKey[requests[i].key].push_back(plan.slots[i]);
+        else
+            exclusiveCount++;
+    }
+    uint32_t aliasedSlotCount = 0;
+    for (auto& [key, slots] : slotsPerKey)
+    {
+        std::sort(slots.begin(), slots.end());
+        uint32_t count = (uint32_t)(std::unique(slots.begin(), slots.end()) - slots.begin());
+        EXPECT_EQ(count, maxOverlap[key]);
+        aliasedSlotCount += count;
+    }
+    EXPECT_EQ(plan.getSlotCount(), aliasedSlotCount + exclusiveCount);
+
+    // The plan must be deterministic.
+    auto plan2 = ResourceAliasingPlanner::plan(requests);
+    EXPECT(plan.slots == plan2.slots);
+}
+} // namespace Falcor
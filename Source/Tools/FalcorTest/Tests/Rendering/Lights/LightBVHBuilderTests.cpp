@@ -0,0 +1,111 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Creates small random emissive triangles. Some triangles are clustered to create uneven splits.
+std::vector<LightCollection::MeshLightTriangle> createTriangles(uint32_t count)
+{
+    std::mt19937 rng(count);
+    std::uniform_real_distribution<float> u;
+    auto randomPoint = [&]() { return float3(u(rng), u(rng), u(rng)); };
+
+    std::vector<LightCollection::MeshLightTriangle> triangles(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto& tri = triangles[i];
+        float3 center = (i % 4 == 0) ? randomPoint() * 0.01f : randomPoint() * 100.f;
+        for (uint32_t j = 0; j < 3; ++j) tri.vtx[j].pos = center + randomPoint() * 0.1f;
+        float3 n = cross(tri.vtx[1].pos - tri.vtx[0].pos, tri.vtx[2].pos - tri.vtx[0].pos);
+        tri.normal = length(n) > 0.f ? normalize(n) : float3(0.f, 0.f, 1.f);
+        tri.flux = u(rng);
+    }
+    return triangles;
+}
+
+LightBVHBuilder::BuildResult build(const std::vector<LightCollection::MeshLightTriangle>& triangles, LightBVHBuilder::SplitHeuristic heuristic, bool parallel)
+{
+    LightBVHBuilder::Options options;
+    options.splitHeuristicSelection = heuristic;
+    options.useParallelBuild = parallel;
+    return LightBVHBuilder(options).buildHierarchy(triangles);
+}
+} // namespace
+
+CPU_TEST(LightBVHBuilder_ParallelBuild)
+{
+    // Large enough for nodes to be built as separate tasks and to be binned in multiple chunks.
+    auto triangles = createTriangles(300000);
+
+    for (auto heuristic : {LightBVHBuilder::SplitHeuristic::Equal, LightBVHBuilder::SplitHeuristic::BinnedSAH, LightBVHBuilder::SplitHeuristic::BinnedSAOH})
+    {
+        auto serial = build(triangles, heuristic, false);
+        auto parallel = build(triangles, heuristic, true);
+
+        ASSERT(!serial.nodes.empty());
+        ASSERT_EQ(serial.nodes.size(), parallel.nodes.size());
+        EXPECT(std::memcmp(serial.nodes.data(), parallel.nodes.data(), serial.nodes.size() * sizeof(PackedNode)) == 0) << enumToString(heuristic);
+        EXPECT(serial.triangleIndices == parallel.triangleIndices) << enumToString(heuristic);
+        EXPECT(serial.triangleBitmasks == parallel.triangleBitmasks) << enumToString(heuristic);
+    }
+}
+
+CPU_TEST(LightBVHBuilder_Benchmark, TAGS("benchmark"))
+{
+    for (uint32_t triangleCount : {10000u, 100000u, 1000000u, 10000000u})
+    {
+        auto triangles = createTriangles(triangleCount);
+
+        for (auto heuristic : {LightBVHBuilder::SplitHeuristic::BinnedSAH, LightBVHBuilder::SplitHeuristic::BinnedSAOH})
+        {
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            auto serial = build(triangles, heuristic, false);
+            auto t1 = CpuTimer::getCurrentTimePoint();
+            auto parallel = build(triangles, heuristic, true);
+            auto t2 = CpuTimer::getCurrentTimePoint();
+
+            EXPECT_EQ(serial.nodes.size(), parallel.nodes.size());
+            logInfo(
+                "LightBVHBuilder {} with {} triangles: serial {:.1f} ms, parallel {:.1f} ms.",
+                enumToString(heuristic),
+                triangleCount,
+                CpuTimer::calcDuration(t0, t1),
+                CpuTimer::calcDuration(t1, t2)
+            );
+        }
+    }
+}
+} // namespace Falcor
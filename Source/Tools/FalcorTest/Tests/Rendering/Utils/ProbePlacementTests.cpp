@@ -0,0 +1,231 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Utils/ProbePlacement.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+struct Mesh
+{
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+
+    /// Add a parallelogram spanned by u and v. The front side faces along cross(u, v).
+    void addQuad(float3 o, float3 u, float3 v)
+    {
+        uint32_t base = (uint32_t)positions.size();
+        positions.insert(positions.end(), {o, o + u, o + u + v, o + v});
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+
+    /// Add an axis-aligned box with faces pointing outwards, or inwards if inward is set.
+    void addBox(float3 lo, float3 hi, bool inward)
+    {
+        const float3 d = hi - lo;
+        const float3 x(d.x, 0.f, 0.f), y(0.f, d.y, 0.f), z(0.f, 0.f, d.z);
+        auto face = [&](float3 o, float3 u, float3 v) { inward ? addQuad(o, v, u) : addQuad(o, u, v); };
+        face(lo, z, y);
+        face(float3(hi.x, lo.y, lo.z), y, z);
+        face(lo, x, z);
+        face(float3(lo.x, hi.y, lo.z), z, x);
+        face(lo, y, x);
+        face(float3(lo.x, lo.y, hi.z), x, y);
+    }
+};
+
+ProbePlacement::Grid createGrid(uint3 probeCounts)
+{
+    ProbePlacement::Grid grid;
+    grid.origin = float3(0.f);
+    grid.spacing = float3(1.f);
+    grid.probeCounts = probeCounts;
+    return grid;
+}
+} // namespace
+
+CPU_TEST(ProbePlacement_Empty)
+{
+    const auto grid = createGrid(uint3(4));
+    ProbePlacement::Options options;
+
+    auto result = ProbePlacement::compute(grid, {}, {}, options);
+    EXPECT_EQ(result.getProbeCount(), 64);
+    EXPECT_EQ(result.getActiveCount(), 0);
+    EXPECT_EQ(result.farCount, 64);
+    EXPECT_EQ(result.getCulledFraction(), 1.f);
+
+    // Without culling everything stays in place.
+    options.cullFar = false;
+    result = ProbePlacement::compute(grid, {}, {}, options);
+    EXPECT_EQ(result.getActiveCount(), 64);
+    EXPECT_EQ(result.movedCount, 0);
+    EXPECT_EQ(result.getCulledFraction(), 0.f);
+}
+
+CPU_TEST(ProbePlacement_Floor)
+{
+    // Floor just above the bottom of the grid. Only the lowest probe layer interpolates from cells containing geometry.
+    const auto grid = createGrid(uint3(4));
+    Mesh mesh;
+    mesh.addQuad(float3(-1.f, 0.1f, -1.f), float3(0.f, 0.f, 6.f), float3(6.f, 0.f, 0.f));
+
+    const auto result = ProbePlacement::compute(grid, mesh.positions, mesh.indices, {});
+    EXPECT_EQ(result.getActiveCount(), 16);
+    EXPECT_EQ(result.farCount, 48);
+    EXPECT_EQ(result.insideCount, 0);
+    EXPECT_EQ(result.movedCount, 0);
+    EXPECT_EQ(result.getCulledFraction(), 0.75f);
+
+    for (uint32_t i = 0; i < result.getActiveCount(); ++i)
+    {
+        uint32_t index = result.activeProbes[i];
+        EXPECT_EQ(index, ProbePlacement::getProbeIndex(grid, uint3(i % 4, 0, i / 4)));
+        EXPECT(result.states[index] == ProbePlacement::ProbeState::Active);
+    }
+}
+
+CPU_TEST(ProbePlacement_PushOut)
+{
+    // Ground plane through the centers of the second probe layer. The probes are pushed up,
+    // as the space below the ground is only bounded by back faces.
+    const auto grid = createGrid(uint3(4));
+    Mesh mesh;
+    mesh.addQuad(float3(-1.f, 1.5f, -1.f), float3(0.f, 0.f, 6.f), float3(6.f, 0.f, 0.f));
+
+    ProbePlacement::Options options;
+    const auto result = ProbePlacement::compute(grid, mesh.positions, mesh.indices, options);
+
+    for (uint32_t z = 0; z < 4; ++z)
+    {
+        for (uint32_t x = 0; x < 4; ++x)
+        {
+            const auto& states = result.states;
+            EXPECT(states[ProbePlacement::getProbeIndex(grid, uint3(x, 0, z))] == ProbePlacement::ProbeState::Inside);
+            EXPECT(states[ProbePlacement::getProbeIndex(grid, uint3(x, 2, z))] == ProbePlacement::ProbeState::Active);
+            EXPECT(states[ProbePlacement::getProbeIndex(grid, uint3(x, 3, z))] == ProbePlacement::ProbeState::Far);
+
+            const uint32_t index = ProbePlacement::getProbeIndex(grid, uint3(x, 1, z));
+            ASSERT(states[index] == ProbePlacement::ProbeState::Active);
+            const float3 position = ProbePlacement::getGridPosition(grid, uint3(x, 1, z)) + result.offsets[index];
+            EXPECT_GE(position.y - 1.5f, options.minClearance);
+            EXPECT_LE(result.offsets[index].y, options.maxOffset);
+        }
+    }
+    EXPECT_EQ(result.movedCount, 16);
+    EXPECT_EQ(result.insideCount, 16);
+    EXPECT_EQ(result.farCount, 16);
+    EXPECT_EQ(result.getCulledFraction(), 0.5f);
+}
+
+CPU_TEST(ProbePlacement_Enclosed)
+{
+    // Closed box around the 8 center probes. With outward facing sides these are inside the box.
+    const auto grid = createGrid(uint3(4));
+    Mesh box;
+    box.addBox(float3(0.9f), float3(3.1f), false);
+
+    auto result = ProbePlacement::compute(grid, box.positions, box.indices, {});
+    EXPECT_EQ(result.insideCount, 8);
+    EXPECT_EQ(result.farCount, 0);
+    EXPECT_EQ(result.getActiveCount(), 56);
+    EXPECT_EQ(result.movedCount, 0);
+    for (uint32_t i = 0; i < result.getProbeCount(); ++i)
+    {
+        const uint3 p(i % 4, (i / 4) % 4, i / 16);
+        const bool center = all(p >= uint3(1)) && all(p <= uint3(2));
+        EXPECT(result.states[i] == (center ? ProbePlacement::ProbeState::Inside : ProbePlacement::ProbeState::Active)) << "probe " << i;
+    }
+
+    // With inward facing sides the box is a room and the outside is culled instead.
+    Mesh room;
+    room.addBox(float3(0.9f), float3(3.1f), true);
+    result = ProbePlacement::compute(grid, room.positions, room.indices, {});
+    EXPECT_EQ(result.insideCount, 56);
+    EXPECT_EQ(result.getActiveCount(), 8);
+
+    // Nothing is culled if culling is disabled.
+    ProbePlacement::Options options;
+    options.cullInside = false;
+    result = ProbePlacement::compute(grid, room.positions, room.indices, options);
+    EXPECT_EQ(result.getActiveCount(), 64);
+}
+
+CPU_TEST(ProbePlacement_Deterministic)
+{
+    ProbePlacement::Grid grid;
+    grid.origin = float3(-2.f, 0.f, 1.f);
+    grid.spacing = float3(0.5f, 0.25f, 1.f);
+    grid.probeCounts = uint3(12, 7, 5);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    Mesh mesh;
+    for (uint32_t i = 0; i < 500; ++i)
+    {
+        const float3 o = grid.origin + float3(u(rng), u(rng), u(rng)) * float3(grid.probeCounts) * grid.spacing;
+        mesh.addQuad(o, float3(u(rng), u(rng), u(rng)) - 0.5f, float3(u(rng), u(rng), u(rng)) - 0.5f);
+    }
+
+    ProbePlacement::Options options;
+    options.voxelsPerProbe = 6;
+    const auto a = ProbePlacement::compute(grid, mesh.positions, mesh.indices, options);
+    const auto b = ProbePlacement::compute(grid, mesh.positions, mesh.indices, options);
+
+    EXPECT_EQ(a.voxelsPerProbe, 6);
+    ASSERT_EQ(a.getProbeCount(), grid.probeCounts.x * grid.probeCounts.y * grid.probeCounts.z);
+    EXPECT(a.activeProbes == b.activeProbes);
+    EXPECT(a.states == b.states);
+    EXPECT_EQ(a.movedCount, b.movedCount);
+
+    uint32_t activeCount = 0;
+    for (uint32_t i = 0; i < a.getProbeCount(); ++i)
+    {
+        EXPECT(all(a.offsets[i] == b.offsets[i])) << "probe " << i;
+        EXPECT(all(abs(a.offsets[i]) <= options.maxOffset * grid.spacing)) << "probe " << i;
+        if (a.states[i] == ProbePlacement::ProbeState::Active)
+        {
+            ASSERT_LT(activeCount, a.getActiveCount());
+            EXPECT_EQ(a.activeProbes[activeCount], i);
+            ++activeCount;
+        }
+        else
+        {
+            EXPECT(all(a.offsets[i] == float3(0.f))) << "probe " << i;
+        }
+    }
+    EXPECT_EQ(activeCount, a.getActiveCount());
+    EXPECT_EQ(a.insideCount + a.farCount + activeCount, a.getProbeCount());
+
+    // Lowering the resolution budget reduces the voxel resolution.
+    options.maxVoxelCount = a.getProbeCount() * 27;
+    EXPECT_EQ(ProbePlacement::compute(grid, mesh.positions, mesh.indices, options).voxelsPerProbe, 3);
+}
+} // namespace Falcor
@@ -0,0 +1,262 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Sampling/AliasTableBuilder.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <hypothesis/hypothesis.h>
+
+#include <cstring>
+#include <iostream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<float> createWeights(uint32_t N, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> uniform;
+    std::vector<float> weights(N);
+    for (auto& w : weights)
+        w = uniform(rng);
+
+    // Add a few zero weights and a few large outliers.
+    for (uint32_t i = 0; i < N / 100; ++i)
+        weights[rng() % N] = 0.f;
+    for (uint32_t i = 0; i < N / 1000; ++i)
+        weights[rng() % N] = 1000.f * uniform(rng);
+    return weights;
+}
+
+/// Returns the largest error of the sampling probabilities stored in the table, relative to the expected probability
+/// or the uniform probability, whichever is larger. Large weights are split over many buckets, each adding the rounding
+/// error of its threshold.
+double computeMaxError(const AliasTableBuilder& builder)
+{
+    const uint32_t N = builder.getCount();
+    const auto& items = builder.getItems();
+    std::vector<double> probabilities(N, 0.0);
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        probabilities[items[i].indexB] += items[i].threshold;
+        probabilities[items[i].indexA] += 1.0 - items[i].threshold;
+    }
+    double maxError = 0.0;
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        double expected = N * builder.getWeights()[i] / builder.getWeightSum();
+        maxError = std::max(maxError, std::abs(probabilities[i] - expected) / std::max(expected, 1.0));
+    }
+    return maxError;
+}
+
+bool isSameTable(const AliasTableBuilder& a, const AliasTableBuilder& b)
+{
+    return a.getCount() == b.getCount() && a.getWeightSum() == b.getWeightSum() &&
+           std::memcmp(a.getItems().data(), b.getItems().data(), a.getCount() * sizeof(AliasTableBuilder::Item)) == 0;
+}
+
+/// Serial alias table construction by Vose's method, used as the baseline in the benchmark.
+std::vector<AliasTableBuilder::Item> buildVose(std::vector<float> weights)
+{
+    const uint32_t N = (uint32_t)weights.size();
+    double weightSum = 0.0;
+    for (float w : weights)
+        weightSum += w;
+    const float avgWeight = float(weightSum / N);
+
+    std::vector<uint32_t> lowIdx(N, 0xFFFFFFFFu);
+    std::vector<uint32_t> highIdx(N, 0xFFFFFFFFu);
+    uint32_t lowCount = 0;
+    uint32_t highCount = 0;
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        if (weights[i] < avgWeight)
+            lowIdx[lowCount++] = i;
+        else
+            highIdx[highCount++] = i;
+    }
+
+    std::vector<AliasTableBuilder::Item> items(N);
+    for (uint32_t i = 0; i < N; ++i)
+    {
+        if (lowIdx[i] != 0xFFFFFFFFu && highIdx[i] != 0xFFFFFFFFu)
+        {
+            items[i] = {weights[lowIdx[i]] / avgWeight, highIdx[i], lowIdx[i], 0};
+            float updatedWeight = (weights[lowIdx[i]] + weights[highIdx[i]]) - avgWeight;
+            weights[highIdx[i]] = updatedWeight;
+            if (updatedWeight < avgWeight)
+                lowIdx[lowCount++] = highIdx[i];
+            else
+                highIdx[highCount++] = highIdx[i];
+        }
+        else
+        {
+            uint32_t index = highIdx[i] != 0xFFFFFFFFu ? highIdx[i] : lowIdx[i];
+            items[i] = {1.f, index, index, 0};
+        }
+    }
+    return items;
+}
+} // namespace
+
+CPU_TEST(AliasTableBuilder_Probabilities)
+{
+    std::mt19937 rng;
+    for (uint32_t N : {1u, 2u, 3u, 1000u, 16384u, 100000u, 1000000u})
+    {
+        AliasTableBuilder builder(createWeights(N, rng));
+        EXPECT_EQ(builder.getCount(), N);
+        EXPECT(!builder.isDirty());
+
+        const auto& items = builder.getItems();
+        for (uint32_t i = 0; i < N; ++i)
+        {
+            ASSERT_EQ(items[i].indexB, i);
+            ASSERT(items[i].indexA < N);
+            ASSERT(items[i].threshold >= 0.f && items[i].threshold <= 1.f);
+        }
+        EXPECT_LE(computeMaxError(builder), 1e-5) << "N = " << N;
+    }
+
+    // Equal weights and zero weights both give a uniform distribution.
+    for (float w : {0.f, 0.5f})
+    {
+        AliasTableBuilder builder(std::vector<float>(50000, w));
+        for (const auto& item : builder.getItems())
+            EXPECT_EQ(item.threshold, 1.f);
+    }
+
+    // A few non-zero weights spread over several chunks.
+    std::vector<float> weights(50000, 0.f);
+    weights[123] = 1.f;
+    weights[40000] = 3.f;
+    AliasTableBuilder builder(weights);
+    EXPECT_LE(computeMaxError(builder), 1e-5);
+}
+
+CPU_TEST(AliasTableBuilder_Sampling)
+{
+    const uint32_t N = 1000;
+    const uint32_t samplesPerWeight = 1000;
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    AliasTableBuilder builder(createWeights(N, rng));
+
+    std::vector<double> obsFrequencies(N, 0.0);
+    for (uint32_t i = 0; i < N * samplesPerWeight; ++i)
+    {
+        uint32_t index = std::min(N - 1, uint32_t(uniform(rng) * N));
+        obsFrequencies[builder.sample(index, uniform(rng))] += 1.0;
+    }
+
+    std::vector<double> expFrequencies(N);
+    for (uint32_t i = 0; i < N; ++i)
+        expFrequencies[i] = builder.getWeights()[i] / builder.getWeightSum() * N * samplesPerWeight;
+
+    const auto& [success, report] =
+        hypothesis::chi2_test(N, obsFrequencies.data(), expFrequencies.data(), N * samplesPerWeight, 5, 0.1);
+    if (!success)
+        std::cout << report << std::endl;
+    EXPECT(success);
+}
+
+CPU_TEST(AliasTableBuilder_Update)
+{
+    const uint32_t N = 200000;
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    AliasTableBuilder builder(createWeights(N, rng));
+
+    // Updates give the same table as building from scratch.
+    for (uint32_t i = 0; i < 100; ++i)
+        builder.setWeight(rng() % N, uniform(rng));
+    EXPECT(builder.isDirty());
+    builder.build();
+    EXPECT(!builder.isDirty());
+    EXPECT(isSameTable(builder, AliasTableBuilder(builder.getWeights())));
+    EXPECT_LE(computeMaxError(builder), 1e-5);
+
+    // Swapping two weights keeps the average, so only the modified chunk is partitioned again.
+    std::vector<float> weights = builder.getWeights();
+    builder.setWeight(10, weights[20]);
+    builder.setWeight(20, weights[10]);
+    builder.build();
+    EXPECT_EQ(builder.getPartitionedChunkCount(), 1u);
+    EXPECT(isSameTable(builder, AliasTableBuilder(builder.getWeights())));
+
+    // Setting a weight to its current value doesn't trigger a rebuild.
+    builder.setWeight(30, builder.getWeights()[30]);
+    EXPECT(!builder.isDirty());
+
+    // Changing the number of weights.
+    builder.setWeights(createWeights(N / 2, rng));
+    builder.build();
+    EXPECT_EQ(builder.getCount(), N / 2);
+    EXPECT(isSameTable(builder, AliasTableBuilder(builder.getWeights())));
+}
+
+CPU_TEST(AliasTableBuilder_Benchmark, TAGS("benchmark"))
+{
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform;
+    for (uint32_t N : {1u << 20, 1u << 22, 1u << 24, 1u << 25})
+    {
+        std::vector<float> weights = createWeights(N, rng);
+
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        buildVose(weights);
+        double voseTime = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+
+        AliasTableBuilder builder;
+        builder.setWeights(weights);
+        t0 = CpuTimer::getCurrentTimePoint();
+        builder.build();
+        double buildTime = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+
+        // Rebuild after changing a small contiguous range of weights, like a few emissive meshes changing intensity.
+        for (uint32_t i = 0; i < 1000; ++i)
+            builder.setWeight(i, uniform(rng));
+        t0 = CpuTimer::getCurrentTimePoint();
+        builder.build();
+        double updateTime = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+
+        logInfo(
+            "AliasTableBuilder N = {}: Vose {:.1f} ms, build {:.1f} ms ({:.1f} M/s), update {:.1f} ms ({} chunks partitioned)",
+            N,
+            voseTime,
+            buildTime,
+            N / (buildTime * 1e3),
+            updateTime,
+            builder.getPartitionedChunkCount()
+        );
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,147 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Animation/AnimationController.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+namespace
+{
+const char kShaderFile[] = "Tests/Scene/AnimationControllerTests.cs.slang";
+
+const SceneBuilder::Flags kFlags = SceneBuilder::Flags::DontMergeMeshes | SceneBuilder::Flags::DontOptimizeGraph;
+
+// Enough leaves in one level to take the parallel update path.
+const uint32_t kLeafCount = 2000;
+
+ref<Animation> createAnimation(const std::string& name, NodeID nodeID, float3 translation)
+{
+    ref<Animation> pAnimation = Animation::create(name, nodeID, 1.0);
+    Animation::Keyframe k0;
+    k0.time = 0.0;
+    Animation::Keyframe k1;
+    k1.time = 1.0;
+    k1.translation = translation;
+    k1.rotation = normalize(quatf(0.1f, 0.2f, 0.3f, 1.f));
+    pAnimation->addKeyframe(k0);
+    pAnimation->addKeyframe(k1);
+    return pAnimation;
+}
+
+bool almostEqual(const float4x4& a, const float4x4& b, float epsilon = 1e-4f)
+{
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c)
+            if (std::abs(a[r][c] - b[r][c]) > epsilon * std::max(1.f, std::abs(b[r][c])))
+                return false;
+    return true;
+}
+} // namespace
+
+GPU_TEST(AnimationController_WorldMatrices)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    SceneBuilder builder(pDevice, Settings(), kFlags);
+    auto pMaterial = StandardMaterial::create(pDevice, "A");
+    MeshID meshID = builder.addTriangleMesh(TriangleMesh::createQuad(), pMaterial);
+
+    // Build a hierarchy with an animated chain, a wide level of leaves below it and a separate static subtree.
+    std::vector<uint32_t> parents;
+    auto addNode = [&](NodeID parent, float3 translation)
+    {
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{fmt::format("Node{}", parents.size()), math::matrixFromTranslation(translation), float4x4::identity(), float4x4::identity(), parent});
+        parents.push_back(parent == NodeID::Invalid() ? uint32_t(-1) : parent.get());
+        builder.addMeshInstance(nodeID, meshID);
+        return nodeID;
+    };
+
+    NodeID root = addNode(NodeID::Invalid(), float3(1.f, 0.f, 0.f));
+    NodeID chain = root;
+    std::vector<NodeID> chainNodes;
+    for (uint32_t i = 0; i < 6; ++i)
+        chainNodes.push_back(chain = addNode(chain, float3(0.f, 1.f, 0.f)));
+    for (uint32_t i = 0; i < kLeafCount; ++i)
+        addNode(chainNodes[2], float3(float(i), 0.f, 0.f));
+    NodeID staticRoot = addNode(NodeID::Invalid(), float3(0.f, 0.f, 5.f));
+    NodeID editedNode = addNode(staticRoot, float3(0.f, 0.f, 1.f));
+    addNode(editedNode, float3(0.f, 0.f, 1.f));
+
+    builder.addAnimation(createAnimation("root", root, float3(1.f, 2.f, 3.f)));
+    builder.addAnimation(createAnimation("chain", chainNodes[1], float3(0.f, 0.f, 4.f)));
+
+    ref<Scene> pScene = builder.getScene();
+    ASSERT(pScene != nullptr);
+    const AnimationController* pController = pScene->getAnimationController();
+    const uint32_t matrixCount = (uint32_t)parents.size();
+    ASSERT_EQ(pController->getGlobalMatrices().size(), matrixCount);
+
+    ProgramDesc desc;
+    desc.addShaderModules(pScene->getShaderModules());
+    desc.addShaderLibrary(kShaderFile);
+    desc.addTypeConformances(pScene->getTypeConformances());
+    desc.csEntry("readWorldMatrices");
+    ctx.createProgram(desc, pScene->getSceneDefines());
+    ctx.allocateStructuredBuffer("worldMatrices", matrixCount);
+    ctx.allocateStructuredBuffer("prevWorldMatrices", matrixCount);
+
+    // Animations change every frame, and one static node is edited once. The matrices uploaded after the edit
+    // have to include the edited subtree in both the current and the previous buffer.
+    std::vector<float4x4> prevGlobalMatrices;
+    for (uint32_t frame = 0; frame < 6; ++frame)
+    {
+        if (frame == 2)
+            pScene->updateNodeTransform(editedNode.get(), math::matrixFromTranslation(float3(0.f, 3.f, 1.f)));
+        pScene->update(ctx.getRenderContext(), 0.1 * frame);
+
+        // Each world matrix is the parent's world matrix times the local matrix, regardless of the level bucketing.
+        const auto& localMatrices = pController->getLocalMatrices();
+        const auto& globalMatrices = pController->getGlobalMatrices();
+        for (uint32_t i = 0; i < matrixCount; ++i)
+        {
+            float4x4 expected = parents[i] == uint32_t(-1) ? localMatrices[i] : mul(globalMatrices[parents[i]], localMatrices[i]);
+            EXPECT(almostEqual(globalMatrices[i], expected)) << "node " << i << ", frame " << frame;
+        }
+
+        // The GPU buffers have to match the CPU matrices of this and the previous frame.
+        pScene->bindShaderData(ctx["gScene"]);
+        ctx["CB"]["gMatrixCount"] = matrixCount;
+        ctx.runProgram(matrixCount, 1, 1);
+        std::vector<float4x4> worldMatrices = ctx.readBuffer<float4x4>("worldMatrices");
+        std::vector<float4x4> prevWorldMatrices = ctx.readBuffer<float4x4>("prevWorldMatrices");
+        for (uint32_t i = 0; i < matrixCount; ++i)
+        {
+            EXPECT(almostEqual(worldMatrices[i], globalMatrices[i])) << "node " << i << ", frame " << frame;
+            if (frame > 0)
+                EXPECT(almostEqual(prevWorldMatrices[i], prevGlobalMatrices[i])) << "node " << i << ", frame " << frame;
+        }
+        prevGlobalMatrices = globalMatrices;
+    }
+}
+} // namespace Falcor
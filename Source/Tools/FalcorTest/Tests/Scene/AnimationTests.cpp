@@ -0,0 +1,206 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Creates an animation with irregularly spaced keyframes where the translation x equals the keyframe time.
+/// Linear interpolation then yields a translation x equal to the sample time.
+ref<Animation> createAnimation(uint32_t nodeID, uint32_t keyframeCount, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.5, 1.5);
+
+    std::vector<Animation::Keyframe> keyframes(keyframeCount);
+    double time = 0.0;
+    for (auto& k : keyframes)
+    {
+        k.time = time;
+        k.translation = float3((float)time, 1.f, 2.f);
+        k.rotation = normalize(quatf(0.1f, 0.2f, 0.3f, 1.f + (float)time));
+        k.scaling = float3(1.f, 2.f, 3.f);
+        time += u(rng) * 0.01;
+    }
+
+    ref<Animation> pAnimation = Animation::create("anim", NodeID{nodeID}, keyframes.back().time);
+    for (const auto& k : keyframes)
+        pAnimation->addKeyframe(k);
+    return pAnimation;
+}
+
+bool almostEqual(const float4x4& a, const float4x4& b, float epsilon = 1e-5f)
+{
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c)
+            if (std::abs(a[r][c] - b[r][c]) > epsilon * std::max(1.f, std::abs(b[r][c])))
+                return false;
+    return true;
+}
+
+/// Baseline sampler using the forward linear keyframe scan that Animation used before the cached galloping search.
+/// The scan restarts at the first keyframe whenever the time moves backwards. Only linear interpolation is supported.
+struct LinearScanSampler
+{
+    const Animation* pAnimation;
+    size_t cachedFrameIndex = 0;
+
+    float4x4 animate(double time)
+    {
+        auto keyframes = pAnimation->getKeyframes();
+        size_t frameIndex = std::min(cachedFrameIndex, keyframes.size() - 1);
+        if (time < keyframes[frameIndex].time)
+            frameIndex = 0;
+        while (frameIndex + 1 < keyframes.size() && keyframes[frameIndex + 1].time <= time)
+            frameIndex++;
+        cachedFrameIndex = frameIndex;
+
+        const auto& k0 = keyframes[frameIndex];
+        const auto& k1 = keyframes[std::min(frameIndex + 1, keyframes.size() - 1)];
+        double segmentDuration = k1.time - k0.time;
+        float t = (float)std::clamp(segmentDuration > 0.0 ? (time - k0.time) / segmentDuration : 1.0, 0.0, 1.0);
+        return math::matrixFromTRS(
+            lerp(k0.translation, k1.translation, t), slerp(k0.rotation, k1.rotation, t), lerp(k0.scaling, k1.scaling, t)
+        );
+    }
+};
+} // namespace
+
+CPU_TEST(Animation_KeyframeLookup)
+{
+    ref<Animation> pAnimation = createAnimation(0, 1000, 1);
+    double duration = pAnimation->getKeyframes().back().time;
+
+    auto check = [&](double time)
+    {
+        float4x4 m = pAnimation->animate(time);
+        EXPECT_LE(std::abs(m[0][3] - (float)time), 1e-4f) << "time = " << time;
+    };
+
+    // Forward, backward and random access.
+    for (uint32_t i = 0; i <= 10000; i++)
+        check(duration * i / 10000);
+    for (uint32_t i = 10000; i-- > 0;)
+        check(duration * i / 10000);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> u(0.0, duration);
+    for (uint32_t i = 0; i < 10000; i++)
+        check(u(rng));
+
+    // Exact keyframe times.
+    for (const auto& k : pAnimation->getKeyframes())
+        check(k.time);
+}
+
+CPU_TEST(Animation_AnimateMany)
+{
+    std::vector<ref<Animation>> animations;
+    std::vector<ref<Animation>> references;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        animations.push_back(createAnimation(i, 100, i));
+        references.push_back(createAnimation(i, 100, i));
+    }
+
+    std::vector<float4x4> transforms(animations.size());
+    for (double time : {0.0, 0.3, 0.1, 0.5, 2.0})
+    {
+        Animation::animateMany(animations, time, transforms);
+        for (size_t i = 0; i < animations.size(); i++)
+        {
+            float4x4 reference = references[i]->animate(time);
+            EXPECT(almostEqual(transforms[i], reference)) << "animation " << i << ", time " << time;
+        }
+    }
+
+    // Compare against explicit T * R * S composition.
+    float4x4 trs = math::matrixFromTRS(float3(1.f, 2.f, 3.f), normalize(quatf(0.1f, 0.2f, 0.3f, 0.9f)), float3(2.f, 3.f, 4.f));
+    float4x4 T = math::matrixFromTranslation(float3(1.f, 2.f, 3.f));
+    float4x4 R = math::matrixFromQuat(normalize(quatf(0.1f, 0.2f, 0.3f, 0.9f)));
+    float4x4 S = math::matrixFromScaling(float3(2.f, 3.f, 4.f));
+    EXPECT(almostEqual(trs, mul(mul(T, R), S)));
+}
+
+CPU_TEST(Animation_Benchmark, TAGS("benchmark"))
+{
+    const uint32_t kFrameCount = 100;
+
+    for (auto [animationCount, keyframeCount] : {std::pair<uint32_t, uint32_t>{10000, 256}, {1000, 4096}})
+    {
+        std::vector<ref<Animation>> animations;
+        for (uint32_t i = 0; i < animationCount; i++)
+            animations.push_back(createAnimation(i, keyframeCount, i));
+        double duration = animations[0]->getDuration();
+        std::vector<float4x4> transforms(animationCount);
+
+        // Sequential playback with a wrap around, as with a looped animation.
+        auto timeAt = [&](uint32_t frame) { return std::fmod(frame * duration * 1.5 / kFrameCount, duration); };
+
+        std::vector<LinearScanSampler> baselines;
+        for (const auto& pAnimation : animations)
+            baselines.push_back({pAnimation.get()});
+
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < kFrameCount; frame++)
+        {
+            for (size_t i = 0; i < baselines.size(); i++)
+                transforms[i] = baselines[i].animate(timeAt(frame));
+        }
+        auto t1 = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < kFrameCount; frame++)
+        {
+            for (size_t i = 0; i < animations.size(); i++)
+                transforms[i] = animations[i]->animate(timeAt(frame));
+        }
+        auto t2 = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < kFrameCount; frame++)
+            Animation::animateMany(animations, timeAt(frame), transforms);
+        auto t3 = CpuTimer::getCurrentTimePoint();
+
+        // The baseline and the keyframe search must agree.
+        for (size_t i = 0; i < animations.size(); i++)
+            EXPECT(almostEqual(transforms[i], baselines[i].animate(timeAt(kFrameCount - 1)))) << "animation " << i;
+
+        logInfo(
+            "Animation with {} animations of {} keyframes, {} frames: linear scan {:.1f} ms, animate() {:.1f} ms, animateMany() {:.1f} ms.",
+            animationCount,
+            keyframeCount,
+            kFrameCount,
+            CpuTimer::calcDuration(t0, t1),
+            CpuTimer::calcDuration(t1, t2),
+            CpuTimer::calcDuration(t2, t3)
+        );
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,278 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridConverter.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996 4456)
+#endif
+// GridBuilder.h uses the std::result_of type trait which was removed in C++20.
+#define result_of invoke_result
+#include <nanovdb/util/GridBuilder.h>
+#undef result_of
+#include <nanovdb/util/Primitives.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Decodes a BC4 block into 16 values.
+void decodeBC4(const uint8_t* block, uint8_t* values)
+{
+    int a0 = block[0];
+    int a1 = block[1];
+    int palette[8] = {a0, a1};
+    if (a0 > a1)
+    {
+        for (int i = 1; i < 7; ++i)
+            palette[1 + i] = ((7 - i) * a0 + i * a1) / 7;
+    }
+    else
+    {
+        for (int i = 1; i < 5; ++i)
+            palette[1 + i] = ((5 - i) * a0 + i * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i)
+        bits |= uint64_t(block[2 + i]) << (8 * i);
+    for (int i = 0; i < 16; ++i)
+        values[i] = (uint8_t)palette[(bits >> (3 * i)) & 7];
+}
+
+uint32_t packMajMin(float majorant, float minorant)
+{
+    return f32tof16(majorant) + (f32tof16(minorant) << 16);
+}
+
+nanovdb::GridHandle<nanovdb::HostBuffer> createSphere(float radius, float voxelSize)
+{
+    return nanovdb::createFogVolumeSphere<float>(radius, nanovdb::Vec3f(0.f), voxelSize, 2.f * voxelSize);
+}
+} // namespace
+
+CPU_TEST(BC4Encode_FitCodes)
+{
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (int iter = 0; iter < 10000; ++iter)
+    {
+        // Narrow the distribution every other iteration to also hit near-constant tiles.
+        int lo = dist(rng);
+        int hi = (iter & 1) ? std::min(255, lo + (dist(rng) & 7)) : dist(rng);
+        if (lo > hi)
+            std::swap(lo, hi);
+        uint8_t tile[16];
+        for (int i = 0; i < 16; ++i)
+            tile[i] = (uint8_t)(lo + dist(rng) % (hi - lo + 1));
+        uint8_t codes[8];
+        for (int i = 0; i < 8; ++i)
+            codes[i] = (uint8_t)dist(rng);
+
+        uint8_t indices[16];
+        uint8_t indicesScalar[16];
+        int error = FitCodes(tile, codes, indices);
+        int errorScalar = FitCodesScalar(tile, codes, indicesScalar);
+        EXPECT_EQ(error, errorScalar);
+        EXPECT(std::equal(indices, indices + 16, indicesScalar)) << "iteration " << iter;
+    }
+}
+
+CPU_TEST(BC4Encode_CompressAlphaDxt5)
+{
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    // Constant and two-valued tiles are reproduced exactly.
+    for (int iter = 0; iter < 256; ++iter)
+    {
+        uint8_t tile[16];
+        uint8_t a = (uint8_t)dist(rng);
+        uint8_t b = (iter & 1) ? (uint8_t)dist(rng) : a;
+        for (int i = 0; i < 16; ++i)
+            tile[i] = (i & 3) ? a : b;
+        uint8_t block[8];
+        uint8_t decoded[16];
+        CompressAlphaDxt5(tile, block);
+        decodeBC4(block, decoded);
+        EXPECT(std::equal(tile, tile + 16, decoded)) << "iteration " << iter;
+    }
+
+    // Random tiles are not worse than interpolating their range in 7 steps.
+    for (int iter = 0; iter < 10000; ++iter)
+    {
+        uint8_t tile[16];
+        for (int i = 0; i < 16; ++i)
+            tile[i] = (uint8_t)dist(rng);
+        uint8_t block[8];
+        uint8_t decoded[16];
+        CompressAlphaDxt5(tile, block);
+        decodeBC4(block, decoded);
+        auto [minIt, maxIt] = std::minmax_element(tile, tile + 16);
+        int bound = (*maxIt - *minIt) / 14 + 2;
+        int error = 0;
+        for (int i = 0; i < 16; ++i)
+            error += (tile[i] - decoded[i]) * (tile[i] - decoded[i]);
+        EXPECT_LE(error, 16 * bound * bound) << "iteration " << iter;
+    }
+}
+
+CPU_TEST(NanoVDBConverter_Ranges)
+{
+    auto handle = createSphere(20.f, 1.f);
+    const nanovdb::FloatGrid* grid = handle.grid<float>();
+    ASSERT(grid != nullptr);
+
+    NanoVDBConverterBC4 converter(grid);
+    converter.convertBricks();
+
+    const uint32_t leafCount = grid->tree().nodeCount(0);
+    EXPECT_GT(converter.getNonEmptyCount(), 0u);
+    EXPECT_LE(converter.getNonEmptyCount(), leafCount);
+
+    // Compare the finest mip against the value range of each brick including its one voxel apron.
+    const auto& bbox = grid->indexBBox();
+    const int3 bbMin = int3(bbox.min().x(), bbox.min().y(), bbox.min().z()) & (~7);
+    const int3 leafDim = converter.getLeafDim(0);
+    const auto& ranges = converter.getRangeData();
+    const auto& ptrs = converter.getPtrData();
+    auto a = grid->getAccessor();
+    uint32_t mismatches = 0;
+    uint32_t bricks = 0;
+    for (int z = 0; z < leafDim.z; ++z)
+    {
+        for (int y = 0; y < leafDim.y; ++y)
+        {
+            for (int x = 0; x < leafDim.x; ++x)
+            {
+                const int3 origin = int3(x, y, z) * 8 + bbMin;
+                const uint32_t index = (z * leafDim.y + y) * leafDim.x + x;
+                uint32_t expected;
+                if (a.probeLeaf(nanovdb::Coord(origin.x, origin.y, origin.z)))
+                {
+                    float minorant = std::numeric_limits<float>::max();
+                    float majorant = std::numeric_limits<float>::lowest();
+                    for (int k = -1; k <= 8; ++k)
+                        for (int j = -1; j <= 8; ++j)
+                            for (int i = -1; i <= 8; ++i)
+                            {
+                                float v = a.getValue(nanovdb::Coord(origin.x + i, origin.y + j, origin.z + k));
+                                minorant = std::min(minorant, v);
+                                majorant = std::max(majorant, v);
+                            }
+                    if (minorant == majorant)
+                        expected = packMajMin(majorant, majorant);
+                    else
+                        expected = packMajMin(f16tof32(f32tof16(majorant) + 1), minorant);
+                    ++bricks;
+                }
+                else
+                {
+                    float value = a.getValue(nanovdb::Coord(origin.x, origin.y, origin.z));
+                    expected = packMajMin(value, value);
+                    EXPECT_EQ(ptrs[index], 0u);
+                }
+                if (ranges[index] != expected)
+                    ++mismatches;
+            }
+        }
+    }
+    EXPECT_EQ(bricks, leafCount);
+    EXPECT_EQ(mismatches, 0u);
+
+    // Each coarser mip holds the range of its 2x2x2 children.
+    for (int mip = 1; mip < 4; ++mip)
+    {
+        const int3 srcDim = converter.getLeafDim(mip - 1);
+        const int3 dstDim = converter.getLeafDim(mip);
+        const uint32_t* src = ranges.data() + converter.getMipOffset(mip - 1);
+        const uint32_t* dst = ranges.data() + converter.getMipOffset(mip);
+        uint32_t mipMismatches = 0;
+        for (int z = 0; z < dstDim.z; ++z)
+        {
+            for (int y = 0; y < dstDim.y; ++y)
+            {
+                for (int x = 0; x < dstDim.x; ++x)
+                {
+                    float majorant = std::numeric_limits<float>::lowest();
+                    float minorant = std::numeric_limits<float>::max();
+                    for (int c = 0; c < 8; ++c)
+                    {
+                        const int3 child = int3(x, y, z) * 2 + int3(c & 1, (c >> 1) & 1, c >> 2);
+                        uint32_t packed = src[(child.z * srcDim.y + child.y) * srcDim.x + child.x];
+                        majorant = std::max(majorant, f16tof32(packed & 0xffff));
+                        minorant = std::min(minorant, f16tof32(packed >> 16));
+                    }
+                    if (dst[(z * dstDim.y + y) * dstDim.x + x] != packMajMin(majorant, minorant))
+                        ++mipMismatches;
+                }
+            }
+        }
+        EXPECT_EQ(mipMismatches, 0u) << "mip " << mip;
+    }
+}
+
+CPU_TEST(NanoVDBConverter_Benchmark, TAGS("benchmark"))
+{
+    const float kRadii[] = {64.f, 128.f, 256.f};
+    for (float radius : kRadii)
+    {
+        auto handle = createSphere(radius, 1.f);
+        const nanovdb::FloatGrid* grid = handle.grid<float>();
+        ASSERT(grid != nullptr);
+
+        // Each leaf brick is a dense 8^3 block of voxels.
+        const uint64_t voxelCount = uint64_t(grid->tree().nodeCount(0)) * 512;
+        const uint32_t kIterations = 3;
+        double bestTime = std::numeric_limits<double>::max();
+        for (uint32_t i = 0; i < kIterations; ++i)
+        {
+            NanoVDBConverterBC4 converter(grid);
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            converter.convertBricks();
+            bestTime = std::min(bestTime, CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint()));
+        }
+        logInfo(
+            "NanoVDBConverter radius {}: {} leaves, {:.2f} ms, {:.1f} Mvoxels/s",
+            radius,
+            grid->tree().nodeCount(0),
+            bestTime,
+            voxelCount / (bestTime * 1e3)
+        );
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,130 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridStreamer.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4996)
+#endif
+#include <nanovdb/util/IO.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+GPU_TEST(GridStreamer_Playback)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "GridStreamer";
+    std::filesystem::create_directories(directory);
+
+    // Write a sequence of spheres with growing radius, so that each frame can be identified by its voxel count.
+    const uint32_t kFrameCount = 12;
+    std::vector<std::filesystem::path> paths;
+    std::vector<uint64_t> voxelCounts;
+    std::string gridname;
+    for (uint32_t i = 0; i < kFrameCount; ++i)
+    {
+        ref<Grid> pGrid = Grid::createSphere(pDevice, 1.f + 0.25f * i, 0.1f);
+        paths.push_back(directory / fmt::format("frame{}.nvdb", i));
+        nanovdb::io::writeGrid(paths.back().string(), pGrid->getGridHandle());
+        voxelCounts.push_back(pGrid->getVoxelCount());
+        gridname = pGrid->getGridHandle().grid<float>()->gridName();
+    }
+
+    GridStreamer::Options options;
+    options.prefetchFrames = 3;
+    options.keepFrames = 1;
+    options.maxUploadsPerFrame = 4;
+    options.loop = false;
+    ref<GridStreamer> pStreamer = GridStreamer::create(pDevice, paths, gridname, options);
+    EXPECT_EQ(pStreamer->getFrameCount(), kFrameCount);
+
+    // Play forward at two frames per call, then backward at one frame per call.
+    std::vector<uint32_t> frames;
+    for (uint32_t frame = 0; frame < kFrameCount; frame += 2)
+        frames.push_back(frame);
+    const size_t forwardCount = frames.size();
+    for (uint32_t frame = kFrameCount; frame-- > 0;)
+        frames.push_back(frame);
+
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        uint32_t frame = frames[i];
+        const ref<Grid>& pGrid = pStreamer->setFrame(frame);
+        ASSERT(pGrid != nullptr);
+        EXPECT_EQ(pGrid->getVoxelCount(), voxelCounts[frame]) << "frame " << frame;
+        EXPECT_EQ(pStreamer->getFrame(), frame);
+
+        GridStreamer::Stats stats = pStreamer->getStats();
+        EXPECT_LE(stats.residentCount, 1 + options.prefetchFrames + options.keepFrames);
+
+        if (i == forwardCount - 1)
+        {
+            EXPECT_EQ(pStreamer->getStep(), 2);
+        }
+
+        // Let the prefetch catch up, as playback is faster than decoding in this test.
+        pStreamer->waitForPrefetch();
+    }
+    EXPECT_EQ(pStreamer->getStep(), -1);
+
+    // Only the first frame and the reversal of the playback direction (10 -> 11) miss, all other frames were prefetched.
+    GridStreamer::Stats stats = pStreamer->getStats();
+    EXPECT_EQ(stats.missCount, 2u);
+    EXPECT_EQ(stats.hitCount, frames.size() - 2);
+    EXPECT_GE(stats.decodedCount, kFrameCount);
+    EXPECT_GT(stats.evictedCount, 0u);
+
+    // Without memory budget only the current frame is kept.
+    options.memoryLimit = 0;
+    pStreamer->setOptions(options);
+    stats = pStreamer->getStats();
+    EXPECT_EQ(stats.residentCount, 1u);
+    EXPECT_EQ(pStreamer->getGrid()->getVoxelCount(), voxelCounts[0]);
+
+    // Frames that fail to load keep the grid of the last frame that loaded.
+    options.memoryLimit = GridStreamer::Options().memoryLimit;
+    pStreamer = GridStreamer::create(pDevice, { paths[0], directory / "missing.nvdb", paths[2] }, gridname, options);
+    EXPECT_EQ(pStreamer->setFrame(0)->getVoxelCount(), voxelCounts[0]);
+    pStreamer->waitForPrefetch();
+    EXPECT_EQ(pStreamer->getStats().failedCount, 1u);
+    EXPECT_EQ(pStreamer->setFrame(1)->getVoxelCount(), voxelCounts[0]);
+    EXPECT_EQ(pStreamer->setFrame(2)->getVoxelCount(), voxelCounts[2]);
+
+    pStreamer = nullptr;
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
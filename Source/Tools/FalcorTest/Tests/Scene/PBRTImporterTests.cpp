@@ -0,0 +1,209 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/BasicMaterial.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <fstream>
+#include <string>
+
+namespace Falcor
+{
+namespace
+{
+const SceneBuilder::Flags kFlags = SceneBuilder::Flags::DontMergeMaterials | SceneBuilder::Flags::DontOptimizeGraph;
+
+/// Create a 'trianglemesh' shape of a grid with resolution x resolution quads.
+std::string createGridShape(uint32_t resolution, float z)
+{
+    std::string str = "Shape \"trianglemesh\"\n    \"point3 P\" [";
+    for (uint32_t y = 0; y <= resolution; ++y)
+    {
+        for (uint32_t x = 0; x <= resolution; ++x)
+            fmt::format_to(std::back_inserter(str), " {} {} {}", float(x) / resolution, float(y) / resolution, z);
+    }
+    str += " ]\n    \"integer indices\" [";
+    for (uint32_t y = 0; y < resolution; ++y)
+    {
+        for (uint32_t x = 0; x < resolution; ++x)
+        {
+            uint32_t i = y * (resolution + 1) + x;
+            uint32_t j = i + resolution + 1;
+            fmt::format_to(std::back_inserter(str), " {} {} {} {} {} {}", i, i + 1, j, i + 1, j + 1, j);
+        }
+    }
+    str += " ]\n";
+    return str;
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& str)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(str.data(), str.size());
+}
+
+/// Write a main scene file that references the given files with 'Include' or 'Import'.
+void writeMainFile(const std::filesystem::path& path, const std::string& directive, const std::vector<std::string>& parts)
+{
+    std::string str =
+        "LookAt 0 0 -5  0 0 0  0 1 0\n"
+        "Camera \"perspective\" \"float fov\" [45]\n"
+        "Film \"rgb\" \"integer xresolution\" [64] \"integer yresolution\" [64]\n"
+        "WorldBegin\n"
+        "LightSource \"distant\" \"point3 from\" [0 0 0] \"point3 to\" [0 0 1]\n"
+        "Material \"diffuse\" \"rgb reflectance\" [0.1 0.1 0.1]\n";
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        fmt::format_to(std::back_inserter(str), "{} \"{}\"\n", directive, parts[i]);
+        str += "AttributeBegin\n";
+        fmt::format_to(std::back_inserter(str), "Material \"diffuse\" \"rgb reflectance\" [0.2 0.2 {}]\n", 0.01f * i);
+        str += createGridShape(2, -1.f);
+        str += "AttributeEnd\n";
+    }
+    writeFile(path, str);
+}
+
+ref<Scene> importScene(ref<Device> pDevice, const std::filesystem::path& path)
+{
+    SceneBuilder builder(pDevice, path, Settings(), kFlags);
+    return builder.getScene();
+}
+} // namespace
+
+GPU_TEST(PBRTImporter_Import)
+{
+    PluginManager::instance().loadPluginByName("PBRTImporter");
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "PBRTImporter";
+    std::filesystem::create_directories(directory);
+
+    // Imported files use the inherited material, unnamed and named materials of their own and add lights.
+    std::vector<std::string> parts;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        std::string str = createGridShape(3 + 3 * i, 0.f);
+        str += "AttributeBegin\n";
+        fmt::format_to(std::back_inserter(str), "Material \"diffuse\" \"rgb reflectance\" [0.3 {} 0.3]\n", 0.1f * i);
+        str += createGridShape(4 + 3 * i, 1.f);
+        str += "AttributeEnd\n";
+        str += "AttributeBegin\n";
+        fmt::format_to(std::back_inserter(str), "MakeNamedMaterial \"part{}\" \"string type\" \"diffuse\"", i);
+        fmt::format_to(std::back_inserter(str), " \"rgb reflectance\" [0.4 0.4 {}]\n", 0.1f * i);
+        fmt::format_to(std::back_inserter(str), "NamedMaterial \"part{}\"\n", i);
+        str += createGridShape(5 + 3 * i, 2.f);
+        str += "AttributeEnd\n";
+        str += "LightSource \"distant\" \"point3 from\" [0 0 0] \"point3 to\" [0 1 0]\n";
+        parts.push_back(fmt::format("part{}.pbrt", i));
+        writeFile(directory / parts.back(), str);
+    }
+    writeMainFile(directory / "include.pbrt", "Include", parts);
+    writeMainFile(directory / "import.pbrt", "Import", parts);
+
+    // Importing must result in the same scene as including.
+    ref<Scene> pIncludeScene = importScene(ctx.getDevice(), directory / "include.pbrt");
+    ref<Scene> pImportScene = importScene(ctx.getDevice(), directory / "import.pbrt");
+    ASSERT(pIncludeScene != nullptr);
+    ASSERT(pImportScene != nullptr);
+
+    EXPECT_EQ(pIncludeScene->getLightCount(), 4);
+    EXPECT_EQ(pIncludeScene->getLightCount(), pImportScene->getLightCount());
+    ASSERT_EQ(pIncludeScene->getMeshCount(), 12);
+    ASSERT_EQ(pIncludeScene->getMeshCount(), pImportScene->getMeshCount());
+    for (uint32_t i = 0; i < pIncludeScene->getMeshCount(); ++i)
+    {
+        const auto& includeMesh = pIncludeScene->getMesh(MeshID(i));
+        const auto& importMesh = pImportScene->getMesh(MeshID(i));
+        EXPECT_EQ(includeMesh.vertexCount, importMesh.vertexCount) << "mesh " << i;
+        EXPECT_EQ(includeMesh.indexCount, importMesh.indexCount) << "mesh " << i;
+
+        auto pIncludeMaterial = dynamic_ref_cast<BasicMaterial>(pIncludeScene->getMaterial(includeMesh.materialID));
+        auto pImportMaterial = dynamic_ref_cast<BasicMaterial>(pImportScene->getMaterial(importMesh.materialID));
+        ASSERT(pIncludeMaterial != nullptr);
+        ASSERT(pImportMaterial != nullptr);
+        EXPECT(all(pIncludeMaterial->getBaseColor() == pImportMaterial->getBaseColor())) << "mesh " << i;
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+GPU_TEST(PBRTImporter_ParseBenchmark, TAGS("benchmark"))
+{
+    PluginManager::instance().loadPluginByName("PBRTImporter");
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "PBRTImporterBenchmark";
+    std::filesystem::create_directories(directory);
+
+    // 8 files with 32 inline meshes of 8K triangles each, about 60 MB in total.
+    const uint32_t kPartCount = 8;
+    const uint32_t kMeshCount = 32;
+    std::vector<std::string> parts;
+    uint64_t totalBytes = 0;
+    for (uint32_t i = 0; i < kPartCount; ++i)
+    {
+        std::string str;
+        for (uint32_t j = 0; j < kMeshCount; ++j)
+            str += createGridShape(64, float(i * kMeshCount + j));
+        parts.push_back(fmt::format("part{}.pbrt", i));
+        writeFile(directory / parts.back(), str);
+        totalBytes += str.size();
+    }
+    writeMainFile(directory / "include.pbrt", "Include", parts);
+    writeMainFile(directory / "import.pbrt", "Import", parts);
+
+    const uint32_t kIterations = 3;
+    const char* kDirectives[2] = {"Include", "Import"};
+    double importTime[2] = {};
+    for (uint32_t i = 0; i < kIterations; ++i)
+    {
+        for (size_t j = 0; j < 2; ++j)
+        {
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            SceneBuilder builder(ctx.getDevice(), directory / (j == 0 ? "include.pbrt" : "import.pbrt"), Settings(), kFlags);
+            builder.waitForMeshes();
+            importTime[j] += CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        }
+    }
+
+    for (size_t j = 0; j < 2; ++j)
+    {
+        double time = importTime[j] / kIterations;
+        logInfo(
+            "PBRT import of {:.1f} MB with '{}': {:.1f} ms, {:.1f} MB/s (average of {} runs).",
+            totalBytes / 1e6,
+            kDirectives[j],
+            time,
+            totalBytes / 1e3 / time,
+            kIterations
+        );
+    }
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -0,0 +1,297 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/PlyReader.h"
+#include "Scene/TriangleMesh.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace Falcor
+{
+namespace
+{
+template<typename T>
+void append(std::string& data, T value, bool bigEndian)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if (bigEndian)
+        std::reverse(bytes, bytes + sizeof(T));
+    data.append(bytes, sizeof(T));
+}
+
+/// Creates a binary PLY file with a grid of quads in the xy-plane.
+std::string createGrid(uint32_t size, bool bigEndian)
+{
+    std::string data = fmt::format(
+        "ply\n"
+        "format {} 1.0\n"
+        "comment Test grid\n"
+        "element vertex {}\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property float u\n"
+        "property float v\n"
+        "element face {}\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n",
+        bigEndian ? "binary_big_endian" : "binary_little_endian",
+        (size + 1) * (size + 1),
+        size * size
+    );
+
+    for (uint32_t y = 0; y <= size; ++y)
+    {
+        for (uint32_t x = 0; x <= size; ++x)
+        {
+            append(data, (float)x, bigEndian);
+            append(data, (float)y, bigEndian);
+            append(data, 0.f, bigEndian);
+            append(data, (float)x / size, bigEndian);
+            append(data, (float)y / size, bigEndian);
+        }
+    }
+
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            int32_t i = y * (size + 1) + x;
+            append(data, (uint8_t)4, bigEndian);
+            append(data, i, bigEndian);
+            append(data, i + 1, bigEndian);
+            append(data, i + (int32_t)size + 2, bigEndian);
+            append(data, i + (int32_t)size + 1, bigEndian);
+        }
+    }
+
+    return data;
+}
+
+bool readFails(const std::string& data)
+{
+    try
+    {
+        PlyReader::read(data.data(), data.size());
+    }
+    catch (const RuntimeError&)
+    {
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+CPU_TEST(PlyReader_Ascii)
+{
+    std::string data =
+        "ply\r\n"
+        "format ascii 1.0\r\n"
+        "element vertex 4\r\n"
+        "property float x\r\n"
+        "property float y\r\n"
+        "property float z\r\n"
+        "property float nx\r\n"
+        "property float ny\r\n"
+        "property float nz\r\n"
+        "element face 1\r\n"
+        "property list uchar int vertex_indices\r\n"
+        "end_header\r\n"
+        "0 0 0 0 0 1\r\n"
+        "1 0 0 0 0 1\r\n"
+        "1 1 0 0 0 1\r\n"
+        "0 1 0 0 0 1\r\n"
+        "4 0 1 2 3\r\n";
+
+    auto mesh = PlyReader::read(data.data(), data.size());
+    ASSERT_EQ(mesh.positions.size(), 4);
+    ASSERT_EQ(mesh.normals.size(), 4);
+    EXPECT(mesh.texCoords.empty());
+    EXPECT(all(mesh.positions[2] == float3(1.f, 1.f, 0.f)));
+    EXPECT(all(mesh.normals[3] == float3(0.f, 0.f, 1.f)));
+
+    // Quad is triangulated as a fan.
+    ASSERT_EQ(mesh.indices.size(), 6);
+    const uint32_t expected[] = {0, 1, 2, 0, 2, 3};
+    for (size_t i = 0; i < 6; ++i)
+        EXPECT_EQ(mesh.indices[i], expected[i]);
+}
+
+CPU_TEST(PlyReader_Binary)
+{
+    for (bool bigEndian : {false, true})
+    {
+        std::string data = createGrid(4, bigEndian);
+        auto mesh = PlyReader::read(data.data(), data.size());
+        ASSERT_EQ(mesh.positions.size(), 25);
+        ASSERT_EQ(mesh.texCoords.size(), 25);
+        EXPECT(mesh.normals.empty());
+        EXPECT(all(mesh.positions[24] == float3(4.f, 4.f, 0.f)));
+        EXPECT(all(mesh.texCoords[6] == float2(0.25f, 0.25f)));
+        ASSERT_EQ(mesh.indices.size(), 16 * 6);
+        EXPECT_EQ(mesh.indices[3], 0);
+        EXPECT_EQ(mesh.indices[4], 6);
+        EXPECT_EQ(mesh.indices[5], 5);
+    }
+}
+
+CPU_TEST(PlyReader_SkipProperties)
+{
+    // Unknown elements and properties (including lists) are skipped.
+    std::string data =
+        "ply\n"
+        "format ascii 1.0\n"
+        "element vertex 3\n"
+        "property double x\n"
+        "property double y\n"
+        "property double z\n"
+        "property list uchar float weights\n"
+        "element material 1\n"
+        "property uchar red\n"
+        "element face 1\n"
+        "property int face_index\n"
+        "property list uint uint vertex_index\n"
+        "end_header\n"
+        "0 0 0 2 0.5 0.5\n"
+        "1 0 0 0\n"
+        "0 1 0 1 1\n"
+        "255\n"
+        "7 3 2 1 0\n";
+
+    auto mesh = PlyReader::read(data.data(), data.size());
+    ASSERT_EQ(mesh.positions.size(), 3);
+    EXPECT(all(mesh.positions[2] == float3(0.f, 1.f, 0.f)));
+    ASSERT_EQ(mesh.indices.size(), 3);
+    EXPECT_EQ(mesh.indices[0], 2);
+}
+
+CPU_TEST(PlyReader_Errors)
+{
+    const std::string header =
+        "ply\n"
+        "format binary_little_endian 1.0\n"
+        "element vertex 3\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "element face 1\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n";
+    std::string data = header;
+    for (int i = 0; i < 9; ++i)
+        append(data, 0.f, false);
+    append(data, (uint8_t)3, false);
+    for (int32_t i : {0, 1, 2})
+        append(data, i, false);
+
+    EXPECT(!readFails(data));
+    EXPECT(readFails(data.substr(0, data.size() - 1)));
+    EXPECT(readFails("obj\n"));
+    EXPECT(readFails(header));
+
+    // Out of bounds index.
+    std::string outOfBounds = data;
+    outOfBounds[outOfBounds.size() - 4] = 3;
+    EXPECT(readFails(outOfBounds));
+}
+
+CPU_TEST(PlyReader_JoinIdenticalVertices)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path path = directory / "PlyReaderJoin.ply";
+    {
+        std::string data = createGrid(4, false);
+        std::ofstream file(path, std::ios::binary);
+        file.write(data.data(), data.size());
+    }
+
+    // Facet normals split the vertices between triangles. The grid is planar, so joining restores the shared vertices.
+    auto pSplit = TriangleMesh::createFromFile(path, TriangleMesh::ImportFlags::None);
+    auto pJoined = TriangleMesh::createFromFile(path, TriangleMesh::ImportFlags::JoinIdenticalVertices);
+    ASSERT(pSplit != nullptr);
+    ASSERT(pJoined != nullptr);
+    EXPECT_EQ(pSplit->getVertices().size(), 16 * 6);
+    EXPECT_EQ(pJoined->getVertices().size(), 25);
+    ASSERT_EQ(pJoined->getIndices().size(), pSplit->getIndices().size());
+    for (size_t i = 0; i < pJoined->getIndices().size(); ++i)
+    {
+        const auto& a = pSplit->getVertices()[pSplit->getIndices()[i]];
+        const auto& b = pJoined->getVertices()[pJoined->getIndices()[i]];
+        EXPECT(all(a.position == b.position) && all(a.normal == b.normal) && all(a.texCoord == b.texCoord)) << "index " << i;
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(PlyReader_Benchmark, TAGS("benchmark"))
+{
+    // 2M triangles, loaded with the native reader and through ASSIMP.
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path path = directory / "PlyReaderBenchmark.ply";
+    {
+        std::string data = createGrid(1000, false);
+        std::ofstream file(path, std::ios::binary);
+        file.write(data.data(), data.size());
+    }
+
+    const uint32_t kIterations = 3;
+    size_t triangleCount[2] = {};
+    double loadTime[2] = {};
+    for (uint32_t i = 0; i < kIterations; ++i)
+    {
+        for (size_t j = 0; j < 2; ++j)
+        {
+            auto flags = TriangleMesh::ImportFlags::GenSmoothNormals;
+            if (j == 1)
+                flags |= TriangleMesh::ImportFlags::UseAssimp;
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            auto pMesh = TriangleMesh::createFromFile(path, flags);
+            loadTime[j] += CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+            ASSERT(pMesh != nullptr);
+            triangleCount[j] = pMesh->getIndices().size() / 3;
+        }
+    }
+    EXPECT_EQ(triangleCount[0], triangleCount[1]);
+
+    logInfo(
+        "PLY load of {} triangles: native {:.1f} ms, ASSIMP {:.1f} ms (average of {} runs).",
+        triangleCount[0],
+        loadTime[0] / kIterations,
+        loadTime[1] / kIterations,
+        kIterations
+    );
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -0,0 +1,266 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+namespace Falcor
+{
+namespace
+{
+const SceneBuilder::Flags kFlags = SceneBuilder::Flags::DontMergeMeshes | SceneBuilder::Flags::DontOptimizeGraph;
+
+std::vector<ref<TriangleMesh>> createTriangleMeshes()
+{
+    std::vector<ref<TriangleMesh>> meshes;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0: meshes.push_back(TriangleMesh::createSphere(0.5f, 8 + i, 4 + i)); break;
+        case 1: meshes.push_back(TriangleMesh::createCube(float3(1.f + i))); break;
+        case 2: meshes.push_back(TriangleMesh::createQuad(float2(1.f + i))); break;
+        }
+    }
+    return meshes;
+}
+
+ref<Scene> buildScene(ref<Device> pDevice, const std::vector<ref<TriangleMesh>>& meshes, bool async)
+{
+    SceneBuilder builder(pDevice, Settings(), kFlags);
+    std::vector<ref<Material>> materials = {
+        StandardMaterial::create(pDevice, "A"),
+        StandardMaterial::create(pDevice, "B"),
+    };
+
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        const auto& pMaterial = materials[i % materials.size()];
+        MeshID meshID = async ? builder.addTriangleMeshAsync(meshes[i], pMaterial) : builder.addTriangleMesh(meshes[i], pMaterial);
+        // Mesh IDs must be assigned in call order.
+        if (meshID != MeshID(i)) return nullptr;
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{fmt::format("Node{}", i)});
+        builder.addMeshInstance(nodeID, meshID);
+    }
+
+    return builder.getScene();
+}
+
+/// Creates a unit quad with face-varying positions, i.e. each triangle corner has its own position index.
+SceneBuilder::Mesh createFaceVaryingQuad(const ref<Material>& pMaterial, std::vector<float3>& positions, std::vector<uint32_t>& indices, float jitter)
+{
+    positions = {
+        float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(1.f, 1.f, 0.f),
+        float3(0.f, 0.f, jitter), float3(1.f, 1.f, jitter), float3(0.f, 1.f, 0.f),
+    };
+    indices = { 0, 1, 2, 3, 4, 5 };
+
+    SceneBuilder::Mesh mesh;
+    mesh.name = "quad";
+    mesh.faceCount = 2;
+    mesh.vertexCount = (uint32_t)positions.size();
+    mesh.indexCount = (uint32_t)indices.size();
+    mesh.pIndices = indices.data();
+    mesh.topology = Vao::Topology::TriangleList;
+    mesh.pMaterial = pMaterial;
+    mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+
+    // Use constant normals and tangents so that only positions and texture coordinates differ between corners.
+    static const float3 kNormal(0.f, 0.f, 1.f);
+    static const float4 kTangent(1.f, 0.f, 0.f, 1.f);
+    mesh.normals = { &kNormal, SceneBuilder::Mesh::AttributeFrequency::Constant };
+    mesh.tangents = { &kTangent, SceneBuilder::Mesh::AttributeFrequency::Constant };
+    mesh.useOriginalTangentSpace = true;
+    return mesh;
+}
+} // namespace
+
+GPU_TEST(SceneBuilder_AsyncMeshes)
+{
+    auto meshes = createTriangleMeshes();
+
+    ref<Scene> pSyncScene = buildScene(ctx.getDevice(), meshes, false);
+    ref<Scene> pAsyncScene = buildScene(ctx.getDevice(), meshes, true);
+    ASSERT(pSyncScene != nullptr);
+    ASSERT(pAsyncScene != nullptr);
+
+    ASSERT_EQ(pSyncScene->getMeshCount(), pAsyncScene->getMeshCount());
+    for (uint32_t i = 0; i < pSyncScene->getMeshCount(); ++i)
+    {
+        const auto& syncMesh = pSyncScene->getMesh(MeshID(i));
+        const auto& asyncMesh = pAsyncScene->getMesh(MeshID(i));
+        EXPECT_EQ(syncMesh.vbOffset, asyncMesh.vbOffset) << "mesh " << i;
+        EXPECT_EQ(syncMesh.ibOffset, asyncMesh.ibOffset) << "mesh " << i;
+        EXPECT_EQ(syncMesh.vertexCount, asyncMesh.vertexCount) << "mesh " << i;
+        EXPECT_EQ(syncMesh.indexCount, asyncMesh.indexCount) << "mesh " << i;
+        EXPECT_EQ(syncMesh.materialID, asyncMesh.materialID) << "mesh " << i;
+        EXPECT_EQ(syncMesh.flags, asyncMesh.flags) << "mesh " << i;
+    }
+}
+
+GPU_TEST(SceneBuilder_AsyncMeshException)
+{
+    SceneBuilder builder(ctx.getDevice(), Settings(), kFlags);
+    auto pMaterial = StandardMaterial::create(ctx.getDevice(), "A");
+
+    NodeID nodeID = builder.addNode(SceneBuilder::Node{"Node"});
+    MeshID failedID = builder.addMeshAsync(pMaterial, [](const SceneBuilder&) -> SceneBuilder::ProcessedMesh { FALCOR_THROW("Mesh task failed"); });
+    builder.addMeshInstance(nodeID, failedID);
+
+    // Parallel loops don't wait for or rethrow from pending mesh tasks.
+    std::atomic<size_t> sum{0};
+    builder.parallelFor(100, [&](size_t i) { sum += i; });
+    EXPECT_EQ(sum.load(), 4950);
+
+    // The failed mesh loses its instances and can't be instanced again.
+    EXPECT_THROW(builder.waitForMeshes());
+    EXPECT_THROW(builder.addMeshInstance(nodeID, failedID));
+
+    // The exception is only thrown once, and later batches are processed normally.
+    MeshID meshID = builder.addTriangleMeshAsync(TriangleMesh::createQuad(), pMaterial);
+    EXPECT_EQ(meshID, MeshID(1));
+    builder.addMeshInstance(nodeID, meshID);
+    builder.waitForMeshes();
+
+    // The failed mesh is removed as unused.
+    ref<Scene> pScene = builder.getScene();
+    ASSERT(pScene != nullptr);
+    EXPECT_EQ(pScene->getMeshCount(), 1);
+}
+
+GPU_TEST(SceneBuilder_AssetResolverOutlivesBuilder)
+{
+    const std::filesystem::path path = std::filesystem::absolute("test_scene_builder_dependency.txt");
+    std::ofstream(path) << "abcd";
+
+    // A copy of the builder's resolver still records dependencies while the builder is alive,
+    // and is safe to use after the builder is destroyed.
+    std::optional<AssetResolver> resolver;
+    {
+        SceneBuilder builder(ctx.getDevice(), Settings(), kFlags);
+        resolver = builder.getAssetResolver();
+        EXPECT_EQ(resolver->resolvePath(path), std::filesystem::canonical(path));
+    }
+    EXPECT_EQ(resolver->resolvePath(path), std::filesystem::canonical(path));
+
+    std::filesystem::remove(path);
+}
+
+GPU_TEST(SceneBuilder_WeldVertices)
+{
+    auto pMaterial = StandardMaterial::create(ctx.getDevice(), "A");
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+
+    // Default merging only merges vertices sharing a position index.
+    {
+        SceneBuilder builder(ctx.getDevice(), Settings(), SceneBuilder::Flags::None);
+        auto processed = builder.processMesh(createFaceVaryingQuad(pMaterial, positions, indices, 0.f));
+        EXPECT_EQ(processed.staticData.size(), 6);
+    }
+
+    // Welding merges identical vertices regardless of their position index.
+    {
+        SceneBuilder builder(ctx.getDevice(), Settings(), SceneBuilder::Flags::WeldVertices);
+        auto processed = builder.processMesh(createFaceVaryingQuad(pMaterial, positions, indices, 0.f));
+        EXPECT_EQ(processed.staticData.size(), 4);
+        EXPECT_EQ(processed.indexCount, 6);
+
+        auto stats = builder.getVertexMergeStats();
+        EXPECT_EQ(stats.meshCount, 1);
+        EXPECT_EQ(stats.inputVertexCount, 6);
+        EXPECT_EQ(stats.outputVertexCount, 4);
+        EXPECT_EQ(stats.getRemovedVertexCount(), 2);
+    }
+
+    // Positions are exact by default, so jittered vertices are kept apart.
+    {
+        SceneBuilder builder(ctx.getDevice(), Settings(), SceneBuilder::Flags::WeldVertices);
+        auto processed = builder.processMesh(createFaceVaryingQuad(pMaterial, positions, indices, 1e-5f));
+        EXPECT_EQ(processed.staticData.size(), 6);
+    }
+
+    // A position tolerance welds the jittered vertices.
+    {
+        Settings settings;
+        settings.addOptions(nlohmann::json{{"weldVertices:positionTolerance", 1e-3f}});
+        SceneBuilder builder(ctx.getDevice(), settings, SceneBuilder::Flags::WeldVertices);
+        auto processed = builder.processMesh(createFaceVaryingQuad(pMaterial, positions, indices, 1e-5f));
+        EXPECT_EQ(processed.staticData.size(), 4);
+    }
+
+    // Vertices within the tolerance are welded even if they fall into adjacent position cells.
+    {
+        Settings settings;
+        settings.addOptions(nlohmann::json{{"weldVertices:positionTolerance", 1e-3f}});
+        SceneBuilder builder(ctx.getDevice(), settings, SceneBuilder::Flags::WeldVertices);
+        auto processed = builder.processMesh(createFaceVaryingQuad(pMaterial, positions, indices, -1e-4f));
+        EXPECT_EQ(processed.staticData.size(), 4);
+    }
+}
+
+GPU_TEST(SceneBuilder_WeldVerticesAnimated)
+{
+    auto pMaterial = StandardMaterial::create(ctx.getDevice(), "A");
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+    SceneBuilder builder(ctx.getDevice(), Settings(), SceneBuilder::Flags::WeldVertices);
+
+    // Vertices of animated meshes are not welded, as they may only coincide in the first frame.
+    {
+        auto mesh = createFaceVaryingQuad(pMaterial, positions, indices, 0.f);
+        mesh.isAnimated = true;
+        auto processed = builder.processMesh(mesh);
+        EXPECT_EQ(processed.staticData.size(), 6);
+    }
+
+    // Vertex animation keyframes are remapped through the attribute indices. Position 3 coincides with position 0 in the
+    // first frame, but moves away in a later keyframe, so the two must remain separate vertices.
+    {
+        SceneBuilder::MeshAttributeIndices attributeIndices;
+        auto processed = builder.processMesh(createFaceVaryingQuad(pMaterial, positions, indices, 0.f), &attributeIndices);
+        ASSERT_EQ(processed.staticData.size(), 6);
+        ASSERT_EQ(attributeIndices.size(), processed.staticData.size());
+
+        std::vector<float3> keyframePositions = positions;
+        keyframePositions[3] = float3(0.f, 0.f, 1.f);
+
+        auto getIndex = [&](size_t i) -> uint32_t
+        { return processed.use16BitIndices ? reinterpret_cast<const uint16_t*>(processed.indexData.data())[i] : processed.indexData[i]; };
+        const uint32_t v0 = getIndex(0);
+        const uint32_t v3 = getIndex(3);
+        EXPECT_NE(v0, v3);
+        EXPECT(all(keyframePositions[attributeIndices[v0].positionIdx] == float3(0.f, 0.f, 0.f)));
+        EXPECT(all(keyframePositions[attributeIndices[v3].positionIdx] == float3(0.f, 0.f, 1.f)));
+    }
+}
+} // namespace Falcor
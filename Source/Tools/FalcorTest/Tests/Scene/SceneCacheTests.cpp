@@ -0,0 +1,211 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCache.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+Scene::SceneData createSceneData(ref<Device> pDevice, const std::vector<uint32_t>& meshVertexCounts)
+{
+    Scene::SceneData sceneData;
+    sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
+    sceneData.meshStaticData.setName("SceneCacheTest::meshStaticData");
+    sceneData.meshIndexData.setName("SceneCacheTest::meshIndexData");
+    sceneData.has32BitIndices = true;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> u;
+
+    for (uint32_t meshIndex = 0; meshIndex < meshVertexCounts.size(); ++meshIndex)
+    {
+        uint32_t vertexCount = meshVertexCounts[meshIndex];
+        std::vector<PackedStaticVertexData> vertices(vertexCount);
+        std::vector<uint32_t> indices(vertexCount * 3);
+        for (auto& v : vertices)
+        {
+            v.position = float3(u(rng), u(rng), u(rng));
+            v.packedNormalTangentCurveRadius = float3(u(rng), u(rng), u(rng));
+            v.texCrd = float2(u(rng), u(rng));
+        }
+        for (auto& i : indices)
+            i = rng() % vertexCount;
+
+        MeshDesc meshDesc = {};
+        meshDesc.vbOffset = sceneData.meshStaticData.insert(vertices.begin(), vertices.end());
+        meshDesc.ibOffset = sceneData.meshIndexData.insert(indices.begin(), indices.end());
+        meshDesc.vertexCount = vertexCount;
+        meshDesc.indexCount = (uint32_t)indices.size();
+        sceneData.meshDesc.push_back(meshDesc);
+        sceneData.meshNames.push_back(fmt::format("mesh{}", meshIndex));
+        sceneData.meshBBs.push_back(AABB(float3(0.f), float3(1.f)));
+    }
+    sceneData.meshDrawCount = (uint32_t)meshVertexCounts.size();
+
+    return sceneData;
+}
+
+SceneCache::Key getTestKey(const std::string& name)
+{
+    SHA1 sha1;
+    sha1.update(name.data(), name.size());
+    return sha1.finalize();
+}
+
+void testRoundTrip(GPUUnitTestContext& ctx, SceneCache::Format format)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Use a mix of small meshes (kept inline in the metadata) and large meshes (stored in separate sections).
+    Scene::SceneData sceneData = createSceneData(pDevice, {16, 50000, 32, 100000});
+
+    auto key = getTestKey(fmt::format("SceneCacheTest_{}", (int)format));
+    SceneCache::writeCache(sceneData, key, {}, format);
+    EXPECT(SceneCache::hasValidCache(key));
+
+    Scene::SceneData loaded = SceneCache::readCache(pDevice, key);
+    std::filesystem::remove(SceneCache::getCachePath(key));
+
+    ASSERT_EQ(loaded.meshDesc.size(), sceneData.meshDesc.size());
+    for (size_t i = 0; i < sceneData.meshDesc.size(); ++i)
+    {
+        EXPECT_EQ(loaded.meshDesc[i].vbOffset, sceneData.meshDesc[i].vbOffset);
+        EXPECT_EQ(loaded.meshDesc[i].ibOffset, sceneData.meshDesc[i].ibOffset);
+    }
+    EXPECT(loaded.meshNames == sceneData.meshNames);
+    EXPECT_EQ(loaded.meshDrawCount, sceneData.meshDrawCount);
+    EXPECT_EQ(loaded.meshStaticData.getByteSize(), sceneData.meshStaticData.getByteSize());
+    EXPECT_EQ(loaded.meshIndexData.getByteSize(), sceneData.meshIndexData.getByteSize());
+
+    ASSERT_EQ(loaded.meshIndexData.getBufferCount(), sceneData.meshIndexData.getBufferCount());
+    for (uint32_t i = 0; i < sceneData.meshIndexData.getBufferCount(); ++i)
+    {
+        const auto& a = loaded.meshIndexData.getCpuBuffer(i);
+        const auto& b = sceneData.meshIndexData.getCpuBuffer(i);
+        ASSERT_EQ(a.size(), b.size());
+        EXPECT(std::memcmp(a.data(), b.data(), a.size() * sizeof(uint32_t)) == 0);
+    }
+    ASSERT_EQ(loaded.meshStaticData.getBufferCount(), sceneData.meshStaticData.getBufferCount());
+    for (uint32_t i = 0; i < sceneData.meshStaticData.getBufferCount(); ++i)
+    {
+        const auto& a = loaded.meshStaticData.getCpuBuffer(i);
+        const auto& b = sceneData.meshStaticData.getCpuBuffer(i);
+        ASSERT_EQ(a.size(), b.size());
+        EXPECT(std::memcmp(a.data(), b.data(), a.size() * sizeof(PackedStaticVertexData)) == 0);
+    }
+}
+} // namespace
+
+CPU_TEST(SceneCache_Dependency)
+{
+    const std::filesystem::path path = std::filesystem::absolute("test_scene_cache_dependency.txt");
+    auto writeFile = [&](const std::string& content)
+    {
+        std::ofstream fs(path, std::ios_base::binary);
+        fs << content;
+    };
+
+    writeFile("abcd");
+    auto dependency = SceneCache::Dependency::create(path, false);
+    auto hashedDependency = SceneCache::Dependency::create(path, true);
+    EXPECT_EQ(dependency.size, 4);
+    EXPECT(!dependency.hash.has_value());
+    EXPECT(hashedDependency.hash.has_value());
+    EXPECT(dependency.isUpToDate());
+    EXPECT(hashedDependency.isUpToDate());
+
+    // Touching the file invalidates records without hash only.
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(10));
+    EXPECT(!dependency.isUpToDate());
+    EXPECT(hashedDependency.isUpToDate());
+
+    // Changing the contents invalidates both.
+    writeFile("abce");
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(20));
+    EXPECT(!dependency.isUpToDate());
+    EXPECT(!hashedDependency.isUpToDate());
+
+    // Removing the file invalidates both.
+    std::filesystem::remove(path);
+    EXPECT(!dependency.isUpToDate());
+    EXPECT(!hashedDependency.isUpToDate());
+}
+
+GPU_TEST(SceneCache_StreamRoundTrip)
+{
+    testRoundTrip(ctx, SceneCache::Format::Stream);
+}
+
+GPU_TEST(SceneCache_MappedRoundTrip)
+{
+    testRoundTrip(ctx, SceneCache::Format::Mapped);
+}
+
+GPU_TEST(SceneCache_LoadBenchmark, TAGS("benchmark"))
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Roughly 1.5 GB of vertex and index data.
+    Scene::SceneData sceneData = createSceneData(pDevice, std::vector<uint32_t>(256, 131072));
+    const uint32_t kIterations = 3;
+
+    for (auto format : {SceneCache::Format::Stream, SceneCache::Format::Mapped})
+    {
+        auto key = getTestKey(fmt::format("SceneCacheBenchmark_{}", (int)format));
+
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        SceneCache::writeCache(sceneData, key, {}, format);
+        auto t1 = CpuTimer::getCurrentTimePoint();
+
+        double readTime = 0.0;
+        for (uint32_t i = 0; i < kIterations; ++i)
+        {
+            auto t2 = CpuTimer::getCurrentTimePoint();
+            Scene::SceneData loaded = SceneCache::readCache(pDevice, key);
+            readTime += CpuTimer::calcDuration(t2, CpuTimer::getCurrentTimePoint());
+            EXPECT_EQ(loaded.meshDesc.size(), sceneData.meshDesc.size());
+        }
+
+        auto cachePath = SceneCache::getCachePath(key);
+        logInfo(
+            "SceneCache {} format: file size {:.1f} MB, write {:.1f} ms, read {:.1f} ms (average of {} runs).",
+            format == SceneCache::Format::Mapped ? "mapped" : "stream",
+            std::filesystem::file_size(cachePath) / (1024.0 * 1024.0),
+            CpuTimer::calcDuration(t0, t1),
+            readTime / kIterations,
+            kIterations
+        );
+        std::filesystem::remove(cachePath);
+    }
+}
+} // namespace Falcor
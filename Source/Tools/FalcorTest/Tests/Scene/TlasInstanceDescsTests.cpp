@@ -0,0 +1,198 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/TlasInstanceDescs.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+float4x4 createTransform(uint32_t i, float t)
+{
+    return math::matrixFromTranslation(float3(float(i), t, 0.f));
+}
+
+bool hasTransform(const RtInstanceDesc& desc, const float4x4& transform)
+{
+    RtInstanceDesc expected = {};
+    expected.setTransform(transform);
+    return std::memcmp(desc.transform, expected.transform, sizeof(desc.transform)) == 0;
+}
+} // namespace
+
+CPU_TEST(TlasInstanceDescs_UpdateTransforms)
+{
+    // 100 instance descs, every other one static. Dynamic ones use matrix (i / 2).
+    const uint32_t kCount = 100;
+    std::vector<float4x4> globalMatrices(kCount / 2);
+    std::vector<uint8_t> matricesChanged(kCount / 2, 0);
+    for (uint32_t i = 0; i < globalMatrices.size(); ++i)
+        globalMatrices[i] = createTransform(i, 0.f);
+
+    TlasInstanceDescs descs;
+    descs.clear();
+    for (uint32_t i = 0; i < kCount; ++i)
+    {
+        RtInstanceDesc desc = {};
+        desc.instanceID = i;
+        bool isStatic = (i % 2) == 0;
+        desc.setTransform(isStatic ? float4x4::identity() : globalMatrices[i / 2]);
+        descs.add(desc, isStatic ? TlasInstanceDescs::kStaticTransform : i / 2);
+    }
+    EXPECT_EQ(descs.getCount(), kCount);
+    EXPECT(descs.isAllDirty());
+    ASSERT_EQ(descs.getDirtyRanges().size(), 1);
+    EXPECT_EQ(descs.getDirtyRanges()[0].offset, 0);
+    EXPECT_EQ(descs.getDirtyRanges()[0].count, kCount);
+
+    // Nothing changed.
+    descs.clearDirty();
+    EXPECT_EQ(descs.updateTransforms(globalMatrices, matricesChanged), 0);
+    EXPECT(descs.getDirtyRanges().empty());
+
+    // Change two nearby matrices and one far away. Nearby ones are merged into one range.
+    for (uint32_t m : {2u, 4u, 40u})
+    {
+        globalMatrices[m] = createTransform(m, 1.f);
+        matricesChanged[m] = 1;
+    }
+    EXPECT_EQ(descs.updateTransforms(globalMatrices, matricesChanged), 3);
+    EXPECT(!descs.isAllDirty());
+    const auto& ranges = descs.getDirtyRanges();
+    ASSERT_EQ(ranges.size(), 2);
+    EXPECT_EQ(ranges[0].offset, 5);
+    EXPECT_EQ(ranges[0].count, 5);
+    EXPECT_EQ(ranges[1].offset, 81);
+    EXPECT_EQ(ranges[1].count, 1);
+
+    for (uint32_t i = 0; i < kCount; ++i)
+    {
+        bool isStatic = (i % 2) == 0;
+        EXPECT(hasTransform(descs.getDescs()[i], isStatic ? float4x4::identity() : globalMatrices[i / 2])) << "desc " << i;
+        EXPECT_EQ(descs.getDescs()[i].instanceID, i);
+    }
+
+    // Ranges accumulate over updates until cleared.
+    std::fill(matricesChanged.begin(), matricesChanged.end(), 0);
+    matricesChanged[0] = 1;
+    EXPECT_EQ(descs.updateTransforms(globalMatrices, matricesChanged), 1);
+    ASSERT_EQ(descs.getDirtyRanges().size(), 2);
+    EXPECT_EQ(descs.getDirtyRanges()[0].offset, 1);
+    EXPECT_EQ(descs.getDirtyRanges()[0].count, 9);
+
+    descs.clearDirty();
+    EXPECT(descs.getDirtyRanges().empty());
+}
+
+CPU_TEST(TlasInstanceDescs_Benchmark, TAGS("benchmark"))
+{
+    // 500k instances, compared against regenerating all instance descs every frame.
+    const uint32_t kCount = 500000;
+    const uint32_t kFrames = 20;
+    std::vector<float4x4> globalMatrices(kCount);
+    for (uint32_t i = 0; i < kCount; ++i)
+        globalMatrices[i] = createTransform(i, 0.f);
+
+    struct Case
+    {
+        const char* name;
+        uint32_t animatedCount;
+    };
+    const Case kCases[] = {{"static", 0}, {"sparse", 100}, {"animated", kCount}};
+
+    std::mt19937 rng(0);
+    for (const auto& c : kCases)
+    {
+        std::vector<uint8_t> matricesChanged(kCount, 0);
+        std::vector<uint32_t> animated(kCount);
+        for (uint32_t i = 0; i < kCount; ++i)
+            animated[i] = i;
+        std::shuffle(animated.begin(), animated.end(), rng);
+        animated.resize(c.animatedCount);
+        for (uint32_t i : animated)
+            matricesChanged[i] = 1;
+
+        TlasInstanceDescs descs;
+        descs.clear();
+        for (uint32_t i = 0; i < kCount; ++i)
+        {
+            RtInstanceDesc desc = {};
+            desc.instanceID = i;
+            desc.instanceMask = 0xFF;
+            desc.setTransform(globalMatrices[i]);
+            descs.add(desc, i);
+        }
+        descs.clearDirty();
+
+        std::vector<RtInstanceDesc> fullDescs;
+        double fullTime = 0.0;
+        double incrementalTime = 0.0;
+        size_t uploadedCount = 0;
+        for (uint32_t frame = 0; frame < kFrames; ++frame)
+        {
+            for (uint32_t i : animated)
+                globalMatrices[i] = createTransform(i, float(frame));
+
+            // Regenerate and upload everything.
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            fullDescs.clear();
+            for (uint32_t i = 0; i < kCount; ++i)
+            {
+                RtInstanceDesc desc = {};
+                desc.instanceID = i;
+                desc.instanceMask = 0xFF;
+                desc.setTransform(globalMatrices[i]);
+                fullDescs.push_back(desc);
+            }
+            fullTime += CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+
+            // Update the transforms of changed instances and collect the dirty ranges.
+            t0 = CpuTimer::getCurrentTimePoint();
+            descs.updateTransforms(globalMatrices, matricesChanged);
+            for (const auto& range : descs.getDirtyRanges())
+                uploadedCount += range.count;
+            descs.clearDirty();
+            incrementalTime += CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        }
+        EXPECT(std::memcmp(fullDescs.data(), descs.getDescs().data(), kCount * sizeof(RtInstanceDesc)) == 0);
+
+        logInfo(
+            "TLAS instance descs, {} instances, {} animated: full {:.3f} ms, incremental {:.3f} ms, {:.1f} KB uploaded (per frame).",
+            kCount,
+            c.animatedCount,
+            fullTime / kFrames,
+            incrementalTime / kFrames,
+            uploadedCount * sizeof(RtInstanceDesc) / 1024.0 / kFrames
+        );
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,222 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+
+#include <fstream>
+#include <string>
+
+namespace Falcor
+{
+namespace
+{
+const SceneBuilder::Flags kFlags = SceneBuilder::Flags::DontMergeMeshes | SceneBuilder::Flags::DontOptimizeGraph;
+
+const char kTriangle[] = R"(
+        def Mesh "Tri"
+        {
+            int[] faceVertexCounts = [3]
+            int[] faceVertexIndices = [0, 1, 2]
+            point3f[] points = [(0, 0, 0), (1, 0, 0), (0, 1, 0)]
+        })";
+
+/// Create a stage with static, nested and animated prototypes, each instanced with and without an animated instance transform.
+std::string createInstancingStage()
+{
+    std::string str = R"(#usda 1.0
+(
+    defaultPrim = "World"
+    startTimeCode = 0
+    endTimeCode = 24
+    timeCodesPerSecond = 24
+    upAxis = "Y"
+)
+)";
+    // Static prototype.
+    str += "class Xform \"InnerSrc\"\n{";
+    str += kTriangle;
+    str += "\n}\n";
+
+    // Static prototype with a child transform and a nested static prototype instance.
+    str += "class Xform \"OuterSrc\"\n{";
+    str += kTriangle;
+    str += R"(
+    def Xform "Child"
+    {
+        double3 xformOp:translate = (0, 2, 0)
+        uniform token[] xformOpOrder = ["xformOp:translate"])";
+    str += kTriangle;
+    str += R"(
+    }
+    def Xform "Nested" (
+        instanceable = true
+        prepend references = </InnerSrc>
+    )
+    {
+        double3 xformOp:translate = (3, 0, 0)
+        double3 xformOp:scale = (2, 2, 2)
+        uniform token[] xformOpOrder = ["xformOp:translate", "xformOp:scale"]
+    }
+}
+)";
+
+    // Prototype with an animated node.
+    str += R"(class Xform "AnimatedSrc"
+{
+    def Xform "Moving"
+    {
+        double3 xformOp:translate.timeSamples = { 0: (0, 0, 0), 24: (0, 0, 5) }
+        uniform token[] xformOpOrder = ["xformOp:translate"])";
+    str += kTriangle;
+    str += R"(
+    }
+}
+)";
+
+    // Prototype with an animated nested prototype instance.
+    str += "class Xform \"NestedAnimatedSrc\"\n{";
+    str += kTriangle;
+    str += R"(
+    def Xform "Nested" (
+        instanceable = true
+        prepend references = </InnerSrc>
+    )
+    {
+        double3 xformOp:translate.timeSamples = { 0: (0, 0, 0), 24: (4, 0, 0) }
+        uniform token[] xformOpOrder = ["xformOp:translate"]
+    }
+}
+)";
+
+    // Instances.
+    str += "def Xform \"World\"\n{\n";
+    auto addInstance = [&](const char* name, const char* proto, const char* xform)
+    {
+        fmt::format_to(
+            std::back_inserter(str),
+            "    def Xform \"{}\" (\n        instanceable = true\n        prepend references = </{}>\n    )\n    {{\n        {}\n"
+            "        uniform token[] xformOpOrder = [\"xformOp:translate\"]\n    }}\n",
+            name,
+            proto,
+            xform
+        );
+    };
+    addInstance("A", "OuterSrc", "double3 xformOp:translate = (10, 0, 0)");
+    addInstance("B", "OuterSrc", "double3 xformOp:translate.timeSamples = { 0: (0, 0, 0), 24: (0, 10, 0) }");
+    addInstance("C", "AnimatedSrc", "double3 xformOp:translate = (0, 0, 0)");
+    addInstance("D", "AnimatedSrc", "double3 xformOp:translate.timeSamples = { 0: (-10, 0, 0), 24: (-10, 5, 0) }");
+    addInstance("E", "NestedAnimatedSrc", "double3 xformOp:translate = (0, -10, 0)");
+    str += "}\n";
+    return str;
+}
+
+struct InstanceTransform
+{
+    uint32_t geometryID;
+    float4x4 transform;
+};
+
+/// Returns the world transform of all geometry instances at the given time.
+std::vector<InstanceTransform> getInstanceTransforms(RenderContext* pRenderContext, const ref<Scene>& pScene, double time)
+{
+    pScene->update(pRenderContext, time);
+    const auto& globalMatrices = pScene->getAnimationController()->getGlobalMatrices();
+    std::vector<InstanceTransform> transforms;
+    for (uint32_t i = 0; i < pScene->getGeometryInstanceCount(); ++i)
+    {
+        const auto& instance = pScene->getGeometryInstance(i);
+        transforms.push_back({instance.geometryID, globalMatrices[instance.globalMatrixID]});
+    }
+    return transforms;
+}
+
+bool almostEqual(const float4x4& a, const float4x4& b, float epsilon = 1e-4f)
+{
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c)
+            if (std::abs(a[r][c] - b[r][c]) > epsilon)
+                return false;
+    return true;
+}
+} // namespace
+
+GPU_TEST(USDImporter_FlattenedPrototypes)
+{
+    PluginManager::instance().loadPluginByName("USDImporter");
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "USDImporter";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path path = directory / "instancing.usda";
+    {
+        std::string str = createInstancingStage();
+        std::ofstream file(path, std::ios::binary);
+        file.write(str.data(), str.size());
+    }
+
+    // Import with flattened prototypes and with replicated prototype subgraphs.
+    ref<Scene> pScenes[2];
+    uint32_t nodeCounts[2];
+    for (size_t i = 0; i < 2; ++i)
+    {
+        Settings settings;
+        settings.addOptions(nlohmann::json{{"usdImporter:flattenPrototypes", i == 0}});
+        SceneBuilder builder(ctx.getDevice(), path, settings, kFlags);
+        nodeCounts[i] = builder.getNodeCount();
+        pScenes[i] = builder.getScene();
+        ASSERT(pScenes[i] != nullptr);
+    }
+
+    // Flattening saves the nodes of the static prototype subgraphs.
+    EXPECT_LT(nodeCounts[0], nodeCounts[1]);
+
+    // Both imports must place the same geometry at the same transforms, including animated instances and prototypes.
+    for (double time : {0.0, 0.5, 1.0})
+    {
+        auto flattened = getInstanceTransforms(ctx.getRenderContext(), pScenes[0], time);
+        auto replicated = getInstanceTransforms(ctx.getRenderContext(), pScenes[1], time);
+        EXPECT_EQ(flattened.size(), 10);
+        ASSERT_EQ(flattened.size(), replicated.size());
+
+        std::vector<bool> matched(replicated.size(), false);
+        for (const auto& a : flattened)
+        {
+            bool found = false;
+            for (size_t j = 0; j < replicated.size() && !found; ++j)
+            {
+                const auto& b = replicated[j];
+                if (!matched[j] && a.geometryID == b.geometryID && almostEqual(a.transform, b.transform))
+                    matched[j] = found = true;
+            }
+            EXPECT(found) << "geometry " << a.geometryID << " at time " << time;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
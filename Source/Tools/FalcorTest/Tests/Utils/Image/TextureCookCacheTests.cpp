@@ -0,0 +1,167 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureCookCache.h"
+#include "Utils/Image/TextureManager.h"
+#include <fstream>
+
+namespace Falcor
+{
+CPU_TEST(TextureCookCache_SelectCompressionMode)
+{
+    using CompressionMode = ImageIO::CompressionMode;
+
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::RGBA8Unorm, 64, 64, CompressionMode::BC7) == CompressionMode::BC7);
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::RGBA8Unorm, 64, 64, CompressionMode::BC5) == CompressionMode::BC5);
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::RGBA8Unorm, 64, 64, CompressionMode::None) == CompressionMode::None);
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::R8Unorm, 64, 64, CompressionMode::BC7) == CompressionMode::BC4);
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::RG8Unorm, 64, 64, CompressionMode::BC7) == CompressionMode::BC5);
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::RGBA16Float, 64, 64, CompressionMode::BC7) == CompressionMode::BC6);
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::RGBA32Float, 64, 64, CompressionMode::BC5) == CompressionMode::BC5);
+
+    // Dimensions that are not a multiple of 4 can't be compressed without cropping.
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::RGBA8Unorm, 66, 64, CompressionMode::BC7) == CompressionMode::None);
+    EXPECT(TextureCookCache::selectCompressionMode(ResourceFormat::RGBA8Unorm, 64, 2, CompressionMode::BC7) == CompressionMode::None);
+}
+
+CPU_TEST(TextureCookCache_ComputeKey)
+{
+    const std::string dataA = "image data";
+    const std::string dataB = "other image data";
+
+    TextureCookCache::CookParams params;
+    std::string key = TextureCookCache::computeKey(dataA.data(), dataA.size(), params);
+    EXPECT_EQ(key.size(), 40);
+
+    // Keys depend on the content only, and change with the content and the cook parameters.
+    EXPECT_EQ(key, TextureCookCache::computeKey(std::string(dataA).data(), dataA.size(), params));
+    EXPECT_NE(key, TextureCookCache::computeKey(dataB.data(), dataB.size(), params));
+
+    TextureCookCache::CookParams srgbParams = params;
+    srgbParams.loadAsSRGB = true;
+    EXPECT_NE(key, TextureCookCache::computeKey(dataA.data(), dataA.size(), srgbParams));
+
+    TextureCookCache::CookParams bc7Params = params;
+    bc7Params.compression = ImageIO::CompressionMode::BC7;
+    EXPECT_NE(key, TextureCookCache::computeKey(dataA.data(), dataA.size(), bc7Params));
+}
+
+CPU_TEST(TextureCookCache_SourceModified)
+{
+    std::filesystem::path cacheDirectory = std::filesystem::temp_directory_path() / "FalcorTest" / "TextureCookCacheSource";
+    std::filesystem::remove_all(cacheDirectory);
+    std::filesystem::create_directories(cacheDirectory);
+
+    std::filesystem::path path = cacheDirectory / "source.png";
+    std::filesystem::copy_file(getRuntimeDirectory() / "data/tests/tiny_mip0.png", path);
+
+    TextureCookCache::CookParams params;
+    params.compression = ImageIO::CompressionMode::BC7;
+
+    {
+        TextureCookCache cookCache(cacheDirectory);
+        EXPECT(cookCache.lookup(path, params).empty());
+        cookCache.waitForCooking();
+        EXPECT_EQ(cookCache.getStats().cookedCount, 1);
+
+        // Repeated lookups of the unmodified file hit the cache.
+        EXPECT(!cookCache.lookup(path, params).empty());
+        EXPECT(!cookCache.lookup(path, params).empty());
+        EXPECT_EQ(cookCache.getStats().hitCount, 2);
+
+        // Modifying the file invalidates the remembered content hash.
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << "not an image";
+        }
+        EXPECT(cookCache.lookup(path, params).empty());
+        cookCache.waitForCooking();
+        auto stats = cookCache.getStats();
+        EXPECT_EQ(stats.hitCount, 2);
+        EXPECT_EQ(stats.missCount, 2);
+        EXPECT_EQ(stats.failedCount, 1);
+    }
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+GPU_TEST(TextureCookCache_TextureManager)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::filesystem::path cacheDirectory = std::filesystem::temp_directory_path() / "FalcorTest" / "TextureCookCache";
+    std::filesystem::remove_all(cacheDirectory);
+
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/tiny_mip0.png";
+    auto pCookCache = std::make_shared<TextureCookCache>(cacheDirectory);
+
+    auto loadTexture = [&]()
+    {
+        TextureManager textureManager(pDevice, 10);
+        textureManager.setCookCache(pCookCache);
+        auto handle = textureManager.loadTexture(
+            path,
+            true,
+            true,
+            ResourceBindFlags::ShaderResource,
+            false,
+            Bitmap::ImportFlags::None,
+            nullptr,
+            nullptr,
+            nullptr,
+            ImageIO::CompressionMode::BC7
+        );
+        return textureManager.getTexture(handle);
+    };
+
+    // The first load misses the cache, loads the source image and schedules cooking.
+    ref<Texture> pTexture = loadTexture();
+    ASSERT(pTexture != nullptr);
+    EXPECT(!isCompressedFormat(pTexture->getFormat()));
+
+    pCookCache->waitForCooking();
+    auto stats = pCookCache->getStats();
+    EXPECT_EQ(stats.missCount, 1);
+    EXPECT_EQ(stats.cookedCount, 1);
+    EXPECT_EQ(stats.failedCount, 0);
+    EXPECT_EQ(stats.pendingCount, 0);
+
+    // The second load uses the cooked texture.
+    pTexture = loadTexture();
+    ASSERT(pTexture != nullptr);
+    EXPECT(pTexture->getFormat() == ResourceFormat::BC7UnormSrgb);
+    EXPECT_EQ(pTexture->getWidth(), 4);
+    EXPECT_EQ(pTexture->getHeight(), 4);
+    EXPECT_EQ(pTexture->getMipCount(), 3);
+    EXPECT(pTexture->getSourcePath() == path);
+    EXPECT_EQ(pCookCache->getStats().hitCount, 1);
+
+    pCookCache.reset();
+    std::filesystem::remove_all(cacheDirectory);
+}
+} // namespace Falcor
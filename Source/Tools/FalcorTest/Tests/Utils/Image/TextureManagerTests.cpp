@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureManager.h"
+#include "Utils/Timing/Profiler.h"
 
 namespace Falcor
 {
@@ -51,4 +52,178 @@ GPU_TEST(TextureManager_LoadMips)
     EXPECT_EQ(tex->getMipCount(), 3);
     EXPECT_EQ(tex->getArraySize(), 1);
 }
+
+GPU_TEST(TextureManager_LoadAsync)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10);
+
+    Profiler* pProfiler = pDevice->getProfiler();
+    bool profilerEnabled = pProfiler->isEnabled();
+    pProfiler->setEnabled(true);
+
+    // Async loads are decoded in the background and uploaded when waiting for them.
+    auto handle0 = textureManager.loadTexture(getRuntimeDirectory() / "data/tests/tiny_mip0.png", false, false);
+    auto handle1 = textureManager.loadTexture(getRuntimeDirectory() / "data/tests/tiny_mip1.png", false, false);
+    ASSERT(handle0.isValid() && handle1.isValid());
+    textureManager.setTexturePriority(handle1, 1);
+
+    textureManager.waitForAllTexturesLoading();
+    auto tex0 = textureManager.getTexture(handle0);
+    auto tex1 = textureManager.getTexture(handle1);
+    ASSERT(tex0 != nullptr && tex1 != nullptr);
+    EXPECT_EQ(tex0->getWidth(), 4);
+    EXPECT_EQ(tex1->getWidth(), 2);
+
+    auto stats = textureManager.getStats().loaderStats;
+    EXPECT_EQ(stats.requestCount, 2);
+    EXPECT_EQ(stats.loadedCount, 2);
+    EXPECT_EQ(stats.pendingCount, 0);
+    EXPECT_GT(stats.decodedBytes, 0);
+    EXPECT_GT(stats.uploadedBytes, 0);
+
+    // Decoding on the worker threads and uploading are profiled.
+    pProfiler->endFrame(ctx.getRenderContext());
+    EXPECT(pProfiler->getEvent("/AsyncTextureLoader::decode") != nullptr);
+    EXPECT(pProfiler->getEvent("/AsyncTextureLoader::upload") != nullptr);
+    pProfiler->setEnabled(profilerEnabled);
+}
+
+GPU_TEST(TextureManager_Streaming)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10);
+
+    TextureManager::StreamingOptions options;
+    options.enabled = true;
+    options.tailSize = 1;
+    textureManager.setStreamingOptions(options);
+
+    // The 4x4 texture is initially resident at its 1x1 tail mip.
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/tiny_mip0.png";
+    auto handle = textureManager.loadTexture(path, true, false, ResourceBindFlags::ShaderResource, false);
+    ASSERT(handle.isValid());
+
+    auto tex = textureManager.getTexture(handle);
+    ASSERT(tex != nullptr);
+    EXPECT_EQ(tex->getWidth(), 1);
+    EXPECT_EQ(tex->getMipCount(), 1);
+    EXPECT_EQ(textureManager.getStats().streamedTextureCount, 1);
+    EXPECT_EQ(textureManager.getStats().streamingPendingRequestCount, 1);
+
+    // All missing mips are loaded in the background by one load, and swapped in by the next update.
+    EXPECT(!textureManager.updateStreaming());
+    EXPECT_EQ(textureManager.getTexture(handle)->getWidth(), 1);
+    textureManager.waitForStreamingLoads();
+    EXPECT(textureManager.updateStreaming());
+    EXPECT(!textureManager.updateStreaming());
+
+    tex = textureManager.getTexture(handle);
+    EXPECT_EQ(tex->getWidth(), 4);
+    EXPECT_EQ(tex->getHeight(), 4);
+    EXPECT_EQ(tex->getMipCount(), 3);
+
+    uint64_t texelSize = getFormatBytesPerBlock(tex->getFormat());
+    auto stats = textureManager.getStats();
+    EXPECT_EQ(stats.streamingResidentBytes, 21 * texelSize);
+    EXPECT_EQ(stats.streamingPendingRequestCount, 0);
+    EXPECT_EQ(stats.streamingEvictionCount, 0);
+
+    // Lowering the budget evicts the most detailed mip.
+    options.budgetInBytes = 5 * texelSize;
+    textureManager.setStreamingOptions(options);
+    EXPECT(textureManager.updateStreaming());
+    EXPECT_EQ(textureManager.getTexture(handle)->getWidth(), 2);
+
+    stats = textureManager.getStats();
+    EXPECT_EQ(stats.streamingResidentBytes, 5 * texelSize);
+    EXPECT_EQ(stats.streamingPendingRequestCount, 1);
+    EXPECT_EQ(stats.streamingEvictionCount, 1);
+
+    // A texture covering 2 pixels on screen only wants its 2x2 mip, which is resident.
+    options.screenHeight = 8;
+    textureManager.setStreamingOptions(options);
+    textureManager.markTexturesUsed({{textureManager.getTexture(handle).get(), 0.25f}});
+    EXPECT_EQ(textureManager.getStats().streamingPendingRequestCount, 0);
+
+    // Removing a texture discards its mip load in flight.
+    options.budgetInBytes = 21 * texelSize;
+    textureManager.setStreamingOptions(options);
+    textureManager.markTextureUsed(handle);
+    EXPECT(!textureManager.updateStreaming());
+    textureManager.removeTexture(handle);
+    EXPECT_EQ(textureManager.getStats().streamedTextureCount, 0);
+    textureManager.waitForStreamingLoads();
+    EXPECT(!textureManager.updateStreaming());
+}
+
+GPU_TEST(TextureManager_Deduplication)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "TextureManagerDeduplication";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    // Byte-identical copy of a texture.
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/tiny_mip0.png";
+    std::filesystem::copy_file(path, directory / "copy.png");
+
+    // Two encodings of the same image.
+    std::vector<uint8_t> pixels(4 * 4 * 4);
+    for (size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = uint8_t(i * 7);
+    using ExportFlags = Bitmap::ExportFlags;
+    Bitmap::saveImage(
+        directory / "a.png", 4, 4, Bitmap::FileFormat::PngFile, ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, pixels.data()
+    );
+    Bitmap::saveImage(
+        directory / "b.png",
+        4,
+        4,
+        Bitmap::FileFormat::PngFile,
+        ExportFlags::ExportAlpha | ExportFlags::Uncompressed,
+        ResourceFormat::RGBA8Unorm,
+        true,
+        pixels.data()
+    );
+
+    TextureManager textureManager(pDevice, 3);
+    textureManager.setDeduplicationEnabled(true);
+
+    auto load = [&](const std::filesystem::path& p)
+    { return textureManager.loadTexture(p, false, false, ResourceBindFlags::ShaderResource, false); };
+
+    auto handle = load(path);
+    auto copyHandle = load(directory / "copy.png");
+    EXPECT(handle.isValid());
+    EXPECT(copyHandle == handle);
+
+    auto aHandle = load(directory / "a.png");
+    auto bHandle = load(directory / "b.png");
+    EXPECT(aHandle.isValid());
+    EXPECT(!(aHandle == handle));
+    EXPECT(bHandle == aHandle);
+
+    // Different content gets its own handle, within the descriptor budget of 3.
+    auto otherHandle = load(getRuntimeDirectory() / "data/tests/tiny_mip1.png");
+    EXPECT(otherHandle.isValid());
+    EXPECT(!(otherHandle == handle) && !(otherHandle == aHandle));
+    EXPECT_EQ(textureManager.getTextureDescCount(), 3);
+
+    auto stats = textureManager.getStats();
+    EXPECT_EQ(stats.textureCount, 3);
+    EXPECT_EQ(stats.dedupedTextureCount, 2);
+    EXPECT_EQ(
+        stats.dedupedMemoryInBytes,
+        textureManager.getTexture(handle)->getTextureSizeInBytes() + textureManager.getTexture(aHandle)->getTextureSizeInBytes()
+    );
+
+    textureManager.removeTexture(handle);
+    EXPECT_EQ(textureManager.getStats().dedupedTextureCount, 1);
+
+    std::filesystem::remove_all(directory);
+}
 } // namespace Falcor
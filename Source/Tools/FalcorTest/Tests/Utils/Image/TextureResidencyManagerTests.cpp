@@ -0,0 +1,140 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureResidencyManager.h"
+
+namespace Falcor
+{
+namespace
+{
+// Mip sizes of an 8x8 texture with one byte per texel.
+const std::vector<uint64_t> kMipSizes = {64, 16, 4, 1};
+const uint32_t kTailMip = 2;
+const uint64_t kTailBytes = 5;
+
+void runUpdates(TextureResidencyManager& manager, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto update = manager.update(4);
+        for (const auto& load : update.loads)
+            manager.completeLoad(load.textureID, load.mip);
+    }
+}
+} // namespace
+
+CPU_TEST(TextureResidencyManager_Load)
+{
+    TextureResidencyManager manager(1000);
+    manager.addTexture(0, kMipSizes, kTailMip);
+    EXPECT_EQ(manager.getResidentMip(0), kTailMip);
+    EXPECT_EQ(manager.getStats().residentBytes, kTailBytes);
+    EXPECT_EQ(manager.getStats().pendingRequestCount, 1);
+
+    // All mips down to the wanted mip are loaded at once.
+    auto update = manager.update(4);
+    ASSERT_EQ(update.loads.size(), 1);
+    EXPECT_EQ(update.loads[0].mip, 0);
+    EXPECT_EQ(manager.getStats().pendingBytes, 80);
+    EXPECT(manager.update(4).empty());
+    manager.completeLoad(0, 0);
+    EXPECT_EQ(manager.getResidentMip(0), 0);
+    EXPECT_EQ(manager.getStats().residentBytes, 85);
+    EXPECT_EQ(manager.getStats().pendingBytes, 0);
+    EXPECT_EQ(manager.getStats().pendingRequestCount, 0);
+    EXPECT_EQ(manager.getStats().loadCount, 1);
+    EXPECT_EQ(manager.getStats().evictionCount, 0);
+
+    // A coarser wanted mip loads only down to that mip.
+    manager.addTexture(1, kMipSizes, kTailMip);
+    manager.markUsed(1, 1);
+    update = manager.update(4);
+    ASSERT_EQ(update.loads.size(), 1);
+    EXPECT_EQ(update.loads[0].mip, 1);
+    EXPECT_EQ(manager.getStats().pendingBytes, 16);
+    manager.completeLoad(1, 1);
+    manager.removeTexture(1);
+
+    manager.removeTexture(0);
+    EXPECT_EQ(manager.getStats().residentBytes, 0);
+    EXPECT_EQ(manager.getResidentMip(0), TextureResidencyManager::kInvalidMip);
+}
+
+CPU_TEST(TextureResidencyManager_Priority)
+{
+    // Room for one full texture and mip 1 of another.
+    TextureResidencyManager manager(85 + kTailBytes + 16);
+    manager.addTexture(0, kMipSizes, kTailMip, 0);
+    manager.addTexture(1, kMipSizes, kTailMip, 1);
+
+    // The less important texture loads as many mips as fit.
+    runUpdates(manager, 4);
+    EXPECT_EQ(manager.getResidentMip(0), 1);
+    EXPECT_EQ(manager.getResidentMip(1), 0);
+    EXPECT_EQ(manager.getStats().evictionCount, 0);
+
+    // Raising the priority evicts the other texture's most detailed mip.
+    manager.setPriority(0, 2);
+    runUpdates(manager, 4);
+    EXPECT_EQ(manager.getResidentMip(0), 0);
+    EXPECT_EQ(manager.getResidentMip(1), 1);
+    EXPECT_EQ(manager.getStats().evictionCount, 1);
+    EXPECT_EQ(manager.getStats().pendingRequestCount, 1);
+    EXPECT_LE(manager.getStats().residentBytes, manager.getBudget());
+}
+
+CPU_TEST(TextureResidencyManager_LRU)
+{
+    TextureResidencyManager manager(85 + kTailBytes + 16);
+    manager.addTexture(0, kMipSizes, kTailMip);
+    manager.addTexture(1, kMipSizes, kTailMip);
+
+    // The most recently used texture wins at equal priority.
+    manager.update(0);
+    manager.markUsed(1);
+    runUpdates(manager, 4);
+    EXPECT_EQ(manager.getResidentMip(0), 1);
+    EXPECT_EQ(manager.getResidentMip(1), 0);
+
+    // Mips more detailed than wanted are evicted first.
+    manager.markUsed(1, kTailMip);
+    manager.markUsed(0);
+    runUpdates(manager, 4);
+    EXPECT_EQ(manager.getResidentMip(0), 0);
+    EXPECT_EQ(manager.getResidentMip(1), 1);
+
+    // Lowering the budget evicts down to the tail mips, which always stay resident.
+    manager.setBudget(kTailBytes);
+    auto update = manager.update(4);
+    EXPECT(update.loads.empty());
+    EXPECT_EQ(update.evictions.size(), 2);
+    EXPECT_EQ(manager.getResidentMip(0), kTailMip);
+    EXPECT_EQ(manager.getResidentMip(1), kTailMip);
+    EXPECT_EQ(manager.getStats().residentBytes, 2 * kTailBytes);
+}
+} // namespace Falcor
@@ -0,0 +1,168 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/JobSystem.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace Falcor
+{
+CPU_TEST(JobSystem_Execute)
+{
+    const size_t kJobCount = 10000;
+    std::atomic<size_t> counter = 0;
+    {
+        JobSystem jobSystem(8);
+        EXPECT_EQ(jobSystem.getThreadCount(), 8);
+        EXPECT(!jobSystem.isWorkerThread());
+        for (size_t i = 0; i < kJobCount; i++)
+            jobSystem.submit([&counter]() { counter++; });
+        // Help out from the calling thread until the queues are empty.
+        while (jobSystem.runPendingJob())
+            ;
+        // Destructor runs all remaining jobs before joining the threads.
+    }
+    EXPECT_EQ(counter.load(), kJobCount);
+}
+
+CPU_TEST(JobSystem_Priority)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool blocked = true;
+    std::vector<int32_t> order;
+    {
+        JobSystem jobSystem(1);
+
+        // Block the only worker so that all following jobs are queued before any of them run.
+        jobSystem.submit(
+            [&]()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]() { return !blocked; });
+            }
+        );
+
+        for (int32_t priority : {1, 5, -2, 3, 5})
+        {
+            jobSystem.submit([&order, priority]() { order.push_back(priority); }, priority);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            blocked = false;
+        }
+        condition.notify_all();
+    }
+    ASSERT_EQ(order.size(), 5);
+    EXPECT_EQ(order[0], 5);
+    EXPECT_EQ(order[1], 5);
+    EXPECT_EQ(order[2], 3);
+    EXPECT_EQ(order[3], 1);
+    EXPECT_EQ(order[4], -2);
+}
+
+CPU_TEST(JobSystem_PriorityAcrossQueues)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t startedCount = 0;
+    size_t releasedCount = 0;
+    std::vector<int32_t> order;
+    {
+        JobSystem jobSystem(2);
+
+        // Block both workers. Blockers are released in the order they started.
+        for (size_t i = 0; i < 2; i++)
+        {
+            jobSystem.submit(
+                [&]()
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    size_t index = startedCount++;
+                    condition.notify_all();
+                    condition.wait(lock, [&]() { return releasedCount > index; });
+                }
+            );
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() { return startedCount == 2; });
+        }
+
+        // Submissions from outside the job system are distributed round-robin, so both queues hold jobs.
+        for (int32_t priority : {1, 2, 3, 4, 5, 6})
+        {
+            jobSystem.submit(
+                [&, priority]()
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    order.push_back(priority);
+                    condition.notify_all();
+                },
+                priority
+            );
+        }
+
+        // Release one worker. It must run the jobs of both queues in priority order.
+        std::unique_lock<std::mutex> lock(mutex);
+        releasedCount = 1;
+        condition.notify_all();
+        condition.wait(lock, [&]() { return order.size() == 6; });
+        releasedCount = 2;
+        condition.notify_all();
+    }
+    ASSERT_EQ(order.size(), 6);
+    for (size_t i = 0; i < order.size(); i++)
+        EXPECT_EQ(order[i], 6 - (int32_t)i);
+}
+
+CPU_TEST(JobSystem_Nested)
+{
+    const size_t kJobCount = 64;
+    std::atomic<size_t> counter = 0;
+    {
+        JobSystem jobSystem(4);
+        for (size_t i = 0; i < kJobCount; i++)
+        {
+            jobSystem.submit(
+                [&]()
+                {
+                    // Jobs submitted from a worker go to the worker's own queue and may be stolen by others.
+                    for (size_t j = 0; j < kJobCount; j++)
+                        jobSystem.submit([&counter]() { counter++; });
+                }
+            );
+        }
+    }
+    EXPECT_EQ(counter.load(), kJobCount * kJobCount);
+}
+} // namespace Falcor
@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Argument counting how often it is formatted.
+struct CountedArg
+{
+    std::atomic<uint32_t>* pCount;
+};
+
+/// Restores the logger settings changed by a test.
+struct ScopedLoggerSettings
+{
+    Logger::Level verbosity = Logger::getVerbosity();
+    Logger::OutputFlags outputs = Logger::getOutputs();
+
+    ~ScopedLoggerSettings()
+    {
+        Logger::flush();
+        Logger::setVerbosity(verbosity);
+        Logger::setOutputs(outputs);
+    }
+};
+} // namespace
+} // namespace Falcor
+
+template<>
+struct fmt::formatter<Falcor::CountedArg> : formatter<uint32_t>
+{
+    template<typename FormatContext>
+    auto format(const Falcor::CountedArg& arg, FormatContext& ctx)
+    {
+        return formatter<uint32_t>::format(++*arg.pCount, ctx);
+    }
+};
+
+namespace Falcor
+{
+CPU_TEST(Logger_LazyFormatting)
+{
+    ScopedLoggerSettings settings;
+    Logger::setOutputs(Logger::OutputFlags::None);
+    Logger::setVerbosity(Logger::Level::Warning);
+
+    EXPECT(Logger::isEnabled(Logger::Level::Error));
+    EXPECT(Logger::isEnabled(Logger::Level::Warning));
+    EXPECT(!Logger::isEnabled(Logger::Level::Info));
+    EXPECT(!Logger::isEnabled(Logger::Level::Debug));
+
+    // Filtered messages must not be formatted.
+    std::atomic<uint32_t> count = 0;
+    logDebug("Debug {}", CountedArg{&count});
+    logInfo("Info {}", CountedArg{&count});
+    EXPECT_EQ(count.load(), 0);
+
+    logWarning("Warning {}", CountedArg{&count});
+    EXPECT_EQ(count.load(), 1);
+}
+
+CPU_TEST(Logger_RateLimit)
+{
+    ScopedLoggerSettings settings;
+    Logger::setOutputs(Logger::OutputFlags::None);
+    Logger::setVerbosity(Logger::Level::Info);
+
+    // Messages over the rate limit of the call site must not be formatted.
+    std::atomic<uint32_t> count = 0;
+    auto t0 = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < 1000; ++i)
+        logWarningLimited("Limited warning {}", CountedArg{&count});
+    double elapsed = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+
+    // The limit is per second, allow for a slow run crossing into the next period.
+    if (elapsed < 1000.0)
+        EXPECT_EQ(count.load(), 100);
+    EXPECT_GE(count.load(), 100);
+    EXPECT_LT(count.load(), 1000);
+}
+
+CPU_TEST(Logger_Threads)
+{
+    ScopedLoggerSettings settings;
+    Logger::setOutputs(Logger::OutputFlags::None);
+    Logger::setVerbosity(Logger::Level::Info);
+
+    // Log from multiple threads, exceeding the queue capacity.
+    const uint32_t kThreadCount = 4;
+    const uint32_t kMessageCount = 10000;
+    std::atomic<uint32_t> count = 0;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreadCount; ++t)
+    {
+        threads.emplace_back(
+            [&count]()
+            {
+                for (uint32_t i = 0; i < kMessageCount; ++i)
+                    logInfo("Message {}", CountedArg{&count});
+            }
+        );
+    }
+    for (auto& thread : threads)
+        thread.join();
+    Logger::flush();
+
+    EXPECT_EQ(count.load(), kThreadCount * kMessageCount);
+}
+
+CPU_TEST(Logger_Benchmark, TAGS("benchmark"))
+{
+    const uint32_t kMessageCount = 1000000;
+    auto measure = [&](auto&& logMessage)
+    {
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kMessageCount; ++i)
+            logMessage(i);
+        Logger::flush();
+        return CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint()) * 1e6 / kMessageCount;
+    };
+
+    double filteredTime, limitedTime, queuedTime;
+    {
+        ScopedLoggerSettings settings;
+        Logger::setOutputs(Logger::OutputFlags::None);
+        Logger::setVerbosity(Logger::Level::Info);
+        filteredTime = measure([](uint32_t i) { logDebug("Vertex {} has invalid normal {}.", i, 0.5f); });
+        limitedTime = measure([](uint32_t i) { logWarningLimited("Vertex {} has invalid normal {}.", i, 0.5f); });
+        queuedTime = measure([](uint32_t i) { logWarning("Vertex {} has invalid normal {}.", i, 0.5f); });
+    }
+
+    logInfo(
+        "Logger overhead per message: filtered {:.1f} ns, rate limited {:.1f} ns, queued {:.1f} ns", filteredTime, limitedTime, queuedTime
+    );
+}
+} // namespace Falcor
@@ -282,6 +282,23 @@ CPU_TEST(Matrix_inverse)
     }
 }
 
+CPU_TEST(Matrix_inverseAffine)
+{
+    float4x4 m = mul(
+        matrixFromTranslation(float3(1.f, -2.f, 3.f)),
+        mul(matrixFromRotation(0.7f, normalize(float3(1.f, 2.f, 3.f))), matrixFromScaling(float3(2.f, 0.5f, 4.f)))
+    );
+    float4x4 a = inverseAffine(m);
+    float4x4 b = inverse(m);
+    for (int r = 0; r < 4; ++r)
+        EXPECT_ALMOST_EQ(a[r], b[r]);
+
+    float4x4 p = mul(m, a);
+    float4x4 identity = float4x4::identity();
+    for (int r = 0; r < 4; ++r)
+        EXPECT_ALMOST_EQ(p[r], identity[r]);
+}
+
 CPU_TEST(Matrix_extractEulerAngleXYZ)
 {
     {
@@ -0,0 +1,256 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/Profiler.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kThreadCount = 4;
+const uint32_t kEventCount = 100;
+
+bool hasEvent(const Profiler& profiler, const std::string& name)
+{
+    const auto& events = profiler.getEvents();
+    return std::any_of(events.begin(), events.end(), [&](const Profiler::Event* pEvent) { return pEvent->getName() == name; });
+}
+
+void recordFrame(Profiler& profiler)
+{
+    static Profiler::EventSite sOuterSite;
+    ScopedProfilerEvent outer(&profiler, "outer", &sOuterSite);
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreadCount; ++t)
+    {
+        threads.emplace_back(
+            [&profiler, t]()
+            {
+                static Profiler::EventSite sTaskSite;
+                static Profiler::EventSite sInnerSite;
+                profiler.setThreadName(fmt::format("Worker {}", t));
+                for (uint32_t i = 0; i < kEventCount; ++i)
+                {
+                    ScopedProfilerEvent task(&profiler, "task", &sTaskSite);
+                    ScopedProfilerEvent inner(&profiler, "inner", &sInnerSite);
+                }
+            }
+        );
+    }
+    for (auto& thread : threads)
+        thread.join();
+}
+} // namespace
+
+GPU_TEST(Profiler_ThreadEvents)
+{
+    Profiler profiler(ctx.getDevice());
+    profiler.setEnabled(true);
+    profiler.startCapture();
+
+    // CPU times are reported one frame late, so record two frames.
+    recordFrame(profiler);
+    profiler.endFrame(ctx.getRenderContext());
+    recordFrame(profiler);
+    profiler.endFrame(ctx.getRenderContext());
+
+    // Events are nested per thread, so the worker events are not nested in the main thread event.
+    EXPECT_EQ(profiler.getEvents().size(), 3);
+    EXPECT(hasEvent(profiler, "/outer"));
+    EXPECT(hasEvent(profiler, "/task"));
+    EXPECT(hasEvent(profiler, "/task/inner"));
+    EXPECT_GT(profiler.getEvent("/outer")->getCpuTime(), 0.f);
+    EXPECT_GE(profiler.getEvent("/task")->getCpuTime(), profiler.getEvent("/task/inner")->getCpuTime());
+
+    auto pCapture = profiler.endCapture();
+    ASSERT(pCapture);
+
+    const auto& paths = pCapture->getEventPaths();
+    const auto& threadNames = pCapture->getThreadNames();
+    // Each thread records into its own lane (thread IDs may be reused by the second frame).
+    ASSERT_GE(threadNames.size(), kThreadCount + 1);
+    EXPECT_EQ(threadNames[0], "Main");
+
+    size_t taskCount = 0;
+    size_t outerCount = 0;
+    for (const auto& span : pCapture->getSpans())
+    {
+        ASSERT_LT(span.eventID, paths.size());
+        ASSERT_LT(span.threadIndex, threadNames.size());
+        EXPECT_GE(span.start, 0.0);
+        EXPECT_GE(span.duration, 0.0);
+        if (paths[span.eventID] == "/task")
+        {
+            EXPECT_NE(span.threadIndex, 0);
+            taskCount++;
+        }
+        if (paths[span.eventID] == "/outer")
+        {
+            EXPECT_EQ(span.threadIndex, 0);
+            outerCount++;
+        }
+    }
+    EXPECT_EQ(taskCount, 2 * kThreadCount * kEventCount);
+    EXPECT_EQ(outerCount, 2);
+
+    std::string trace = pCapture->toTraceJsonString();
+    EXPECT(trace.find("\"traceEvents\"") != std::string::npos);
+    EXPECT(trace.find("\"ph\":\"X\"") != std::string::npos);
+    EXPECT(trace.find("\"name\":\"Worker 0\"") != std::string::npos);
+    EXPECT(trace.find("\"path\":\"/task/inner\"") != std::string::npos);
+}
+
+GPU_TEST(Profiler_EventNames)
+{
+    Profiler profiler(ctx.getDevice());
+    profiler.setEnabled(true);
+
+    // A call site shared by different names, as with events named by render pass.
+    Profiler::EventSite site;
+    for (uint32_t frame = 0; frame < 2; ++frame)
+    {
+        for (const char* name : {"a", "b", "a"})
+            ScopedProfilerEvent event(&profiler, name, &site);
+
+        // Invalid names are ignored, events nested in them are attached to the parent.
+        profiler.startEvent(nullptr, "x/y");
+        {
+            ScopedProfilerEvent event(&profiler, "c", &site);
+        }
+        profiler.endEvent(nullptr, "x/y");
+
+        profiler.endFrame(ctx.getRenderContext());
+    }
+
+    EXPECT_EQ(profiler.getEvents().size(), 3);
+    EXPECT(hasEvent(profiler, "/a"));
+    EXPECT(hasEvent(profiler, "/b"));
+    EXPECT(hasEvent(profiler, "/c"));
+}
+
+GPU_TEST(Profiler_Benchmark, TAGS("benchmark"))
+{
+    const uint32_t kFrameCount = 1000;
+    const uint32_t kEventsPerFrame = 1000;
+    const std::string kNames[] = {"GBuffer", "Shadows", "Lighting", "PostFX"};
+
+    auto measure = [&](Profiler& profiler, auto&& recordEvent, uint32_t frameCount = kFrameCount)
+    {
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            for (uint32_t i = 0; i < kEventsPerFrame; ++i)
+                recordEvent(i);
+            profiler.endFrame(ctx.getRenderContext());
+        }
+        // Report nanoseconds per event, including the per frame aggregation.
+        return CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint()) * 1e6 / (frameCount * kEventsPerFrame);
+    };
+
+    Profiler profiler(ctx.getDevice());
+    double disabledTime = measure(
+        profiler,
+        [&](uint32_t)
+        {
+            static Profiler::EventSite sSite;
+            ScopedProfilerEvent event(&profiler, "event", &sSite);
+        }
+    );
+
+    profiler.setEnabled(true);
+    double cachedTime = measure(
+        profiler,
+        [&](uint32_t)
+        {
+            static Profiler::EventSite sSite;
+            ScopedProfilerEvent event(&profiler, "event", &sSite);
+        }
+    );
+    double nestedTime = measure(
+        profiler,
+        [&](uint32_t)
+        {
+            static Profiler::EventSite sOuterSite;
+            static Profiler::EventSite sInnerSite;
+            ScopedProfilerEvent outer(&profiler, "outer", &sOuterSite);
+            ScopedProfilerEvent inner(&profiler, "inner", &sInnerSite);
+        }
+    ) / 2.0;
+    double dynamicTime = measure(
+        profiler,
+        [&](uint32_t i)
+        {
+            static Profiler::EventSite sSite;
+            ScopedProfilerEvent event(&profiler, kNames[i % 4], &sSite);
+        }
+    );
+    double uncachedTime = measure(profiler, [&](uint32_t i) { ScopedProfilerEvent event(&profiler, kNames[i % 4]); });
+
+    logInfo(
+        "Profiler CPU event overhead: disabled {:.1f} ns, cached site {:.1f} ns, nested {:.1f} ns, dynamic name {:.1f} ns, uncached "
+        "{:.1f} ns",
+        disabledTime,
+        cachedTime,
+        nestedTime,
+        dynamicTime,
+        uncachedTime
+    );
+
+    // Events with a render context, as recorded by FALCOR_PROFILE in render passes. These use the device profiler and include
+    // issuing and resolving the GPU timestamp queries, so fewer frames are measured.
+    const uint32_t kGpuFrameCount = 100;
+    Profiler* pDeviceProfiler = ctx.getDevice()->getProfiler();
+    bool deviceProfilerEnabled = pDeviceProfiler->isEnabled();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    pDeviceProfiler->setEnabled(false);
+    double gpuDisabledTime = measure(*pDeviceProfiler, [&](uint32_t) { FALCOR_PROFILE(pRenderContext, "event"); }, kGpuFrameCount);
+
+    pDeviceProfiler->setEnabled(true);
+    double gpuCachedTime = measure(*pDeviceProfiler, [&](uint32_t) { FALCOR_PROFILE(pRenderContext, "event"); }, kGpuFrameCount);
+    double gpuDynamicTime =
+        measure(*pDeviceProfiler, [&](uint32_t i) { FALCOR_PROFILE(pRenderContext, kNames[i % 4]); }, kGpuFrameCount);
+    pDeviceProfiler->setEnabled(deviceProfilerEnabled);
+
+    logInfo(
+        "Profiler GPU event overhead: disabled {:.1f} ns, cached site {:.1f} ns, dynamic name {:.1f} ns",
+        gpuDisabledTime,
+        gpuCachedTime,
+        gpuDynamicTime
+    );
+}
+} // namespace Falcor
@@ -28,8 +28,12 @@
 #include <FreeImage.h>
 #include <args.hxx>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -40,6 +44,14 @@
 #include <cmath>
 #include <cstring>
 
+// SSE2 is part of the x86-64 baseline, so the vectorized kernels are available on all platforms we build for.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMAGE_COMPARE_SSE 1
+#include <emmintrin.h>
+#else
+#define IMAGE_COMPARE_SSE 0
+#endif
+
 template<typename T>
 T sqr(T x)
 {
@@ -188,75 +200,242 @@ private:
     std::unique_ptr<float[]> mData;
 };
 
+/**
+ * Error metrics.
+ * Each metric defines the per-channel error (scalar and SSE variants) and a scale factor applied to the per-pixel mean.
+ * All metrics are non-negative, which allows the comparison to stop early once the error threshold is exceeded.
+ */
+
 struct MSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 1.0;
+    static float eval(float a, float b) { return sqr(a - b); }
+#if IMAGE_COMPARE_SSE
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]);
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_mul_ps(d, d);
     }
+#endif
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 1.0;
+    static float eval(float a, float b) { return sqr(a - b) / (sqr(a) + 1e-3f); }
+#if IMAGE_COMPARE_SSE
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_div_ps(_mm_mul_ps(d, d), _mm_add_ps(_mm_mul_ps(a, a), _mm_set1_ps(1e-3f)));
     }
+#endif
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 1.0;
+    static float eval(float a, float b) { return std::fabs(sqr(a - b)); }
+#if IMAGE_COMPARE_SSE
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs(sqr(a[i] - b[i]));
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_mul_ps(d, d));
     }
+#endif
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    static constexpr double kScale = 100.0;
+    static float eval(float a, float b) { return std::fabs((a - b) / (a + 1e-3f)); }
+#if IMAGE_COMPARE_SSE
+    static __m128 eval(__m128 a, __m128 b)
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
-        return 100.0 * error / count;
+        __m128 d = _mm_div_ps(_mm_sub_ps(a, b), _mm_add_ps(a, _mm_set1_ps(1e-3f)));
+        return _mm_andnot_ps(_mm_set1_ps(-0.f), d);
     }
+#endif
 };
 
-template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+/**
+ * Compute the error of a row of RGBA pixels.
+ * The SSE path processes four pixels at a time and transposes the per-channel errors to get four per-pixel errors.
+ * \param[in] a Pixels of the first image.
+ * \param[in] b Pixels of the second image.
+ * \param[in] count Number of pixels.
+ * \param[out] errorMap Optional per-pixel error output.
+ * \return Sum of the per-pixel errors.
+ */
+template<typename Metric, uint32_t Channels>
+double compareRow(const float* a, const float* b, uint32_t count, float* errorMap)
 {
-    Metric metric;
+    static_assert(Channels == 3 || Channels == 4);
+    const float weight = float(Metric::kScale / Channels);
     double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
+    uint32_t i = 0;
+
+#if IMAGE_COMPARE_SSE
+    const __m128 weight4 = _mm_set1_ps(weight);
+    __m128d sum01 = _mm_setzero_pd();
+    __m128d sum23 = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4, a += 16, b += 16)
+    {
+        __m128 e0 = Metric::eval(_mm_loadu_ps(a), _mm_loadu_ps(b));
+        __m128 e1 = Metric::eval(_mm_loadu_ps(a + 4), _mm_loadu_ps(b + 4));
+        __m128 e2 = Metric::eval(_mm_loadu_ps(a + 8), _mm_loadu_ps(b + 8));
+        __m128 e3 = Metric::eval(_mm_loadu_ps(a + 12), _mm_loadu_ps(b + 12));
+        // After the transpose, e0..e3 hold the R, G, B and A errors of the four pixels.
+        _MM_TRANSPOSE4_PS(e0, e1, e2, e3);
+        __m128 error = _mm_add_ps(_mm_add_ps(e0, e1), e2);
+        if constexpr (Channels == 4)
+            error = _mm_add_ps(error, e3);
+        error = _mm_mul_ps(error, weight4);
+        if (errorMap)
+        {
+            _mm_storeu_ps(errorMap, error);
+            errorMap += 4;
+        }
+        sum01 = _mm_add_pd(sum01, _mm_cvtps_pd(error));
+        sum23 = _mm_add_pd(sum23, _mm_cvtps_pd(_mm_movehl_ps(error, error)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(sum01, sum23));
+    sum = lanes[0] + lanes[1];
+#endif
+
+    for (; i < count; ++i, a += 4, b += 4)
     {
-        double error = metric(a, b, alpha ? 4 : 3);
+        float error = 0.f;
+        for (uint32_t c = 0; c < Channels; ++c)
+            error += Metric::eval(a[c], b[c]);
+        error *= weight;
         if (errorMap)
-            *errorMap++ = float(error);
+            *errorMap++ = error;
         sum += error;
-        a += 4;
-        b += 4;
     }
-    return sum / count;
+
+    return sum;
+}
+
+struct CompareOptions
+{
+    bool alpha = false;         ///< Include alpha channel.
+    float threshold = 0.f;      ///< Error threshold.
+    bool earlyOut = false;      ///< Stop comparing once the error is known to exceed the threshold.
+    uint32_t tileSize = 64;     ///< Tile size in pixels.
+    uint32_t threadCount = 1;   ///< Number of threads.
+};
+
+struct CompareResult
+{
+    double error = 0.0;             ///< Mean error. If the comparison stopped early, this is a lower bound of the error.
+    bool stoppedEarly = false;      ///< True if the comparison stopped before all tiles were processed.
+    uint32_t tilesX = 0;            ///< Number of tiles in x.
+    uint32_t tilesY = 0;            ///< Number of tiles in y.
+    std::vector<float> tileErrors;  ///< Mean error per tile (row-major). Tiles that were not processed are zero.
+};
+
+/**
+ * Compare two images tile by tile on multiple threads.
+ * Tiles are handed out through an atomic counter. The total error is accumulated from the per-tile sums in tile order,
+ * so the result does not depend on the number of threads.
+ */
+template<typename Metric, uint32_t Channels>
+CompareResult compareTiled(const Image& imageA, const Image& imageB, const CompareOptions& options, float* errorMap)
+{
+    const uint32_t width = imageA.getWidth();
+    const uint32_t height = imageA.getHeight();
+    const uint32_t tileSize = std::max(options.tileSize, 1u);
+    const double pixelCount = double(width) * height;
+
+    CompareResult result;
+    result.tilesX = (width + tileSize - 1) / tileSize;
+    result.tilesY = (height + tileSize - 1) / tileSize;
+    const uint32_t tileCount = result.tilesX * result.tilesY;
+    if (tileCount == 0)
+        return result;
+
+    std::vector<double> tileSums(tileCount, 0.0);
+    std::atomic<uint32_t> nextTile{0};
+    std::atomic<double> runningSum{0.0};
+    std::atomic<bool> stop{false};
+    const double stopSum = double(options.threshold) * pixelCount;
+
+    auto worker = [&]()
+    {
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            uint32_t tile = nextTile.fetch_add(1, std::memory_order_relaxed);
+            if (tile >= tileCount)
+                break;
+
+            const uint32_t x0 = (tile % result.tilesX) * tileSize;
+            const uint32_t y0 = (tile / result.tilesX) * tileSize;
+            const uint32_t x1 = std::min(x0 + tileSize, width);
+            const uint32_t y1 = std::min(y0 + tileSize, height);
+
+            double sum = 0.0;
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                size_t offset = size_t(y) * width + x0;
+                sum += compareRow<Metric, Channels>(
+                    imageA.getData() + offset * 4, imageB.getData() + offset * 4, x1 - x0, errorMap ? errorMap + offset : nullptr
+                );
+            }
+            tileSums[tile] = sum;
+
+            if (options.earlyOut)
+            {
+                double prev = runningSum.load(std::memory_order_relaxed);
+                while (!runningSum.compare_exchange_weak(prev, prev + sum, std::memory_order_relaxed))
+                    ;
+                // The error can only grow, so the threshold test fails as soon as the partial sum exceeds it.
+                // Non-finite sums (nans and infs) are treated as errors and stop the comparison as well.
+                double total = prev + sum;
+                if (!(total <= stopSum) || std::isinf(total))
+                    stop.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    const uint32_t threadCount = std::clamp(options.threadCount, 1u, tileCount);
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    result.stoppedEarly = stop.load();
+    result.tileErrors.resize(tileCount);
+    double sum = 0.0;
+    for (uint32_t tile = 0; tile < tileCount; ++tile)
+    {
+        const uint32_t x0 = (tile % result.tilesX) * tileSize;
+        const uint32_t y0 = (tile / result.tilesX) * tileSize;
+        const uint32_t tilePixels = (std::min(x0 + tileSize, width) - x0) * (std::min(y0 + tileSize, height) - y0);
+        result.tileErrors[tile] = float(tileSums[tile] / tilePixels);
+        sum += tileSums[tile];
+    }
+    result.error = sum / pixelCount;
+
+    return result;
+}
+
+template<typename Metric>
+CompareResult compare(const Image& imageA, const Image& imageB, const CompareOptions& options, float* errorMap)
+{
+    return options.alpha ? compareTiled<Metric, 4>(imageA, imageB, options, errorMap)
+                         : compareTiled<Metric, 3>(imageA, imageB, options, errorMap);
 }
 
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    std::function<CompareResult(const Image& imageA, const Image& imageB, const CompareOptions& options, float* errorMap)> compare;
 };
 
 static const std::vector<ErrorMetric> errorMetrics = {
@@ -302,9 +481,9 @@ static bool compareImages(
     const std::filesystem::path& pathA,
     const std::filesystem::path& pathB,
     ErrorMetric metric,
-    float threshold,
-    bool alpha,
-    const std::filesystem::path& heatMapPath
+    CompareOptions options,
+    const std::filesystem::path& heatMapPath,
+    const std::filesystem::path& tileHeatMapPath
 )
 {
     auto loadImage = [](const std::filesystem::path& path)
@@ -332,12 +511,11 @@ static bool compareImages(
         }
     };
 
-    // Load images.
-    auto imageA = loadImage(pathA);
-    if (!imageA)
-        return false;
+    // Load images. Decoding dominates for large images, so load both in parallel.
+    auto futureA = std::async(std::launch::async, loadImage, pathA);
     auto imageB = loadImage(pathB);
-    if (!imageB)
+    auto imageA = futureA.get();
+    if (!imageA || !imageB)
         return false;
 
     // Check resolution.
@@ -350,24 +528,34 @@ static bool compareImages(
     uint32_t width = imageA->getWidth();
     uint32_t height = imageB->getHeight();
 
+    // Heat maps need the error of every pixel, so they disable the early out.
+    if (!heatMapPath.empty() || !tileHeatMapPath.empty())
+        options.earlyOut = false;
+
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    CompareResult result = metric.compare(*imageA, *imageB, options, errorMap.get());
+    double error = result.error;
 
-    // Generate heat map.
+    // Generate heat maps.
     if (errorMap)
     {
         auto heatMap = generateHeatMap(width, height, errorMap.get());
         saveImage(*heatMap, heatMapPath);
     }
+    if (!tileHeatMapPath.empty() && !result.tileErrors.empty())
+    {
+        auto heatMap = generateHeatMap(result.tilesX, result.tilesY, result.tileErrors.data());
+        saveImage(*heatMap, tileHeatMapPath);
+    }
 
     std::cout << error << std::endl;
 
     // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error))
+    if (result.stoppedEarly || std::isnan(error) || std::isinf(error))
         return false;
 
-    return error <= threshold;
+    return error <= options.threshold;
 }
 
 static void printMetrics(std::ostream& stream = std::cout)
@@ -389,6 +577,12 @@ int main(int argc, char** argv)
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
     args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
+    args::ValueFlag<std::string> tileHeatMapFlag(parser, "filename", "Generate error heat map with one pixel per tile.", {"tile-heatmap"});
+    args::Flag earlyOutFlag(
+        parser, "", "Stop once the error exceeds the threshold. The reported error is then a lower bound.", {'x', "early-out"}
+    );
+    args::ValueFlag<uint32_t> tileSizeFlag(parser, "size", "Tile size in pixels (default 64).", {"tile-size"});
+    args::ValueFlag<uint32_t> threadsFlag(parser, "count", "Number of threads (default: number of hardware threads).", {'j', "threads"});
     args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
     args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
     args::CompletionFlag completionFlag(parser, {"complete"});
@@ -441,13 +635,21 @@ int main(int argc, char** argv)
         metric = *it;
     }
 
+    CompareOptions options;
+    options.alpha = alphaFlag ? args::get(alphaFlag) : false;
+    options.threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    options.earlyOut = earlyOutFlag ? args::get(earlyOutFlag) : false;
+    if (tileSizeFlag)
+        options.tileSize = std::max(args::get(tileSizeFlag), 1u);
+    options.threadCount = threadsFlag ? args::get(threadsFlag) : std::thread::hardware_concurrency();
+
     bool success = compareImages(
         args::get(image1),
         args::get(image2),
         metric,
-        thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false,
-        heatMapFlag ? args::get(heatMapFlag) : ""
+        options,
+        heatMapFlag ? args::get(heatMapFlag) : "",
+        tileHeatMapFlag ? args::get(tileHeatMapFlag) : ""
     );
     return success ? 0 : 1;
 }
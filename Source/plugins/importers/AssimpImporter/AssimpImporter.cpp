@@ -30,7 +30,6 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
-#include "Utils/NumericRange.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
@@ -46,7 +45,6 @@
 
 #include <pybind11/pybind11.h>
 
-#include <execution>
 #include <fstream>
 
 namespace Falcor
@@ -573,102 +571,94 @@ void createMeshes(ImporterData& data)
         const aiMesh* pMesh = pScene->mMeshes[i];
         if (!pMesh->HasFaces())
         {
-            logWarning("AssimpImporter: Mesh '{}' has no faces, ignoring.", pMesh->mName.C_Str());
+            logWarningLimited("AssimpImporter: Mesh '{}' has no faces, ignoring.", pMesh->mName.C_Str());
             meshes.push_back(nullptr);
             continue;
         }
         if (pMesh->mFaces->mNumIndices != 3)
         {
-            logWarning("AssimpImporter: Mesh '{}' is not a triangle mesh, ignoring.", pMesh->mName.C_Str());
+            logWarningLimited("AssimpImporter: Mesh '{}' is not a triangle mesh, ignoring.", pMesh->mName.C_Str());
             meshes.push_back(nullptr);
             continue;
         }
         meshes.push_back(pMesh);
     }
 
-    // Pre-process meshes.
-    std::vector<SceneBuilder::ProcessedMesh> processedMeshes(meshes.size());
-    auto range = NumericRange<size_t>(0, meshes.size());
-    std::for_each(
-        std::execution::par,
-        range.begin(),
-        range.end(),
-        [&](size_t i)
-        {
-            const aiMesh* pAiMesh = meshes[i];
-            if (!pAiMesh)
-                return;
-            const uint32_t perFaceIndexCount = pAiMesh->mFaces[0].mNumIndices;
-
-            SceneBuilder::Mesh mesh;
-            mesh.name = pAiMesh->mName.C_Str();
-            mesh.faceCount = pAiMesh->mNumFaces;
-
-            // Temporary memory for the vertex and index data.
-            std::vector<uint32_t> indexList;
-            std::vector<float2> texCrds;
-            std::vector<float4> tangents;
-            std::vector<uint4> boneIds;
-            std::vector<float4> boneWeights;
-
-            // Indices
-            createIndexList(pAiMesh, indexList);
-            FALCOR_ASSERT(indexList.size() <= std::numeric_limits<uint32_t>::max());
-            mesh.indexCount = (uint32_t)indexList.size();
-            mesh.pIndices = indexList.data();
-            mesh.topology = Vao::Topology::TriangleList;
-
-            // Vertices
-            FALCOR_ASSERT(pAiMesh->mVertices);
-            mesh.vertexCount = pAiMesh->mNumVertices;
-            static_assert(sizeof(pAiMesh->mVertices[0]) == sizeof(mesh.positions.pData[0]));
-            static_assert(sizeof(pAiMesh->mNormals[0]) == sizeof(mesh.normals.pData[0]));
-            mesh.positions.pData = reinterpret_cast<float3*>(pAiMesh->mVertices);
-            mesh.positions.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-            mesh.normals.pData = reinterpret_cast<float3*>(pAiMesh->mNormals);
-            mesh.normals.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-
-            if (pAiMesh->HasTextureCoords(0))
-            {
-                createTexCrdList(pAiMesh->mTextureCoords[0], pAiMesh->mNumVertices, texCrds);
-                FALCOR_ASSERT(!texCrds.empty());
-                mesh.texCrds.pData = texCrds.data();
-                mesh.texCrds.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-            }
+    // Process meshes asynchronously on the scene builder's task pool.
+    // Mesh IDs are assigned in order, so the global mesh order is deterministic.
+    // The Assimp scene must stay alive until SceneBuilder::waitForMeshes() returns.
+    data.meshMap.clear();
+    data.meshMap.resize(meshes.size(), MeshID::Invalid());
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        const aiMesh* pAiMesh = meshes[i];
+        if (!pAiMesh)
+            continue;
 
-            if (loadTangents && pAiMesh->HasTangentsAndBitangents())
-            {
-                createTangentList(pAiMesh->mTangents, pAiMesh->mBitangents, pAiMesh->mNormals, pAiMesh->mNumVertices, tangents);
-                FALCOR_ASSERT(!tangents.empty());
-                mesh.tangents.pData = tangents.data();
-                mesh.tangents.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-            }
+        const ref<Material>& pMaterial = data.materialMap.at(pAiMesh->mMaterialIndex);
 
-            if (pAiMesh->HasBones())
+        data.meshMap[i] = data.builder.addMeshAsync(
+            pMaterial,
+            [pAiMesh, pMaterial, loadTangents, &data](const SceneBuilder& builder)
             {
-                loadBones(pAiMesh, data, boneWeights, boneIds);
-                mesh.boneIDs.pData = boneIds.data();
-                mesh.boneIDs.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-                mesh.boneWeights.pData = boneWeights.data();
-                mesh.boneWeights.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
-            }
+                SceneBuilder::Mesh mesh;
+                mesh.name = pAiMesh->mName.C_Str();
+                mesh.faceCount = pAiMesh->mNumFaces;
+
+                // Temporary memory for the vertex and index data.
+                std::vector<uint32_t> indexList;
+                std::vector<float2> texCrds;
+                std::vector<float4> tangents;
+                std::vector<uint4> boneIds;
+                std::vector<float4> boneWeights;
+
+                // Indices
+                createIndexList(pAiMesh, indexList);
+                FALCOR_ASSERT(indexList.size() <= std::numeric_limits<uint32_t>::max());
+                mesh.indexCount = (uint32_t)indexList.size();
+                mesh.pIndices = indexList.data();
+                mesh.topology = Vao::Topology::TriangleList;
+
+                // Vertices
+                FALCOR_ASSERT(pAiMesh->mVertices);
+                mesh.vertexCount = pAiMesh->mNumVertices;
+                static_assert(sizeof(pAiMesh->mVertices[0]) == sizeof(mesh.positions.pData[0]));
+                static_assert(sizeof(pAiMesh->mNormals[0]) == sizeof(mesh.normals.pData[0]));
+                mesh.positions.pData = reinterpret_cast<float3*>(pAiMesh->mVertices);
+                mesh.positions.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                mesh.normals.pData = reinterpret_cast<float3*>(pAiMesh->mNormals);
+                mesh.normals.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+
+                if (pAiMesh->HasTextureCoords(0))
+                {
+                    createTexCrdList(pAiMesh->mTextureCoords[0], pAiMesh->mNumVertices, texCrds);
+                    FALCOR_ASSERT(!texCrds.empty());
+                    mesh.texCrds.pData = texCrds.data();
+                    mesh.texCrds.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                }
 
-            mesh.pMaterial = data.materialMap.at(pAiMesh->mMaterialIndex);
+                if (loadTangents && pAiMesh->HasTangentsAndBitangents())
+                {
+                    createTangentList(pAiMesh->mTangents, pAiMesh->mBitangents, pAiMesh->mNormals, pAiMesh->mNumVertices, tangents);
+                    FALCOR_ASSERT(!tangents.empty());
+                    mesh.tangents.pData = tangents.data();
+                    mesh.tangents.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                }
 
-            processedMeshes[i] = data.builder.processMesh(mesh);
-        }
-    );
+                if (pAiMesh->HasBones())
+                {
+                    loadBones(pAiMesh, data, boneWeights, boneIds);
+                    mesh.boneIDs.pData = boneIds.data();
+                    mesh.boneIDs.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                    mesh.boneWeights.pData = boneWeights.data();
+                    mesh.boneWeights.frequency = SceneBuilder::Mesh::AttributeFrequency::Vertex;
+                }
 
-    // Add meshes to the scene.
-    // We retain a deterministic order of the meshes in the global scene buffer by adding
-    // them sequentially after being processed in parallel.
-    data.meshMap.clear();
-    data.meshMap.resize(processedMeshes.size(), MeshID::Invalid());
-    for (size_t i = 0; i < processedMeshes.size(); ++i)
-    {
-        if (!meshes[i])
-            continue;
-        data.meshMap[i] = data.builder.addProcessedMesh(processedMeshes[i]);
+                mesh.pMaterial = pMaterial;
+
+                return builder.processMesh(mesh);
+            }
+        );
     }
 }
 
@@ -958,7 +948,7 @@ ref<Material> createMaterial(
             if (str == "doublesided")
                 pMaterial->setDoubleSided(true);
             else
-                logWarning("AssimpImporter: Material '{}' has an unknown material property: '{}'.", nameStr, nameVec[i]);
+                logWarningLimited("AssimpImporter: Material '{}' has an unknown material property: '{}'.", nameStr, nameVec[i]);
         }
     }
 
@@ -1176,6 +1166,7 @@ void importInternal(const void* buffer, size_t byteSize, const std::filesystem::
 
     createMeshes(data);
     addMeshInstances(data, data.pScene->mRootNode);
+    builder.waitForMeshes();
     timeReport.measure("Creating meshes");
 
     createAnimations(data, importMode);
@@ -28,6 +28,7 @@
 #include "MitsubaImporter.h"
 #include "Parser.h"
 #include "Tables.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/MathHelpers.h"
@@ -37,7 +38,11 @@
 
 #include <pybind11/pybind11.h>
 
+#include <algorithm>
+#include <execution>
+#include <functional>
 #include <unordered_map>
+#include <variant>
 
 namespace Falcor
 {
@@ -116,6 +121,10 @@ struct ShapeInfo
     ref<TriangleMesh> pMesh;
     float4x4 transform;
     ref<Material> pMaterial;
+
+    // Mesh file to load in the resolve phase (see buildScene()).
+    std::filesystem::path meshPath;
+    TriangleMesh::ImportFlags meshFlags = TriangleMesh::ImportFlags::None;
 };
 
 struct SensorInfo
@@ -129,13 +138,22 @@ struct EmitterInfo
     ref<EnvMap> pEnvMap;
     ref<Light> pLight;
     float4x4 transform;
+
+    // Environment map file to decode in the resolve phase (see buildScene()).
+    std::filesystem::path envMapPath;
+    float envMapScale = 1.f;
+    Bitmap::UniqueConstPtr pEnvMapBitmap;
 };
 
 struct TextureInfo
 {
     float4 value;
     ref<Texture> pTexture;
+    std::filesystem::path path; ///< Bitmap file, loaded asynchronously by the scene builder.
+    bool raw = false;           ///< Load the bitmap as linear data instead of sRGB.
     float4x4 transform;
+
+    bool hasTexture() const { return pTexture || !path.empty(); }
 };
 
 struct BSDFInfo
@@ -190,7 +208,9 @@ TextureInfo buildTexture(BuilderContext& ctx, const XMLObject& inst)
         if (props.hasString("wrap_mode"))
             ctx.unsupportedParameter("wrap_mode");
 
-        texture.pTexture = Texture::createFromFile(ctx.builder.getDevice(), filename, true, !raw);
+        ctx.builder.addDependency(filename);
+        texture.path = filename;
+        texture.raw = raw;
         texture.transform = toUV;
     }
     else if (inst.type == "checkerboard")
@@ -246,6 +266,15 @@ TextureInfo lookupTexture(BuilderContext& ctx, const Properties& props, const st
     }
 }
 
+void setBaseColorTexture(BuilderContext& ctx, const ref<Material>& pMaterial, const TextureInfo& texture)
+{
+    if (texture.pTexture)
+        pMaterial->setTexture(Material::TextureSlot::BaseColor, texture.pTexture);
+    else
+        ctx.builder.loadMaterialTexture(pMaterial, Material::TextureSlot::BaseColor, texture.path, !texture.raw);
+    pMaterial->setTextureTransform(transformFromMatrix4x4(texture.transform));
+}
+
 void setMicrofacetProperties(ref<StandardMaterial> pMaterial, BuilderContext& ctx, const Properties& props, float defaultAlpha = 0.1f)
 {
     if (props.hasString("distribution"))
@@ -253,9 +282,9 @@ void setMicrofacetProperties(ref<StandardMaterial> pMaterial, BuilderContext& ct
     if (props.hasBool("sample_visible"))
         ctx.unsupportedParameter("sample_visible");
     auto alpha = lookupTexture(ctx, props, "alpha", float4(defaultAlpha));
-    if (alpha.pTexture)
+    if (alpha.hasTexture())
         ctx.logWarningOnce("Microfacet alpha texture is not supported.");
-    pMaterial->setRoughness(std::sqrt(alpha.pTexture ? defaultAlpha : alpha.value.x));
+    pMaterial->setRoughness(std::sqrt(alpha.hasTexture() ? defaultAlpha : alpha.value.x));
     // TODO: set roughness texture
 }
 
@@ -271,10 +300,9 @@ BSDFInfo buildBSDF(BuilderContext& ctx, const XMLObject& inst)
     {
         auto pPBRTMaterial = PBRTDiffuseMaterial::create(ctx.builder.getDevice(), inst.id);
         auto reflectance = lookupTexture(ctx, props, "reflectance", float4(0.5f));
-        if (reflectance.pTexture)
+        if (reflectance.hasTexture())
         {
-            pPBRTMaterial->setTexture(Material::TextureSlot::BaseColor, reflectance.pTexture);
-            pPBRTMaterial->setTextureTransform(transformFromMatrix4x4(reflectance.transform));
+            setBaseColorTexture(ctx, pPBRTMaterial, reflectance);
         }
         else
         {
@@ -343,9 +371,9 @@ BSDFInfo buildBSDF(BuilderContext& ctx, const XMLObject& inst)
         {
             const float defaultAlpha = 0.1f;
             auto alpha = lookupTexture(ctx, props, "alpha", float4(defaultAlpha));
-            if (alpha.pTexture)
+            if (alpha.hasTexture())
                 ctx.logWarningOnce("Microfacet alpha texture is not supported.");
-            pPBRTMaterial->setRoughness(alpha.pTexture ? float2(defaultAlpha) : alpha.value.xy());
+            pPBRTMaterial->setRoughness(alpha.hasTexture() ? float2(defaultAlpha) : alpha.value.xy());
         }
 
         pMaterial = pPBRTMaterial;
@@ -354,10 +382,9 @@ BSDFInfo buildBSDF(BuilderContext& ctx, const XMLObject& inst)
     {
         auto pStandardMaterial = StandardMaterial::create(ctx.builder.getDevice(), inst.id);
         auto diffuseReflectance = lookupTexture(ctx, props, "diffuse_reflectance", float4(0.5f));
-        if (diffuseReflectance.pTexture)
+        if (diffuseReflectance.hasTexture())
         {
-            pStandardMaterial->setTexture(Material::TextureSlot::BaseColor, diffuseReflectance.pTexture);
-            pStandardMaterial->setTextureTransform(transformFromMatrix4x4(diffuseReflectance.transform));
+            setBaseColorTexture(ctx, pStandardMaterial, diffuseReflectance);
         }
         else
         {
@@ -485,9 +512,9 @@ ShapeInfo buildShape(BuilderContext& ctx, const XMLObject& inst)
             flags = TriangleMesh::ImportFlags::GenSmoothNormals | TriangleMesh::ImportFlags::JoinIdenticalVertices;
         }
 
-        shape.pMesh = TriangleMesh::createFromFile(filename, flags);
-        if (shape.pMesh)
-            shape.pMesh->setName(inst.id);
+        ctx.builder.addDependency(filename);
+        shape.meshPath = filename;
+        shape.meshFlags = flags;
         shape.transform = toWorld;
     }
     else if (inst.type == "sphere")
@@ -687,18 +714,10 @@ EmitterInfo buildEmitter(BuilderContext& ctx, const XMLObject& inst)
     {
         auto filename = props.getString("filename");
         auto scale = props.getFloat("scale", 1.f);
-        auto pEnvMap = EnvMap::createFromFile(ctx.builder.getDevice(), filename);
-        if (pEnvMap)
-        {
-            const float4x4 flipZ({1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, -1.f, 0.f, 0.f, 0.f, 0.f, 1.f});
-            toWorld = mul(toWorld, flipZ);
-
-            pEnvMap->setIntensity(scale);
-            float3 rotation;
-            extractEulerAngleXYZ(toWorld, rotation.x, rotation.y, rotation.z);
-            pEnvMap->setRotation(math::degrees(rotation));
-        }
-        emitter.pEnvMap = pEnvMap;
+        ctx.builder.addDependency(filename);
+        emitter.envMapPath = filename;
+        emitter.envMapScale = scale;
+        emitter.transform = toWorld;
     }
     else if (inst.type == "point")
     {
@@ -723,12 +742,44 @@ EmitterInfo buildEmitter(BuilderContext& ctx, const XMLObject& inst)
     return emitter;
 }
 
+ref<EnvMap> createEnvMap(BuilderContext& ctx, const EmitterInfo& emitter)
+{
+    // DDS files are not decoded in the resolve phase, as they may contain mips and compressed formats.
+    auto pDevice = ctx.builder.getDevice();
+    ref<EnvMap> pEnvMap;
+    if (emitter.pEnvMapBitmap)
+    {
+        auto pTexture = Texture::createFromBitmap(pDevice, *emitter.pEnvMapBitmap, true, false);
+        pTexture->setSourcePath(emitter.envMapPath);
+        pEnvMap = EnvMap::create(pDevice, pTexture);
+    }
+    else if (hasExtension(emitter.envMapPath, "dds"))
+    {
+        pEnvMap = EnvMap::createFromFile(pDevice, emitter.envMapPath);
+    }
+
+    if (pEnvMap)
+    {
+        const float4x4 flipZ({1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, -1.f, 0.f, 0.f, 0.f, 0.f, 1.f});
+        float4x4 toWorld = mul(emitter.transform, flipZ);
+
+        pEnvMap->setIntensity(emitter.envMapScale);
+        float3 rotation;
+        extractEulerAngleXYZ(toWorld, rotation.x, rotation.y, rotation.z);
+        pEnvMap->setRotation(math::degrees(rotation));
+    }
+    return pEnvMap;
+}
+
 void buildScene(BuilderContext& ctx, const XMLObject& inst)
 {
     FALCOR_ASSERT(inst.cls == Class::Scene);
 
     const auto& props = inst.props;
 
+    // Parse phase: Build all objects in order. Mesh and environment map files are only recorded, and material texture loads
+    // are issued to the scene builder, which loads them asynchronously.
+    std::vector<std::pair<std::string, std::variant<SensorInfo, EmitterInfo, ShapeInfo>>> objects;
     for (const auto& [name, id] : props.getNamedReferences())
     {
         const auto& child = ctx.instances[id];
@@ -736,53 +787,79 @@ void buildScene(BuilderContext& ctx, const XMLObject& inst)
         switch (child.cls)
         {
         case Class::Sensor:
+            objects.emplace_back(id, buildSensor(ctx, child));
+            break;
+        case Class::Emitter:
+            objects.emplace_back(id, buildEmitter(ctx, child));
+            break;
+        case Class::Shape:
+            objects.emplace_back(id, buildShape(ctx, child));
+            break;
+        }
+    }
+
+    // Resolve phase: Load all mesh files and decode environment maps in parallel.
+    // This only runs CPU work, GPU resources are created on this thread below.
+    std::vector<std::function<void()>> loads;
+    for (auto& [id, object] : objects)
+    {
+        if (auto pShape = std::get_if<ShapeInfo>(&object); pShape && !pShape->meshPath.empty())
+        {
+            loads.push_back([pShape]() { pShape->pMesh = TriangleMesh::createFromFile(pShape->meshPath, pShape->meshFlags); });
+        }
+        else if (auto pEmitter = std::get_if<EmitterInfo>(&object); pEmitter && !pEmitter->envMapPath.empty())
         {
-            auto sensor = buildSensor(ctx, child);
+            if (!hasExtension(pEmitter->envMapPath, "dds"))
+                loads.push_back([pEmitter]() { pEmitter->pEnvMapBitmap = Bitmap::createFromFile(pEmitter->envMapPath, true); });
+        }
+    }
+    std::for_each(std::execution::par, loads.begin(), loads.end(), [](const std::function<void()>& load) { load(); });
 
-            if (sensor.pCamera)
+    // Add objects to the scene builder in order, so the scene doesn't depend on load order.
+    for (auto& [id, object] : objects)
+    {
+        if (auto pSensor = std::get_if<SensorInfo>(&object))
+        {
+            if (pSensor->pCamera)
             {
-                SceneBuilder::Node node{id, sensor.transform};
+                SceneBuilder::Node node{id, pSensor->transform};
                 auto nodeID = ctx.builder.addNode(node);
-                sensor.pCamera->setNodeID(nodeID);
-                ctx.builder.addCamera(sensor.pCamera);
+                pSensor->pCamera->setNodeID(nodeID);
+                ctx.builder.addCamera(pSensor->pCamera);
             }
         }
-        break;
-
-        case Class::Emitter:
+        else if (auto pEmitter = std::get_if<EmitterInfo>(&object))
         {
-            auto emitter = buildEmitter(ctx, child);
+            if (!pEmitter->envMapPath.empty())
+                pEmitter->pEnvMap = createEnvMap(ctx, *pEmitter);
 
-            if (emitter.pEnvMap)
+            if (pEmitter->pEnvMap)
             {
                 if (ctx.builder.getEnvMap() != nullptr)
                     FALCOR_THROW("Only one envmap can be added.");
-                ctx.builder.setEnvMap(emitter.pEnvMap);
+                ctx.builder.setEnvMap(pEmitter->pEnvMap);
             }
-            else if (emitter.pLight)
+            else if (pEmitter->pLight)
             {
-                SceneBuilder::Node node{id, emitter.transform};
+                SceneBuilder::Node node{id, pEmitter->transform};
                 auto nodeID = ctx.builder.addNode(node);
-                emitter.pLight->setNodeID(nodeID);
-                ctx.builder.addLight(emitter.pLight);
+                pEmitter->pLight->setNodeID(nodeID);
+                ctx.builder.addLight(pEmitter->pLight);
             }
         }
-        break;
-
-        case Class::Shape:
+        else if (auto pShape = std::get_if<ShapeInfo>(&object))
         {
-            auto shape = buildShape(ctx, child);
+            if (pShape->pMesh && !pShape->meshPath.empty())
+                pShape->pMesh->setName(id);
 
-            if (shape.pMesh && shape.pMaterial)
+            if (pShape->pMesh && pShape->pMaterial)
             {
-                SceneBuilder::Node node{id, shape.transform};
+                SceneBuilder::Node node{id, pShape->transform};
                 auto nodeID = ctx.builder.addNode(node);
-                auto meshID = ctx.builder.addTriangleMesh(shape.pMesh, shape.pMaterial);
+                auto meshID = ctx.builder.addTriangleMeshAsync(pShape->pMesh, pShape->pMaterial);
                 ctx.builder.addMeshInstance(nodeID, meshID);
             }
         }
-        break;
-        }
     }
 }
 
@@ -55,7 +55,56 @@ std::string to_string(const MaterialRef& materialRef)
     }
 }
 
-BasicScene::BasicScene(const std::filesystem::path& searchPath) : mSearchPath(searchPath) {}
+void BasicScene::ImportRemap::apply(ShapeSceneEntity& shape) const
+{
+    uint32_t* pIndex = std::get_if<uint32_t>(&shape.materialRef);
+    if (pIndex && *pIndex >= materialIndexBase)
+        *pIndex = *pIndex - materialIndexBase + materialOffset;
+    if (shape.lightIndex >= 0)
+        shape.lightIndex += areaLightOffset;
+}
+
+BasicScene::BasicScene(const std::filesystem::path& searchPath, uint32_t materialIndexBase)
+    : mSearchPath(searchPath), mMaterialIndexBase(materialIndexBase)
+{}
+
+std::unique_ptr<BasicScene> BasicScene::createImportScene() const
+{
+    return std::make_unique<BasicScene>(mSearchPath, mMaterialIndexBase + (uint32_t)mMaterials.size());
+}
+
+BasicScene::ImportRemap BasicScene::mergeImport(BasicScene& importScene, size_t lightPosition)
+{
+    FALCOR_ASSERT(lightPosition <= mLights.size());
+
+    ImportRemap remap;
+    remap.materialIndexBase = importScene.mMaterialIndexBase;
+    remap.materialOffset = mMaterialIndexBase + (uint32_t)mMaterials.size();
+    remap.areaLightOffset = (uint32_t)mAreaLights.size();
+
+    // Names are validated by the scene builder, so there are no duplicates.
+    mNamedMaterials.merge(importScene.mNamedMaterials);
+    std::move(importScene.mMaterials.begin(), importScene.mMaterials.end(), std::back_inserter(mMaterials));
+    std::move(importScene.mMedia.begin(), importScene.mMedia.end(), std::back_inserter(mMedia));
+    mFloatTextures.merge(importScene.mFloatTextures);
+    mSpectrumTextures.merge(importScene.mSpectrumTextures);
+    mLights.insert(
+        mLights.begin() + lightPosition,
+        std::make_move_iterator(importScene.mLights.begin()),
+        std::make_move_iterator(importScene.mLights.end())
+    );
+    std::move(importScene.mAreaLights.begin(), importScene.mAreaLights.end(), std::back_inserter(mAreaLights));
+
+    for (auto& [name, instanceDefinition] : importScene.mInstanceDefinitions)
+    {
+        for (auto& shape : instanceDefinition.shapes)
+            remap.apply(shape);
+    }
+    mInstanceDefinitions.merge(importScene.mInstanceDefinitions);
+    std::move(importScene.mIncludedFiles.begin(), importScene.mIncludedFiles.end(), std::back_inserter(mIncludedFiles));
+
+    return remap;
+}
 
 void BasicScene::setOptions(
     SceneEntity filter,
@@ -82,7 +131,7 @@ void BasicScene::addNamedMaterial(std::string name, MaterialSceneEntity material
 uint32_t BasicScene::addMaterial(MaterialSceneEntity material)
 {
     mMaterials.push_back(material);
-    return (uint32_t)(mMaterials.size() - 1);
+    return mMaterialIndexBase + (uint32_t)(mMaterials.size() - 1);
 }
 
 void BasicScene::addMedium(MediumSceneEntity medium)
@@ -126,12 +175,17 @@ void BasicScene::addInstances(std::vector<InstanceSceneEntity>& instances)
     std::move(instances.begin(), instances.end(), std::back_inserter(mInstances));
 }
 
+void BasicScene::addIncludedFile(const std::filesystem::path& path)
+{
+    mIncludedFiles.push_back(path);
+}
+
 const MaterialSceneEntity& BasicScene::getMaterial(const MaterialRef& materialRef) const
 {
     if (const uint32_t* pIndex = std::get_if<uint32_t>(&materialRef))
     {
-        FALCOR_ASSERT(*pIndex >= 0 && *pIndex <= mMaterials.size());
-        return mMaterials[*pIndex];
+        FALCOR_ASSERT(*pIndex >= mMaterialIndexBase && *pIndex - mMaterialIndexBase < mMaterials.size());
+        return mMaterials[*pIndex - mMaterialIndexBase];
     }
     else if (const std::string* pName = std::get_if<std::string>(&materialRef))
     {
@@ -432,6 +486,11 @@ void BasicSceneBuilder::onObjectEnd(FileLoc loc)
         throwError(loc, "ObjectEnd called outside of instance definition.");
     }
 
+    if (mStack.empty())
+    {
+        throwError(loc, "Mismatched nesting: ObjectEnd without ObjectBegin.");
+    }
+
     if (mStack.back().type == StackEntry::Type::Attribute)
     {
         throwError(loc, "Mismatched nesting: open AttributeBegin from {} at ObjectEnd.", mStack.back().loc.toString());
@@ -462,6 +521,78 @@ void BasicSceneBuilder::onObjectInstance(const std::string& name, FileLoc loc)
     mInstances.push_back(std::move(instance));
 }
 
+void BasicSceneBuilder::onInclude(const std::filesystem::path& path, FileLoc loc)
+{
+    mScene.addIncludedFile(path);
+}
+
+std::unique_ptr<ParserTarget> BasicSceneBuilder::onImport(const std::filesystem::path& path, FileLoc loc)
+{
+    VERIFY_WORLD("Import");
+
+    // Shapes of an imported file inside an instance definition belong to the definition, parse these in place.
+    if (mpActiveInstanceDefinition)
+        return nullptr;
+
+    // The imported file is parsed into its own scene, starting from the current graphics state.
+    // Named entities are validated against ours when merging.
+    auto pImportScene = mScene.createImportScene();
+    auto pBuilder = std::make_unique<BasicSceneBuilder>(*pImportScene);
+    pBuilder->mpImportScene = std::move(pImportScene);
+    pBuilder->mCurrentBlock = mCurrentBlock;
+    pBuilder->mGraphicsState = mGraphicsState;
+    pBuilder->mNamedCoordinateSystems = mNamedCoordinateSystems;
+    pBuilder->mImportPosition = {mShapes.size(), mInstances.size(), mScene.getLights().size()};
+    return pBuilder;
+}
+
+void BasicSceneBuilder::onMergeImport(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc)
+{
+    auto pImport = dynamic_cast<BasicSceneBuilder*>(pImportTarget.get());
+    FALCOR_ASSERT(pImport && pImport->mpImportScene);
+
+    if (!pImport->mStack.empty())
+    {
+        throwError(loc, "Missing end to AttributeBegin in imported file.");
+    }
+
+    auto mergeNames = [&](std::set<std::string>& names, const std::set<std::string>& importNames, const std::string_view type)
+    {
+        for (const auto& name : importNames)
+        {
+            if (!names.insert(name).second)
+                throwError(loc, "Redefining {} '{}' in imported file.", type, name);
+        }
+    };
+    mergeNames(mNamedMaterialNames, pImport->mNamedMaterialNames, "named material");
+    mergeNames(mMediumNames, pImport->mMediumNames, "named medium");
+    mergeNames(mFloatTextureNames, pImport->mFloatTextureNames, "texture");
+    mergeNames(mSpectrumTextureNames, pImport->mSpectrumTextureNames, "texture");
+    mergeNames(mInstanceNames, pImport->mInstanceNames, "object instance");
+
+    // Imports are merged in order, so entities of previous imports were inserted before the recorded positions.
+    const auto& position = pImport->mImportPosition;
+    const size_t lightCount = pImport->mpImportScene->getLights().size();
+    BasicScene::ImportRemap remap = mScene.mergeImport(*pImport->mpImportScene, position.lights + mMergedImportCount.lights);
+    for (auto& shape : pImport->mShapes)
+        remap.apply(shape);
+
+    mShapes.insert(
+        mShapes.begin() + position.shapes + mMergedImportCount.shapes,
+        std::make_move_iterator(pImport->mShapes.begin()),
+        std::make_move_iterator(pImport->mShapes.end())
+    );
+    mInstances.insert(
+        mInstances.begin() + position.instances + mMergedImportCount.instances,
+        std::make_move_iterator(pImport->mInstances.begin()),
+        std::make_move_iterator(pImport->mInstances.end())
+    );
+
+    mMergedImportCount.shapes += pImport->mShapes.size();
+    mMergedImportCount.instances += pImport->mInstances.size();
+    mMergedImportCount.lights += lightCount;
+}
+
 void BasicSceneBuilder::onEndOfFiles()
 {
     if (mCurrentBlock != BlockState::WorldBlock)
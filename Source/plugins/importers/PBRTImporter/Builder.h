@@ -39,6 +39,7 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <variant>
@@ -230,7 +231,34 @@ struct InstanceSceneEntity
 class BasicScene
 {
 public:
-    BasicScene(const std::filesystem::path& searchPath);
+    /**
+     * Remapping of material and area light indices when merging an imported scene.
+     */
+    struct ImportRemap
+    {
+        uint32_t materialIndexBase = 0; ///< First material index of the imported scene.
+        uint32_t materialOffset = 0;    ///< Index of the first imported material in the scene it is merged into.
+        uint32_t areaLightOffset = 0;   ///< Index of the first imported area light in the scene it is merged into.
+
+        void apply(ShapeSceneEntity& shape) const;
+    };
+
+    BasicScene(const std::filesystem::path& searchPath, uint32_t materialIndexBase = 0);
+
+    /**
+     * Create an empty scene to parse an 'Import' directive into.
+     * Material indices of the imported scene start after the current materials, so indices in inherited graphics state stay valid.
+     */
+    std::unique_ptr<BasicScene> createImportScene() const;
+
+    /**
+     * Merge a scene created with createImportScene() into this scene.
+     * Shapes of instance definitions are remapped, other shapes of the imported file must be remapped with the returned remap.
+     * @param[in] importScene Imported scene. Its contents are moved out.
+     * @param[in] lightPosition Position at which the imported lights are inserted.
+     * @return Remapping of material and area light indices.
+     */
+    ImportRemap mergeImport(BasicScene& importScene, size_t lightPosition);
 
     void setOptions(
         SceneEntity filter,
@@ -251,6 +279,7 @@ public:
     void addShapes(std::vector<ShapeSceneEntity>& shapes);
     void addInstanceDefinition(InstanceDefinitionSceneEntity instanceDefinition);
     void addInstances(std::vector<InstanceSceneEntity>& instances);
+    void addIncludedFile(const std::filesystem::path& path);
 
     const CameraSceneEntity& getCamera() const { return mCamera; }
 
@@ -263,6 +292,7 @@ public:
     const std::vector<ShapeSceneEntity>& getShapes() const { return mShapes; }
     const std::map<std::string, InstanceDefinitionSceneEntity>& getInstanceDefinitions() const { return mInstanceDefinitions; }
     const std::vector<InstanceSceneEntity>& getInstances() const { return mInstances; }
+    const std::vector<std::filesystem::path>& getIncludedFiles() const { return mIncludedFiles; }
 
     /**
      * Get a named or unnamed material.
@@ -277,6 +307,7 @@ public:
 
 private:
     std::filesystem::path mSearchPath;
+    uint32_t mMaterialIndexBase = 0;
 
     SceneEntity mFilter;
     SceneEntity mFilm;
@@ -296,6 +327,7 @@ private:
 
     std::map<std::string, InstanceDefinitionSceneEntity> mInstanceDefinitions;
     std::vector<InstanceSceneEntity> mInstances;
+    std::vector<std::filesystem::path> mIncludedFiles;
 };
 
 constexpr uint32_t kMaxTransforms = 2;
@@ -384,6 +416,9 @@ public:
     void onObjectBegin(const std::string& name, FileLoc loc) override;
     void onObjectEnd(FileLoc loc) override;
     void onObjectInstance(const std::string& name, FileLoc loc) override;
+    void onInclude(const std::filesystem::path& path, FileLoc loc) override;
+    std::unique_ptr<ParserTarget> onImport(const std::filesystem::path& path, FileLoc loc) override;
+    void onMergeImport(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc) override;
 
     void onEndOfFiles() override;
 
@@ -474,6 +509,21 @@ private:
 
     std::vector<ShapeSceneEntity> mShapes;
     std::vector<InstanceSceneEntity> mInstances;
+
+    /// Scene owned by builders created for 'Import' directives.
+    std::unique_ptr<BasicScene> mpImportScene;
+
+    /// Positions in the parent builder at which imported entities are inserted.
+    struct ImportPosition
+    {
+        size_t shapes = 0;
+        size_t instances = 0;
+        size_t lights = 0;
+    };
+    ImportPosition mImportPosition;
+
+    /// Number of entities inserted by merged imports, used to adjust positions of later imports.
+    ImportPosition mMergedImportCount;
 };
 
 } // namespace Falcor::pbrt
@@ -69,6 +69,7 @@
 #include "Utils/Settings/Settings.h"
 #include "Utils/Logger.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/FNVHash.h"
 #include "Scene/Importer.h"
@@ -86,6 +87,9 @@
 
 #include <pybind11/pybind11.h>
 
+#include <algorithm>
+#include <execution>
+#include <set>
 #include <unordered_map>
 
 namespace Falcor
@@ -226,6 +230,14 @@ struct BuilderContext
 
     std::map<std::string, InstanceDefinition> instanceDefinitions;
 
+    /// PLY mesh loaded ahead of shape creation.
+    struct PreloadedMesh
+    {
+        Falcor::ref<Falcor::TriangleMesh> pTriangleMesh;
+        size_t useCount = 0; ///< Number of shapes still referencing the mesh.
+    };
+    std::map<std::filesystem::path, PreloadedMesh> plyMeshes;
+
     size_t curveCount = 0;
 
     bool usePBRTMaterials = false;
@@ -259,7 +271,12 @@ struct BuilderContext
         return pMaterial;
     }
 
-    Resolver resolver = [this](const std::filesystem::path& path) { return scene.resolvePath(path); };
+    Resolver resolver = [this](const std::filesystem::path& path)
+    {
+        auto resolved = scene.resolvePath(path);
+        builder.addDependency(resolved);
+        return resolved;
+    };
 };
 
 inline void warnUnsupportedType(const FileLoc& loc, const std::string_view category, const std::string_view name)
@@ -1593,7 +1610,24 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         auto filename = params.getString("filename", "");
         auto path = ctx.resolver(filename);
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
+        if (auto it = ctx.plyMeshes.find(path); it != ctx.plyMeshes.end())
+        {
+            // The mesh is modified per shape below, so all but the last shape using a preloaded mesh get a copy.
+            auto& preloaded = it->second;
+            if (--preloaded.useCount == 0)
+            {
+                shape.pTriangleMesh = std::move(preloaded.pTriangleMesh);
+                ctx.plyMeshes.erase(it);
+            }
+            else if (const auto& pMesh = preloaded.pTriangleMesh)
+            {
+                shape.pTriangleMesh = Falcor::TriangleMesh::create(pMesh->getVertices(), pMesh->getIndices(), pMesh->getFrontFaceCW());
+            }
+        }
+        else
+        {
+            shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path);
+        }
         if (shape.pTriangleMesh)
             shape.pTriangleMesh->setName(filename);
         shape.transform = entity.transform;
@@ -1764,7 +1798,7 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
         auto shape = createShape(ctx, shapeEntity);
         if (shape.pTriangleMesh)
         {
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
+            auto meshID = ctx.builder.addTriangleMeshAsync(shape.pTriangleMesh, shape.pMaterial);
             instanceDefinition.meshes.emplace_back(meshID, shape.transform);
         }
 
@@ -1791,6 +1825,44 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
     return instanceDefinition;
 }
 
+/**
+ * Load all PLY meshes referenced by shapes in parallel.
+ * Shapes are created sequentially, so loading the meshes up front takes file IO and parsing off that path.
+ */
+void loadPlyMeshes(BuilderContext& ctx)
+{
+    auto addShapes = [&ctx](const std::vector<ShapeSceneEntity>& entities)
+    {
+        for (const auto& entity : entities)
+        {
+            if (entity.name == "plymesh")
+                ctx.plyMeshes[ctx.scene.resolvePath(entity.params.getString("filename", ""))].useCount++;
+        }
+    };
+
+    // Only instance definitions that are instanced are created.
+    addShapes(ctx.scene.getShapes());
+    std::set<std::string> instanced;
+    for (const auto& entity : ctx.scene.getInstances())
+        instanced.insert(entity.name);
+    for (const auto& [name, entity] : ctx.scene.getInstanceDefinitions())
+    {
+        if (instanced.count(name) > 0)
+            addShapes(entity.shapes);
+    }
+
+    std::vector<std::pair<const std::filesystem::path, BuilderContext::PreloadedMesh>*> meshes;
+    for (auto& mesh : ctx.plyMeshes)
+        meshes.push_back(&mesh);
+
+    std::for_each(
+        std::execution::par,
+        meshes.begin(),
+        meshes.end(),
+        [](auto* pMesh) { pMesh->second.pTriangleMesh = Falcor::TriangleMesh::createFromFile(pMesh->first); }
+    );
+}
+
 void buildScene(BuilderContext& ctx)
 {
     // Load float textures.
@@ -1842,6 +1914,9 @@ void buildScene(BuilderContext& ctx)
         }
     }
 
+    // Load PLY meshes in parallel before processing the shapes.
+    loadPlyMeshes(ctx);
+
     // Process shapes and create meshes.
     for (const auto& entity : ctx.scene.getShapes())
     {
@@ -1849,7 +1924,7 @@ void buildScene(BuilderContext& ctx)
         if (shape.pTriangleMesh)
         {
             auto nodeID = ctx.builder.addNode({entity.name, shape.transform});
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
+            auto meshID = ctx.builder.addTriangleMeshAsync(shape.pTriangleMesh, shape.pMaterial);
             ctx.builder.addMeshInstance(nodeID, meshID);
         }
     }
@@ -1925,8 +2000,22 @@ void PBRTImporter::importScene(
         TimeReport timeReport;
         pbrt::BasicScene pbrtScene(path.parent_path());
         pbrt::BasicSceneBuilder pbrtBuilder(pbrtScene);
+        auto parseStart = CpuTimer::getCurrentTimePoint();
         pbrt::parseFile(pbrtBuilder, path);
+        double parseTime = CpuTimer::calcDuration(parseStart, CpuTimer::getCurrentTimePoint());
+        uint64_t parsedBytes = std::filesystem::file_size(path);
+        for (const auto& includedFile : pbrtScene.getIncludedFiles())
+        {
+            builder.addDependency(includedFile);
+            parsedBytes += std::filesystem::file_size(includedFile);
+        }
         timeReport.measure("Parsing pbrt scene");
+        logInfo(
+            "PBRTImporter: Parsed {:.1f} MB in {:.1f} ms ({:.1f} MB/s).",
+            parsedBytes / 1e6,
+            parseTime,
+            parsedBytes / 1e3 / std::max(parseTime, 1e-3)
+        );
 
         pbrt::BuilderContext ctx{pbrtScene, builder};
         ctx.usePBRTMaterials = builder.getSettings().getOption("PBRTImporter:usePBRTMaterials", false);
@@ -36,10 +36,12 @@
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/TaskManager.h"
 
 #include <fast_float/fast_float.h>
 
 #include <atomic>
+#include <mutex>
 #include <utility>
 #include <charconv>
 
@@ -93,11 +95,14 @@ std::unique_ptr<Tokenizer> Tokenizer::createFromFile(const std::filesystem::path
         std::string str = decompressFile(path);
         return std::make_unique<Tokenizer>(std::move(str), path);
     }
-    else
-    {
-        std::string str = readFile(path);
-        return std::make_unique<Tokenizer>(std::move(str), path);
-    }
+
+    auto pFile = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    if (pFile->isOpen())
+        return std::make_unique<Tokenizer>(std::move(pFile), path);
+
+    // Empty files can't be mapped. This also reports errors for files that can't be read.
+    std::string str = readFile(path);
+    return std::make_unique<Tokenizer>(std::move(str), path);
 }
 
 std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
@@ -107,16 +112,37 @@ std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
 
 Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path) : mPath(path), mContents(std::move(str))
 {
-    auto pFilename = std::make_unique<std::string>(path.string());
-    mLoc = FileLoc(*pFilename);
-    getFilenames().push_back(std::move(pFilename));
+    init(mContents.data(), mContents.size());
+}
+
+Tokenizer::Tokenizer(std::unique_ptr<MemoryMappedFile> pFile, const std::filesystem::path& path) : mPath(path), mpFile(std::move(pFile))
+{
+    FALCOR_ASSERT(mpFile && mpFile->isOpen());
+    init(static_cast<const char*>(mpFile->getData()), mpFile->getMappedSize());
+}
+
+void Tokenizer::init(const char* data, size_t size)
+{
+    mLoc = FileLoc(addFilename(mPath));
 
-    mPos = mContents.data();
-    mEnd = mPos + mContents.size();
-    if (isUTF16(mContents.data(), mContents.size()))
+    mBegin = data;
+    mPos = data;
+    mEnd = data + size;
+    if (isUTF16(data, size))
         throwError("File is encoded with UTF-16, which is not currently supported.");
 }
 
+const std::string& Tokenizer::addFilename(const std::filesystem::path& path)
+{
+    // Files are tokenized on multiple threads when using 'Import'.
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<std::string>> filenames;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    filenames.push_back(std::make_unique<std::string>(path.string()));
+    return *filenames.back();
+}
+
 bool Tokenizer::isUTF16(const void* ptr, size_t len) const
 {
     auto c = reinterpret_cast<const unsigned char*>(ptr);
@@ -448,14 +474,35 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
     return parameterVector;
 }
 
-void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
+/**
+ * Files referenced by 'Import' directives that are parsed in parallel.
+ */
+struct PendingImports
+{
+    struct Import
+    {
+        std::unique_ptr<ParserTarget> pTarget;
+        FileLoc loc;
+    };
+
+    std::vector<Import> imports;
+    /// Declared after the imports, so it is destroyed first. Its destructor waits for the parse jobs writing to the targets.
+    std::unique_ptr<TaskManager> pTaskManager;
+};
+
+static void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer, const std::filesystem::path& searchPath);
+
+static void parseTokens(
+    ParserTarget& target,
+    std::unique_ptr<Tokenizer> tokenizer,
+    const std::filesystem::path& searchPath,
+    PendingImports& pendingImports
+)
 {
     static std::atomic<bool> warnedTransformBeginEndDeprecated{false};
 
     logInfo("PBRTImporter: Started parsing '{}'.", tokenizer->getPath().string());
 
-    auto searchPath = tokenizer->getPath().parent_path();
-
     std::vector<std::unique_ptr<Tokenizer>> fileStack;
     fileStack.push_back(std::move(tokenizer));
 
@@ -633,13 +680,33 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 Token filenameToken = *nextToken(TokenRequired);
                 std::string filename = toString(dequoteString(filenameToken));
                 auto path = searchPath / filename;
+                target.onInclude(path, tok->loc);
                 std::unique_ptr<Tokenizer> includeTokenizer = Tokenizer::createFromFile(path);
                 logInfo("PBRTImporter: Started parsing '{}'.", includeTokenizer->getPath().string());
                 fileStack.push_back(std::move(includeTokenizer));
             }
             else if (tok->token == "Import")
             {
-                throwError(tok->loc, "'Import' directive not supported yet.");
+                Token filenameToken = *nextToken(TokenRequired);
+                std::string filename = toString(dequoteString(filenameToken));
+                auto path = searchPath / filename;
+                target.onInclude(path, tok->loc);
+                if (auto pImportTarget = target.onImport(path, tok->loc))
+                {
+                    // Parse the file into its own target on the job system. Targets are merged in order once parsing is done.
+                    if (!pendingImports.pTaskManager)
+                        pendingImports.pTaskManager = std::make_unique<TaskManager>();
+                    ParserTarget* pTarget = pImportTarget.get();
+                    pendingImports.imports.push_back({std::move(pImportTarget), tok->loc});
+                    pendingImports.pTaskManager->addTask([pTarget, path, searchPath]()
+                                                         { parse(*pTarget, Tokenizer::createFromFile(path), searchPath); });
+                }
+                else
+                {
+                    std::unique_ptr<Tokenizer> importTokenizer = Tokenizer::createFromFile(path);
+                    logInfo("PBRTImporter: Started parsing '{}'.", importTokenizer->getPath().string());
+                    fileStack.push_back(std::move(importTokenizer));
+                }
             }
             else if (tok->token == "Identity")
             {
@@ -876,17 +943,31 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
     }
 }
 
+static void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer, const std::filesystem::path& searchPath)
+{
+    // If parsing throws, pending imports are waited for when pendingImports is destroyed.
+    PendingImports pendingImports;
+    parseTokens(target, std::move(tokenizer), searchPath, pendingImports);
+
+    if (pendingImports.pTaskManager)
+    {
+        pendingImports.pTaskManager->finish(nullptr);
+        for (auto& import : pendingImports.imports)
+            target.onMergeImport(std::move(import.pTarget), import.loc);
+    }
+}
+
 void parseFile(ParserTarget& target, const std::filesystem::path& path)
 {
     auto tokenizer = Tokenizer::createFromFile(path);
-    parse(target, std::move(tokenizer));
+    parse(target, std::move(tokenizer), path.parent_path());
     target.onEndOfFiles();
 }
 
 void parseString(ParserTarget& target, std::string str)
 {
     auto tokenizer = Tokenizer::createFromString(std::move(str));
-    parse(target, std::move(tokenizer));
+    parse(target, std::move(tokenizer), {});
     target.onEndOfFiles();
 }
 
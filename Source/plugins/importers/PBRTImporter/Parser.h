@@ -35,6 +35,7 @@
 
 #include "Types.h"
 #include "Parameters.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include <functional>
 #include <filesystem>
 #include <memory>
@@ -97,6 +98,19 @@ public:
     virtual void onObjectBegin(const std::string& name, FileLoc loc) = 0;
     virtual void onObjectEnd(FileLoc loc) = 0;
     virtual void onObjectInstance(const std::string& name, FileLoc loc) = 0;
+    virtual void onInclude(const std::filesystem::path& path, FileLoc loc) = 0;
+
+    /**
+     * Called for an 'Import' directive.
+     * Imported files are parsed in parallel into the returned target, which must not share mutable state with this target.
+     * Return nullptr to parse the file in place like an 'Include'.
+     */
+    virtual std::unique_ptr<ParserTarget> onImport(const std::filesystem::path& path, FileLoc loc) { return nullptr; }
+
+    /**
+     * Called when parsing of a file has finished, once for each target returned by onImport() in directive order.
+     */
+    virtual void onMergeImport(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc) {}
 
     virtual void onEndOfFiles() = 0;
 };
@@ -113,10 +127,15 @@ struct Token
     FileLoc loc;
 };
 
+/**
+ * Tokenizer for pbrt scene files.
+ * Uncompressed files are memory mapped and tokenized in place, so parsing doesn't keep a copy of the file in memory.
+ */
 class Tokenizer
 {
 public:
     Tokenizer(std::string str, const std::filesystem::path& path);
+    Tokenizer(std::unique_ptr<MemoryMappedFile> pFile, const std::filesystem::path& path);
 
     static std::unique_ptr<Tokenizer> createFromFile(const std::filesystem::path& path);
     static std::unique_ptr<Tokenizer> createFromString(std::string str);
@@ -129,16 +148,17 @@ public:
 
     const std::filesystem::path& getPath() const { return mPath; }
 
+    /// Get the size of the tokenized contents in bytes.
+    size_t getSize() const { return mEnd - mBegin; }
+
 private:
+    void init(const char* data, size_t size);
+
     /**
      * Static list of filenames to allow file locations (FileLoc::filename) to be valid
      * even after the tokenizer is destroyed.
      */
-    static std::vector<std::unique_ptr<std::string>>& getFilenames()
-    {
-        static std::vector<std::unique_ptr<std::string>> filenames;
-        return filenames;
-    }
+    static const std::string& addFilename(const std::filesystem::path& path);
 
     bool isUTF16(const void* ptr, size_t len) const;
 
@@ -170,12 +190,14 @@ private:
         }
     }
 
-    std::filesystem::path mPath; ///< File path we're reading from.
-    FileLoc mLoc;                ///< File location.
-    std::string mContents;       ///< File contents we're parsing.
+    std::filesystem::path mPath;              ///< File path we're reading from.
+    FileLoc mLoc;                             ///< File location.
+    std::string mContents;                    ///< File contents we're parsing (if not memory mapped).
+    std::unique_ptr<MemoryMappedFile> mpFile; ///< Memory mapped file we're parsing.
 
-    const char* mPos; ///< Current position in the file.
-    const char* mEnd; ///< End of the file (one past).
+    const char* mBegin; ///< Start of the file.
+    const char* mPos;   ///< Current position in the file.
+    const char* mEnd;   ///< End of the file (one past).
 
     std::string mEscaped; ///< Temporary storage for escaped tokens.
 };
@@ -41,6 +41,10 @@
 
 #include <tbb/parallel_for.h>
 
+#include <cstring>
+#include <map>
+#include <optional>
+
 BEGIN_DISABLE_USD_WARNINGS
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usd/stage.h>
@@ -75,6 +79,7 @@ namespace Falcor
     namespace
     {
         const bool kLoadMeshVertexAnimations = true;
+        const bool kFlattenPrototypes = true;
 
         // Subdivide each bspline curve segment into a single linear swept sphere segments (could be more if memory/perf allows).
         uint32_t kCurveSubdivPerSegment = 1;
@@ -252,21 +257,21 @@ namespace Falcor
             UsdAttribute pointsAttr = usdMesh.GetPointsAttr();
             if (!pointsAttr || !pointsAttr.Get(&baseMesh.points, timeCode))
             {
-                logWarning("Mesh '{}' does not specify vertices. Ignoring.", meshName);
+                logWarningLimited("Mesh '{}' does not specify vertices. Ignoring.", meshName);
                 return false;
             }
 
             UsdAttribute faceCountsAttr = usdMesh.GetFaceVertexCountsAttr();
             if (!faceCountsAttr || !faceCountsAttr.Get(&baseMesh.topology.faceCounts, timeCode))
             {
-                logWarning("Mesh '{}' has no faces. Ignoring.", meshName);
+                logWarningLimited("Mesh '{}' has no faces. Ignoring.", meshName);
                 return false;
             }
 
             UsdAttribute faceIndicesAttr = usdMesh.GetFaceVertexIndicesAttr();
             if (!faceIndicesAttr || !faceIndicesAttr.Get(&baseMesh.topology.faceIndices, timeCode))
             {
-                logWarning("Mesh '{}' does not specify face indices. Ignoring.", meshName);
+                logWarningLimited("Mesh '{}' does not specify face indices. Ignoring.", meshName);
                 return false;
             }
 
@@ -591,21 +596,21 @@ namespace Falcor
             UsdAttribute extentAttr = usdCurve.GetExtentAttr();
             if (!extentAttr || !extentAttr.Get(&usdExtent, timeCode))
             {
-                logWarning("Curve '{}' has no AABB. Ignoring.", curveName);
+                logWarningLimited("Curve '{}' has no AABB. Ignoring.", curveName);
                 return false;
             }
 
             UsdAttribute pointsAttr = usdCurve.GetPointsAttr();
             if (!pointsAttr || !pointsAttr.Get(&usdPoints, timeCode))
             {
-                logWarning("Curve '{}' does not specify control points. Ignoring.", curveName);
+                logWarningLimited("Curve '{}' does not specify control points. Ignoring.", curveName);
                 return false;
             }
 
             UsdAttribute curveVertexCountsAttr = usdCurve.GetCurveVertexCountsAttr();
             if (!curveVertexCountsAttr || !curveVertexCountsAttr.Get(&usdCurveVertexCounts, timeCode))
             {
-                logWarning("Curve '{}' has no vertices. Ignoring.", curveName);
+                logWarningLimited("Curve '{}' has no vertices. Ignoring.", curveName);
                 return false;
             }
 
@@ -684,7 +689,7 @@ namespace Falcor
             }
             else
             {
-                logWarning("Curve '{}' has no texture coordinates.", curveName);
+                logWarningLimited("Curve '{}' has no texture coordinates.", curveName);
             }
 
             return true;
@@ -754,7 +759,7 @@ namespace Falcor
             }
             else
             {
-                logWarning("Curve '{}' has no texture coordinates.", curveName);
+                logWarningLimited("Curve '{}' has no texture coordinates.", curveName);
             }
 
             return true;
@@ -800,12 +805,12 @@ namespace Falcor
 
             if (sbMesh.pIndices == nullptr || sbMesh.indexCount == 0)
             {
-                logWarning("Gprim '{}' has no indices. Ignoring.", meshPrim.GetPath().GetString());
+                logWarningLimited("Gprim '{}' has no indices. Ignoring.", meshPrim.GetPath().GetString());
                 return false;
             }
             if (sbMesh.positions.pData == nullptr)
             {
-                logWarning("Gprim '{}' has no position data. Ignoring.", meshPrim.GetPath().GetString());
+                logWarningLimited("Gprim '{}' has no position data. Ignoring.", meshPrim.GetPath().GetString());
                 return false;
             }
             return true;
@@ -835,12 +840,12 @@ namespace Falcor
 
             if (sbCurve.pIndices == nullptr || sbCurve.indexCount == 0)
             {
-                logWarning("Gprim '{}' has no indices. Ignoring.", curvePrim.GetPath().GetString());
+                logWarningLimited("Gprim '{}' has no indices. Ignoring.", curvePrim.GetPath().GetString());
                 return false;
             }
             if (sbCurve.positions.pData == nullptr)
             {
-                logWarning("Gprim '{}' has no position data. Ignoring.", curvePrim.GetPath().GetString());
+                logWarningLimited("Gprim '{}' has no position data. Ignoring.", curvePrim.GetPath().GetString());
                 return false;
             }
             return true;
@@ -1085,8 +1090,8 @@ namespace Falcor
 
         void addMeshesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
-            // Process collected mesh tasks.
-            tbb::parallel_for<size_t>(0, ctx.meshTasks.size(),
+            // Process collected mesh tasks on the scene builder's task pool.
+            ctx.builder.parallelFor(ctx.meshTasks.size(),
                 [&](size_t i)
                 {
                     FALCOR_ASSERT(ctx.meshTasks[i].sampleIdx == 0);
@@ -1121,7 +1126,7 @@ namespace Falcor
                 }
 
                 // Process time-sampled mesh keyframes
-                tbb::parallel_for<size_t>(0, ctx.meshKeyframeTasks.size(),
+                ctx.builder.parallelFor(ctx.meshKeyframeTasks.size(),
                     [&](size_t i)
                     {
                         auto& task = ctx.meshKeyframeTasks[i];
@@ -1136,6 +1141,110 @@ namespace Falcor
             timeReport.measure("Process meshes");
         }
 
+        /** Geometry of a prototype flattened into lists of instances, including the geometry of nested prototype instances.
+            Geometry is grouped by its transform relative to the prototype root, so that instantiating the prototype
+            only requires a single scene graph node per group, rather than a copy of the prototype's subgraph.
+        */
+        struct FlattenedPrototype
+        {
+            struct Group
+            {
+                std::string name;                   ///< Name of the first geom instance in the group, relative to the prototype.
+                float4x4 xform;                     ///< Transform relative to the prototype root.
+                std::vector<MeshID> meshIDs;        ///< Instanced meshes.
+                std::vector<CurveID> curveIDs;      ///< Instanced curves.
+            };
+
+            bool valid = false;                     ///< False if the prototype contains animations, and has to be instantiated as a subgraph.
+            std::vector<Group> groups;              ///< Instance groups.
+        };
+
+        /** Flatten the geometry of a prototype. Flattened prototypes are cached, indexed in the same way as ctx.prototypeGeoms.
+            Must be called after meshes and curves have been added to the scene builder.
+        */
+        const FlattenedPrototype& flattenPrototype(ImporterContext& ctx, const UsdPrim& protoPrim, std::vector<std::optional<FlattenedPrototype>>& cache)
+        {
+            size_t protoIndex = ctx.prototypeGeomMap.at(protoPrim);
+            if (cache[protoIndex])
+                return *cache[protoIndex];
+
+            // Insert an invalid entry first, which also guards against cyclic prototype references.
+            cache[protoIndex] = FlattenedPrototype{};
+            const PrototypeGeom& protoGeom = ctx.prototypeGeoms[protoIndex];
+            if (!protoGeom.animations.empty())
+                return *cache[protoIndex];
+
+            FlattenedPrototype flat;
+            struct XformLess
+            {
+                bool operator()(const float4x4& a, const float4x4& b) const { return std::memcmp(&a, &b, sizeof(float4x4)) < 0; }
+            };
+            std::map<float4x4, size_t, XformLess> groupIndices;
+            auto getGroup = [&](const std::string& name, const float4x4& xform) -> FlattenedPrototype::Group&
+            {
+                auto [it, inserted] = groupIndices.emplace(xform, flat.groups.size());
+                if (inserted)
+                    flat.groups.push_back(FlattenedPrototype::Group{name, xform});
+                return flat.groups[it->second];
+            };
+
+            // Compute node transforms relative to the prototype root. Parent nodes are always created before their children.
+            std::vector<float4x4> nodeXforms(protoGeom.nodes.size());
+            for (size_t i = 0; i < protoGeom.nodes.size(); ++i)
+            {
+                const auto& node = protoGeom.nodes[i];
+                FALCOR_ASSERT(node.parent == NodeID::Invalid() || node.parent.get() < i);
+                nodeXforms[i] = (node.parent == NodeID::Invalid()) ? node.transform : mul(nodeXforms[node.parent.get()], node.transform);
+            }
+
+            for (const auto& inst : protoGeom.geomInstances)
+            {
+                float4x4 xform = mul(nodeXforms[inst.parentID.get()], inst.xform);
+                if (inst.prim.IsA<UsdGeomMesh>())
+                {
+                    const auto& mesh = ctx.getMesh(inst.prim);
+                    auto& group = getGroup(inst.name, xform);
+                    group.meshIDs.insert(group.meshIDs.end(), mesh.meshIDs.begin(), mesh.meshIDs.end());
+                }
+                else if (inst.prim.IsA<UsdGeomBasisCurves>())
+                {
+                    const auto& curve = ctx.getCurve(inst.prim);
+                    auto& group = getGroup(inst.name, xform);
+                    if (curve.tessellationMode == CurveTessellationMode::LinearSweptSphere)
+                        group.curveIDs.push_back(CurveID{ curve.geometryID });
+                    else
+                        group.meshIDs.push_back(MeshID{ curve.geometryID });
+                }
+                else
+                {
+                    logError("Instanced geometry '{}' is of an unsupported type.", inst.name);
+                }
+            }
+
+            for (const auto& protoInst : protoGeom.prototypeInstances)
+            {
+                // Animated or missing nested prototypes are handled when instantiating the subgraph.
+                if (!protoInst.keyframes.empty() || !ctx.hasPrototype(protoInst.protoPrim))
+                    return *cache[protoIndex];
+
+                const FlattenedPrototype& child = flattenPrototype(ctx, protoInst.protoPrim, cache);
+                if (!child.valid)
+                    return *cache[protoIndex];
+
+                float4x4 protoInstXform = mul(nodeXforms[protoInst.parentID.get()], protoInst.xform);
+                for (const auto& childGroup : child.groups)
+                {
+                    auto& group = getGroup(protoInst.name + "/" + childGroup.name, mul(protoInstXform, childGroup.xform));
+                    group.meshIDs.insert(group.meshIDs.end(), childGroup.meshIDs.begin(), childGroup.meshIDs.end());
+                    group.curveIDs.insert(group.curveIDs.end(), childGroup.curveIDs.begin(), childGroup.curveIDs.end());
+                }
+            }
+
+            flat.valid = true;
+            cache[protoIndex] = std::move(flat);
+            return *cache[protoIndex];
+        }
+
         void addInstancesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
             // Helper function to add all submeshes associated with the given UsdGeomMesh to SceneBuilder
@@ -1156,11 +1265,50 @@ namespace Falcor
                 addSubmeshes(instance.prim, instance.name, float4x4::identity(), instance.bindTransform, instance.parentID);
             }
 
-            // Add instances of prototypes to scene builder. Because SceneBuilder only supports instanced meshes, and not
-            // general instancing, we effectively replicate each Prototype's subgraph. We could in theory collapse the subgraph
-            // if all of the transformations are static, but time-sampled transformations require us to use a more general approach.
+            // Add instances of prototypes to scene builder. SceneBuilder only supports instanced meshes and curves, not general
+            // instancing. Prototypes without time-sampled transformations are flattened into lists of geometry grouped by transform,
+            // so that each instance only adds one node per group. Other prototypes are instantiated by replicating their subgraph.
+            std::vector<std::optional<FlattenedPrototype>> flattenedPrototypes(ctx.prototypeGeoms.size());
+            const bool flattenPrototypes = ctx.builder.getSettings().getOption("usdImporter:flattenPrototypes", kFlattenPrototypes);
+            const uint32_t nodeCount = ctx.builder.getNodeCount();
+            size_t flattenedInstanceCount = 0;
+
             for (const auto& instance : ctx.prototypeInstances)
             {
+                const FlattenedPrototype* pFlat = flattenPrototypes && ctx.hasPrototype(instance.protoPrim) ? &flattenPrototype(ctx, instance.protoPrim, flattenedPrototypes) : nullptr;
+                if (pFlat && pFlat->valid)
+                {
+                    // Animated instances need a root node targeted by the animation, static ones fold their transform into the group nodes.
+                    NodeID parentID = instance.parentID;
+                    float4x4 xform = instance.xform;
+                    if (instance.keyframes.size() > 0)
+                    {
+                        parentID = ctx.builder.addNode(makeNode(instance.name, instance.xform, float4x4::identity(), instance.parentID));
+                        xform = float4x4::identity();
+                        ref<Animation> pAnimation = Animation::create(instance.name, parentID, instance.keyframes.back().time);
+                        for (const auto& keyframe : instance.keyframes)
+                        {
+                            pAnimation->addKeyframe(keyframe);
+                        }
+                        ctx.builder.addAnimation(pAnimation);
+                    }
+
+                    for (const auto& group : pFlat->groups)
+                    {
+                        NodeID nodeID = ctx.builder.addNode(makeNode(instance.name + "/" + group.name, mul(xform, group.xform), float4x4::identity(), parentID));
+                        for (MeshID meshID : group.meshIDs)
+                        {
+                            ctx.builder.addMeshInstance(nodeID, meshID);
+                        }
+                        for (CurveID curveID : group.curveIDs)
+                        {
+                            ctx.builder.addCurveInstance(nodeID, curveID);
+                        }
+                    }
+                    ++flattenedInstanceCount;
+                    continue;
+                }
+
                 std::vector<std::pair<PrototypeInstance, NodeID>> protoInstanceStack = { std::make_pair(instance, instance.parentID) };
                 while (!protoInstanceStack.empty())
                 {
@@ -1256,6 +1404,15 @@ namespace Falcor
                 }
             }
 
+            if (!ctx.prototypeInstances.empty())
+            {
+                uint32_t addedNodeCount = ctx.builder.getNodeCount() - nodeCount;
+                logInfo(
+                    "USDImporter: Created {} prototype instances ({} flattened) using {} scene graph nodes ({:.1f} MB).",
+                    ctx.prototypeInstances.size(), flattenedInstanceCount, addedNodeCount, addedNodeCount * sizeof(SceneBuilder::Node) / (1024.0 * 1024.0)
+                );
+            }
+
             timeReport.measure("Create instances");
         }
 
@@ -1263,7 +1420,7 @@ namespace Falcor
         void addCurvesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
             // Process collected curves.
-            tbb::parallel_for<size_t>(0, ctx.curves.size(),
+            ctx.builder.parallelFor(ctx.curves.size(),
                 [&](size_t i) { processCurve(ctx.curves[i], ctx); }
             );
 
@@ -2041,7 +2198,7 @@ namespace Falcor
                 }
                 else if (prim.IsA<UsdLuxBoundableLightBase>() || prim.IsA<UsdLuxNonboundableLightBase>())
                 {
-                    logWarning("Ignoring light '{}' encountered in prototype prim.", primName);
+                    logWarningLimited("Ignoring light '{}' encountered in prototype prim.", primName);
                     it.PruneChildren();
                 }
                 else if (prim.IsA<UsdGeomXform>())
@@ -2062,7 +2219,7 @@ namespace Falcor
                 }
                 else if (!prim.GetTypeName().GetString().empty())
                 {
-                    logWarning("Ignoring prim '{}' of unsupported type {} while traversing prototype prim.", primName, prim.GetTypeName().GetString());
+                    logWarningLimited("Ignoring prim '{}' of unsupported type {} while traversing prototype prim.", primName, prim.GetTypeName().GetString());
                     it.PruneChildren();
                 }
             }